@@ -58,19 +58,22 @@ int idCollisionModelManagerLocal::Contacts( contactInfo_t *contacts, const int m
 								cmHandle_t model, const idVec3 &origin, const idMat3 &modelAxis ) {
 	trace_t results;
 	idVec3 end;
+	cm_traceContext_t *context;
+
+	context = idCollisionModelManagerLocal::GetTraceContext();
 
 	// same as Translation but instead of storing the first collision we store all collisions as contacts
-	idCollisionModelManagerLocal::getContacts = true;
-	idCollisionModelManagerLocal::contacts = contacts;
-	idCollisionModelManagerLocal::maxContacts = maxContacts;
-	idCollisionModelManagerLocal::numContacts = 0;
+	context->getContacts = true;
+	context->contacts = contacts;
+	context->maxContacts = maxContacts;
+	context->numContacts = 0;
 	end = start + dir.SubVec3(0) * depth;
 	idCollisionModelManagerLocal::Translation( &results, start, end, trm, trmAxis, contentMask, model, origin, modelAxis );
 	if ( dir.SubVec3(1).LengthSqr() != 0.0f ) {
 		// FIXME: rotational contacts
 	}
-	idCollisionModelManagerLocal::getContacts = false;
-	idCollisionModelManagerLocal::maxContacts = 0;
+	context->getContacts = false;
+	context->maxContacts = 0;
 
-	return idCollisionModelManagerLocal::numContacts;
+	return context->numContacts;
 }
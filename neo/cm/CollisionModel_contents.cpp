@@ -60,10 +60,9 @@ bool idCollisionModelManagerLocal::TestTrmVertsInBrush( cm_traceWork_t *tw, cm_b
 	float d, bestd;
 	idVec3 *p;
 
-	if ( b->checkcount == idCollisionModelManagerLocal::checkCount ) {
+	if ( CM_PrimitiveChecked( tw->context, b ) ) {
 		return false;
 	}
-	b->checkcount = idCollisionModelManagerLocal::checkCount;
 
 	if ( !(b->contents & tw->contents) ) {
 		return false;
@@ -132,10 +131,10 @@ CM_SetTrmEdgeSidedness
 CM_SetTrmPolygonSidedness
 ================
 */
-#define CM_SetTrmPolygonSidedness( v, plane, bitNum ) {						\
+#define CM_SetTrmPolygonSidedness( v, p, plane, bitNum ) {					\
 	const int mask = 1 << bitNum;											\
 	if ( ( (v)->sideSet & mask ) == 0 ) {									\
-		const float fl = plane.Distance( (v)->p );							\
+		const float fl = plane.Distance( p );								\
 		(v)->side = ( (v)->side & ~mask ) | ( ( fl < 0.0f ) ? mask : 0 );		\
 		(v)->sideSet |= mask;												\
 	}																		\
@@ -154,13 +153,13 @@ bool idCollisionModelManagerLocal::TestTrmInPolygon( cm_traceWork_t *tw, cm_poly
 	float d, bestd;
 	cm_trmEdge_t *trmEdge;
 	cm_edge_t *edge;
-	cm_vertex_t *v, *v1, *v2;
+	cm_vertex_t *v;
+	cm_primitiveState_t *edgeState, *vertexState, *v1, *v2;
 
 	// if already checked this polygon
-	if ( p->checkcount == idCollisionModelManagerLocal::checkCount ) {
+	if ( CM_PrimitiveChecked( tw->context, p ) ) {
 		return false;
 	}
-	p->checkcount = idCollisionModelManagerLocal::checkCount;
 
 	// if this polygon does not have the right contents behind it
 	if ( !(p->contents & tw->contents) ) {
@@ -192,14 +191,14 @@ bool idCollisionModelManagerLocal::TestTrmInPolygon( cm_traceWork_t *tw, cm_poly
 			edgeNum = p->edges[i];
 			edge = tw->model->edges + abs(edgeNum);
 			// if this edge is already tested
-			if ( edge->checkcount == idCollisionModelManagerLocal::checkCount ) {
+			if ( CM_EdgeState( tw, edgeNum )->checkcount == tw->context->checkCount ) {
 				continue;
 			}
 
 			for ( j = 0; j < 2; j++ ) {
 				v = &tw->model->vertices[edge->vertexNum[j]];
 				// if this vertex is already tested
-				if ( v->checkcount == idCollisionModelManagerLocal::checkCount ) {
+				if ( CM_VertexState( tw, edge->vertexNum[j] )->checkcount == tw->context->checkCount ) {
 					continue;
 				}
 
@@ -234,19 +233,20 @@ bool idCollisionModelManagerLocal::TestTrmInPolygon( cm_traceWork_t *tw, cm_poly
 	for ( i = 0; i < p->numEdges; i++ ) {
 		edgeNum = p->edges[i];
 		edge = tw->model->edges + abs(edgeNum);
+		edgeState = CM_EdgeState( tw, edgeNum );
 		// reset sidedness cache if this is the first time we encounter this edge
-		if ( edge->checkcount != idCollisionModelManagerLocal::checkCount ) {
-			edge->sideSet = 0;
+		if ( edgeState->checkcount != tw->context->checkCount ) {
+			edgeState->sideSet = 0;
 		}
 		// pluecker coordinate for edge
 		tw->polygonEdgePlueckerCache[i].FromLine( tw->model->vertices[edge->vertexNum[0]].p,
 													tw->model->vertices[edge->vertexNum[1]].p );
-		v = &tw->model->vertices[edge->vertexNum[INT32_SIGNBITSET( edgeNum )]];
+		vertexState = CM_VertexState( tw, edge->vertexNum[INT32_SIGNBITSET( edgeNum )] );
 		// reset sidedness cache if this is the first time we encounter this vertex
-		if ( v->checkcount != idCollisionModelManagerLocal::checkCount ) {
-			v->sideSet = 0;
+		if ( vertexState->checkcount != tw->context->checkCount ) {
+			vertexState->sideSet = 0;
 		}
-		v->checkcount = idCollisionModelManagerLocal::checkCount;
+		vertexState->checkcount = tw->context->checkCount;
 	}
 
 	// get side of polygon for each trm vertex
@@ -268,8 +268,9 @@ bool idCollisionModelManagerLocal::TestTrmInPolygon( cm_traceWork_t *tw, cm_poly
 			edgeNum = p->edges[j];
 			edge = tw->model->edges + abs(edgeNum);
 #if 1
-			CM_SetTrmEdgeSidedness( edge, tw->edges[i].pl, tw->polygonEdgePlueckerCache[j], i );
-			if ( INT32_SIGNBITSET( edgeNum ) ^ ( ( edge->side >> i ) & 1 ) ^ flip ) {
+			edgeState = CM_EdgeState( tw, edgeNum );
+			CM_SetTrmEdgeSidedness( edgeState, tw->edges[i].pl, tw->polygonEdgePlueckerCache[j], i );
+			if ( INT32_SIGNBITSET( edgeNum ) ^ ( ( edgeState->side >> i ) & 1 ) ^ flip ) {
 				break;
 			}
 #else
@@ -307,17 +308,18 @@ bool idCollisionModelManagerLocal::TestTrmInPolygon( cm_traceWork_t *tw, cm_poly
 	for ( i = 0; i < p->numEdges; i++ ) {
 		edgeNum = p->edges[i];
 		edge = tw->model->edges + abs(edgeNum);
-		if ( edge->checkcount == idCollisionModelManagerLocal::checkCount ) {
+		edgeState = CM_EdgeState( tw, edgeNum );
+		if ( edgeState->checkcount == tw->context->checkCount ) {
 			continue;
 		}
-		edge->checkcount = idCollisionModelManagerLocal::checkCount;
+		edgeState->checkcount = tw->context->checkCount;
 
 		for ( j = 0; j < tw->numPolys; j++ ) {
 #if 1
-			v1 = tw->model->vertices + edge->vertexNum[0];
-			CM_SetTrmPolygonSidedness( v1, tw->polys[j].plane, j );
-			v2 = tw->model->vertices + edge->vertexNum[1];
-			CM_SetTrmPolygonSidedness( v2, tw->polys[j].plane, j );
+			v1 = CM_VertexState( tw, edge->vertexNum[0] );
+			CM_SetTrmPolygonSidedness( v1, tw->model->vertices[edge->vertexNum[0]].p, tw->polys[j].plane, j );
+			v2 = CM_VertexState( tw, edge->vertexNum[1] );
+			CM_SetTrmPolygonSidedness( v2, tw->model->vertices[edge->vertexNum[1]].p, tw->polys[j].plane, j );
 			// if the polygon edge does not cross the trm polygon plane
 			if ( !(((v1->side ^ v2->side) >> j) & 1) ) {
 				continue;
@@ -326,10 +328,8 @@ bool idCollisionModelManagerLocal::TestTrmInPolygon( cm_traceWork_t *tw, cm_poly
 #else
 			float d1, d2;
 
-			v1 = tw->model->vertices + edge->vertexNum[0];
-			d1 = tw->polys[j].plane.Distance( v1->p );
-			v2 = tw->model->vertices + edge->vertexNum[1];
-			d2 = tw->polys[j].plane.Distance( v2->p );
+			d1 = tw->polys[j].plane.Distance( tw->model->vertices[edge->vertexNum[0]].p );
+			d2 = tw->polys[j].plane.Distance( tw->model->vertices[edge->vertexNum[1]].p );
 			// if the polygon edge does not cross the trm polygon plane
 			if ( (d1 >= 0.0f && d2 >= 0.0f) || (d1 <= 0.0f && d2 <= 0.0f) ) {
 				continue;
@@ -345,8 +345,8 @@ bool idCollisionModelManagerLocal::TestTrmInPolygon( cm_traceWork_t *tw, cm_poly
 				trmEdge = tw->edges + abs(trmEdgeNum);
 #if 1
 				bitNum = abs(trmEdgeNum);
-				CM_SetTrmEdgeSidedness( edge, trmEdge->pl, tw->polygonEdgePlueckerCache[i], bitNum );
-				if ( INT32_SIGNBITSET( trmEdgeNum ) ^ ( ( edge->side >> bitNum ) & 1 ) ^ flip ) {
+				CM_SetTrmEdgeSidedness( edgeState, trmEdge->pl, tw->polygonEdgePlueckerCache[i], bitNum );
+				if ( INT32_SIGNBITSET( trmEdgeNum ) ^ ( ( edgeState->side >> bitNum ) & 1 ) ^ flip ) {
 					break;
 				}
 #else
@@ -418,7 +418,7 @@ int idCollisionModelManagerLocal::PointContents( const idVec3 p, cmHandle_t mode
 	cm_brush_t *b;
 	idPlane *plane;
 
-	node = idCollisionModelManagerLocal::PointNode( p, idCollisionModelManagerLocal::models[model] );
+	node = idCollisionModelManagerLocal::PointNode( p, idCollisionModelManagerLocal::ModelForHandle( GetTraceContext(), model ) );
 	for ( bref = node->brushes; bref; bref = bref->next ) {
 		b = bref->b;
 		// test if the point is within the brush bounds
@@ -477,6 +477,7 @@ int idCollisionModelManagerLocal::ContentsTrm( trace_t *results, const idVec3 &s
 	bool model_rotated, trm_rotated;
 	idMat3 invModelAxis, tmpAxis;
 	idVec3 dir;
+	cm_traceContext_t *context;
 	ALIGN16( cm_traceWork_t tw );
 
 	// fast point case
@@ -492,8 +493,9 @@ int idCollisionModelManagerLocal::ContentsTrm( trace_t *results, const idVec3 &s
 		return results->c.contents;
 	}
 
-	idCollisionModelManagerLocal::checkCount++;
+	context = idCollisionModelManagerLocal::GetTraceContext();
 
+	tw.context = context;
 	tw.trace.fraction = 1.0f;
 	tw.trace.c.contents = 0;
 	tw.trace.c.type = CONTACT_NONE;
@@ -504,10 +506,12 @@ int idCollisionModelManagerLocal::ContentsTrm( trace_t *results, const idVec3 &s
 	tw.pointTrace = false;
 	tw.quickExit = false;
 	tw.numContacts = 0;
-	tw.model = idCollisionModelManagerLocal::models[model];
+	tw.model = idCollisionModelManagerLocal::ModelForHandle( context, model );
 	tw.start = start - modelOrigin;
 	tw.end = tw.start;
 
+	CM_BeginTrace( context, tw.model );
+
 	model_rotated = modelAxis.IsRotated();
 	if ( model_rotated ) {
 		invModelAxis = modelAxis.Transpose();
@@ -627,7 +631,7 @@ int idCollisionModelManagerLocal::Contents( const idVec3 &start,
 		common->Printf("idCollisionModelManagerLocal::Contents: invalid model handle\n");
 		return 0;
 	}
-	if ( !idCollisionModelManagerLocal::models || !idCollisionModelManagerLocal::models[model] ) {
+	if ( !idCollisionModelManagerLocal::models || !idCollisionModelManagerLocal::ModelForHandle( GetTraceContext(), model ) ) {
 		common->Printf("idCollisionModelManagerLocal::Contents: invalid model\n");
 		return 0;
 	}
@@ -94,6 +94,7 @@ idCVar cm_drawInternal(		"cm_drawInternal",		"1",		CVAR_GAME | CVAR_BOOL,	"draw
 idCVar cm_drawNormals(		"cm_drawNormals",		"0",		CVAR_GAME | CVAR_BOOL,	"draw polygon and edge normals" );
 idCVar cm_backFaceCull(		"cm_backFaceCull",		"0",		CVAR_GAME | CVAR_BOOL,	"cull back facing polygons" );
 idCVar cm_debugCollision(	"cm_debugCollision",	"0",		CVAR_GAME | CVAR_BOOL,	"debug the collision detection" );
+idCVar cm_flatTree(			"cm_flatTree",			"1",		CVAR_GAME | CVAR_BOOL,	"trace through the flattened node tree" );
 
 static idVec4 cm_color;
 
@@ -324,7 +325,7 @@ void idCollisionModelManagerLocal::DrawModel( cmHandle_t handle, const idVec3 &m
 		cm_drawColor.ClearModified();
 	}
 
-	model = models[ handle ];
+	model = ModelForHandle( GetTraceContext(), handle );
 	viewPos = (viewOrigin - modelOrigin) * modelAxis.Transpose();
 	checkCount++;
 	DrawNodePolygons( model, model->node, modelOrigin, modelAxis, viewPos, radius );
@@ -487,3 +488,267 @@ void idCollisionModelManagerLocal::DebugOutput( const idVec3 &origin ) {
 	Mem_Free( testend );
 	testend = NULL;
 }
+
+/*
+===============================================================================
+
+Multi-threaded trace test
+
+===============================================================================
+*/
+
+static const int CM_STRESS_TRACES_PER_JOB	= 256;
+static const int CM_STRESS_TRACES_PER_PASS	= 65536;
+static const int CM_STRESS_MAX_REPORTED		= 8;
+
+typedef struct cm_stressJob_s {
+	int						firstTrace;
+	int						numTraces;
+	idBounds				bounds;				// world model bounds the traces start in
+	trace_t *				results;
+} cm_stressJob_t;
+
+/*
+================
+CM_StressTestTrace
+
+  the trace is fully determined by the trace number so every thread can repeat it
+================
+*/
+static void CM_StressTestTrace( int traceNum, const idBounds &bounds, trace_t &results ) {
+	int i;
+	idVec3 start, end, size, axis;
+	idRandom random( traceNum );
+
+	for ( i = 0; i < 3; i++ ) {
+		start[i] = bounds[0][i] + random.RandomFloat() * ( bounds[1][i] - bounds[0][i] );
+		end[i] = start[i] + random.CRandomFloat() * cm_testLength.GetFloat();
+		size[i] = 1.0f + random.RandomFloat() * 32.0f;
+		axis[i] = random.CRandomFloat();
+	}
+	axis.Normalize();
+
+	idTraceModel trm( idBounds( -size, size ) );
+	idMat3 trmAxis = idAngles( 0.0f, random.RandomFloat() * 360.0f, 0.0f ).ToMat3();
+	const int contentMask = CONTENTS_SOLID|CONTENTS_PLAYERCLIP;
+
+	switch( random.RandomInt( 5 ) ) {
+		case 0: {
+			// point translation
+			collisionModelManager->Translation( &results, start, end, NULL, mat3_identity, contentMask, 0, vec3_origin, mat3_identity );
+			break;
+		}
+		case 1: {
+			// box translation
+			collisionModelManager->Translation( &results, start, end, &trm, trmAxis, contentMask, 0, vec3_origin, mat3_identity );
+			break;
+		}
+		case 2: {
+			// box rotation about a point near the box
+			idRotation rotation( start + axis.Cross( idVec3( 0.0f, 0.0f, 1.0f ) ) * size.Length(), axis, random.CRandomFloat() * cm_testAngle.GetFloat() );
+			collisionModelManager->Rotation( &results, start, rotation, &trm, trmAxis, contentMask, 0, vec3_origin, mat3_identity );
+			break;
+		}
+		case 3: {
+			// position test
+			memset( &results, 0, sizeof( results ) );
+			results.c.contents = collisionModelManager->Contents( start, &trm, trmAxis, -1, 0, vec3_origin, mat3_identity );
+			break;
+		}
+		default: {
+			// box against a trace model of the calling thread halfway the translation
+			idTraceModel obstacle( idBounds( -idVec3( size.y, size.z, size.x ), idVec3( size.y, size.z, size.x ) ) );
+			cmHandle_t handle = collisionModelManager->SetupTrmModel( obstacle, NULL );
+			collisionModelManager->Translation( &results, start, end, &trm, trmAxis, -1, handle, ( start + end ) * 0.5f, trmAxis.Transpose() );
+			break;
+		}
+	}
+}
+
+/*
+================
+CM_StressTestJob
+================
+*/
+static void CM_StressTestJob( cm_stressJob_t *job ) {
+	for ( int i = 0; i < job->numTraces; i++ ) {
+		CM_StressTestTrace( job->firstTrace + i, job->bounds, job->results[i] );
+	}
+}
+
+REGISTER_PARALLEL_JOB( CM_StressTestJob, "CM_StressTestJob" );
+
+/*
+================
+CM_TracesEqual
+
+  the model feature is not compared because for trace model polygons it is a pointer into the model of the thread
+================
+*/
+static bool CM_TracesEqual( const trace_t &a, const trace_t &b ) {
+	return a.fraction == b.fraction &&
+			a.endpos.Compare( b.endpos ) &&
+			a.endAxis.Compare( b.endAxis ) &&
+			a.c.type == b.c.type &&
+			a.c.point.Compare( b.c.point ) &&
+			a.c.normal.Compare( b.c.normal ) &&
+			a.c.dist == b.c.dist &&
+			a.c.contents == b.c.contents &&
+			a.c.material == b.c.material &&
+			a.c.trmFeature == b.c.trmFeature;
+}
+
+/*
+================
+cm_traceStressTest
+
+  fires random traces against the world model from the job threads and compares the results
+  with the same traces run one after the other on the calling thread
+================
+*/
+CONSOLE_COMMAND( cm_traceStressTest, "usage: cm_traceStressTest [numThreads] [numTraces]", 0 ) {
+	int i, j, first, numJobs, numMismatches;
+	idBounds bounds;
+
+	const int numThreads	= args.Argc() > 1 ? Max( 1, atoi( args.Argv( 1 ) ) ) : parallelJobManager->GetNumProcessingUnits();
+	const int numTraces		= args.Argc() > 2 ? Max( 1, atoi( args.Argv( 2 ) ) ) : 1000000;
+
+	if ( !collisionModelManager->GetModelBounds( 0, bounds ) ) {
+		common->Printf( "cm_traceStressTest: no collision map loaded\n" );
+		return;
+	}
+
+	trace_t *reference = (trace_t *) Mem_Alloc( CM_STRESS_TRACES_PER_PASS * sizeof( trace_t ), TAG_COLLISION );
+	trace_t *results = (trace_t *) Mem_Alloc( CM_STRESS_TRACES_PER_PASS * sizeof( trace_t ), TAG_COLLISION );
+	cm_stressJob_t *jobs = (cm_stressJob_t *) Mem_Alloc( ( CM_STRESS_TRACES_PER_PASS / CM_STRESS_TRACES_PER_JOB ) * sizeof( cm_stressJob_t ), TAG_COLLISION );
+	idParallelJobList *jobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, CM_STRESS_TRACES_PER_PASS / CM_STRESS_TRACES_PER_JOB, 0, NULL );
+
+	uint64 serialMicroseconds = 0;
+	uint64 parallelMicroseconds = 0;
+	numMismatches = 0;
+
+	for ( first = 0; first < numTraces; first += CM_STRESS_TRACES_PER_PASS ) {
+		const int numPassTraces = Min( CM_STRESS_TRACES_PER_PASS, numTraces - first );
+
+		uint64 startTime = Sys_Microseconds();
+		for ( i = 0; i < numPassTraces; i++ ) {
+			CM_StressTestTrace( first + i, bounds, reference[i] );
+		}
+		serialMicroseconds += Sys_Microseconds() - startTime;
+
+		numJobs = 0;
+		for ( i = 0; i < numPassTraces; i += CM_STRESS_TRACES_PER_JOB ) {
+			cm_stressJob_t &job = jobs[numJobs++];
+			job.firstTrace = first + i;
+			job.numTraces = Min( CM_STRESS_TRACES_PER_JOB, numPassTraces - i );
+			job.bounds = bounds;
+			job.results = results + i;
+			jobList->AddJob( (jobRun_t)CM_StressTestJob, &job );
+		}
+
+		startTime = Sys_Microseconds();
+		jobList->Submit( NULL, numThreads );
+		jobList->Wait();
+		parallelMicroseconds += Sys_Microseconds() - startTime;
+
+		for ( j = 0; j < numPassTraces; j++ ) {
+			if ( CM_TracesEqual( reference[j], results[j] ) ) {
+				continue;
+			}
+			if ( numMismatches < CM_STRESS_MAX_REPORTED ) {
+				common->Printf( "trace %d: fraction %f contents %d, single threaded fraction %f contents %d\n", first + j,
+								results[j].fraction, results[j].c.contents, reference[j].fraction, reference[j].c.contents );
+			}
+			numMismatches++;
+		}
+	}
+
+	parallelJobManager->FreeJobList( jobList );
+	Mem_Free( jobs );
+	Mem_Free( results );
+	Mem_Free( reference );
+
+	common->Printf( "cm_traceStressTest: %d traces, single threaded %d ms, %d threads %d ms (%.2fx)\n", numTraces,
+					(int)( serialMicroseconds / 1000 ), numThreads, (int)( parallelMicroseconds / 1000 ),
+					(float)serialMicroseconds / Max( parallelMicroseconds, (uint64)1 ) );
+	if ( numMismatches != 0 ) {
+		common->Warning( "cm_traceStressTest: %d of %d traces differ from the single threaded results", numMismatches, numTraces );
+	} else {
+		common->Printf( "all traces match the single threaded results\n" );
+	}
+}
+
+/*
+================
+cm_testFlatTree
+
+  runs the same random traces through the linked node tree and the flattened node tree
+================
+*/
+CONSOLE_COMMAND( cm_testFlatTree, "usage: cm_testFlatTree [numTraces]", 0 ) {
+	int first, i, numMismatches;
+	idBounds bounds;
+
+	const int numTraces = args.Argc() > 1 ? Max( 1, atoi( args.Argv( 1 ) ) ) : 1000000;
+
+	if ( !collisionModelManager->GetModelBounds( 0, bounds ) ) {
+		common->Printf( "cm_testFlatTree: no collision map loaded\n" );
+		return;
+	}
+
+	const bool flatTree = cm_flatTree.GetBool();
+	trace_t *reference = (trace_t *) Mem_Alloc( CM_STRESS_TRACES_PER_PASS * sizeof( trace_t ), TAG_COLLISION );
+	trace_t *results = (trace_t *) Mem_Alloc( CM_STRESS_TRACES_PER_PASS * sizeof( trace_t ), TAG_COLLISION );
+
+	uint64 nodeMicroseconds = 0;
+	uint64 flatMicroseconds = 0;
+	numMismatches = 0;
+
+	for ( first = 0; first < numTraces; first += CM_STRESS_TRACES_PER_PASS ) {
+		const int numPassTraces = Min( CM_STRESS_TRACES_PER_PASS, numTraces - first );
+
+		cm_flatTree.SetBool( false );
+		uint64 startTime = Sys_Microseconds();
+		for ( i = 0; i < numPassTraces; i++ ) {
+			CM_StressTestTrace( first + i, bounds, reference[i] );
+		}
+		nodeMicroseconds += Sys_Microseconds() - startTime;
+
+		cm_flatTree.SetBool( true );
+		startTime = Sys_Microseconds();
+		for ( i = 0; i < numPassTraces; i++ ) {
+			CM_StressTestTrace( first + i, bounds, results[i] );
+		}
+		flatMicroseconds += Sys_Microseconds() - startTime;
+
+		for ( i = 0; i < numPassTraces; i++ ) {
+			if ( !CM_TracesEqual( reference[i], results[i] ) ) {
+				numMismatches++;
+			}
+		}
+	}
+
+	cm_flatTree.SetBool( flatTree );
+	Mem_Free( results );
+	Mem_Free( reference );
+
+	common->Printf( "cm_testFlatTree: %d traces, node tree %d ms, flat tree %d ms (%.2fx)\n", numTraces,
+					(int)( nodeMicroseconds / 1000 ), (int)( flatMicroseconds / 1000 ),
+					(float)nodeMicroseconds / Max( flatMicroseconds, (uint64)1 ) );
+	if ( numMismatches != 0 ) {
+		common->Warning( "cm_testFlatTree: %d of %d traces differ between the node trees", numMismatches, numTraces );
+	}
+}
+
+/*
+================
+cm_testBinaryLoad
+
+  times loading the world model from the flattened and the node tree binary formats
+================
+*/
+CONSOLE_COMMAND( cm_testBinaryLoad, "usage: cm_testBinaryLoad [numLoads]", 0 ) {
+	const int numLoads = args.Argc() > 1 ? Max( 1, atoi( args.Argv( 1 ) ) ) : 100;
+
+	collisionModelManagerLocal.TestBinaryModelLoad( 0, numLoads );
+}
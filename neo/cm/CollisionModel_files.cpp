@@ -538,6 +538,8 @@ cm_model_t * idCollisionModelManagerLocal::ParseCollisionModel( idLexer *src ) {
 	CM_GetNodeBounds( &model->bounds, model->node );
 	// get model contents
 	model->contents = CM_GetNodeContents( model->node );
+	// flatten the tree for tracing
+	BuildFlatTree( model );
 	// total memory used by this model
 	model->usedMemory = model->numVertices * sizeof(cm_vertex_t) +
 						model->numEdges * sizeof(cm_edge_t) +
@@ -545,7 +547,10 @@ cm_model_t * idCollisionModelManagerLocal::ParseCollisionModel( idLexer *src ) {
 						model->brushMemory +
 						model->numNodes * sizeof(cm_node_t) +
 						model->numPolygonRefs * sizeof(cm_polygonRef_t) +
-						model->numBrushRefs * sizeof(cm_brushRef_t);
+						model->numBrushRefs * sizeof(cm_brushRef_t) +
+						model->numFlatNodes * sizeof(cm_flatNode_t) +
+						model->numFlatPolygons * sizeof(cm_polygon_t *) +
+						model->numFlatBrushes * sizeof(cm_brush_t *);
 
 	return model;
 }
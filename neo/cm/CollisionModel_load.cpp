@@ -187,15 +187,9 @@ void idCollisionModelManagerLocal::Clear() {
 	maxModels = 0;
 	numModels = 0;
 	models = NULL;
-	memset( trmPolygons, 0, sizeof( trmPolygons ) );
-	trmBrushes[0] = NULL;
 	trmMaterial = NULL;
 	numProcNodes = 0;
 	procNodes = NULL;
-	getContacts = false;
-	contacts = NULL;
-	maxContacts = 0;
-	numContacts = 0;
 }
 
 /*
@@ -376,6 +370,8 @@ void idCollisionModelManagerLocal::FreeModel( cm_model_t *model ) {
 	if ( model->node ) {
 		FreeTree_r( model, model->node, model->node );
 	}
+	// free the flattened tree
+	FreeFlatTree( model );
 	// free blocks with polygon references
 	for ( polygonRefBlock = model->polygonRefBlocks; polygonRefBlock; polygonRefBlock = nextPolygonRefBlock ) {
 		nextPolygonRefBlock = polygonRefBlock->next;
@@ -423,7 +419,10 @@ void idCollisionModelManagerLocal::FreeMap() {
 		FreeModel( models[i] );
 	}
 
-	FreeTrmModelStructure();
+	// no thread is tracing while the map is freed
+	for ( i = 0; i < traceContexts.Num(); i++ ) {
+		FreeTrmModelStructure( traceContexts[i] );
+	}
 
 	Mem_Free( models );
 
@@ -437,22 +436,22 @@ void idCollisionModelManagerLocal::FreeMap() {
 idCollisionModelManagerLocal::FreeTrmModelStructure
 ================
 */
-void idCollisionModelManagerLocal::FreeTrmModelStructure() {
+void idCollisionModelManagerLocal::FreeTrmModelStructure( cm_traceContext_t *context ) {
 	int i;
 
-	assert( models );
-	if ( !models[MAX_SUBMODELS] ) {
+	if ( !context->trmModel ) {
 		return;
 	}
 
 	for ( i = 0; i < MAX_TRACEMODEL_POLYS; i++ ) {
-		FreePolygon( models[MAX_SUBMODELS], trmPolygons[i]->p );
+		FreePolygon( context->trmModel, context->trmPolygons[i]->p );
 	}
-	FreeBrush( models[MAX_SUBMODELS], trmBrushes[0]->b );
+	FreeBrush( context->trmModel, context->trmBrushes[0]->b );
 
-	models[MAX_SUBMODELS]->node->polygons = NULL;
-	models[MAX_SUBMODELS]->node->brushes = NULL;
-	FreeModel( models[MAX_SUBMODELS] );
+	context->trmModel->node->polygons = NULL;
+	context->trmModel->node->brushes = NULL;
+	FreeModel( context->trmModel );
+	context->trmModel = NULL;
 }
 
 
@@ -557,6 +556,12 @@ cm_model_t *idCollisionModelManagerLocal::AllocModel() {
 	model->brushRefBlocks = NULL;
 	model->polygonBlock = NULL;
 	model->brushBlock = NULL;
+	model->numFlatNodes = 0;
+	model->flatNodes = NULL;
+	model->numFlatPolygons = 0;
+	model->flatPolygons = NULL;
+	model->numFlatBrushes = 0;
+	model->flatBrushes = NULL;
 	model->numPolygons = model->polygonMemory =
 	model->numBrushes = model->brushMemory =
 	model->numNodes = model->numBrushRefs =
@@ -734,7 +739,7 @@ void idCollisionModelManagerLocal::AddBrushToNode( cm_model_t *model, cm_node_t
 idCollisionModelManagerLocal::SetupTrmModelStructure
 ================
 */
-void idCollisionModelManagerLocal::SetupTrmModelStructure() {
+void idCollisionModelManagerLocal::SetupTrmModelStructure( cm_traceContext_t *context ) {
 	int i;
 	cm_node_t *node;
 	cm_model_t *model;
@@ -742,8 +747,7 @@ void idCollisionModelManagerLocal::SetupTrmModelStructure() {
 	// setup model
 	model = AllocModel();
 
-	assert( models );
-	models[MAX_SUBMODELS] = model;
+	context->trmModel = model;
 	// create node to hold the collision data
 	node = (cm_node_t *) AllocNode( model, 1 );
 	node->planeType = -1;
@@ -755,40 +759,35 @@ void idCollisionModelManagerLocal::SetupTrmModelStructure() {
 	model->numEdges = 0;
 	model->maxEdges = MAX_TRACEMODEL_EDGES+1;
 	model->edges = (cm_edge_t *) Mem_ClearedAlloc( model->maxEdges * sizeof(cm_edge_t), TAG_COLLISION );
-	// create a material for the trace model polygons
-	trmMaterial = declManager->FindMaterial( "_tracemodel", false );
-	if ( !trmMaterial ) {
-		common->FatalError( "_tracemodel material not found" );
-	}
 
 	// allocate polygons
 	for ( i = 0; i < MAX_TRACEMODEL_POLYS; i++ ) {
-		trmPolygons[i] = AllocPolygonReference( model, MAX_TRACEMODEL_POLYS );
-		trmPolygons[i]->p = AllocPolygon( model, MAX_TRACEMODEL_POLYEDGES );
-		trmPolygons[i]->p->bounds.Clear();
-		trmPolygons[i]->p->plane.Zero();
-		trmPolygons[i]->p->checkcount = 0;
-		trmPolygons[i]->p->contents = -1;		// all contents
-		trmPolygons[i]->p->material = trmMaterial;
-		trmPolygons[i]->p->numEdges = 0;
+		context->trmPolygons[i] = AllocPolygonReference( model, MAX_TRACEMODEL_POLYS );
+		context->trmPolygons[i]->p = AllocPolygon( model, MAX_TRACEMODEL_POLYEDGES );
+		context->trmPolygons[i]->p->bounds.Clear();
+		context->trmPolygons[i]->p->plane.Zero();
+		context->trmPolygons[i]->p->checkcount = 0;
+		context->trmPolygons[i]->p->contents = -1;		// all contents
+		context->trmPolygons[i]->p->material = trmMaterial;
+		context->trmPolygons[i]->p->numEdges = 0;
 	}
 	// allocate brush for position test
-	trmBrushes[0] = AllocBrushReference( model, 1 );
-	trmBrushes[0]->b = AllocBrush( model, MAX_TRACEMODEL_POLYS );
-	trmBrushes[0]->b->primitiveNum = 0;
-	trmBrushes[0]->b->bounds.Clear();
-	trmBrushes[0]->b->checkcount = 0;
-	trmBrushes[0]->b->contents = -1;		// all contents
-	trmBrushes[ 0 ]->b->material = trmMaterial;
-	trmBrushes[0]->b->numPlanes = 0;
+	context->trmBrushes[0] = AllocBrushReference( model, 1 );
+	context->trmBrushes[0]->b = AllocBrush( model, MAX_TRACEMODEL_POLYS );
+	context->trmBrushes[0]->b->primitiveNum = 0;
+	context->trmBrushes[0]->b->bounds.Clear();
+	context->trmBrushes[0]->b->checkcount = 0;
+	context->trmBrushes[0]->b->contents = -1;		// all contents
+	context->trmBrushes[0]->b->material = trmMaterial;
+	context->trmBrushes[0]->b->numPlanes = 0;
 }
 
 /*
 ================
 idCollisionModelManagerLocal::SetupTrmModel
 
-Trace models (item boxes, etc) are converted to collision models on the fly, using the last model slot
-as a reusable temporary buffer
+Trace models (item boxes, etc) are converted to collision models on the fly, using a reusable
+temporary model of the calling thread that is only valid for traces from that same thread
 ================
 */
 cmHandle_t idCollisionModelManagerLocal::SetupTrmModel( const idTraceModel &trm, const idMaterial *material ) {
@@ -797,6 +796,9 @@ cmHandle_t idCollisionModelManagerLocal::SetupTrmModel( const idTraceModel &trm,
 	cm_edge_t *edge;
 	cm_polygon_t *poly;
 	cm_model_t *model;
+	cm_traceContext_t *context;
+	cm_polygonRef_t **trmPolygons;
+	cm_brushRef_t **trmBrushes;
 	const traceModelVert_t *trmVert;
 	const traceModelEdge_t *trmEdge;
 	const traceModelPoly_t *trmPoly;
@@ -807,7 +809,14 @@ cmHandle_t idCollisionModelManagerLocal::SetupTrmModel( const idTraceModel &trm,
 		material = trmMaterial;
 	}
 
-	model = models[MAX_SUBMODELS];
+	context = GetTraceContext();
+	if ( !context->trmModel ) {
+		SetupTrmModelStructure( context );
+	}
+	trmPolygons = context->trmPolygons;
+	trmBrushes = context->trmBrushes;
+
+	model = context->trmModel;
 	model->node->brushes = NULL;
 	model->node->polygons = NULL;
 	// if not a valid trace model
@@ -2957,6 +2966,8 @@ void idCollisionModelManagerLocal::FinishModel( cm_model_t *model ) {
 	CM_GetNodeBounds( &model->bounds, model->node );
 	// get model contents
 	model->contents = CM_GetNodeContents( model->node );
+	// flatten the tree for tracing
+	BuildFlatTree( model );
 	// total memory used by this model
 	model->usedMemory = model->numVertices * sizeof(cm_vertex_t) +
 						model->numEdges * sizeof(cm_edge_t) +
@@ -2964,11 +2975,168 @@ void idCollisionModelManagerLocal::FinishModel( cm_model_t *model ) {
 						model->brushMemory +
 						model->numNodes * sizeof(cm_node_t) +
 						model->numPolygonRefs * sizeof(cm_polygonRef_t) +
-						model->numBrushRefs * sizeof(cm_brushRef_t);
+						model->numBrushRefs * sizeof(cm_brushRef_t) +
+						model->numFlatNodes * sizeof(cm_flatNode_t) +
+						model->numFlatPolygons * sizeof(cm_polygon_t *) +
+						model->numFlatBrushes * sizeof(cm_brush_t *);
+}
+
+/*
+================
+idCollisionModelManagerLocal::AllocFlatTree
+
+  the nodes and the polygon and brush references are allocated as a single memory block
+================
+*/
+void idCollisionModelManagerLocal::AllocFlatTree( cm_model_t *model, int numNodes, int numPolygons, int numBrushes ) {
+	FreeFlatTree( model );
+
+	const size_t nodeSize = numNodes * sizeof( cm_flatNode_t );
+	const size_t polygonSize = numPolygons * sizeof( cm_polygon_t * );
+	const size_t brushSize = numBrushes * sizeof( cm_brush_t * );
+	byte *block = (byte *) Mem_Alloc( nodeSize + polygonSize + brushSize, TAG_COLLISION );
+
+	model->numFlatNodes = numNodes;
+	model->flatNodes = (cm_flatNode_t *) block;
+	model->numFlatPolygons = numPolygons;
+	model->flatPolygons = (cm_polygon_t **) ( block + nodeSize );
+	model->numFlatBrushes = numBrushes;
+	model->flatBrushes = (cm_brush_t **) ( block + nodeSize + polygonSize );
+}
+
+/*
+================
+idCollisionModelManagerLocal::FreeFlatTree
+================
+*/
+void idCollisionModelManagerLocal::FreeFlatTree( cm_model_t *model ) {
+	Mem_Free( model->flatNodes );
+	model->numFlatNodes = 0;
+	model->flatNodes = NULL;
+	model->numFlatPolygons = 0;
+	model->flatPolygons = NULL;
+	model->numFlatBrushes = 0;
+	model->flatBrushes = NULL;
+}
+
+/*
+================
+idCollisionModelManagerLocal::BuildFlatTree
+
+  stores the nodes in depth first order with the polygon and brush references of each node packed in arrays
+================
+*/
+void idCollisionModelManagerLocal::BuildFlatTree( cm_model_t *model ) {
+	struct local {
+		static void Count_r( const cm_node_t *node, int &numNodes, int &numPolygons, int &numBrushes ) {
+			while ( 1 ) {
+				numNodes++;
+				for ( cm_polygonRef_t *pref = node->polygons; pref; pref = pref->next ) {
+					numPolygons++;
+				}
+				for ( cm_brushRef_t *bref = node->brushes; bref; bref = bref->next ) {
+					numBrushes++;
+				}
+				if ( node->planeType == -1 ) {
+					break;
+				}
+				Count_r( node->children[0], numNodes, numPolygons, numBrushes );
+				node = node->children[1];
+			}
+		}
+		static int Flatten_r( cm_model_t *model, const cm_node_t *node, int &numNodes, int &numPolygons, int &numBrushes ) {
+			const int nodeNum = numNodes++;
+			cm_flatNode_t &flatNode = model->flatNodes[nodeNum];
+			flatNode.planeType = node->planeType;
+			flatNode.planeDist = node->planeDist;
+			flatNode.firstPolygon = numPolygons;
+			for ( cm_polygonRef_t *pref = node->polygons; pref; pref = pref->next ) {
+				model->flatPolygons[numPolygons++] = pref->p;
+			}
+			flatNode.numPolygons = numPolygons - flatNode.firstPolygon;
+			flatNode.firstBrush = numBrushes;
+			for ( cm_brushRef_t *bref = node->brushes; bref; bref = bref->next ) {
+				model->flatBrushes[numBrushes++] = bref->b;
+			}
+			flatNode.numBrushes = numBrushes - flatNode.firstBrush;
+			flatNode.backChild = -1;
+			if ( node->planeType != -1 ) {
+				Flatten_r( model, node->children[0], numNodes, numPolygons, numBrushes );
+				flatNode.backChild = Flatten_r( model, node->children[1], numNodes, numPolygons, numBrushes );
+			}
+			return nodeNum;
+		}
+	};
+
+	FreeFlatTree( model );
+
+	if ( model->node == NULL ) {
+		return;
+	}
+
+	int numNodes = 0, numPolygons = 0, numBrushes = 0;
+	local::Count_r( model->node, numNodes, numPolygons, numBrushes );
+	AllocFlatTree( model, numNodes, numPolygons, numBrushes );
+
+	numNodes = numPolygons = numBrushes = 0;
+	local::Flatten_r( model, model->node, numNodes, numPolygons, numBrushes );
+	assert( numNodes == model->numFlatNodes && numPolygons == model->numFlatPolygons && numBrushes == model->numFlatBrushes );
+}
+
+/*
+================
+idCollisionModelManagerLocal::NodeTreeFromFlatTree
+
+  creates the linked node tree used while building and drawing from the flattened tree
+================
+*/
+cm_node_t *idCollisionModelManagerLocal::NodeTreeFromFlatTree( cm_model_t *model ) {
+	struct local {
+		static void Build_r( cm_model_t *model, int nodeNum, cm_node_t *node ) {
+			const cm_flatNode_t &flatNode = model->flatNodes[nodeNum];
+			node->planeType = flatNode.planeType;
+			node->planeDist = flatNode.planeDist;
+			// link in reverse so the lists have the same order as the packed references
+			for ( int i = flatNode.numPolygons - 1; i >= 0; i-- ) {
+				cm_polygonRef_t * pref = collisionModelManagerLocal.AllocPolygonReference( model, model->numFlatPolygons );
+				pref->p = model->flatPolygons[flatNode.firstPolygon + i];
+				pref->next = node->polygons;
+				node->polygons = pref;
+			}
+			for ( int i = flatNode.numBrushes - 1; i >= 0; i-- ) {
+				cm_brushRef_t * bref = collisionModelManagerLocal.AllocBrushReference( model, model->numFlatBrushes );
+				bref->b = model->flatBrushes[flatNode.firstBrush + i];
+				bref->next = node->brushes;
+				node->brushes = bref;
+			}
+			if ( flatNode.planeType != -1 ) {
+				node->children[0] = collisionModelManagerLocal.AllocNode( model, model->numFlatNodes );
+				node->children[1] = collisionModelManagerLocal.AllocNode( model, model->numFlatNodes );
+				node->children[0]->parent = node;
+				node->children[1]->parent = node;
+				Build_r( model, nodeNum + 1, node->children[0] );
+				Build_r( model, flatNode.backChild, node->children[1] );
+			}
+		}
+	};
+
+	if ( model->numFlatNodes == 0 ) {
+		return NULL;
+	}
+
+	cm_node_t *node = AllocNode( model, model->numFlatNodes );
+	local::Build_r( model, 0, node );
+	return node;
 }
 
-static const byte BCM_VERSION = 100;
+// version 100 stores the node tree recursively with -1 terminated reference lists per node,
+// version 101 stores the flattened nodes and the packed references as arrays
+static const byte BCM_VERSION = 101;
+static const byte BCM_VERSION_NODE_TREE = 100;
 static const unsigned int BCM_MAGIC = ( 'B' << 24 ) | ( 'C' << 16 ) | ( 'M' << 16 ) | BCM_VERSION;
+static const unsigned int BCM_MAGIC_NODE_TREE = ( 'B' << 24 ) | ( 'C' << 16 ) | ( 'M' << 16 ) | BCM_VERSION_NODE_TREE;
+
+compile_time_assert( sizeof( cm_flatNode_t ) == 7 * sizeof( int ) );
 
 /*
 ================
@@ -2979,7 +3147,7 @@ cm_model_t * idCollisionModelManagerLocal::LoadBinaryModelFromFile( idFile *file
 
 	unsigned int magic = 0;
 	file->ReadBig( magic );
-	if ( magic != BCM_MAGIC ) {
+	if ( magic != BCM_MAGIC && magic != BCM_MAGIC_NODE_TREE ) {
 		return NULL;
 	}
 	ID_TIME_T storedTimeStamp = FILE_NOT_FOUND_TIMESTAMP;
@@ -3109,8 +3277,35 @@ cm_model_t * idCollisionModelManagerLocal::LoadBinaryModelFromFile( idFile *file
 			}
 		}
 	};
-	model->node = AllocNode( model, model->numNodes + 1 );
-	local::ReadNodeTree( file, model, model->node, polys, brushes );
+	if ( magic == BCM_MAGIC_NODE_TREE ) {
+		model->node = AllocNode( model, model->numNodes + 1 );
+		local::ReadNodeTree( file, model, model->node, polys, brushes );
+		BuildFlatTree( model );
+	} else {
+		int numFlatNodes = 0, numFlatPolygons = 0, numFlatBrushes = 0;
+		file->ReadBig( numFlatNodes );
+		file->ReadBig( numFlatPolygons );
+		file->ReadBig( numFlatBrushes );
+		AllocFlatTree( model, numFlatNodes, numFlatPolygons, numFlatBrushes );
+
+		// the nodes are stored with their in memory layout so all of them are read at once,
+		// with fs_mapResourceFiles set the file is a view of the mapped resource container
+		// and this is a single copy and byte swap straight out of the mapping
+		file->ReadBigArray( (int *) model->flatNodes, numFlatNodes * sizeof( cm_flatNode_t ) / sizeof( int ) );
+
+		// the references are stored as polygon and brush indexes
+		idTempArray< int > indexes( Max( Max( numFlatPolygons, numFlatBrushes ), 1 ) );
+		file->ReadBigArray( indexes.Ptr(), numFlatPolygons );
+		for ( int i = 0; i < numFlatPolygons; i++ ) {
+			model->flatPolygons[i] = polys[indexes[i]];
+		}
+		file->ReadBigArray( indexes.Ptr(), numFlatBrushes );
+		for ( int i = 0; i < numFlatBrushes; i++ ) {
+			model->flatBrushes[i] = brushes[indexes[i]];
+		}
+
+		model->node = NodeTreeFromFlatTree( model );
+	}
 
 	// We should have only allocated a single block, and used every entry in the block
 	// assert( model->nodeBlocks != NULL && model->nodeBlocks->next == NULL && model->nodeBlocks->nextNode == NULL );
@@ -3125,7 +3320,10 @@ cm_model_t * idCollisionModelManagerLocal::LoadBinaryModelFromFile( idFile *file
 		model->brushMemory +
 		model->numNodes * sizeof(cm_node_t) +
 		model->numPolygonRefs * sizeof(cm_polygonRef_t) +
-		model->numBrushRefs * sizeof(cm_brushRef_t);
+		model->numBrushRefs * sizeof(cm_brushRef_t) +
+		model->numFlatNodes * sizeof(cm_flatNode_t) +
+		model->numFlatPolygons * sizeof(cm_polygon_t *) +
+		model->numFlatBrushes * sizeof(cm_brush_t *);
 	return model;
 }
 
@@ -3147,9 +3345,9 @@ cm_model_t * idCollisionModelManagerLocal::LoadBinaryModel( const char *fileName
 idCollisionModelManagerLocal::WriteBinaryModel
 ================
 */
-void idCollisionModelManagerLocal::WriteBinaryModelToFile( cm_model_t *model, idFile *file, ID_TIME_T sourceTimeStamp ) {
+void idCollisionModelManagerLocal::WriteBinaryModelToFile( cm_model_t *model, idFile *file, ID_TIME_T sourceTimeStamp, bool flatNodes ) {
 
-	file->WriteBig( BCM_MAGIC );
+	file->WriteBig( flatNodes ? BCM_MAGIC : BCM_MAGIC_NODE_TREE );
 	file->WriteBig( sourceTimeStamp );
 	file->WriteString( model->name );
 	file->WriteBig( model->bounds );
@@ -3253,7 +3451,30 @@ void idCollisionModelManagerLocal::WriteBinaryModelToFile( cm_model_t *model, id
 		file->WriteBig( brushes[i]->primitiveNum );
 		file->WriteBigArray( brushes[i]->planes, brushes[i]->numPlanes );
 	}
-	local::WriteNodeTree( file, model->node, polys, brushes );
+	if ( !flatNodes ) {
+		local::WriteNodeTree( file, model->node, polys, brushes );
+		return;
+	}
+
+	if ( model->flatNodes == NULL ) {
+		BuildFlatTree( model );
+	}
+	file->WriteBig( model->numFlatNodes );
+	file->WriteBig( model->numFlatPolygons );
+	file->WriteBig( model->numFlatBrushes );
+	file->WriteBigArray( (const int *) model->flatNodes, model->numFlatNodes * sizeof( cm_flatNode_t ) / sizeof( int ) );
+
+	idList< int > indexes;
+	indexes.SetNum( model->numFlatPolygons );
+	for ( int i = 0; i < model->numFlatPolygons; i++ ) {
+		indexes[i] = polys.FindIndex( model->flatPolygons[i] );
+	}
+	file->WriteBigArray( indexes.Ptr(), indexes.Num() );
+	indexes.SetNum( model->numFlatBrushes );
+	for ( int i = 0; i < model->numFlatBrushes; i++ ) {
+		indexes[i] = brushes.FindIndex( model->flatBrushes[i] );
+	}
+	file->WriteBigArray( indexes.Ptr(), indexes.Num() );
 }
 
 /*
@@ -3270,6 +3491,51 @@ void idCollisionModelManagerLocal::WriteBinaryModel( cm_model_t *model, const ch
 	WriteBinaryModelToFile( model, file, sourceTimeStamp );
 }
 
+/*
+================
+idCollisionModelManagerLocal::TestBinaryModelLoad
+
+  compares the load time of the flattened binary format against the recursive node tree format
+================
+*/
+void idCollisionModelManagerLocal::TestBinaryModelLoad( cmHandle_t handle, int numLoads ) {
+	if ( handle < 0 || handle >= numModels || models[handle] == NULL ) {
+		common->Printf( "TestBinaryModelLoad: invalid model handle\n" );
+		return;
+	}
+	cm_model_t *model = models[handle];
+
+	for ( int flatNodes = 0; flatNodes < 2; flatNodes++ ) {
+		idFile_Memory file( "testBinaryModel" );
+		WriteBinaryModelToFile( model, &file, 0, ( flatNodes != 0 ) );
+		file.MakeReadOnly();
+
+		int numNodes = 0;
+		int maxLoad = 0;
+		int totalLoad = 0;
+		for ( int i = 0; i < numLoads; i++ ) {
+			file.Rewind();
+
+			const uint64 startTime = Sys_Microseconds();
+			cm_model_t *loaded = LoadBinaryModelFromFile( &file, 0 );
+			const int loadTime = (int)( Sys_Microseconds() - startTime );
+
+			if ( loaded == NULL ) {
+				common->Printf( "TestBinaryModelLoad: failed to load %s\n", model->name.c_str() );
+				return;
+			}
+			numNodes = loaded->numFlatNodes;
+			FreeModel( loaded );
+
+			totalLoad += loadTime;
+			maxLoad = Max( maxLoad, loadTime );
+		}
+
+		common->Printf( "%-10s %7d KB, %5d nodes, avg %6d usec, max %6d usec\n", flatNodes ? "flat" : "node tree",
+						file.Length() >> 10, numNodes, totalLoad / Max( numLoads, 1 ), maxLoad );
+	}
+}
+
 /*
 ================
 idCollisionModelManagerLocal::LoadRenderModel
@@ -3576,12 +3842,12 @@ void idCollisionModelManagerLocal::ModelInfo( cmHandle_t model ) {
 		common->Printf( "idCollisionModelManagerLocal::ModelInfo: invalid model handle\n" );
 		return;
 	}
-	if ( !models[model] ) {
+	if ( !ModelForHandle( GetTraceContext(), model ) ) {
 		common->Printf( "idCollisionModelManagerLocal::ModelInfo: invalid model\n" );
 		return;
 	}
 
-	PrintModelInfo( models[model] );
+	PrintModelInfo( ModelForHandle( GetTraceContext(), model ) );
 }
 
 /*
@@ -3725,8 +3991,11 @@ void idCollisionModelManagerLocal::LoadMap( const idMapFile *mapFile ) {
 
 	common->UpdateLevelLoadPacifier();
 
-	// setup trace model structure
-	SetupTrmModelStructure();
+	// create a material for the trace model polygons
+	trmMaterial = declManager->FindMaterial( "_tracemodel", false );
+	if ( !trmMaterial ) {
+		common->FatalError( "_tracemodel material not found" );
+	}
 
 	common->UpdateLevelLoadPacifier();
 
@@ -52,6 +52,7 @@ If you have questions concerning this license or the applicable additional terms
 #define NODE_BLOCK_SIZE_LARGE				256
 #define REFERENCE_BLOCK_SIZE_SMALL			8
 #define REFERENCE_BLOCK_SIZE_LARGE			256
+#define CHECKED_HASH_SIZE					1024	// initial size of the per thread checked polygon and brush hash, must be power of 2
 
 #define MAX_WINDING_LIST					128		// quite a few are generated at times
 #define INTEGRAL_EPSILON					0.01f
@@ -166,6 +167,16 @@ typedef struct cm_nodeBlock_s {
 	struct cm_nodeBlock_s *next;				// next block with nodes
 } cm_nodeBlock_t;
 
+typedef struct cm_flatNode_s {
+	int						planeType;			// node axial plane type, -1 for leaf nodes
+	float					planeDist;			// node plane distance
+	int						backChild;			// index of children[1], children[0] directly follows the node
+	int						firstPolygon;		// first polygon reference in cm_model_t::flatPolygons
+	int						numPolygons;		// number of polygons in node
+	int						firstBrush;			// first brush reference in cm_model_t::flatBrushes
+	int						numBrushes;			// number of brushes in node
+} cm_flatNode_t;
+
 typedef struct cm_model_s {
 	idStr					name;				// model name
 	idBounds				bounds;				// model bounds
@@ -185,6 +196,13 @@ typedef struct cm_model_s {
 	cm_brushRefBlock_t *	brushRefBlocks;		// list with blocks of brush references
 	cm_polygonBlock_t *		polygonBlock;		// memory block with all polygons
 	cm_brushBlock_t *		brushBlock;			// memory block with all brushes
+	// flattened spatial subdivision used for tracing, stored in a single memory block
+	int						numFlatNodes;		// number of flattened nodes
+	cm_flatNode_t *			flatNodes;			// nodes in depth first order
+	int						numFlatPolygons;	// number of packed polygon references
+	cm_polygon_t **			flatPolygons;		// polygon references of all nodes packed together
+	int						numFlatBrushes;		// number of packed brush references
+	cm_brush_t **			flatBrushes;		// brush references of all nodes packed together
 	// statistics
 	int						numPolygons;
 	int						polygonMemory;
@@ -239,6 +257,7 @@ typedef struct cm_trmPolygon_s {
 } cm_trmPolygon_t;
 
 typedef struct cm_traceWork_s {
+	struct cm_traceContext_s *context;				// per thread data of the calling thread
 	int numVerts;
 	cm_trmVertex_t vertices[MAX_TRACEMODEL_VERTS];	// trm vertices
 	int numEdges;
@@ -287,6 +306,123 @@ typedef struct cm_traceWork_s {
 /*
 ===============================================================================
 
+Per thread trace data
+
+Everything written while tracing is kept per calling thread so the model data
+is only read and any number of threads can trace at the same time. Models are
+not allowed to be loaded or freed while traces are running.
+
+===============================================================================
+*/
+
+typedef struct cm_primitiveState_s {
+	int						checkcount;			// for multi-check avoidance
+	unsigned long			side;				// same as cm_vertex_t::side and cm_edge_t::side
+	unsigned long			sideSet;			// each bit tells if sidedness for the trace model vertex or edge has been calculated yet
+} cm_primitiveState_t;
+
+typedef struct cm_checkedPrimitive_s {
+	const void *			primitive;			// polygon or brush
+	int						checkcount;			// trace the primitive was checked during
+} cm_checkedPrimitive_t;
+
+typedef struct cm_traceContext_s {
+	cm_traceContext_s() {
+		checkCount = 0;
+		maxVertexStates = 0;
+		vertexStates = NULL;
+		maxEdgeStates = 0;
+		edgeStates = NULL;
+		checkedMask = 0;
+		numChecked = 0;
+		checked = NULL;
+		getContacts = false;
+		contacts = NULL;
+		maxContacts = 0;
+		numContacts = 0;
+		trmModel = NULL;
+		memset( trmPolygons, 0, sizeof( trmPolygons ) );
+		trmBrushes[0] = NULL;
+		entered = 0;
+	}
+	int						checkCount;			// for multi-check avoidance
+							// state of the vertices and edges of the model being traced
+	int						maxVertexStates;
+	cm_primitiveState_t *	vertexStates;
+	int						maxEdgeStates;
+	cm_primitiveState_t *	edgeStates;
+							// polygons and brushes checked during the current trace
+	int						checkedMask;
+	int						numChecked;
+	cm_checkedPrimitive_t *	checked;
+							// trace work for Translation and Rotation
+	ALIGN16( cm_traceWork_t translationWork );
+	ALIGN16( cm_traceWork_t rotationWork );
+							// for retrieving contact points
+	bool					getContacts;
+	contactInfo_t *			contacts;
+	int						maxContacts;
+	int						numContacts;
+							// trace model setup with SetupTrmModel on this thread
+	cm_model_t *			trmModel;
+	cm_polygonRef_t *		trmPolygons[MAX_TRACEMODEL_POLYS];
+	cm_brushRef_t *			trmBrushes[1];
+							// set while testing for missed collisions with cm_debugCollision
+	int						entered;
+} cm_traceContext_t;
+
+void	CM_BeginTrace( cm_traceContext_t *context, const cm_model_t *model );
+void	CM_GrowCheckedHash( cm_traceContext_t *context );
+
+/*
+================
+CM_EdgeState
+================
+*/
+ID_INLINE cm_primitiveState_t *CM_EdgeState( const cm_traceWork_t *tw, const int edgeNum ) {
+	return &tw->context->edgeStates[abs( edgeNum )];
+}
+
+/*
+================
+CM_VertexState
+================
+*/
+ID_INLINE cm_primitiveState_t *CM_VertexState( const cm_traceWork_t *tw, const int vertexNum ) {
+	return &tw->context->vertexStates[vertexNum];
+}
+
+/*
+================
+CM_PrimitiveChecked
+
+  returns true if the polygon or brush was already checked during this trace, otherwise marks it as checked
+================
+*/
+ID_INLINE bool CM_PrimitiveChecked( cm_traceContext_t *context, const void *primitive ) {
+	if ( context->numChecked * 2 > context->checkedMask ) {
+		CM_GrowCheckedHash( context );
+	}
+	// entries stamped by an earlier trace are empty
+	int hash = ( (unsigned int)( (uintptr_t)primitive >> 4 ) * 2654435761u ) & context->checkedMask;
+	while( 1 ) {
+		cm_checkedPrimitive_t *entry = &context->checked[hash];
+		if ( entry->checkcount != context->checkCount ) {
+			entry->primitive = primitive;
+			entry->checkcount = context->checkCount;
+			context->numChecked++;
+			return false;
+		}
+		if ( entry->primitive == primitive ) {
+			return true;
+		}
+		hash = ( hash + 1 ) & context->checkedMask;
+	}
+}
+
+/*
+===============================================================================
+
 Collision Map
 
 ===============================================================================
@@ -352,6 +488,8 @@ public:
 	void			ListModels();
 	// write a collision model file for the map entity
 	bool			WriteCollisionModelForMapEntity( const idMapEntity *mapEnt, const char *filename, const bool testTraceModel = true );
+	// time loading the binary version of a model with the flattened and the old node layout
+	void			TestBinaryModelLoad( cmHandle_t model, int numLoads );
 
 private:			// CollisionMap_translate.cpp
 	int				TranslateEdgeThroughEdge( idVec3 &cross, idPluecker &l1, idPluecker &l2, float *fraction );
@@ -404,12 +542,18 @@ private:			// CollisionMap_contents.cpp
 private:			// CollisionMap_trace.cpp
 	void			TraceTrmThroughNode( cm_traceWork_t *tw, cm_node_t *node );
 	void			TraceThroughAxialBSPTree_r( cm_traceWork_t *tw, cm_node_t *node, float p1f, float p2f, idVec3 &p1, idVec3 &p2);
+	void			TraceTrmThroughFlatNode( cm_traceWork_t *tw, const cm_flatNode_t *node );
+	void			TraceThroughFlatTree_r( cm_traceWork_t *tw, int nodeNum, float p1f, float p2f, idVec3 &p1, idVec3 &p2 );
+	void			TraceThroughTree( cm_traceWork_t *tw, idVec3 &start, idVec3 &end );
 	void			TraceThroughModel( cm_traceWork_t *tw );
 	void			RecurseProcBSP_r( trace_t *results, int parentNodeNum, int nodeNum, float p1f, float p2f, const idVec3 &p1, const idVec3 &p2 );
+					// per thread data
+	cm_traceContext_t *GetTraceContext();
+	cm_model_t *	ModelForHandle( const cm_traceContext_t *context, cmHandle_t model ) const;
 
 private:			// CollisionMap_load.cpp
 	void			Clear();
-	void			FreeTrmModelStructure();
+	void			FreeTrmModelStructure( cm_traceContext_t *context );
 					// model deallocation
 	void			RemovePolygonReferences_r( cm_node_t *node, cm_polygon_t *p );
 	void			RemoveBrushReferences_r( cm_node_t *node, cm_brush_t *b );
@@ -449,7 +593,7 @@ private:			// CollisionMap_load.cpp
 	cm_brush_t *	AllocBrush( cm_model_t *model, int numPlanes );
 	void			AddPolygonToNode( cm_model_t *model, cm_node_t *node, cm_polygon_t *p );
 	void			AddBrushToNode( cm_model_t *model, cm_node_t *node, cm_brush_t *b );
-	void			SetupTrmModelStructure();
+	void			SetupTrmModelStructure( cm_traceContext_t *context );
 	void			R_FilterPolygonIntoTree( cm_model_t *model, cm_node_t *node, cm_polygonRef_t *pref, cm_polygon_t *p );
 	void			R_FilterBrushIntoTree( cm_model_t *model, cm_node_t *node, cm_brushRef_t *pref, cm_brush_t *b );
 	cm_node_t *		R_CreateAxialBSPTree( cm_model_t *model, cm_node_t *node, const idBounds &bounds );
@@ -473,6 +617,11 @@ private:			// CollisionMap_load.cpp
 	void			RemapEdges( cm_node_t *node, int *edgeRemap );
 	void			OptimizeArrays( cm_model_t *model );
 	void			FinishModel( cm_model_t *model );
+					// flattened node tree
+	void			AllocFlatTree( cm_model_t *model, int numNodes, int numPolygons, int numBrushes );
+	void			FreeFlatTree( cm_model_t *model );
+	void			BuildFlatTree( cm_model_t *model );
+	cm_node_t *		NodeTreeFromFlatTree( cm_model_t *model );
 	void			BuildModels( const idMapFile *mapFile );
 	cmHandle_t		FindModel( const char *name );
 	cm_model_t *	CollisionModelForMapEntity( const idMapEntity *mapEnt );	// brush/patch model from .map
@@ -480,7 +629,7 @@ private:			// CollisionMap_load.cpp
 	cm_model_t *	LoadBinaryModel( const char *fileName, ID_TIME_T sourceTimeStamp );
 	cm_model_t *	LoadBinaryModelFromFile( idFile *fileIn, ID_TIME_T sourceTimeStamp );
 	void			WriteBinaryModel( cm_model_t *model, const char *fileName, ID_TIME_T sourceTimeStamp );
-	void			WriteBinaryModelToFile( cm_model_t *model, idFile *fileOut, ID_TIME_T sourceTimeStamp ); 
+	void			WriteBinaryModelToFile( cm_model_t *model, idFile *fileOut, ID_TIME_T sourceTimeStamp, bool flatNodes = true );
 	bool			TrmFromModel_r( idTraceModel &trm, cm_node_t *node );
 	bool			TrmFromModel( const cm_model_t *model, idTraceModel &trm );
 
@@ -515,25 +664,38 @@ private:			// collision map data
 	idStr			mapName;
 	ID_TIME_T			mapFileTime;
 	int				loaded;
-					// for multi-check avoidance
+					// for multi-check avoidance while building and drawing, traces use the per thread checkCount
 	int				checkCount;
 					// models
 	int				maxModels;
 	int				numModels;
 	cm_model_t **	models;
-					// polygons and brush for trm model
-	cm_polygonRef_t*trmPolygons[MAX_TRACEMODEL_POLYS];
-	cm_brushRef_t *	trmBrushes[1];
+					// material for trm model
 	const idMaterial *trmMaterial;
 					// for data pruning
 	int				numProcNodes;
 	cm_procNode_t *	procNodes;
-					// for retrieving contact points
-	bool			getContacts;
-	contactInfo_t *	contacts;
-	int				maxContacts;
-	int				numContacts;
+					// per thread trace data of every thread that ever traced
+	idSysMutex		traceContextLock;
+	idList<cm_traceContext_t *>	traceContexts;
 };
 
+/*
+================
+idCollisionModelManagerLocal::ModelForHandle
+
+  the trace model handle refers to the trm model of the calling thread
+================
+*/
+ID_INLINE cm_model_t *idCollisionModelManagerLocal::ModelForHandle( const cm_traceContext_t *context, cmHandle_t model ) const {
+	if ( model == TRACE_MODEL_HANDLE ) {
+		return context->trmModel;
+	}
+	return models[model];
+}
+
+extern idCollisionModelManagerLocal	collisionModelManagerLocal;
+
 // for debugging
 extern idCVar cm_debugCollision;
+extern idCVar cm_flatTree;
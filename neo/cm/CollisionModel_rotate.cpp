@@ -509,7 +509,7 @@ void idCollisionModelManagerLocal::RotateTrmEdgeThroughPolygon( cm_traceWork_t *
 		edge = tw->model->edges + abs(edgeNum);
 
 		// if this edge is already checked
-		if ( edge->checkcount == idCollisionModelManagerLocal::checkCount ) {
+		if ( CM_EdgeState( tw, edgeNum )->checkcount == tw->context->checkCount ) {
 			continue;
 		}
 
@@ -1060,13 +1060,13 @@ bool idCollisionModelManagerLocal::RotateTrmThroughPolygon( cm_traceWork_t *tw,
 	cm_trmPolygon_t *bp;
 	cm_vertex_t *v;
 	cm_edge_t *e;
+	cm_primitiveState_t *edgeState, *vertexState;
 	idVec3 *rotationOrigin;
 
 	// if already checked this polygon
-	if ( p->checkcount == idCollisionModelManagerLocal::checkCount ) {
+	if ( CM_PrimitiveChecked( tw->context, p ) ) {
 		return false;
 	}
-	p->checkcount = idCollisionModelManagerLocal::checkCount;
 
 	// if this polygon does not have the right contents behind it
 	if ( !(p->contents & tw->contents) ) {
@@ -1161,12 +1161,13 @@ bool idCollisionModelManagerLocal::RotateTrmThroughPolygon( cm_traceWork_t *tw,
 		for ( i = 0; i < p->numEdges; i++ ) {
 			edgeNum = p->edges[i];
 			e = tw->model->edges + abs(edgeNum);
+			edgeState = CM_EdgeState( tw, edgeNum );
 
-			if ( e->checkcount == idCollisionModelManagerLocal::checkCount ) {
+			if ( edgeState->checkcount == tw->context->checkCount ) {
 				continue;
 			}
 			// set edge check count
-			e->checkcount = idCollisionModelManagerLocal::checkCount;
+			edgeState->checkcount = tw->context->checkCount;
 			// can never collide with internal edges
 			if ( e->internal ) {
 				continue;
@@ -1175,13 +1176,14 @@ bool idCollisionModelManagerLocal::RotateTrmThroughPolygon( cm_traceWork_t *tw,
 			for ( k = 0; k < 2; k++ ) {
 
 				v = tw->model->vertices + e->vertexNum[k ^ INT32_SIGNBITSET( edgeNum )];
+				vertexState = CM_VertexState( tw, e->vertexNum[k ^ INT32_SIGNBITSET( edgeNum )] );
 
 				// if this vertex is already checked
-				if ( v->checkcount == idCollisionModelManagerLocal::checkCount ) {
+				if ( vertexState->checkcount == tw->context->checkCount ) {
 					continue;
 				}
 				// set vertex check count
-				v->checkcount = idCollisionModelManagerLocal::checkCount;
+				vertexState->checkcount = tw->context->checkCount;
 
 				// if the vertex is outside the trm rotation bounds
 				if ( !tw->bounds.ContainsPoint( v->p ) ) {
@@ -1264,19 +1266,22 @@ void idCollisionModelManagerLocal::Rotation180( trace_t *results, const idVec3 &
 	cm_trmPolygon_t *poly;
 	cm_trmEdge_t *edge;
 	cm_trmVertex_t *vert;
-	ALIGN16( static cm_traceWork_t tw );
+	cm_traceContext_t *context;
+
+	context = idCollisionModelManagerLocal::GetTraceContext();
 
 	if ( model < 0 || model > MAX_SUBMODELS || model > idCollisionModelManagerLocal::maxModels ) {
 		common->Printf("idCollisionModelManagerLocal::Rotation180: invalid model handle\n");
 		return;
 	}
-	if ( !idCollisionModelManagerLocal::models[model] ) {
+	if ( !idCollisionModelManagerLocal::ModelForHandle( context, model ) ) {
 		common->Printf("idCollisionModelManagerLocal::Rotation180: invalid model\n");
 		return;
 	}
 
-	idCollisionModelManagerLocal::checkCount++;
+	cm_traceWork_t &tw = context->rotationWork;
 
+	tw.context = context;
 	tw.trace.fraction = 1.0f;
 	tw.trace.c.contents = 0;
 	tw.trace.c.type = CONTACT_NONE;
@@ -1289,8 +1294,11 @@ void idCollisionModelManagerLocal::Rotation180( trace_t *results, const idVec3 &
 	tw.angle = endAngle - startAngle;
 	assert( tw.angle > -180.0f && tw.angle < 180.0f );
 	tw.maxTan = initialTan = idMath::Fabs( tan( ( idMath::PI / 360.0f ) * tw.angle ) );
-	tw.model = idCollisionModelManagerLocal::models[model];
+	tw.model = idCollisionModelManagerLocal::ModelForHandle( context, model );
 	tw.start = start - modelOrigin;
+
+	CM_BeginTrace( context, tw.model );
+
 	// rotation axis, axis is assumed to be normalized
 	tw.axis = axis;
 //	assert( tw.axis[0] * tw.axis[0] + tw.axis[1] * tw.axis[1] + tw.axis[2] * tw.axis[2] > 0.99f );
@@ -1611,15 +1619,14 @@ void idCollisionModelManagerLocal::Rotation180( trace_t *results, const idVec3 &
 idCollisionModelManagerLocal::Rotation
 ================
 */
-#ifdef _DEBUG
-static int entered = 0;
-#endif
-
 void idCollisionModelManagerLocal::Rotation( trace_t *results, const idVec3 &start, const idRotation &rotation,
 										const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
 										cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis ) {
 	idVec3 tmp;
 	float maxa, stepa, a, lasta;
+#ifdef _DEBUG
+	cm_traceContext_t *context = idCollisionModelManagerLocal::GetTraceContext();
+#endif
 
 	assert( ((byte *)&start) < ((byte *)results) || ((byte *)&start) > (((byte *)results) + sizeof( trace_t )) );
 	assert( ((byte *)&trmAxis) < ((byte *)results) || ((byte *)&trmAxis) > (((byte *)results) + sizeof( trace_t )) );
@@ -1636,13 +1643,13 @@ void idCollisionModelManagerLocal::Rotation( trace_t *results, const idVec3 &sta
 	bool startsolid = false;
 	// test whether or not stuck to begin with
 	if ( cm_debugCollision.GetBool() ) {
-		if ( !entered ) {
-			entered = 1;
+		if ( !context->entered ) {
+			context->entered = 1;
 			// if already messed up to begin with
 			if ( idCollisionModelManagerLocal::Contents( start, trm, trmAxis, -1, model, modelOrigin, modelAxis ) & contentMask ) {
 				startsolid = true;
 			}
-			entered = 0;
+			context->entered = 0;
 		}
 	}
 #endif
@@ -1677,8 +1684,8 @@ void idCollisionModelManagerLocal::Rotation( trace_t *results, const idVec3 &sta
 #ifdef _DEBUG
 	// test for missed collisions
 	if ( cm_debugCollision.GetBool() ) {
-		if ( !entered ) {
-			entered = 1;
+		if ( !context->entered ) {
+			context->entered = 1;
 			// if the trm is stuck in the model
 			if ( idCollisionModelManagerLocal::Contents( results->endpos, trm, results->endAxis, -1, model, modelOrigin, modelAxis ) & contentMask ) {
 				trace_t tr;
@@ -1688,7 +1695,7 @@ void idCollisionModelManagerLocal::Rotation( trace_t *results, const idVec3 &sta
 				// re-run collision detection to find out where it failed
 				idCollisionModelManagerLocal::Rotation( &tr, start, rotation, trm, trmAxis, contentMask, model, modelOrigin, modelAxis );
 			}
-			entered = 0;
+			context->entered = 0;
 		}
 	}
 #endif
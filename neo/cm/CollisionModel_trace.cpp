@@ -43,6 +43,92 @@ If you have questions concerning this license or the applicable additional terms
 /*
 ===============================================================================
 
+Per thread trace data
+
+===============================================================================
+*/
+
+static ID_TLS	threadTraceContext;		// trace context of the calling thread
+
+/*
+================
+CM_BeginTrace
+
+  starts a new trace through the model, all primitive states and checked primitives of earlier traces become stale
+================
+*/
+void CM_BeginTrace( cm_traceContext_t *context, const cm_model_t *model ) {
+	context->checkCount++;
+	context->numChecked = 0;
+
+	// the stamps of a fresh array are never equal to the new check count
+	if ( model->maxVertices > context->maxVertexStates ) {
+		Mem_Free( context->vertexStates );
+		context->maxVertexStates = model->maxVertices;
+		context->vertexStates = (cm_primitiveState_t *) Mem_ClearedAlloc( context->maxVertexStates * sizeof( cm_primitiveState_t ), TAG_COLLISION );
+	}
+	if ( model->maxEdges > context->maxEdgeStates ) {
+		Mem_Free( context->edgeStates );
+		context->maxEdgeStates = model->maxEdges;
+		context->edgeStates = (cm_primitiveState_t *) Mem_ClearedAlloc( context->maxEdgeStates * sizeof( cm_primitiveState_t ), TAG_COLLISION );
+	}
+	if ( context->checked == NULL ) {
+		context->checkedMask = CHECKED_HASH_SIZE - 1;
+		context->checked = (cm_checkedPrimitive_t *) Mem_ClearedAlloc( CHECKED_HASH_SIZE * sizeof( cm_checkedPrimitive_t ), TAG_COLLISION );
+	}
+}
+
+/*
+================
+CM_GrowCheckedHash
+
+  doubles the size of the checked primitive hash, keeping the primitives checked during the current trace
+================
+*/
+void CM_GrowCheckedHash( cm_traceContext_t *context ) {
+	int i, oldSize;
+	cm_checkedPrimitive_t *oldChecked;
+
+	oldSize = context->checkedMask + 1;
+	oldChecked = context->checked;
+
+	context->checkedMask = oldSize * 2 - 1;
+	context->checked = (cm_checkedPrimitive_t *) Mem_ClearedAlloc( oldSize * 2 * sizeof( cm_checkedPrimitive_t ), TAG_COLLISION );
+	context->numChecked = 0;
+
+	for ( i = 0; i < oldSize; i++ ) {
+		if ( oldChecked[i].checkcount == context->checkCount ) {
+			CM_PrimitiveChecked( context, oldChecked[i].primitive );
+		}
+	}
+	Mem_Free( oldChecked );
+}
+
+/*
+================
+idCollisionModelManagerLocal::GetTraceContext
+
+  a thread gets its trace context the first time it traces, contexts are never freed because only
+  long lived threads like the job threads are expected to trace
+================
+*/
+cm_traceContext_t *idCollisionModelManagerLocal::GetTraceContext() {
+	cm_traceContext_t *context;
+
+	context = (cm_traceContext_t *)(ptrdiff_t)threadTraceContext;
+	if ( context == NULL ) {
+		context = new (TAG_COLLISION) cm_traceContext_t;
+		traceContextLock.Lock();
+		traceContexts.Append( context );
+		traceContextLock.Unlock();
+		threadTraceContext = (ptrdiff_t)context;
+	}
+	return context;
+}
+
+/*
+===============================================================================
+
 Trace through the spatial subdivision
 
 ===============================================================================
@@ -209,6 +295,175 @@ void idCollisionModelManagerLocal::TraceThroughAxialBSPTree_r( cm_traceWork_t *t
 	idCollisionModelManagerLocal::TraceThroughAxialBSPTree_r( tw, node->children[side^1], midf, p2f, mid, p2 );
 }
 
+/*
+================
+idCollisionModelManagerLocal::TraceTrmThroughFlatNode
+================
+*/
+void idCollisionModelManagerLocal::TraceTrmThroughFlatNode( cm_traceWork_t *tw, const cm_flatNode_t *node ) {
+	cm_polygon_t **polygons = tw->model->flatPolygons + node->firstPolygon;
+	cm_brush_t **brushes = tw->model->flatBrushes + node->firstBrush;
+	int i;
+
+	// position test
+	if ( tw->positionTest ) {
+		// if already stuck in solid
+		if ( tw->trace.fraction == 0.0f ) {
+			return;
+		}
+		// test if any of the trm vertices is inside a brush
+		for ( i = 0; i < node->numBrushes; i++ ) {
+			if ( idCollisionModelManagerLocal::TestTrmVertsInBrush( tw, brushes[i] ) ) {
+				return;
+			}
+		}
+		// if just testing a point we're done
+		if ( tw->pointTrace ) {
+			return;
+		}
+		// test if the trm is stuck in any polygons
+		for ( i = 0; i < node->numPolygons; i++ ) {
+			if ( idCollisionModelManagerLocal::TestTrmInPolygon( tw, polygons[i] ) ) {
+				return;
+			}
+		}
+	}
+	else if ( tw->rotation ) {
+		// rotate through all polygons in this leaf
+		for ( i = 0; i < node->numPolygons; i++ ) {
+			if ( idCollisionModelManagerLocal::RotateTrmThroughPolygon( tw, polygons[i] ) ) {
+				return;
+			}
+		}
+	}
+	else {
+		// trace through all polygons in this leaf
+		for ( i = 0; i < node->numPolygons; i++ ) {
+			if ( idCollisionModelManagerLocal::TranslateTrmThroughPolygon( tw, polygons[i] ) ) {
+				return;
+			}
+		}
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::TraceThroughFlatTree_r
+
+  same as TraceThroughAxialBSPTree_r but walks the flattened nodes, the front child directly follows its parent
+================
+*/
+void idCollisionModelManagerLocal::TraceThroughFlatTree_r( cm_traceWork_t *tw, int nodeNum, float p1f, float p2f, idVec3 &p1, idVec3 &p2 ) {
+	float		t1, t2, offset;
+	float		frac, frac2;
+	float		idist;
+	idVec3		mid;
+	int			side;
+	float		midf;
+
+	if ( tw->quickExit ) {
+		return;		// stop immediately
+	}
+
+	if ( tw->trace.fraction <= p1f ) {
+		return;		// already hit something nearer
+	}
+
+	const cm_flatNode_t *node = &tw->model->flatNodes[nodeNum];
+
+	// if we need to test this node for collisions
+	if ( node->numPolygons || ( tw->positionTest && node->numBrushes ) ) {
+		// trace through node with collision data
+		idCollisionModelManagerLocal::TraceTrmThroughFlatNode( tw, node );
+	}
+	// if already stuck in solid
+	if ( tw->positionTest && tw->trace.fraction == 0.0f ) {
+		return;
+	}
+	// if this is a leaf node
+	if ( node->planeType == -1 ) {
+		return;
+	}
+	const int children[2] = { nodeNum + 1, node->backChild };
+
+	// distance from plane for trace start and end
+	t1 = p1[node->planeType] - node->planeDist;
+	t2 = p2[node->planeType] - node->planeDist;
+	// adjust the plane distance appropriately for mins/maxs
+	offset = tw->extents[node->planeType];
+	// see which sides we need to consider
+	if ( t1 >= offset && t2 >= offset ) {
+		idCollisionModelManagerLocal::TraceThroughFlatTree_r( tw, children[0], p1f, p2f, p1, p2 );
+		return;
+	}
+
+	if ( t1 < -offset && t2 < -offset ) {
+		idCollisionModelManagerLocal::TraceThroughFlatTree_r( tw, children[1], p1f, p2f, p1, p2 );
+		return;
+	}
+
+	if ( t1 < t2 ) {
+		idist = 1.0f / (t1-t2);
+		side = 1;
+		frac2 = (t1 + offset) * idist;
+		frac = (t1 - offset) * idist;
+	} else if (t1 > t2) {
+		idist = 1.0f / (t1-t2);
+		side = 0;
+		frac2 = (t1 - offset) * idist;
+		frac = (t1 + offset) * idist;
+	} else {
+		side = 0;
+		frac = 1.0f;
+		frac2 = 0.0f;
+	}
+
+	// move up to the node
+	if ( frac < 0.0f ) {
+		frac = 0.0f;
+	}
+	else if ( frac > 1.0f ) {
+		frac = 1.0f;
+	}
+
+	midf = p1f + (p2f - p1f)*frac;
+
+	mid[0] = p1[0] + frac*(p2[0] - p1[0]);
+	mid[1] = p1[1] + frac*(p2[1] - p1[1]);
+	mid[2] = p1[2] + frac*(p2[2] - p1[2]);
+
+	idCollisionModelManagerLocal::TraceThroughFlatTree_r( tw, children[side], p1f, midf, p1, mid );
+
+	// go past the node
+	if ( frac2 < 0.0f ) {
+		frac2 = 0.0f;
+	}
+	else if ( frac2 > 1.0f ) {
+		frac2 = 1.0f;
+	}
+
+	midf = p1f + (p2f - p1f)*frac2;
+
+	mid[0] = p1[0] + frac2*(p2[0] - p1[0]);
+	mid[1] = p1[1] + frac2*(p2[1] - p1[1]);
+	mid[2] = p1[2] + frac2*(p2[2] - p1[2]);
+
+	idCollisionModelManagerLocal::TraceThroughFlatTree_r( tw, children[side^1], midf, p2f, mid, p2 );
+}
+
+/*
+================
+idCollisionModelManagerLocal::TraceThroughTree
+================
+*/
+void idCollisionModelManagerLocal::TraceThroughTree( cm_traceWork_t *tw, idVec3 &start, idVec3 &end ) {
+	if ( tw->model->flatNodes != NULL && cm_flatTree.GetBool() ) {
+		idCollisionModelManagerLocal::TraceThroughFlatTree_r( tw, 0, 0, 1, start, end );
+	} else {
+		idCollisionModelManagerLocal::TraceThroughAxialBSPTree_r( tw, tw->model->node, 0, 1, start, end );
+	}
+}
+
 /*
 ================
 idCollisionModelManagerLocal::TraceThroughModel
@@ -222,7 +477,7 @@ void idCollisionModelManagerLocal::TraceThroughModel( cm_traceWork_t *tw ) {
 
 	if ( !tw->rotation ) {
 		// trace through spatial subdivision and then through leafs
-		idCollisionModelManagerLocal::TraceThroughAxialBSPTree_r( tw, tw->model->node, 0, 1, tw->start, tw->end );
+		idCollisionModelManagerLocal::TraceThroughTree( tw, tw->start, tw->end );
 	}
 	else {
 		// approximate the rotation with a series of straight line movements
@@ -240,7 +495,7 @@ void idCollisionModelManagerLocal::TraceThroughModel( cm_traceWork_t *tw ) {
 				rot.Set( tw->origin, tw->axis, tw->angle * ((float) (i+1) / numSteps) );
 				end = start * rot;
 				// trace through spatial subdivision and then through leafs
-				idCollisionModelManagerLocal::TraceThroughAxialBSPTree_r( tw, tw->model->node, 0, 1, start, end );
+				idCollisionModelManagerLocal::TraceThroughTree( tw, start, end );
 				// no need to continue if something was hit already
 				if ( tw->trace.fraction < 1.0f ) {
 					return;
@@ -252,6 +507,6 @@ void idCollisionModelManagerLocal::TraceThroughModel( cm_traceWork_t *tw ) {
 			start = tw->start;
 		}
 		// last step of the approximation
-		idCollisionModelManagerLocal::TraceThroughAxialBSPTree_r( tw, tw->model->node, 0, 1, start, tw->end );
+		idCollisionModelManagerLocal::TraceThroughTree( tw, start, tw->end );
 	}
 }
@@ -635,6 +635,20 @@ void idAFEntity_Base::Think() {
 	}
 }
 
+/*
+================
+idAFEntity_Base::CanThinkInParallel
+
+  an active articulated figure changes the pose after running physics
+================
+*/
+bool idAFEntity_Base::CanThinkInParallel() {
+	if ( af.IsActive() ) {
+		return false;
+	}
+	return idAnimatedEntity::CanThinkInParallel();
+}
+
 /*
 ================
 idAFEntity_Base::BodyForClipModelId
@@ -156,6 +156,7 @@ public:
 	void					Restore( idRestoreGame *savefile );
 
 	virtual void			Think();
+	virtual bool			CanThinkInParallel();
 	virtual void			AddDamageEffect( const trace_t &collision, const idVec3 &velocity, const char *damageDefName );
 	virtual void			GetImpactInfo( idEntity *ent, int id, const idVec3 &point, impactInfo_t *info );
 	virtual void			ApplyImpulse( idEntity *ent, int id, const idVec3 &point, const idVec3 &impulse );
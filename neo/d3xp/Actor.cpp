@@ -1201,6 +1201,18 @@ void idActor::CheckBlink() {
 	blink_time = gameLocal.time + blink_min + gameLocal.random.RandomFloat() * ( blink_max - blink_min );
 }
 
+/*
+================
+idActor::CanThinkInParallel
+
+  the script and the animation controllers change the animation during the think
+  so a frame created up front would be created again
+================
+*/
+bool idActor::CanThinkInParallel() {
+	return false;
+}
+
 /*
 ================
 idActor::GetPhysicsToVisualTransform
@@ -140,6 +140,8 @@ public:
 	virtual bool			GetPhysicsToVisualTransform( idVec3 &origin, idMat3 &axis );
 	virtual bool			GetPhysicsToSoundTransform( idVec3 &origin, idMat3 &axis );
 
+	virtual bool			CanThinkInParallel();
+
 							// script state management
 	void					ShutdownThreads();
 	virtual bool			ShouldConstructScriptObjectAtSpawn() const;
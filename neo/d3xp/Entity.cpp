@@ -869,6 +869,36 @@ void idEntity::Think() {
 	Present();
 }
 
+/*
+================
+idEntity::CanThinkInParallel
+
+  Entities that return true get ThinkParallel called from a job before the serial think
+  of all entities. ThinkParallel may only read and write the state of the entity itself
+  and its team master, the team master always runs on the same job before its team.
+================
+*/
+bool idEntity::CanThinkInParallel() {
+	return false;
+}
+
+/*
+================
+idEntity::ThinkParallel
+================
+*/
+void idEntity::ThinkParallel() {
+}
+
+/*
+================
+idEntity::VerifyParallelThink
+================
+*/
+bool idEntity::VerifyParallelThink() {
+	return true;
+}
+
 /*
 ================
 idEntity::DoDormantTests
@@ -5440,6 +5470,48 @@ void idAnimatedEntity::Think() {
 	UpdateDamageEffects();
 }
 
+/*
+================
+idAnimatedEntity::CanThinkInParallel
+
+  the joints for the current frame only depend on the animator so they can be created up front,
+  a change to the animation during the serial think before anything uses the frame throws it away
+================
+*/
+bool idAnimatedEntity::CanThinkInParallel() {
+	if ( !( thinkFlags & TH_ANIMATE ) || fl.hidden || !animator.ModelHandle() ) {
+		return false;
+	}
+	// the animation debug output is printed while creating the frame
+	if ( g_debugAnim.GetInteger() != -1 ) {
+		return false;
+	}
+	// a frame that is created again later is wasted work, so only do it for entities that will
+	// likely be drawn, the others keep creating their frame when something asks for the joints
+	if ( !gameLocal.InPlayerPVS( this ) ) {
+		return false;
+	}
+	return true;
+}
+
+/*
+================
+idAnimatedEntity::ThinkParallel
+================
+*/
+void idAnimatedEntity::ThinkParallel() {
+	animator.PrebuildFrame( gameLocal.time );
+}
+
+/*
+================
+idAnimatedEntity::VerifyParallelThink
+================
+*/
+bool idAnimatedEntity::VerifyParallelThink() {
+	return animator.CompareFrame( gameLocal.time );
+}
+
 /*
 ================
 idAnimatedEntity::UpdateAnimation
@@ -245,6 +245,9 @@ public:
 
 	// thinking
 	virtual void			Think();
+	virtual bool			CanThinkInParallel();	// true if ThinkParallel touches nothing but this entity and its team master
+	virtual void			ThinkParallel();				// runs on a job thread before the serial think of all entities
+	virtual bool			VerifyParallelThink();			// redoes the parallel think serially, returns false if the results differ
 	bool					CheckDormant();	// dormant == on the active list, but out of PVS
 	virtual	void			DormantBegin();	// called when entity becomes dormant
 	virtual	void			DormantEnd();		// called when entity wakes from being dormant
@@ -617,6 +620,9 @@ public:
 	virtual void			ClientPredictionThink();
 	virtual void			ClientThink( const int curTime, const float fraction, const bool predict );
 	virtual void			Think();
+	virtual bool			CanThinkInParallel();
+	virtual void			ThinkParallel();
+	virtual bool			VerifyParallelThink();
 
 	void					UpdateAnimation();
 
@@ -211,6 +211,9 @@ void idGameLocal::Clear() {
 	numEntitiesToDeactivate = 0;
 	sortPushers = false;
 	sortTeamMasters = false;
+	parallelThinkEntities.Clear();
+	parallelThinkJobs.Clear();
+	parallelThinkJobList = NULL;
 	persistentLevelInfo.Clear();
 	memset( globalShaderParms, 0, sizeof( globalShaderParms ) );
 	random.SetSeed( 0 );
@@ -413,6 +416,11 @@ void idGameLocal::Shutdown() {
 	// free the collision map
 	collisionModelManager->FreeMap();
 
+	if ( parallelThinkJobList != NULL ) {
+		parallelJobManager->FreeJobList( parallelThinkJobList );
+		parallelThinkJobList = NULL;
+	}
+
 	ShutdownConsoleCommands();
 
 	// free memory allocated by class objects
@@ -2191,6 +2199,148 @@ void idGameLocal::SortActiveEntityList() {
 	sortPushers = false;
 }
 
+/*
+================
+idSort_ParallelThinkEntity
+================
+*/
+class idSort_ParallelThinkEntity : public idSort_Quick< parallelThinkEntity_t, idSort_ParallelThinkEntity > {
+public:
+	int Compare( const parallelThinkEntity_t & a, const parallelThinkEntity_t & b ) const {
+		if ( a.team != b.team ) {
+			return a.team - b.team;
+		}
+		return a.order - b.order;
+	}
+};
+
+/*
+================
+ParallelThinkJob
+================
+*/
+static void ParallelThinkJob( parallelThinkJob_t *job ) {
+	for ( int i = 0; i < job->numEntities; i++ ) {
+		job->entities[i].ent->ThinkParallel();
+	}
+}
+
+REGISTER_PARALLEL_JOB( ParallelThinkJob, "ParallelThinkJob" );
+
+static const int PARALLEL_THINK_ENTITIES_PER_JOB = 16;
+
+/*
+================
+idGameLocal::RunParallelThink
+
+  Runs the parallel think of all entities in time group 1 that can think in parallel.
+  The members of a team are kept together on one job in the order of the active entity
+  list so a team member may depend on the state of its team master.
+================
+*/
+void idGameLocal::RunParallelThink() {
+	idEntity *ent, *master;
+	int i, num;
+
+	parallelThinkEntities.SetNum( 0 );
+	parallelThinkJobs.SetNum( 0 );
+
+	num = 0;
+	for ( ent = activeEntities.Next(); ent != NULL; ent = ent->activeNode.Next(), num++ ) {
+		if ( ent->timeGroup != TIME_GROUP1 ) {
+			continue;
+		}
+		if ( !ent->CanThinkInParallel() ) {
+			continue;
+		}
+		master = ent->GetTeamMaster();
+		parallelThinkEntity_t & pte = *parallelThinkEntities.Alloc();
+		pte.ent = ent;
+		pte.team = ( master != NULL ) ? master->entityNumber : ent->entityNumber;
+		pte.order = num;
+		pte.entityNumber = ent->entityNumber;
+		pte.spawnId = spawnIds[ ent->entityNumber ];
+		pte.moved = false;
+		if ( g_parallelThinkCheck.GetBool() ) {
+			pte.origin = ent->GetPhysics()->GetOrigin();
+			pte.axis = ent->GetPhysics()->GetAxis();
+		}
+	}
+
+	if ( parallelThinkEntities.Num() == 0 ) {
+		return;
+	}
+
+	idSort_ParallelThinkEntity().Sort( parallelThinkEntities.Ptr(), parallelThinkEntities.Num() );
+
+	// only split jobs between teams
+	parallelThinkJob_t *job = NULL;
+	for ( i = 0; i < parallelThinkEntities.Num(); i++ ) {
+		if ( job == NULL || ( job->numEntities >= PARALLEL_THINK_ENTITIES_PER_JOB && parallelThinkEntities[i].team != parallelThinkEntities[i - 1].team ) ) {
+			job = parallelThinkJobs.Alloc();
+			job->entities = &parallelThinkEntities[i];
+			job->numEntities = 0;
+		}
+		job->numEntities++;
+	}
+
+	if ( parallelThinkJobList == NULL ) {
+		parallelThinkJobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, MAX_GENTITIES, 0, NULL );
+	}
+
+	for ( i = 0; i < parallelThinkJobs.Num(); i++ ) {
+		parallelThinkJobList->AddJob( (jobRun_t)ParallelThinkJob, &parallelThinkJobs[i] );
+	}
+	parallelThinkJobList->Submit();
+	parallelThinkJobList->Wait();
+
+	// the parallel think must leave the physics alone, VerifyParallelThink reports the entities that moved
+	if ( g_parallelThinkCheck.GetBool() ) {
+		for ( i = 0; i < parallelThinkEntities.Num(); i++ ) {
+			parallelThinkEntity_t & pte = parallelThinkEntities[i];
+			const idPhysics * phys = pte.ent->GetPhysics();
+			pte.moved = !phys->GetOrigin().Compare( pte.origin ) || !phys->GetAxis().Compare( pte.axis );
+		}
+	}
+}
+
+/*
+================
+idGameLocal::VerifyParallelThink
+
+  Reports the entities whose physics moved during the parallel think, then redoes the parallel
+  think of every entity that is still around after the serial think and reports the entities
+  that end up with a different state than the serial path gives.
+================
+*/
+void idGameLocal::VerifyParallelThink() {
+	int i, numChecked, numDifferent;
+
+	numChecked = 0;
+	numDifferent = 0;
+	for ( i = 0; i < parallelThinkEntities.Num(); i++ ) {
+		const parallelThinkEntity_t & pte = parallelThinkEntities[i];
+		// the entity may have been removed during the serial think
+		if ( entities[ pte.entityNumber ] != pte.ent || spawnIds[ pte.entityNumber ] != pte.spawnId ) {
+			continue;
+		}
+		numChecked++;
+		if ( pte.moved ) {
+			Warning( "%d: entity '%s' moved during the parallel think", time, pte.ent->name.c_str() );
+			numDifferent++;
+			continue;
+		}
+		if ( !pte.ent->VerifyParallelThink() ) {
+			Warning( "%d: entity '%s' differs from the serial think", time, pte.ent->name.c_str() );
+			numDifferent++;
+		}
+	}
+
+	if ( numDifferent != 0 ) {
+		Warning( "%d: %d of %d entities differ from the serial think", time, numDifferent, numChecked );
+	}
+}
+
 
 
 /*
@@ -2383,6 +2533,10 @@ void idGameLocal::RunFrame( idUserCmdMgr & cmdMgr, gameReturn_t & ret ) {
 					num++;
 				}
 			} else {
+				// let entities with a self contained think do that part on the job threads first
+				if ( g_parallelThink.GetBool() ) {
+					RunParallelThink();
+				}
 				num = 0;
 				for( ent = activeEntities.Next(); ent != NULL; ent = ent->activeNode.Next() ) {
 					if ( ent->timeGroup != TIME_GROUP1 ) {
@@ -2396,6 +2550,15 @@ void idGameLocal::RunFrame( idUserCmdMgr & cmdMgr, gameReturn_t & ret ) {
 
 		RunTimeGroup2( cmdMgr );
 
+		// compare the parallel think against the serial think
+		if ( parallelThinkEntities.Num() ) {
+			if ( g_parallelThinkCheck.GetBool() ) {
+				VerifyParallelThink();
+			}
+			parallelThinkEntities.SetNum( 0 );
+			parallelThinkJobs.SetNum( 0 );
+		}
+
 		// Run catch-up for any client projectiles.
 		// This is done after the main think so that all projectiles will be up-to-date
 		// when snapshots are created.
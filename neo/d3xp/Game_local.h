@@ -93,6 +93,7 @@ void gameError( const char *fmt, ... );
 #include "ai/AAS.h"
 
 #include "physics/Clip.h"
+#include "physics/ClipTree.h"
 #include "physics/Push.h"
 
 #include "Pvs.h"
@@ -158,6 +159,22 @@ typedef struct {
 	int			team;			
 } spawnSpot_t;
 
+typedef struct {
+	idEntity	*ent;
+	int			team;			// entity number of the team master, entities of the same team run on the same job
+	int			order;			// position in the active entity list
+	int			entityNumber;	// kept here because the entity may be gone when the check runs
+	int			spawnId;
+	idVec3		origin;			// physics origin and axis before the parallel think, only set for g_parallelThinkCheck
+	idMat3		axis;
+	bool		moved;			// the physics origin or axis changed during the parallel think
+} parallelThinkEntity_t;
+
+typedef struct {
+	parallelThinkEntity_t *	entities;
+	int						numEntities;
+} parallelThinkJob_t;
+
 //============================================================================
 
 class idEventQueue {
@@ -573,6 +590,10 @@ private:
 	idStaticList<idEntity *, MAX_GENTITIES> teamInitialSpots[2];
 	int						teamCurrentInitialSpot[2];
 
+	idStaticList<parallelThinkEntity_t, MAX_GENTITIES> parallelThinkEntities;	// entities that ran the parallel think this frame
+	idStaticList<parallelThinkJob_t, MAX_GENTITIES> parallelThinkJobs;
+	idParallelJobList *		parallelThinkJobList;
+
 	struct netInterpolationInfo_t {		// Was in GameTimeManager.h in id5, needed common place to put this.
 		netInterpolationInfo_t()
 			: pct( 0.0f )
@@ -610,6 +631,8 @@ private:
 	void					FreePlayerPVS();
 	void					UpdateGravity();
 	void					SortActiveEntityList();
+	void					RunParallelThink();
+	void					VerifyParallelThink();
 	void					ShowTargets();
 	void					RunDebugInfo();
 
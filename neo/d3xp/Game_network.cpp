@@ -53,6 +53,7 @@ static const int SNAP_LAST_CLIENT_FRAME_END = SNAP_LAST_CLIENT_FRAME + MAX_PLAYE
 */
 
 idCVar net_clientSmoothing( "net_clientSmoothing", "0.8", CVAR_GAME | CVAR_FLOAT, "smooth other clients angles and position.", 0.0f, 0.95f );
+idCVar net_snapRelevanceDistance( "net_snapRelevanceDistance", "4096", CVAR_GAME | CVAR_FLOAT, "distance at which an entity is least relevant to a client when its snapshot has to be trimmed", 1.0f, 65536.0f );
 idCVar net_clientSelfSmoothing( "net_clientSelfSmoothing", "0.6", CVAR_GAME | CVAR_FLOAT, "smooth self position if network causes prediction error.", 0.0f, 0.95f );
 extern idCVar net_clientMaxPrediction;
 
@@ -305,6 +306,38 @@ void idGameLocal::SaveEntityNetworkEvent( const idEntity *ent, int eventId, cons
 	savedEventQueue.Enqueue( event, idEventQueue::OUTOFORDER_IGNORE );
 }
 
+/*
+================
+GetEntitySnapshotRelevance
+
+  How much a client cares about an entity, used to decide what gets deferred when a
+  snapshot delta doesn't fit. Players and anything bound to them always go out, then
+  entities in the client's PVS, nearest first.
+================
+*/
+static uint8 GetEntitySnapshotRelevance( const idPVS & pvs, idEntity * ent, pvsHandle_t pvsHandle, const idVec3 & viewOrigin ) {
+	if ( ent->entityNumber < MAX_CLIENTS ) {
+		return idSnapShot::RELEVANCE_ALWAYS_SEND;
+	}
+	idEntity * master = ent->GetBindMaster();
+	if ( master != NULL && master->entityNumber < MAX_CLIENTS ) {
+		return idSnapShot::RELEVANCE_ALWAYS_SEND;
+	}
+
+	const float dist = ( ent->GetPhysics()->GetOrigin() - viewOrigin ).LengthFast();
+	const float closeness = 1.0f - idMath::ClampFloat( 0.0f, 1.0f, dist / net_snapRelevanceDistance.GetFloat() );
+
+	bool inPVS = true;
+	if ( ent->GetNumPVSAreas() > 0 ) {
+		inPVS = pvs.InCurrentPVS( pvsHandle, ent->GetPVSAreas(), ent->GetNumPVSAreas() );
+	}
+
+	if ( inPVS ) {
+		return (uint8)( 128 + idMath::Ftoi( 126.0f * closeness ) );
+	}
+	return (uint8)idMath::Ftoi( 64.0f * closeness );
+}
+
 /*
 ================
 idGameLocal::ServerWriteSnapshot
@@ -347,9 +380,14 @@ void idGameLocal::ServerWriteSnapshot( idSnapShot & ss ) {
 		portalSkyPVS = pvs.SetupCurrentPVS( skyEnt->GetPVSAreas(), skyEnt->GetNumPVSAreas() );
 	}
 
+	idLobbyBase & lobby = session->GetActingGameStateLobbyBase();
+
 	// Build PVS data for each player and write their player state to the snapshot as well
 	pvsHandle_t pvsHandles[ MAX_PLAYERS ];
+	int visIndexes[ MAX_PLAYERS ];
+	idVec3 viewOrigins[ MAX_PLAYERS ];
 	for ( int i = 0; i < MAX_PLAYERS; i++ ) {
+		visIndexes[i] = -1;
 		idPlayer * player = static_cast<idPlayer *>( entities[ i ] );
 		if ( player == NULL ) {
 			pvsHandles[i].i = -1;
@@ -373,6 +411,13 @@ void idGameLocal::ServerWriteSnapshot( idSnapShot & ss ) {
 			pvsHandles[i] = tempPVS;
 		}
 
+		// The snapshot for a peer is written with visIndex peer + 1, the host's own player doesn't get one
+		const int peer = lobby.PeerIndexFromLobbyUser( lobbyUserIDs[i] );
+		if ( peer >= 0 && peer + 1 < idSnapShot::MAX_RELEVANCE_INDEX ) {
+			visIndexes[i] = peer + 1;
+			viewOrigins[i] = spectated->GetPhysics()->GetOrigin();
+		}
+
 		// Write the last usercmd processed by the server so that clients know
 		// when to stop predicting.
 		msg.BeginWriting();
@@ -403,6 +448,13 @@ void idGameLocal::ServerWriteSnapshot( idSnapShot & ss ) {
 		}
 
 		ss.S_AddObject( SNAP_ENTITIES + ent->entityNumber, ~0U, msg, ent->GetName() );
+
+		for ( int i = 0; i < MAX_PLAYERS; i++ ) {
+			if ( visIndexes[i] < 0 ) {
+				continue;
+			}
+			ss.SetObjectRelevance( SNAP_ENTITIES + ent->entityNumber, visIndexes[i], GetEntitySnapshotRelevance( pvs, ent, pvsHandles[i], viewOrigins[i] ) );
+		}
 	}
 
 	// Free PVS handles for all the players
@@ -491,6 +491,8 @@ public:
 	void						ForceUpdate();
 	void						ClearForceUpdate();
 	bool						CreateFrame( int animtime, bool force );
+	bool						PrebuildFrame( int animtime );
+	bool						CompareFrame( int animtime );
 	bool						FrameHasChanged( int animtime ) const;
 	void						GetDelta( int fromtime, int totime, idVec3 &delta ) const;
 	bool						GetDeltaRotation( int fromtime, int totime, idMat3 &delta ) const;
@@ -540,6 +542,8 @@ private:
 	void						PushAnims( int channel, int currentTime, int blendTime );
 
 private:
+	void						DiscardPrebuiltFrame();
+
 	const idDeclModelDef *		modelDef;
 	idEntity *					entity;
 
@@ -552,6 +556,7 @@ private:
 	mutable bool				stoppedAnimatingUpdate;
 	bool						removeOriginOffset;
 	bool						forceUpdate;
+	int							prebuiltFrameTime;		// time of the frame PrebuildFrame created if nothing used it yet, -1 otherwise
 
 	idBounds					frameBounds;
 
@@ -3097,6 +3097,7 @@ idAnimator::idAnimator() {
 	stoppedAnimatingUpdate	= false;
 	removeOriginOffset		= false;
 	forceUpdate				= false;
+	prebuiltFrameTime		= -1;
 
 	frameBounds.Clear();
 
@@ -3246,6 +3247,7 @@ void idAnimator::Restore( idRestoreGame *savefile ) {
 	savefile->ReadBool( stoppedAnimatingUpdate );
 	savefile->ReadBool( forceUpdate );
 	savefile->ReadBounds( frameBounds );
+	prebuiltFrameTime = -1;
 
 	savefile->ReadFloat( AFPoseBlendWeight );
 
@@ -3572,6 +3574,7 @@ void idAnimator::SetFrame( int channelNum, int animNum, int frame, int currentTi
 
 	PushAnims( channelNum, currentTime, blendTime );
 	channels[ channelNum ][ 0 ].SetFrame( modelDef, animNum, frame, currentTime, blendTime );
+	DiscardPrebuiltFrame();
 	if ( entity ) {
 		entity->BecomeActive( TH_ANIMATE );
 	}
@@ -3593,6 +3596,7 @@ void idAnimator::CycleAnim( int channelNum, int animNum, int currentTime, int bl
 	
 	PushAnims( channelNum, currentTime, blendTime );
 	channels[ channelNum ][ 0 ].CycleAnim( modelDef, animNum, currentTime, blendTime );
+	DiscardPrebuiltFrame();
 	if ( entity ) {
 		entity->BecomeActive( TH_ANIMATE );
 	}
@@ -3614,6 +3618,7 @@ void idAnimator::PlayAnim( int channelNum, int animNum, int currentTime, int ble
 	
 	PushAnims( channelNum, currentTime, blendTime );
 	channels[ channelNum ][ 0 ].PlayAnim( modelDef, animNum, currentTime, blendTime );
+	DiscardPrebuiltFrame();
 	if ( entity ) {
 		entity->BecomeActive( TH_ANIMATE );
 	}
@@ -3645,6 +3650,8 @@ void idAnimator::SyncAnimChannels( int channelNum, int fromChannelNum, int curre
 	// disable framecommands on the current channel so that commands aren't called twice
 	toBlend.AllowFrameCommands( false );
 
+	DiscardPrebuiltFrame();
+
 	if ( entity ) {
 		entity->BecomeActive( TH_ANIMATE );
 	}
@@ -4277,6 +4284,9 @@ bool idAnimator::CreateFrame( int currentTime, bool force ) {
 		return false;
 	}
 
+	// once something asks for the frame, a prebuilt frame is used just like the serial path would use it
+	prebuiltFrameTime = -1;
+
 	if ( !force && !r_showSkel.GetInteger() ) {
 		if ( lastTransformTime == currentTime ) {
 			return false;
@@ -4494,6 +4504,62 @@ bool idAnimator::CreateFrame( int currentTime, bool force ) {
 	return true;
 }
 
+/*
+=====================
+idAnimator::PrebuildFrame
+
+  creates the frame for the given time ahead of the serial think,
+  changing the animation before anything asks for the frame throws it away again
+=====================
+*/
+bool idAnimator::PrebuildFrame( int currentTime ) {
+	if ( !CreateFrame( currentTime, false ) ) {
+		return false;
+	}
+	prebuiltFrameTime = currentTime;
+	return true;
+}
+
+/*
+=====================
+idAnimator::DiscardPrebuiltFrame
+
+  PushAnims doesn't force an update when the channel had no weight or was started this frame,
+  so a prebuilt frame would survive the animation change and show the old pose.
+  Only the frame time is reset, forceUpdate would make FrameHasChanged differ from the serial path.
+=====================
+*/
+void idAnimator::DiscardPrebuiltFrame() {
+	if ( prebuiltFrameTime == -1 ) {
+		return;
+	}
+	prebuiltFrameTime = -1;
+	lastTransformTime = -1;
+}
+
+/*
+=====================
+idAnimator::CompareFrame
+
+  rebuilds the frame created earlier for the given time and returns false if the joints differ
+=====================
+*/
+bool idAnimator::CompareFrame( int currentTime ) {
+	if ( lastTransformTime != currentTime || !joints ) {
+		return true;
+	}
+
+	idJointMat *oldJoints = ( idJointMat * )_alloca16( numJoints * sizeof( oldJoints[0] ) );
+	SIMDProcessor->Memcpy( oldJoints, joints, numJoints * sizeof( oldJoints[0] ) );
+
+	// rebuilding the frame should not change when the next update happens
+	const bool oldStoppedAnimatingUpdate = stoppedAnimatingUpdate;
+	CreateFrame( currentTime, true );
+	stoppedAnimatingUpdate = oldStoppedAnimatingUpdate;
+
+	return ( memcmp( oldJoints, joints, numJoints * sizeof( oldJoints[0] ) ) == 0 );
+}
+
 /*
 =====================
 idAnimator::ForceUpdate
@@ -1513,6 +1513,181 @@ static void Cmd_TestDeath_f( const idCmdArgs &args ) {
 
 }
 
+/*
+==================
+Cmd_TestClipBatch_f
+
+compares idClip::TranslationBatch with idClip::Translation for traces around the player
+==================
+*/
+static void Cmd_TestClipBatch_f( const idCmdArgs &args ) {
+	idPlayer *player;
+
+	player = gameLocal.GetLocalPlayer();
+	if ( !player || !gameLocal.CheatsOk() ) {
+		return;
+	}
+
+	const int numTraces = ( args.Argc() > 1 ) ? idMath::ClampInt( 1, 65536, atoi( args.Argv( 1 ) ) ) : 4096;
+	const idVec3 eye = player->GetEyePosition();
+	idRandom random( numTraces );
+
+	idList< clipTrace_t > traces;
+	idList< trace_t > singleResults;
+	traces.SetNum( numTraces );
+	singleResults.SetNum( numTraces );
+
+	// half the traces start at the eye like hitscan weapons, the others are spread around the player like sight checks
+	for ( int i = 0; i < numTraces; i++ ) {
+		idVec3 dir( random.CRandomFloat(), random.CRandomFloat(), random.CRandomFloat() * 0.25f );
+		dir.Normalize();
+
+		clipTrace_t &trace = traces[i];
+		trace.start = eye;
+		if ( i & 1 ) {
+			trace.start += idVec3( random.CRandomFloat(), random.CRandomFloat(), random.CRandomFloat() * 0.25f ) * 2048.0f;
+		}
+		trace.end = trace.start + dir * ( 256.0f + random.RandomFloat() * 3840.0f );
+		trace.mdl = ( ( i & 3 ) == 3 ) ? gameLocal.clip.DefaultClipModel() : NULL;
+		trace.trmAxis = mat3_identity;
+		trace.contentMask = MASK_SHOT_RENDERMODEL;
+		trace.passEntity = player;
+	}
+
+	uint64 startTime = Sys_Microseconds();
+	for ( int i = 0; i < numTraces; i++ ) {
+		const clipTrace_t &trace = traces[i];
+		gameLocal.clip.Translation( singleResults[i], trace.start, trace.end, trace.mdl, trace.trmAxis, trace.contentMask, trace.passEntity );
+	}
+	const uint64 singleMicroseconds = Sys_Microseconds() - startTime;
+
+	startTime = Sys_Microseconds();
+	const int numHits = gameLocal.clip.TranslationBatch( traces.Ptr(), numTraces );
+	const uint64 batchMicroseconds = Sys_Microseconds() - startTime;
+
+	int numMismatches = 0;
+	for ( int i = 0; i < numTraces; i++ ) {
+		const trace_t &batchResult = traces[i].results;
+		const trace_t &singleResult = singleResults[i];
+		if ( batchResult.fraction != singleResult.fraction || batchResult.c.entityNum != singleResult.c.entityNum ) {
+			if ( numMismatches < 10 ) {
+				gameLocal.Printf( "trace %d: fraction %f entity %d, single trace fraction %f entity %d\n", i,
+						batchResult.fraction, batchResult.c.entityNum, singleResult.fraction, singleResult.c.entityNum );
+			}
+			numMismatches++;
+		}
+	}
+
+	gameLocal.Printf( "testClipBatch: %d traces, %d hits, single %d usec, batched %d usec (%.2fx)\n", numTraces, numHits,
+			(int)singleMicroseconds, (int)batchMicroseconds, (float)singleMicroseconds / Max( batchMicroseconds, (uint64)1 ) );
+	if ( numMismatches > 0 ) {
+		gameLocal.Warning( "testClipBatch: %d traces do not match the single trace results", numMismatches );
+	}
+}
+
+/*
+==================
+Cmd_TestClipTree_f
+
+links the clip models of the current map into the clip sectors and the clip tree and compares query, move and unlink times
+==================
+*/
+static void Cmd_TestClipTree_f( const idCmdArgs &args ) {
+	const int numMoveFrames = 16;
+	idClipModel *clipModelList[MAX_GENTITIES];
+	idList<idClipModel *> clipModels;
+	idList<idVec3> origins;
+	idList<idMat3> axes;
+	idList<idBounds> queryBounds;
+
+	if ( !gameLocal.GetLocalPlayer() || !gameLocal.CheatsOk() ) {
+		return;
+	}
+
+	const int numQueries = ( args.Argc() > 1 ) ? idMath::ClampInt( 1, 1000000, atoi( args.Argv( 1 ) ) ) : 10000;
+	const bool usedClipTree = gameLocal.clip.UsingClipTree();
+
+	// record the layout of the map
+	gameLocal.clip.GetLinkedClipModels( clipModels );
+	if ( clipModels.Num() == 0 ) {
+		gameLocal.Printf( "testClipTree: no clip models linked\n" );
+		return;
+	}
+	origins.SetNum( clipModels.Num() );
+	axes.SetNum( clipModels.Num() );
+	for ( int i = 0; i < clipModels.Num(); i++ ) {
+		origins[i] = clipModels[i]->GetOrigin();
+		axes[i] = clipModels[i]->GetAxis();
+	}
+
+	// query around the clip models like movement and trace bounds do
+	idRandom random( clipModels.Num() );
+	queryBounds.SetNum( numQueries );
+	for ( int i = 0; i < numQueries; i++ ) {
+		const idBounds &absBounds = clipModels[random.RandomInt( clipModels.Num() )]->GetAbsBounds();
+		const idVec3 center = absBounds.GetCenter() + idVec3( random.CRandomFloat(), random.CRandomFloat(), random.CRandomFloat() ) * 64.0f;
+		queryBounds[i] = idBounds( center ).Expand( 16.0f + random.RandomFloat() * 240.0f );
+	}
+
+	unsigned int checksums[2];
+	for ( int pass = 0; pass < 2; pass++ ) {
+		const bool useClipTree = ( pass == 1 );
+
+		// force all clip models to be relinked from scratch
+		gameLocal.clip.SetClipTree( !useClipTree );
+		uint64 startTime = Sys_Microseconds();
+		gameLocal.clip.SetClipTree( useClipTree );
+		const uint64 linkMicroseconds = Sys_Microseconds() - startTime;
+
+		int numFound = 0;
+		checksums[pass] = 0;
+		startTime = Sys_Microseconds();
+		for ( int i = 0; i < numQueries; i++ ) {
+			const int num = gameLocal.clip.ClipModelsTouchingBounds( queryBounds[i], -1, clipModelList, MAX_GENTITIES );
+			for ( int j = 0; j < num; j++ ) {
+				checksums[pass] += clipModelList[j]->GetEntity()->entityNumber * 64 + clipModelList[j]->GetId();
+			}
+			numFound += num;
+		}
+		const uint64 queryMicroseconds = Sys_Microseconds() - startTime;
+
+		// jitter all clip models a few units per frame like moving entities
+		random.SetSeed( 0 );
+		startTime = Sys_Microseconds();
+		for ( int frame = 0; frame < numMoveFrames; frame++ ) {
+			for ( int i = 0; i < clipModels.Num(); i++ ) {
+				const idVec3 offset( random.CRandomFloat() * 4.0f, random.CRandomFloat() * 4.0f, 0.0f );
+				clipModels[i]->SetPosition( clipModels[i]->GetOrigin() + offset, axes[i] );
+				clipModels[i]->Link( gameLocal.clip );
+			}
+		}
+		const uint64 moveMicroseconds = Sys_Microseconds() - startTime;
+
+		startTime = Sys_Microseconds();
+		for ( int i = 0; i < clipModels.Num(); i++ ) {
+			clipModels[i]->Unlink();
+		}
+		const uint64 unlinkMicroseconds = Sys_Microseconds() - startTime;
+
+		for ( int i = 0; i < clipModels.Num(); i++ ) {
+			clipModels[i]->SetPosition( origins[i], axes[i] );
+			clipModels[i]->Link( gameLocal.clip );
+		}
+
+		gameLocal.Printf( "%s: link %d usec, %d queries %d usec (%d clip models), %d moves %d usec, unlink %d usec\n",
+				useClipTree ? "clip tree   " : "clip sectors", (int)linkMicroseconds, numQueries, (int)queryMicroseconds, numFound,
+				numMoveFrames * clipModels.Num(), (int)moveMicroseconds, (int)unlinkMicroseconds );
+		gameLocal.clip.PrintClipTreeStatistics();
+	}
+
+	gameLocal.clip.SetClipTree( usedClipTree );
+
+	gameLocal.Printf( "testClipTree: %d clip models\n", clipModels.Num() );
+	if ( checksums[0] != checksums[1] ) {
+		gameLocal.Warning( "testClipTree: the clip tree found different clip models than the clip sectors" );
+	}
+}
+
 /*
 ==================
 Cmd_WeaponSplat_f
@@ -2332,6 +2507,8 @@ void idGameLocal::InitConsoleCommands() {
 	cmdSystem->AddCommand( "popLight",				Cmd_PopLight_f,				CMD_FL_GAME|CMD_FL_CHEAT,	"removes the last created light" );
 	cmdSystem->AddCommand( "testDeath",				Cmd_TestDeath_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"tests death" );
 	cmdSystem->AddCommand( "testSave",				Cmd_TestSave_f,				CMD_FL_GAME|CMD_FL_CHEAT,	"writes out a test savegame" );
+	cmdSystem->AddCommand( "testClipBatch",			Cmd_TestClipBatch_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"compares batched traces with single traces" );
+	cmdSystem->AddCommand( "testClipTree",			Cmd_TestClipTree_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"compares the clip tree with the clip sectors on the current map" );
 	cmdSystem->AddCommand( "testModel",				idTestModel::TestModel_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"tests a model", idTestModel::ArgCompletion_TestModel );
 	cmdSystem->AddCommand( "testSkin",				idTestModel::TestSkin_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"tests a skin on an existing testModel", idCmdSystem::ArgCompletion_Decl<DECL_SKIN> );
 	cmdSystem->AddCommand( "testShaderParm",		idTestModel::TestShaderParm_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"sets a shaderParm on an existing testModel" );
@@ -119,6 +119,8 @@ idCVar g_showEnemies(				"g_showEnemies",			"0",			CVAR_GAME | CVAR_BOOL, "draws
 
 idCVar g_frametime(					"g_frametime",				"0",			CVAR_GAME | CVAR_BOOL, "displays timing information for each game frame" );
 idCVar g_timeentities(				"g_timeEntities",			"0",			CVAR_GAME | CVAR_FLOAT, "when non-zero, shows entities whose think functions exceeded the # of milliseconds specified" );
+idCVar g_parallelThink(				"g_parallelThink",			"0",			CVAR_GAME | CVAR_BOOL, "create the animator frames of visible animated entities on the job threads before the serial think" );
+idCVar g_parallelThinkCheck(		"g_parallelThinkCheck",		"0",			CVAR_GAME | CVAR_BOOL, "report entities that moved during the parallel think and entities whose prebuilt animator frame differs from a rebuilt one after the serial think" );
 
 idCVar g_debugShockwave(			"g_debugShockwave",			"0",			CVAR_GAME | CVAR_BOOL, "Debug the shockwave" );
 
@@ -229,6 +231,8 @@ idCVar rb_showInertia(				"rb_showInertia",			"0",			CVAR_GAME | CVAR_BOOL, "sho
 idCVar rb_showVelocity(				"rb_showVelocity",			"0",			CVAR_GAME | CVAR_BOOL, "show the velocity of each rigid body" );
 idCVar rb_showActive(				"rb_showActive",			"0",			CVAR_GAME | CVAR_BOOL, "show rigid bodies that are not at rest" );
 
+idCVar g_clipTree(					"g_clipTree",				"0",			CVAR_GAME | CVAR_BOOL, "link clip models into a dynamic bounds tree instead of clip sectors, takes effect at map load" );
+
 // The default values for player movement cvars are set in def/player.def
 idCVar pm_jumpheight(				"pm_jumpheight",			"48",			CVAR_GAME | CVAR_NETWORKSYNC | CVAR_FLOAT, "approximate hieght the player can jump" );
 idCVar pm_stepsize(					"pm_stepsize",				"16",			CVAR_GAME | CVAR_NETWORKSYNC | CVAR_FLOAT, "maximum height the player can step up without jumping" );
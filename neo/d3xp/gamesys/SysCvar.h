@@ -79,6 +79,8 @@ extern idCVar	g_showEnemies;
 
 extern idCVar	g_frametime;
 extern idCVar	g_timeentities;
+extern idCVar	g_parallelThink;
+extern idCVar	g_parallelThinkCheck;
 
 extern idCVar	ai_debugScript;
 extern idCVar	ai_debugMove;
@@ -158,6 +160,8 @@ extern idCVar	rb_showInertia;
 extern idCVar	rb_showVelocity;
 extern idCVar	rb_showActive;
 
+extern idCVar	g_clipTree;
+
 extern idCVar	pm_jumpheight;
 extern idCVar	pm_stepsize;
 extern idCVar	pm_crouchspeed;
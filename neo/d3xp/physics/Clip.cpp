@@ -359,6 +359,9 @@ void idClipModel::Init() {
 	traceModelIndex = -1;
 	clipLinks = NULL;
 	touchCount = -1;
+	clipTree = NULL;
+	clipTreeProxy = -1;
+	clipTreeLinked = false;
 }
 
 /*
@@ -435,6 +438,9 @@ idClipModel::idClipModel( const idClipModel *model ) {
 	renderModelHandle = model->renderModelHandle;
 	clipLinks = NULL;
 	touchCount = -1;
+	clipTree = NULL;
+	clipTreeProxy = -1;
+	clipTreeLinked = false;
 }
 
 /*
@@ -445,6 +451,7 @@ idClipModel::~idClipModel
 idClipModel::~idClipModel() {
 	// make sure the clip model is no longer linked
 	Unlink();
+	FreeClipTreeProxy();
 	if ( traceModelIndex != -1 ) {
 		FreeTraceModel( traceModelIndex );
 	}
@@ -473,7 +480,7 @@ void idClipModel::Save( idSaveGame *savefile ) const {
 	}
 	savefile->WriteInt( traceModelIndex );
 	savefile->WriteInt( renderModelHandle );
-	savefile->WriteBool( clipLinks != NULL );
+	savefile->WriteBool( IsLinked() );
 	savefile->WriteInt( touchCount );
 }
 
@@ -527,7 +534,7 @@ idClipModel::SetPosition
 ================
 */
 void idClipModel::SetPosition( const idVec3 &newOrigin, const idMat3 &newAxis ) {
-	if ( clipLinks ) {
+	if ( IsLinked() ) {
 		Unlink();	// unlink from old position
 	}
 	origin = newOrigin;
@@ -576,6 +583,9 @@ idClipModel::Unlink
 void idClipModel::Unlink() {
 	clipLink_t *link;
 
+	// the clip tree proxy stays in the tree so the clip model can be relinked cheaply
+	clipTreeLinked = false;
+
 	for ( link = clipLinks; link; link = clipLinks ) {
 		clipLinks = link->nextLink;
 		if ( link->prevInSector ) {
@@ -590,6 +600,20 @@ void idClipModel::Unlink() {
 	}
 }
 
+/*
+===============
+idClipModel::FreeClipTreeProxy
+===============
+*/
+void idClipModel::FreeClipTreeProxy() {
+	if ( clipTree != NULL ) {
+		clipTree->DestroyProxy( clipTreeProxy );
+		clipTree = NULL;
+		clipTreeProxy = -1;
+	}
+	clipTreeLinked = false;
+}
+
 /*
 ===============
 idClipModel::Link_r
@@ -634,7 +658,7 @@ void idClipModel::Link( idClip &clp ) {
 		return;
 	}
 
-	if ( clipLinks ) {
+	if ( IsLinked() ) {
 		Unlink();	// unlink from old position
 	}
 
@@ -657,7 +681,18 @@ void idClipModel::Link( idClip &clp ) {
 	absBounds[0] -= vec3_boxEpsilon;
 	absBounds[1] += vec3_boxEpsilon;
 
-	Link_r( clp.clipSectors );
+	if ( clp.clipTree != NULL ) {
+		if ( clipTree != clp.clipTree ) {
+			FreeClipTreeProxy();
+			clipTree = clp.clipTree;
+			clipTreeProxy = clipTree->CreateProxy( this, absBounds );
+		} else {
+			clipTree->MoveProxy( clipTreeProxy, absBounds );
+		}
+		clipTreeLinked = true;
+	} else {
+		Link_r( clp.clipSectors );
+	}
 }
 
 /*
@@ -707,6 +742,7 @@ idClip::idClip
 idClip::idClip() {
 	numClipSectors = 0;
 	clipSectors = NULL;
+	clipTree = NULL;
 	worldBounds.Zero();
 	numRotations = numTranslations = numMotions = numRenderModelTraces = numContents = numContacts = 0;
 }
@@ -781,6 +817,10 @@ void idClip::Init() {
 	// create world sectors
 	CreateClipSectors_r( 0, worldBounds, maxSector );
 
+	if ( g_clipTree.GetBool() ) {
+		clipTree = new (TAG_PHYSICS_CLIP) idClipTree;
+	}
+
 	size = worldBounds[1] - worldBounds[0];
 	gameLocal.Printf( "map bounds are (%1.1f, %1.1f, %1.1f)\n", size[0], size[1], size[2] );
 	gameLocal.Printf( "max clip sector is (%1.1f, %1.1f, %1.1f)\n", maxSector[0], maxSector[1], maxSector[2] );
@@ -801,6 +841,9 @@ void idClip::Shutdown() {
 	delete[] clipSectors;
 	clipSectors = NULL;
 
+	delete clipTree;
+	clipTree = NULL;
+
 	// free the trace model used for the temporaryClipModel
 	if ( temporaryClipModel.traceModelIndex != -1 ) {
 		idClipModel::FreeTraceModel( temporaryClipModel.traceModelIndex );
@@ -904,12 +947,71 @@ int idClip::ClipModelsTouchingBounds( const idBounds &bounds, int contentMask, i
 	parms.count = 0;
 	parms.maxCount = maxCount;
 
+	if ( clipTree != NULL ) {
+		return clipTree->ClipModelsTouchingBounds( parms.bounds, contentMask, clipModelList, maxCount );
+	}
+
 	touchCount++;
 	ClipModelsTouchingBounds_r( clipSectors, parms );
 
 	return parms.count;
 }
 
+/*
+================
+idClip::GetLinkedClipModels
+================
+*/
+void idClip::GetLinkedClipModels( idList<idClipModel *> &clipModelList ) const {
+	if ( clipTree != NULL ) {
+		clipTree->GetLinkedClipModels( clipModelList );
+		return;
+	}
+
+	// clip models can be linked into multiple sectors
+	touchCount++;
+	for ( int i = 0; i < numClipSectors; i++ ) {
+		for ( clipLink_t *link = clipSectors[i].clipLinks; link; link = link->nextInSector ) {
+			idClipModel *check = link->clipModel;
+			if ( check->touchCount == touchCount ) {
+				continue;
+			}
+			check->touchCount = touchCount;
+			clipModelList.Append( check );
+		}
+	}
+}
+
+/*
+================
+idClip::SetClipTree
+================
+*/
+void idClip::SetClipTree( bool enable ) {
+	idList<idClipModel *> clipModelList;
+
+	if ( enable == ( clipTree != NULL ) ) {
+		return;
+	}
+
+	GetLinkedClipModels( clipModelList );
+
+	if ( enable ) {
+		for ( int i = 0; i < clipModelList.Num(); i++ ) {
+			clipModelList[i]->Unlink();
+		}
+		clipTree = new (TAG_PHYSICS_CLIP) idClipTree;
+	} else {
+		// also removes the proxies of clip models that are not linked
+		delete clipTree;
+		clipTree = NULL;
+	}
+
+	for ( int i = 0; i < clipModelList.Num(); i++ ) {
+		clipModelList[i]->Link( *this );
+	}
+}
+
 /*
 ================
 idClip::EntitiesTouchingBounds
@@ -953,14 +1055,29 @@ idClip::GetTraceClipModels
 ====================
 */
 int idClip::GetTraceClipModels( const idBounds &bounds, int contentMask, const idEntity *passEntity, idClipModel **clipModelList ) const {
-	int i, num;
-	idClipModel	*cm;
-	idEntity *passOwner;
+	int num;
 
 	num = ClipModelsTouchingBounds( bounds, contentMask, clipModelList, MAX_GENTITIES );
 
+	RemovePassEntityClipModels( passEntity, clipModelList, num );
+
+	return num;
+}
+
+/*
+====================
+idClip::RemovePassEntityClipModels
+
+  sets the clip models GetTraceClipModels excludes to NULL
+====================
+*/
+void idClip::RemovePassEntityClipModels( const idEntity *passEntity, idClipModel **clipModelList, const int num ) const {
+	int i;
+	idClipModel	*cm;
+	idEntity *passOwner;
+
 	if ( !passEntity ) {
-		return num;
+		return;
 	}
 
 	if ( passEntity->GetPhysics()->GetNumClipModels() > 0 ) {
@@ -986,8 +1103,6 @@ int idClip::GetTraceClipModels( const idBounds &bounds, int contentMask, const i
 			}
 		}
 	}
-
-	return num;
 }
 
 /*
@@ -1207,6 +1322,335 @@ bool idClip::Translation( trace_t &results, const idVec3 &start, const idVec3 &e
 	return ( results.fraction < 1.0f );
 }
 
+/*
+===============================================================
+
+	idClip batched translations
+
+===============================================================
+*/
+
+#define CLIP_BATCH_SIZE				16			// max traces that share one walk through the clip sectors
+#define CLIP_BATCH_MAX_EXTENT		1024.0f		// max size of the bounds around all traces in a batch
+
+typedef struct clipBatchTrace_s {
+	idBounds				bounds;		// trace bounds
+	const idTraceModel *	trm;
+	float					radius;
+	unsigned int			sortKey;	// morton code of the trace bounds center
+	int						index;		// index into the traces passed to TranslationBatch
+} clipBatchTrace_t;
+
+class idSort_ClipBatchTrace : public idSort_Quick< clipBatchTrace_t, idSort_ClipBatchTrace > {
+public:
+	int Compare( const clipBatchTrace_t & a, const clipBatchTrace_t & b ) const {
+		if ( a.sortKey < b.sortKey ) {
+			return -1;
+		}
+		if ( a.sortKey > b.sortKey ) {
+			return 1;
+		}
+		return a.index - b.index;
+	}
+};
+
+// structure of arrays with the absolute bounds and contents of all clip models touching a batch
+typedef struct clipBatchModels_s {
+	ALIGN16( float			minX[MAX_GENTITIES] );
+	ALIGN16( float			minY[MAX_GENTITIES] );
+	ALIGN16( float			minZ[MAX_GENTITIES] );
+	ALIGN16( float			maxX[MAX_GENTITIES] );
+	ALIGN16( float			maxY[MAX_GENTITIES] );
+	ALIGN16( float			maxZ[MAX_GENTITIES] );
+	ALIGN16( int			contents[MAX_GENTITIES] );
+	idClipModel *			clipModels[MAX_GENTITIES];
+	int						numClipModels;		// padded to a multiple of 4
+} clipBatchModels_t;
+
+static clipBatchModels_t	clipBatchModels;
+
+/*
+============
+ClipBatch_SpreadBits
+
+  spreads the lower 10 bits of x so there are two zero bits between each bit
+============
+*/
+static unsigned int ClipBatch_SpreadBits( unsigned int x ) {
+	x &= 0x3FF;
+	x = ( x | ( x << 16 ) ) & 0x030000FF;
+	x = ( x | ( x <<  8 ) ) & 0x0300F00F;
+	x = ( x | ( x <<  4 ) ) & 0x030C30C3;
+	x = ( x | ( x <<  2 ) ) & 0x09249249;
+	return x;
+}
+
+/*
+============
+ClipBatch_SortKey
+============
+*/
+static unsigned int ClipBatch_SortKey( const idBounds &bounds, const idBounds &worldBounds, const idVec3 &worldScale ) {
+	const idVec3 center = bounds.GetCenter();
+	unsigned int key = 0;
+	for ( int i = 0; i < 3; i++ ) {
+		const int cell = idMath::Ftoi( idMath::ClampFloat( 0.0f, 1023.0f, ( center[i] - worldBounds[0][i] ) * worldScale[i] ) );
+		key |= ClipBatch_SpreadBits( cell ) << i;
+	}
+	return key;
+}
+
+/*
+============
+ClipBatch_GatherModels
+
+  copies the clip models into the structure of arrays, the list is padded with empty entries that never touch anything
+============
+*/
+static void ClipBatch_GatherModels( clipBatchModels_t &models, idClipModel **clipModelList, const int num ) {
+	for ( int i = 0; i < num; i++ ) {
+		const idClipModel *cm = clipModelList[i];
+		const idBounds &absBounds = cm->GetAbsBounds();
+		models.minX[i] = absBounds[0].x;
+		models.minY[i] = absBounds[0].y;
+		models.minZ[i] = absBounds[0].z;
+		models.maxX[i] = absBounds[1].x;
+		models.maxY[i] = absBounds[1].y;
+		models.maxZ[i] = absBounds[1].z;
+		models.contents[i] = cm->GetContents();
+		models.clipModels[i] = clipModelList[i];
+	}
+	models.numClipModels = ( num + 3 ) & ~3;
+	for ( int i = num; i < models.numClipModels; i++ ) {
+		models.minX[i] = models.minY[i] = models.minZ[i] = idMath::INFINITY;
+		models.maxX[i] = models.maxY[i] = models.maxZ[i] = -idMath::INFINITY;
+		models.contents[i] = 0;
+		models.clipModels[i] = NULL;
+	}
+}
+
+/*
+============
+ClipBatch_ModelsTouchingBounds
+
+  same tests as idClip::ClipModelsTouchingBounds_r on four clip models at a time, keeps the order of the gathered clip models
+============
+*/
+static int ClipBatch_ModelsTouchingBounds( const clipBatchModels_t &models, const idBounds &bounds, const int contentMask, idClipModel **clipModelList ) {
+	const idVec3 boundsMin = bounds[0] - vec3_boxEpsilon;
+	const idVec3 boundsMax = bounds[1] + vec3_boxEpsilon;
+	int num = 0;
+
+#ifdef ID_WIN_X86_SSE2_INTRIN
+
+	const __m128 vector_min_x = _mm_set1_ps( boundsMin.x );
+	const __m128 vector_min_y = _mm_set1_ps( boundsMin.y );
+	const __m128 vector_min_z = _mm_set1_ps( boundsMin.z );
+	const __m128 vector_max_x = _mm_set1_ps( boundsMax.x );
+	const __m128 vector_max_y = _mm_set1_ps( boundsMax.y );
+	const __m128 vector_max_z = _mm_set1_ps( boundsMax.z );
+	const __m128i vector_content_mask = _mm_set1_epi32( contentMask );
+	const __m128i vector_int_zero = _mm_setzero_si128();
+
+	for ( int i = 0; i < models.numClipModels; i += 4 ) {
+		__m128 outside = _mm_cmpgt_ps( _mm_load_ps( models.minX + i ), vector_max_x );
+		outside = _mm_or_ps( outside, _mm_cmplt_ps( _mm_load_ps( models.maxX + i ), vector_min_x ) );
+		outside = _mm_or_ps( outside, _mm_cmpgt_ps( _mm_load_ps( models.minY + i ), vector_max_y ) );
+		outside = _mm_or_ps( outside, _mm_cmplt_ps( _mm_load_ps( models.maxY + i ), vector_min_y ) );
+		outside = _mm_or_ps( outside, _mm_cmpgt_ps( _mm_load_ps( models.minZ + i ), vector_max_z ) );
+		outside = _mm_or_ps( outside, _mm_cmplt_ps( _mm_load_ps( models.maxZ + i ), vector_min_z ) );
+
+		const __m128i contents = _mm_and_si128( _mm_load_si128( (const __m128i *)( models.contents + i ) ), vector_content_mask );
+		outside = _mm_or_ps( outside, _mm_castsi128_ps( _mm_cmpeq_epi32( contents, vector_int_zero ) ) );
+
+		const int touching = _mm_movemask_ps( outside ) ^ 15;
+		if ( touching == 0 ) {
+			continue;
+		}
+		for ( int j = 0; j < 4; j++ ) {
+			if ( touching & ( 1 << j ) ) {
+				clipModelList[num++] = models.clipModels[i + j];
+			}
+		}
+	}
+
+#else
+
+	for ( int i = 0; i < models.numClipModels; i++ ) {
+		if ( !( models.contents[i] & contentMask ) ) {
+			continue;
+		}
+		if (	models.minX[i] > boundsMax.x ||
+				models.maxX[i] < boundsMin.x ||
+				models.minY[i] > boundsMax.y ||
+				models.maxY[i] < boundsMin.y ||
+				models.minZ[i] > boundsMax.z ||
+				models.maxZ[i] < boundsMin.z ) {
+			continue;
+		}
+		clipModelList[num++] = models.clipModels[i];
+	}
+
+#endif
+
+	return num;
+}
+
+/*
+============
+idClip::TranslationBatchEntities
+
+  clips a trace that already went through the world against the given clip models
+============
+*/
+void idClip::TranslationBatchEntities( clipTrace_t &query, const idTraceModel *trm, const float radius, idClipModel **clipModelList, const int num ) {
+	trace_t trace;
+
+	for ( int i = 0; i < num; i++ ) {
+		idClipModel *touch = clipModelList[i];
+
+		if ( !touch ) {
+			continue;
+		}
+
+		if ( touch->renderModelHandle != -1 ) {
+			idClip::numRenderModelTraces++;
+			TraceRenderModel( trace, query.start, query.end, radius, query.trmAxis, touch );
+		} else {
+			idClip::numTranslations++;
+			collisionModelManager->Translation( &trace, query.start, query.end, trm, query.trmAxis, query.contentMask,
+									touch->Handle(), touch->origin, touch->axis );
+		}
+
+		if ( trace.fraction < query.results.fraction ) {
+			query.results = trace;
+			query.results.c.entityNum = touch->entity->entityNumber;
+			query.results.c.id = touch->id;
+			if ( query.results.fraction == 0.0f ) {
+				break;
+			}
+		}
+	}
+}
+
+/*
+============
+idClip::TranslationBatch
+
+  Traces are sorted along a morton curve through the world bounds and grouped with nearby traces.
+  The clip sectors are walked once for the bounds around each group and the clip models found
+  are tested against the bounds of every trace in the group four at a time.
+============
+*/
+int idClip::TranslationBatch( clipTrace_t *traces, const int numTraces ) {
+	idClipModel *clipModelList[MAX_GENTITIES];
+	int numHits = 0;
+
+	if ( numTraces <= 0 ) {
+		return 0;
+	}
+
+	idTempArray< clipBatchTrace_t > batchTraces( numTraces );
+	int numBatchTraces = 0;
+
+	idVec3 worldScale;
+	for ( int i = 0; i < 3; i++ ) {
+		const float size = worldBounds[1][i] - worldBounds[0][i];
+		worldScale[i] = ( size > 0.0f ) ? ( 1023.0f / size ) : 0.0f;
+	}
+
+	// test all traces against the world first
+	for ( int i = 0; i < numTraces; i++ ) {
+		clipTrace_t &query = traces[i];
+
+		if ( TestHugeTranslation( query.results, query.mdl, query.start, query.end, query.trmAxis ) ) {
+			numHits++;
+			continue;
+		}
+
+		const idTraceModel *trm = TraceModelForClipModel( query.mdl );
+
+		if ( !query.passEntity || query.passEntity->entityNumber != ENTITYNUM_WORLD ) {
+			// test world
+			idClip::numTranslations++;
+			collisionModelManager->Translation( &query.results, query.start, query.end, trm, query.trmAxis, query.contentMask, 0, vec3_origin, mat3_default );
+			query.results.c.entityNum = query.results.fraction != 1.0f ? ENTITYNUM_WORLD : ENTITYNUM_NONE;
+			if ( query.results.fraction == 0.0f ) {
+				numHits++;
+				continue;		// blocked immediately by the world
+			}
+		} else {
+			memset( &query.results, 0, sizeof( query.results ) );
+			query.results.fraction = 1.0f;
+			query.results.endpos = query.end;
+			query.results.endAxis = query.trmAxis;
+		}
+
+		clipBatchTrace_t &batchTrace = batchTraces[numBatchTraces++];
+		if ( !trm ) {
+			batchTrace.bounds.FromPointTranslation( query.start, query.results.endpos - query.start );
+			batchTrace.radius = 0.0f;
+		} else {
+			batchTrace.bounds.FromBoundsTranslation( trm->bounds, query.start, query.trmAxis, query.results.endpos - query.start );
+			batchTrace.radius = trm->bounds.GetRadius();
+		}
+		batchTrace.trm = trm;
+		batchTrace.sortKey = ClipBatch_SortKey( batchTrace.bounds, worldBounds, worldScale );
+		batchTrace.index = i;
+	}
+
+	idSort_ClipBatchTrace().Sort( batchTraces.Ptr(), numBatchTraces );
+
+	// clip groups of nearby traces against the entities
+	for ( int first = 0; first < numBatchTraces; ) {
+		idBounds batchBounds = batchTraces[first].bounds;
+		int batchContentMask = traces[batchTraces[first].index].contentMask;
+		int last;
+
+		for ( last = first + 1; last < numBatchTraces && last - first < CLIP_BATCH_SIZE; last++ ) {
+			const idBounds grownBounds = batchBounds + batchTraces[last].bounds;
+			const idVec3 size = grownBounds[1] - grownBounds[0];
+			if ( size.x > CLIP_BATCH_MAX_EXTENT || size.y > CLIP_BATCH_MAX_EXTENT || size.z > CLIP_BATCH_MAX_EXTENT ) {
+				break;
+			}
+			batchBounds = grownBounds;
+			batchContentMask |= traces[batchTraces[last].index].contentMask;
+		}
+
+		const int numGathered = ClipModelsTouchingBounds( batchBounds, batchContentMask, clipModelList, MAX_GENTITIES );
+
+		if ( numGathered >= MAX_GENTITIES ) {
+			// the list may be incomplete so gather the clip models for each trace
+			for ( int i = first; i < last; i++ ) {
+				const clipBatchTrace_t &batchTrace = batchTraces[i];
+				clipTrace_t &query = traces[batchTrace.index];
+				const int num = GetTraceClipModels( batchTrace.bounds, query.contentMask, query.passEntity, clipModelList );
+				TranslationBatchEntities( query, batchTrace.trm, batchTrace.radius, clipModelList, num );
+			}
+		} else {
+			ClipBatch_GatherModels( clipBatchModels, clipModelList, numGathered );
+
+			for ( int i = first; i < last; i++ ) {
+				const clipBatchTrace_t &batchTrace = batchTraces[i];
+				clipTrace_t &query = traces[batchTrace.index];
+				const int num = ClipBatch_ModelsTouchingBounds( clipBatchModels, batchTrace.bounds, query.contentMask, clipModelList );
+				RemovePassEntityClipModels( query.passEntity, clipModelList, num );
+				TranslationBatchEntities( query, batchTrace.trm, batchTrace.radius, clipModelList, num );
+			}
+		}
+
+		for ( int i = first; i < last; i++ ) {
+			if ( traces[batchTraces[i].index].results.fraction < 1.0f ) {
+				numHits++;
+			}
+		}
+
+		first = last;
+	}
+
+	return numHits;
+}
+
 /*
 ============
 idClip::Rotation
@@ -1694,6 +2138,19 @@ void idClip::PrintStatistics() {
 	numRotations = numTranslations = numMotions = numRenderModelTraces = numContents = numContacts = 0;
 }
 
+/*
+============
+idClip::PrintClipTreeStatistics
+============
+*/
+void idClip::PrintClipTreeStatistics() const {
+	if ( clipTree == NULL ) {
+		gameLocal.Printf( "clip sectors: %d sectors\n", numClipSectors );
+		return;
+	}
+	gameLocal.Printf( "clip tree: %d proxies, %d nodes, height %d\n", clipTree->GetNumProxies(), clipTree->GetNumNodes(), clipTree->GetHeight() );
+}
+
 /*
 ============
 idClip::DrawClipModels
@@ -53,6 +53,7 @@ class idEntity;
 class idClipModel {
 
 	friend class idClip;
+	friend class idClipTree;
 
 public:
 							idClipModel();
@@ -125,9 +126,13 @@ private:
 
 	struct clipLink_s *		clipLinks;				// links into sectors
 	int						touchCount;
+	class idClipTree *		clipTree;				// clip tree the proxy belongs to
+	int						clipTreeProxy;			// leaf in the clip tree, kept while unlinked so relinking inside the fat bounds is cheap
+	bool					clipTreeLinked;
 
 	void					Init();			// initialize
 	void					Link_r( struct clipSector_s *node );
+	void					FreeClipTreeProxy();
 
 	static int				AllocTraceModel( const idTraceModel &trm, bool persistantThroughSaves = true );
 	static void				FreeTraceModel( int traceModelIndex );
@@ -221,7 +226,7 @@ ID_INLINE bool idClipModel::IsTraceModel() const {
 }
 
 ID_INLINE bool idClipModel::IsLinked() const {
-	return ( clipLinks != NULL );
+	return ( clipLinks != NULL || clipTreeLinked );
 }
 
 ID_INLINE bool idClipModel::IsEnabled() const {
@@ -246,6 +251,17 @@ ID_INLINE const idTraceModel *idClipModel::GetTraceModel() const {
 //
 //===============================================================
 
+// a single translation query for idClip::TranslationBatch
+typedef struct clipTrace_s {
+	idVec3					start;
+	idVec3					end;
+	const idClipModel *		mdl;
+	idMat3					trmAxis;
+	int						contentMask;
+	const idEntity *		passEntity;
+	trace_t					results;
+} clipTrace_t;
+
 class idClip {
 
 	friend class idClipModel;
@@ -268,6 +284,10 @@ public:
 	int						Contents( const idVec3 &start,
 								const idClipModel *mdl, const idMat3 &trmAxis, int contentMask, const idEntity *passEntity );
 
+	// clip a batch of translations versus the rest of the world, returns the number of traces that hit something
+	// the results are the same as calling Translation for each trace but clip sectors are walked once per group of nearby traces
+	int						TranslationBatch( clipTrace_t *traces, const int numTraces );
+
 	// special case translations versus the rest of the world
 	bool					TracePoint( trace_t &results, const idVec3 &start, const idVec3 &end,
 								int contentMask, const idEntity *passEntity );
@@ -302,6 +322,12 @@ public:
 	const idBounds &		GetWorldBounds() const;
 	idClipModel *			DefaultClipModel();
 
+							// switch between the clip sectors and the clip tree by relinking all clip models
+	void					SetClipTree( bool enable );
+	bool					UsingClipTree() const;
+	void					GetLinkedClipModels( idList<idClipModel *> &clipModelList ) const;
+	void					PrintClipTreeStatistics() const;
+
 							// stats and debug drawing
 	void					PrintStatistics();
 	void					DrawClipModels( const idVec3 &eye, const float radius, const idEntity *passEntity );
@@ -310,6 +336,7 @@ public:
 private:
 	int						numClipSectors;
 	struct clipSector_s *	clipSectors;
+	class idClipTree *		clipTree;				// used instead of the clip sectors when not NULL
 	idBounds				worldBounds;
 	idClipModel				temporaryClipModel;
 	idClipModel				defaultClipModel;
@@ -327,6 +354,8 @@ private:
 	void					ClipModelsTouchingBounds_r( const struct clipSector_s *node, struct listParms_s &parms ) const;
 	const idTraceModel *	TraceModelForClipModel( const idClipModel *mdl ) const;
 	int						GetTraceClipModels( const idBounds &bounds, int contentMask, const idEntity *passEntity, idClipModel **clipModelList ) const;
+	void					RemovePassEntityClipModels( const idEntity *passEntity, idClipModel **clipModelList, const int num ) const;
+	void					TranslationBatchEntities( clipTrace_t &trace, const idTraceModel *trm, const float radius, idClipModel **clipModelList, const int num );
 	void					TraceRenderModel( trace_t &trace, const idVec3 &start, const idVec3 &end, const float radius, const idMat3 &axis, idClipModel *touch ) const;
 };
 
@@ -350,4 +379,8 @@ ID_INLINE idClipModel *idClip::DefaultClipModel() {
 	return &defaultClipModel;
 }
 
+ID_INLINE bool idClip::UsingClipTree() const {
+	return ( clipTree != NULL );
+}
+
 #endif /* !__CLIP_H__ */
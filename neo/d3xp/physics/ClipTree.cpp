@@ -0,0 +1,499 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").  
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#pragma hdrstop
+#include "../../idlib/precompiled.h"
+
+
+#include "../Game_local.h"
+
+#define CLIP_TREE_MAX_STACK			256
+
+/*
+================
+ClipTree_SurfaceArea
+================
+*/
+static float ClipTree_SurfaceArea( const idBounds &bounds ) {
+	const idVec3 size = bounds[1] - bounds[0];
+	return 2.0f * ( size.x * size.y + size.y * size.z + size.z * size.x );
+}
+
+/*
+================
+ClipTree_ContainsBounds
+================
+*/
+static bool ClipTree_ContainsBounds( const idBounds &outer, const idBounds &inner ) {
+	return	outer[0].x <= inner[0].x && outer[0].y <= inner[0].y && outer[0].z <= inner[0].z &&
+			outer[1].x >= inner[1].x && outer[1].y >= inner[1].y && outer[1].z >= inner[1].z;
+}
+
+/*
+================
+idClipTree::idClipTree
+================
+*/
+idClipTree::idClipTree() {
+	root = -1;
+	freeList = -1;
+	numProxies = 0;
+}
+
+/*
+================
+idClipTree::~idClipTree
+================
+*/
+idClipTree::~idClipTree() {
+	Clear();
+}
+
+/*
+================
+idClipTree::Clear
+================
+*/
+void idClipTree::Clear() {
+	for ( int i = 0; i < nodes.Num(); i++ ) {
+		idClipModel *clipModel = nodes[i].clipModel;
+		if ( nodes[i].height == 0 && clipModel != NULL ) {
+			clipModel->clipTree = NULL;
+			clipModel->clipTreeProxy = -1;
+			clipModel->clipTreeLinked = false;
+		}
+	}
+	nodes.Clear();
+	root = -1;
+	freeList = -1;
+	numProxies = 0;
+}
+
+/*
+================
+idClipTree::AllocNode
+================
+*/
+int idClipTree::AllocNode() {
+	if ( freeList == -1 ) {
+		const int oldNum = nodes.Num();
+		const int newNum = ( oldNum > 0 ) ? oldNum * 2 : 64;
+		nodes.SetNum( newNum );
+		for ( int i = newNum - 1; i >= oldNum; i-- ) {
+			nodes[i].clipModel = NULL;
+			nodes[i].parent = freeList;
+			nodes[i].height = -1;
+			freeList = i;
+		}
+	}
+
+	const int nodeNum = freeList;
+	clipTreeNode_t &node = nodes[nodeNum];
+	freeList = node.parent;
+	node.clipModel = NULL;
+	node.parent = -1;
+	node.children[0] = -1;
+	node.children[1] = -1;
+	node.height = 0;
+	return nodeNum;
+}
+
+/*
+================
+idClipTree::FreeNode
+================
+*/
+void idClipTree::FreeNode( int nodeNum ) {
+	clipTreeNode_t &node = nodes[nodeNum];
+	node.clipModel = NULL;
+	node.parent = freeList;
+	node.height = -1;
+	freeList = nodeNum;
+}
+
+/*
+================
+idClipTree::CreateProxy
+================
+*/
+int idClipTree::CreateProxy( idClipModel *clipModel, const idBounds &absBounds ) {
+	const int leaf = AllocNode();
+	nodes[leaf].bounds = absBounds.Expand( CLIP_TREE_FAT_MARGIN );
+	nodes[leaf].clipModel = clipModel;
+	InsertLeaf( leaf );
+	numProxies++;
+	return leaf;
+}
+
+/*
+================
+idClipTree::DestroyProxy
+================
+*/
+void idClipTree::DestroyProxy( int proxy ) {
+	assert( nodes[proxy].height == 0 );
+	RemoveLeaf( proxy );
+	FreeNode( proxy );
+	numProxies--;
+}
+
+/*
+================
+idClipTree::MoveProxy
+================
+*/
+bool idClipTree::MoveProxy( int proxy, const idBounds &absBounds ) {
+	const idBounds &fatBounds = nodes[proxy].bounds;
+
+	// keep the leaf where it is as long as the clip model stays inside the fat bounds
+	// and the fat bounds did not become a lot larger than the clip model
+	if ( ClipTree_ContainsBounds( fatBounds, absBounds ) ) {
+		const idVec3 fatSize = fatBounds[1] - fatBounds[0];
+		const idVec3 maxSize = absBounds[1] - absBounds[0] + idVec3( 4.0f * CLIP_TREE_FAT_MARGIN, 4.0f * CLIP_TREE_FAT_MARGIN, 4.0f * CLIP_TREE_FAT_MARGIN );
+		if ( fatSize.x <= maxSize.x && fatSize.y <= maxSize.y && fatSize.z <= maxSize.z ) {
+			return false;
+		}
+	}
+
+	RemoveLeaf( proxy );
+	nodes[proxy].bounds = absBounds.Expand( CLIP_TREE_FAT_MARGIN );
+	InsertLeaf( proxy );
+	return true;
+}
+
+/*
+================
+idClipTree::InsertLeaf
+
+  walks down the tree to the sibling that gives the smallest increase in surface area
+================
+*/
+void idClipTree::InsertLeaf( int leaf ) {
+	if ( root == -1 ) {
+		root = leaf;
+		nodes[leaf].parent = -1;
+		return;
+	}
+
+	const idBounds leafBounds = nodes[leaf].bounds;
+	int index = root;
+	while ( nodes[index].height > 0 ) {
+		const clipTreeNode_t &node = nodes[index];
+		const float area = ClipTree_SurfaceArea( node.bounds );
+		const float combinedArea = ClipTree_SurfaceArea( node.bounds + leafBounds );
+
+		// cost of creating a new parent for this node and the new leaf
+		const float cost = 2.0f * combinedArea;
+		// minimum cost of pushing the leaf further down the tree
+		const float inheritanceCost = 2.0f * ( combinedArea - area );
+
+		float childCost[2];
+		for ( int i = 0; i < 2; i++ ) {
+			const clipTreeNode_t &child = nodes[node.children[i]];
+			childCost[i] = ClipTree_SurfaceArea( child.bounds + leafBounds ) + inheritanceCost;
+			if ( child.height > 0 ) {
+				childCost[i] -= ClipTree_SurfaceArea( child.bounds );
+			}
+		}
+
+		if ( cost < childCost[0] && cost < childCost[1] ) {
+			break;
+		}
+
+		index = ( childCost[0] < childCost[1] ) ? node.children[0] : node.children[1];
+	}
+
+	const int sibling = index;
+	const int oldParent = nodes[sibling].parent;
+	const int newParent = AllocNode();
+	clipTreeNode_t &parent = nodes[newParent];
+	parent.parent = oldParent;
+	parent.bounds = leafBounds + nodes[sibling].bounds;
+	parent.height = nodes[sibling].height + 1;
+	parent.children[0] = sibling;
+	parent.children[1] = leaf;
+
+	if ( oldParent != -1 ) {
+		if ( nodes[oldParent].children[0] == sibling ) {
+			nodes[oldParent].children[0] = newParent;
+		} else {
+			nodes[oldParent].children[1] = newParent;
+		}
+	} else {
+		root = newParent;
+	}
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	Refit( nodes[leaf].parent );
+}
+
+/*
+================
+idClipTree::RemoveLeaf
+================
+*/
+void idClipTree::RemoveLeaf( int leaf ) {
+	if ( leaf == root ) {
+		root = -1;
+		return;
+	}
+
+	const int parent = nodes[leaf].parent;
+	const int grandParent = nodes[parent].parent;
+	const int sibling = ( nodes[parent].children[0] == leaf ) ? nodes[parent].children[1] : nodes[parent].children[0];
+
+	if ( grandParent != -1 ) {
+		// connect the sibling to the grand parent and free the parent
+		if ( nodes[grandParent].children[0] == parent ) {
+			nodes[grandParent].children[0] = sibling;
+		} else {
+			nodes[grandParent].children[1] = sibling;
+		}
+		nodes[sibling].parent = grandParent;
+		FreeNode( parent );
+
+		Refit( grandParent );
+	} else {
+		root = sibling;
+		nodes[sibling].parent = -1;
+		FreeNode( parent );
+	}
+}
+
+/*
+================
+idClipTree::Refit
+
+  balances and recalculates the bounds and height of the given node and all its parents
+================
+*/
+void idClipTree::Refit( int nodeNum ) {
+	while ( nodeNum != -1 ) {
+		nodeNum = Balance( nodeNum );
+
+		clipTreeNode_t &node = nodes[nodeNum];
+		const clipTreeNode_t &child0 = nodes[node.children[0]];
+		const clipTreeNode_t &child1 = nodes[node.children[1]];
+		node.height = 1 + Max( child0.height, child1.height );
+		node.bounds = child0.bounds + child1.bounds;
+
+		nodeNum = node.parent;
+	}
+}
+
+/*
+================
+idClipTree::Balance
+
+  if one child of the node is more than one level higher than the other
+  the higher child is rotated up, returns the node now at the position of the given node
+================
+*/
+int idClipTree::Balance( int nodeNum ) {
+	const int iA = nodeNum;
+	clipTreeNode_t &A = nodes[iA];
+
+	if ( A.height < 2 ) {
+		return iA;
+	}
+
+	const int iB = A.children[0];
+	const int iC = A.children[1];
+	clipTreeNode_t &B = nodes[iB];
+	clipTreeNode_t &C = nodes[iC];
+
+	const int balance = C.height - B.height;
+
+	if ( balance > 1 ) {
+		// rotate C up
+		const int iF = C.children[0];
+		const int iG = C.children[1];
+		clipTreeNode_t &F = nodes[iF];
+		clipTreeNode_t &G = nodes[iG];
+
+		C.children[0] = iA;
+		C.parent = A.parent;
+		A.parent = iC;
+
+		if ( C.parent != -1 ) {
+			if ( nodes[C.parent].children[0] == iA ) {
+				nodes[C.parent].children[0] = iC;
+			} else {
+				nodes[C.parent].children[1] = iC;
+			}
+		} else {
+			root = iC;
+		}
+
+		if ( F.height > G.height ) {
+			C.children[1] = iF;
+			A.children[1] = iG;
+			G.parent = iA;
+			A.bounds = B.bounds + G.bounds;
+			C.bounds = A.bounds + F.bounds;
+			A.height = 1 + Max( B.height, G.height );
+			C.height = 1 + Max( A.height, F.height );
+		} else {
+			C.children[1] = iG;
+			A.children[1] = iF;
+			F.parent = iA;
+			A.bounds = B.bounds + F.bounds;
+			C.bounds = A.bounds + G.bounds;
+			A.height = 1 + Max( B.height, F.height );
+			C.height = 1 + Max( A.height, G.height );
+		}
+		return iC;
+	}
+
+	if ( balance < -1 ) {
+		// rotate B up
+		const int iD = B.children[0];
+		const int iE = B.children[1];
+		clipTreeNode_t &D = nodes[iD];
+		clipTreeNode_t &E = nodes[iE];
+
+		B.children[0] = iA;
+		B.parent = A.parent;
+		A.parent = iB;
+
+		if ( B.parent != -1 ) {
+			if ( nodes[B.parent].children[0] == iA ) {
+				nodes[B.parent].children[0] = iB;
+			} else {
+				nodes[B.parent].children[1] = iB;
+			}
+		} else {
+			root = iB;
+		}
+
+		if ( D.height > E.height ) {
+			B.children[1] = iD;
+			A.children[0] = iE;
+			E.parent = iA;
+			A.bounds = C.bounds + E.bounds;
+			B.bounds = A.bounds + D.bounds;
+			A.height = 1 + Max( C.height, E.height );
+			B.height = 1 + Max( A.height, D.height );
+		} else {
+			B.children[1] = iE;
+			A.children[0] = iD;
+			D.parent = iA;
+			A.bounds = C.bounds + D.bounds;
+			B.bounds = A.bounds + E.bounds;
+			A.height = 1 + Max( C.height, D.height );
+			B.height = 1 + Max( A.height, E.height );
+		}
+		return iB;
+	}
+
+	return iA;
+}
+
+/*
+================
+idClipTree::ClipModelsTouchingBounds
+
+  the bounds are expected to already be expanded with the box epsilon
+================
+*/
+int idClipTree::ClipModelsTouchingBounds( const idBounds &bounds, int contentMask, idClipModel **clipModelList, int maxCount ) const {
+	int stack[CLIP_TREE_MAX_STACK];
+	int stackSize = 0;
+	int count = 0;
+
+	if ( root == -1 ) {
+		return 0;
+	}
+
+	stack[stackSize++] = root;
+	while ( stackSize > 0 ) {
+		const clipTreeNode_t &node = nodes[stack[--stackSize]];
+
+		if (	node.bounds[0][0] > bounds[1][0] ||
+				node.bounds[1][0] < bounds[0][0] ||
+				node.bounds[0][1] > bounds[1][1] ||
+				node.bounds[1][1] < bounds[0][1] ||
+				node.bounds[0][2] > bounds[1][2] ||
+				node.bounds[1][2] < bounds[0][2] ) {
+			continue;
+		}
+
+		if ( node.height > 0 ) {
+			assert( stackSize + 2 <= CLIP_TREE_MAX_STACK );
+			stack[stackSize++] = node.children[1];
+			stack[stackSize++] = node.children[0];
+			continue;
+		}
+
+		idClipModel *check = node.clipModel;
+
+		// if the clip model is linked and enabled
+		if ( !check->clipTreeLinked || !check->enabled ) {
+			continue;
+		}
+
+		// if the clip model does not have any contents we are looking for
+		if ( !( check->contents & contentMask ) ) {
+			continue;
+		}
+
+		// if the bounds really do overlap
+		if (	check->absBounds[0][0] > bounds[1][0] ||
+				check->absBounds[1][0] < bounds[0][0] ||
+				check->absBounds[0][1] > bounds[1][1] ||
+				check->absBounds[1][1] < bounds[0][1] ||
+				check->absBounds[0][2] > bounds[1][2] ||
+				check->absBounds[1][2] < bounds[0][2] ) {
+			continue;
+		}
+
+		if ( count >= maxCount ) {
+			gameLocal.Warning( "idClipTree::ClipModelsTouchingBounds: max count" );
+			return count;
+		}
+
+		clipModelList[count++] = check;
+	}
+
+	return count;
+}
+
+/*
+================
+idClipTree::GetLinkedClipModels
+================
+*/
+void idClipTree::GetLinkedClipModels( idList<idClipModel *> &clipModelList ) const {
+	for ( int i = 0; i < nodes.Num(); i++ ) {
+		const clipTreeNode_t &node = nodes[i];
+		if ( node.height == 0 && node.clipModel != NULL && node.clipModel->clipTreeLinked ) {
+			clipModelList.Append( node.clipModel );
+		}
+	}
+}
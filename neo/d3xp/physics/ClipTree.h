@@ -0,0 +1,92 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").  
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __CLIPTREE_H__
+#define __CLIPTREE_H__
+
+/*
+===============================================================================
+
+  Dynamic bounding box tree for linking clip models.
+
+  Leaves store fat bounds that are larger than the absolute bounds of the
+  clip model so a moving clip model only has to be reinserted once it leaves
+  its fat bounds. Inserting and removing leaves refits the bounds of all
+  parents and rotates nodes to keep the tree balanced.
+
+===============================================================================
+*/
+
+class idClipModel;
+
+#define CLIP_TREE_FAT_MARGIN		16.0f		// fat bounds are this much larger than the clip model bounds
+
+typedef struct clipTreeNode_s {
+	idBounds				bounds;			// fat bounds of the clip model for leaves
+	idClipModel *			clipModel;		// NULL for internal nodes
+	int						parent;			// next free node for nodes on the free list
+	int						children[2];	// -1 for leaves
+	int						height;			// 0 for leaves, -1 for free nodes
+} clipTreeNode_t;
+
+class idClipTree {
+public:
+							idClipTree();
+							~idClipTree();
+
+							// removes all leaves and resets the clip models that used them
+	void					Clear();
+
+	int						CreateProxy( idClipModel *clipModel, const idBounds &absBounds );
+	void					DestroyProxy( int proxy );
+							// returns true if the leaf was reinserted because the bounds moved outside the fat bounds
+	bool					MoveProxy( int proxy, const idBounds &absBounds );
+
+							// same tests as the clip sector walk in idClip::ClipModelsTouchingBounds
+	int						ClipModelsTouchingBounds( const idBounds &bounds, int contentMask, idClipModel **clipModelList, int maxCount ) const;
+	void					GetLinkedClipModels( idList<idClipModel *> &clipModelList ) const;
+
+	int						GetNumProxies() const { return numProxies; }
+	int						GetNumNodes() const { return nodes.Num(); }
+	int						GetHeight() const { return ( root != -1 ) ? nodes[root].height : 0; }
+
+private:
+	idList<clipTreeNode_t, TAG_IDLIB_LIST_PHYSICS>	nodes;
+	int						root;
+	int						freeList;
+	int						numProxies;
+
+	int						AllocNode();
+	void					FreeNode( int nodeNum );
+	void					InsertLeaf( int leaf );
+	void					RemoveLeaf( int leaf );
+	int						Balance( int nodeNum );
+	void					Refit( int nodeNum );
+};
+
+#endif /* !__CLIPTREE_H__ */
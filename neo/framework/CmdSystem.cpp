@@ -52,6 +52,14 @@ typedef struct commandDef_s {
 	char *					description;
 } commandDef_t;
 
+// Command text posted from any thread, waiting for the main thread to buffer it
+struct postedCommand_t {
+	postedCommand_t *		queueNext;
+	cmdExecution_t			exec;
+	int						length;
+	char					text[1];		// allocated to fit the text
+};
+
 /*
 ================================================
 idCmdSystemLocal 
@@ -74,6 +82,9 @@ public:
 	virtual void			BufferCommandText( cmdExecution_t exec, const char *text );
 	virtual void			ExecuteCommandBuffer();
 
+	virtual void			PostCommandText( cmdExecution_t exec, const char *text );
+	virtual void			BufferPostedCommands();
+
 	virtual void			ArgCompletion_FolderExtension( const idCmdArgs &args, void(*callback)( const char *s ), const char *folder, bool stripFolder, ... );
 	virtual void			ArgCompletion_DeclName( const idCmdArgs &args, void(*callback)( const char *s ), int type );
 
@@ -103,6 +114,10 @@ private:
 	// a command stored to be executed after a reloadEngine and all associated commands have been processed
 	idCmdArgs				postReload;
 
+	// text posted from other threads, and what has been taken off that queue but didn't fit in textBuf yet
+	idSysInterlockedQueue< postedCommand_t >	postedCommands;
+	postedCommand_t *		pendingPostedCommands;
+
 private:	
 	void					ExecuteTokenizedString( const idCmdArgs &args );
 	void					InsertCommandText( const char *text );
@@ -351,6 +366,7 @@ void idCmdSystemLocal::Init() {
 	completionString = "*";
 
 	textLength = 0;
+	pendingPostedCommands = NULL;
 }
 
 /*
@@ -372,6 +388,18 @@ void idCmdSystemLocal::Shutdown() {
 	completionParms.Clear();
 	tokenizedCmds.Clear();
 	postReload.Clear();
+
+	for ( postedCommand_t * posted = postedCommands.GetAll(); posted != NULL; ) {
+		postedCommand_t * next = posted->queueNext;
+		Mem_Free( posted );
+		posted = next;
+	}
+	for ( postedCommand_t * posted = pendingPostedCommands; posted != NULL; ) {
+		postedCommand_t * next = posted->queueNext;
+		Mem_Free( posted );
+		posted = next;
+	}
+	pendingPostedCommands = NULL;
 }
 
 /*
@@ -591,6 +619,12 @@ idCmdSystemLocal::BufferCommandText
 ============
 */
 void idCmdSystemLocal::BufferCommandText( cmdExecution_t exec, const char *text ) {
+	if ( exec != CMD_EXEC_NOW && !idLib::IsMainThread() ) {
+		// the text buffer belongs to the main thread, CMD_EXEC_NOW doesn't touch it and
+		// still runs right away on the calling thread, the game thread depends on that
+		PostCommandText( exec, text );
+		return;
+	}
 	switch( exec ) {
 		case CMD_EXEC_NOW: {
 			ExecuteCommandText( text );
@@ -693,6 +727,52 @@ void idCmdSystemLocal::ExecuteCommandBuffer() {
 	}
 }
 
+/*
+============
+idCmdSystemLocal::PostCommandText
+============
+*/
+void idCmdSystemLocal::PostCommandText( cmdExecution_t exec, const char *text ) {
+	const int length = idStr::Length( text );
+	postedCommand_t * posted = (postedCommand_t *)Mem_Alloc( sizeof( postedCommand_t ) + length, TAG_SYSTEM );
+	posted->queueNext = NULL;
+	posted->exec = exec;
+	posted->length = length;
+	memcpy( posted->text, text, length + 1 );
+	postedCommands.Add( posted );
+}
+
+/*
+============
+idCmdSystemLocal::BufferPostedCommands
+
+Text that doesn't fit in the command buffer stays pending for a later frame instead of
+being dropped, so nothing a thread posts gets lost or skipped ahead of.
+============
+*/
+void idCmdSystemLocal::BufferPostedCommands() {
+	assert( idLib::IsMainThread() );
+
+	postedCommand_t * posted = postedCommands.GetAll();
+	if ( posted != NULL ) {
+		postedCommand_t ** tail = &pendingPostedCommands;
+		while ( *tail != NULL ) {
+			tail = &(*tail)->queueNext;
+		}
+		*tail = posted;
+	}
+
+	while ( pendingPostedCommands != NULL ) {
+		posted = pendingPostedCommands;
+		if ( posted->exec != CMD_EXEC_NOW && textLength + posted->length + 1 >= MAX_CMD_BUFFER ) {
+			break;
+		}
+		pendingPostedCommands = posted->queueNext;
+		BufferCommandText( posted->exec, posted->text );
+		Mem_Free( posted );
+	}
+}
+
 /*
 ============
 idCmdSystemLocal::ArgCompletion_FolderExtension
@@ -799,3 +879,125 @@ bool idCmdSystemLocal::PostReloadEngine() {
 	postReload.Clear();
 	return true;
 }
+
+/*
+================================================================================================
+
+	cmdQueueStressTest
+
+================================================================================================
+*/
+
+static const int CMD_QUEUE_STRESS_MAX_PRODUCERS = 16;
+
+static int	cmdQueueStressNext[ CMD_QUEUE_STRESS_MAX_PRODUCERS ];
+static int	cmdQueueStressReceived;
+static int	cmdQueueStressOutOfOrder;
+
+/*
+============
+CmdQueueStressMark_f
+============
+*/
+static void CmdQueueStressMark_f( const idCmdArgs &args ) {
+	const int producer = atoi( args.Argv( 1 ) );
+	const int sequence = atoi( args.Argv( 2 ) );
+	if ( producer < 0 || producer >= CMD_QUEUE_STRESS_MAX_PRODUCERS ) {
+		cmdQueueStressOutOfOrder++;
+		return;
+	}
+	if ( sequence != cmdQueueStressNext[ producer ] ) {
+		cmdQueueStressOutOfOrder++;
+	}
+	cmdQueueStressNext[ producer ] = sequence + 1;
+	cmdQueueStressReceived++;
+}
+
+/*
+================================================
+idCmdQueueStressThread
+
+Posts numbered commands as fast as it can, half through PostCommandText and half through
+BufferCommandText, which has to forward them since this isn't the main thread.
+================================================
+*/
+class idCmdQueueStressThread : public idSysThread {
+public:
+	int							producer;
+	int							numCommands;
+	idSysInterlockedInteger *	numFinished;
+
+	virtual int Run() {
+		char text[64];
+		for ( int i = 0; i < numCommands; i++ ) {
+			idStr::snPrintf( text, sizeof( text ), "_cmdQueueStressMark %d %d\n", producer, i );
+			if ( i & 1 ) {
+				cmdSystem->BufferCommandText( CMD_EXEC_APPEND, text );
+			} else {
+				cmdSystem->PostCommandText( CMD_EXEC_APPEND, text );
+			}
+		}
+		numFinished->Increment();
+		return 0;
+	}
+};
+
+/*
+============
+cmdQueueStressTest
+
+Several threads post commands while the main thread buffers and executes them, every command
+must run exactly once and in the order its thread posted it.
+============
+*/
+CONSOLE_COMMAND( cmdQueueStressTest, "usage: cmdQueueStressTest [numProducers] [commandsPerProducer]", 0 ) {
+	const int numProducers			= args.Argc() > 1 ? idMath::ClampInt( 1, CMD_QUEUE_STRESS_MAX_PRODUCERS, atoi( args.Argv( 1 ) ) ) : 8;
+	const int commandsPerProducer	= args.Argc() > 2 ? Max( 1, atoi( args.Argv( 2 ) ) ) : 20000;
+	const int totalCommands			= numProducers * commandsPerProducer;
+
+	memset( cmdQueueStressNext, 0, sizeof( cmdQueueStressNext ) );
+	cmdQueueStressReceived = 0;
+	cmdQueueStressOutOfOrder = 0;
+	cmdSystem->AddCommand( "_cmdQueueStressMark", CmdQueueStressMark_f, CMD_FL_SYSTEM, "used by cmdQueueStressTest" );
+
+	const int startTime = Sys_Milliseconds();
+
+	idSysInterlockedInteger numFinished;
+	idList< idCmdQueueStressThread * > threads;
+	for ( int i = 0; i < numProducers; i++ ) {
+		idCmdQueueStressThread * thread = new (TAG_SYSTEM) idCmdQueueStressThread;
+		thread->producer = i;
+		thread->numCommands = commandsPerProducer;
+		thread->numFinished = &numFinished;
+		thread->StartThread( va( "cmdQueueStress%d", i ), CORE_ANY );
+		threads.Append( thread );
+	}
+
+	int finishedTime = 0;
+	while ( cmdQueueStressReceived < totalCommands ) {
+		const bool producersDone = ( numFinished.GetValue() == numProducers );
+		cmdSystem->BufferPostedCommands();
+		cmdSystem->ExecuteCommandBuffer();
+		if ( producersDone ) {
+			if ( finishedTime == 0 ) {
+				finishedTime = Sys_Milliseconds();
+			} else if ( Sys_Milliseconds() - finishedTime > 5000 ) {
+				break;		// everything posted should have come through long ago
+			}
+		}
+	}
+
+	const int msec = Max( 1, Sys_Milliseconds() - startTime );
+
+	for ( int i = 0; i < threads.Num(); i++ ) {
+		threads[i]->StopThread();
+	}
+	threads.DeleteContents( true );
+	cmdSystem->RemoveCommand( "_cmdQueueStressMark" );
+
+	idLib::Printf( "cmdQueueStressTest: %d producers x %d commands in %d ms (%.0f commands/s)\n", numProducers, commandsPerProducer, msec, totalCommands * 1000.0f / msec );
+	idLib::Printf( "%d executed, %d lost, %d out of order\n", cmdQueueStressReceived, totalCommands - cmdQueueStressReceived, cmdQueueStressOutOfOrder );
+	if ( cmdQueueStressReceived != totalCommands || cmdQueueStressOutOfOrder != 0 ) {
+		idLib::Warning( "cmdQueueStressTest: FAILED" );
+	}
+}
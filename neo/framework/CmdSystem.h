@@ -159,12 +159,20 @@ public:
 	virtual void		AppendCommandText( const char * text ) = 0;
 
 						// Adds command text to the command buffer, does not add a final \n
+						// CMD_EXEC_NOW executes the text immediately on any thread, the other modes
+						// go through PostCommandText when called off the main thread.
 	virtual void		BufferCommandText( cmdExecution_t exec, const char *text ) = 0;
 						// Pulls off \n \r or ; terminated lines of text from the command buffer and
 						// executes the commands. Stops when the buffer is empty.
 						// Normally called once per frame, but may be explicitly invoked.
 	virtual void		ExecuteCommandBuffer() = 0;
 
+						// Thread safe version of BufferCommandText, the text is queued until the main
+						// thread calls BufferPostedCommands. Text posted by one thread keeps its order.
+	virtual void		PostCommandText( cmdExecution_t exec, const char *text ) = 0;
+						// Moves posted command text into the command buffer, called once per frame.
+	virtual void		BufferPostedCommands() = 0;
+
 						// Base for path/file auto-completion.
 	virtual void		ArgCompletion_FolderExtension( const idCmdArgs &args, void(*callback)( const char *s ), const char *folder, bool stripFolder, ... ) = 0;
 						// Base for decl name auto-completion.
@@ -1015,15 +1015,15 @@ void idCommonLocal::Init( int argc, const char * const * argv, const char *cmdli
 
 		fileSystem->BeginLevelLoad( "_startup", saveFile.GetDataPtr(), saveFile.GetAllocated() );
 
+		// init the parallel job manager, the declaration manager uses it to load decl files
+		parallelJobManager->Init();
+
 		// initialize the declaration manager
 		declManager->Init();
 
 		// init journalling, etc
 		eventLoop->Init();
 
-		// init the parallel job manager
-		parallelJobManager->Init();
-
 		// exec the startup scripts
 		cmdSystem->BufferCommandText( CMD_EXEC_APPEND, "exec default.cfg\n" );
 
@@ -31,6 +31,18 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "Common_local.h"
 
+idCVar com_benchmarkHeadless( "com_benchmarkHeadless", "1", CVAR_SYSTEM | CVAR_BOOL, "skip the renderer back end while running benchmarkDemo, so only the CPU side of a frame is timed" );
+
+struct demoBenchmarkFrame_t {
+	uint64	totalMicroSec;
+	uint64	demoMicroSec;			// reading the demo commands into the render world
+	uint64	frontEndMicroSec;
+	uint64	backEndMicroSec;		// for the previous frame
+	uint64	shadowMicroSec;
+	uint64	gpuMicroSec;
+	uint64	jobListMicroSec[MAX_JOBLISTS];
+};
+
 /*
 ================
 FindUnusedFileName
@@ -241,6 +253,163 @@ void idCommonLocal::TimeRenderDemo( const char *demoName, bool twice, bool quit
 	}
 }
 
+/*
+================
+idCommonLocal::BenchmarkRenderDemo
+
+Draws every frame of a demo as fast as possible and writes the CPU time of each frame,
+split into the demo, front end and job list times, to resultName. The output is csv if
+resultName ends in .csv, json otherwise.
+================
+*/
+void idCommonLocal::BenchmarkRenderDemo( const char *demoName, const char *resultName, bool quit ) {
+	idStr demo = demoName;
+	idStr result = resultName;
+
+	StartPlayingRenderDemo( demo );
+	if ( !readDemo ) {
+		return;
+	}
+
+	const bool savedSkipBackEnd = cvarSystem->GetCVarBool( "r_skipBackEnd" );
+	if ( com_benchmarkHeadless.GetBool() ) {
+		cvarSystem->SetCVarBool( "r_skipBackEnd", true );
+	}
+
+	idList< demoBenchmarkFrame_t > frames;
+	frames.SetGranularity( 1024 );
+	bool usedJobLists[MAX_JOBLISTS] = { false };
+
+	// the job lists keep the times of their last run until they run again, remember which run
+	// was counted already so a list that didn't run in a frame isn't counted again
+	uint64 countedSubmitTime[MAX_JOBLISTS] = { 0 };
+	for ( int i = 0; i < parallelJobManager->GetNumJobLists() && i < MAX_JOBLISTS; i++ ) {
+		countedSubmitTime[i] = parallelJobManager->GetJobList( i )->GetSubmitTimeMicroSec();
+	}
+
+	const uint64 benchmarkStart = Sys_Microseconds();
+	while ( readDemo != NULL ) {
+		demoBenchmarkFrame_t & frame = frames.Alloc();
+		memset( &frame, 0, sizeof( frame ) );
+		const uint64 frameStart = Sys_Microseconds();
+
+		// read commands until the next view is ready
+		const int startFrame = numDemoFrames;
+		bool finished = false;
+		while ( numDemoFrames == startFrame ) {
+			if ( !AdvanceRenderDemo( true ) ) {
+				finished = true;
+				break;
+			}
+		}
+		if ( finished ) {
+			frames.RemoveIndex( frames.Num() - 1 );
+			break;
+		}
+		const uint64 demoEnd = Sys_Microseconds();
+
+		const bool captureToImage = false;
+		UpdateScreen( captureToImage );
+
+		frame.totalMicroSec = Sys_Microseconds() - frameStart;
+		frame.demoMicroSec = demoEnd - frameStart;
+		frame.frontEndMicroSec = time_frontend;
+		frame.backEndMicroSec = time_backend;
+		frame.shadowMicroSec = time_shadows;
+		frame.gpuMicroSec = time_gpu;
+		for ( int i = 0; i < parallelJobManager->GetNumJobLists() && i < MAX_JOBLISTS; i++ ) {
+			idParallelJobList * jobList = parallelJobManager->GetJobList( i );
+			const jobListId_t id = jobList->GetId();
+			const uint64 submitTime = jobList->GetSubmitTimeMicroSec();
+			if ( submitTime == countedSubmitTime[i] ) {
+				continue;
+			}
+			countedSubmitTime[i] = submitTime;
+			if ( jobList->GetNumExecutedJobs() > 0 ) {
+				frame.jobListMicroSec[id] += jobList->GetTotalProcessingTimeMicroSec();
+				usedJobLists[id] = true;
+			}
+		}
+	}
+	const uint64 benchmarkEnd = Sys_Microseconds();
+
+	// a demo that ends on a demoShot frame is still open
+	if ( readDemo != NULL ) {
+		Stop();
+		StartMenu();
+	}
+	cvarSystem->SetCVarBool( "r_skipBackEnd", savedSkipBackEnd );
+
+	if ( frames.Num() == 0 ) {
+		common->Printf( "%s has no frames\n", demo.c_str() );
+		return;
+	}
+
+	uint64 minFrame = frames[0].totalMicroSec;
+	uint64 maxFrame = frames[0].totalMicroSec;
+	for ( int i = 1; i < frames.Num(); i++ ) {
+		minFrame = Min( minFrame, frames[i].totalMicroSec );
+		maxFrame = Max( maxFrame, frames[i].totalMicroSec );
+	}
+	const float seconds = ( benchmarkEnd - benchmarkStart ) * 0.000001f;
+	common->Printf( "%i frames in %3.1f seconds = %3.1f fps, frame min %1.2f ms, max %1.2f ms%s\n", frames.Num(), seconds, frames.Num() / seconds,
+		minFrame * 0.001f, maxFrame * 0.001f, com_benchmarkHeadless.GetBool() ? " (headless)" : "" );
+
+	idFile * f = fileSystem->OpenFileWrite( result );
+	if ( f == NULL ) {
+		common->Warning( "couldn't write %s", result.c_str() );
+	} else {
+		idStr extension;
+		result.ExtractFileExtension( extension );
+		if ( extension.Icmp( "csv" ) == 0 ) {
+			f->Printf( "frame,total,demo,frontend,backend,shadows,gpu" );
+			for ( int j = 0; j < MAX_JOBLISTS; j++ ) {
+				if ( usedJobLists[j] ) {
+					f->Printf( ",%s", GetJobListName( (jobListId_t)j ) );
+				}
+			}
+			f->Printf( "\n" );
+			for ( int i = 0; i < frames.Num(); i++ ) {
+				const demoBenchmarkFrame_t & frame = frames[i];
+				f->Printf( "%d,%lld,%lld,%lld,%lld,%lld,%lld", i, frame.totalMicroSec, frame.demoMicroSec, frame.frontEndMicroSec,
+					frame.backEndMicroSec, frame.shadowMicroSec, frame.gpuMicroSec );
+				for ( int j = 0; j < MAX_JOBLISTS; j++ ) {
+					if ( usedJobLists[j] ) {
+						f->Printf( ",%lld", frame.jobListMicroSec[j] );
+					}
+				}
+				f->Printf( "\n" );
+			}
+		} else {
+			f->Printf( "{\n" );
+			f->Printf( "\t\"demo\": \"%s\",\n", demo.c_str() );
+			f->Printf( "\t\"headless\": %s,\n", com_benchmarkHeadless.GetBool() ? "true" : "false" );
+			f->Printf( "\t\"numFrames\": %d,\n", frames.Num() );
+			f->Printf( "\t\"seconds\": %f,\n", seconds );
+			f->Printf( "\t\"units\": \"microseconds\",\n" );
+			f->Printf( "\t\"frames\": [\n" );
+			for ( int i = 0; i < frames.Num(); i++ ) {
+				const demoBenchmarkFrame_t & frame = frames[i];
+				f->Printf( "\t\t{ \"total\": %lld, \"demo\": %lld, \"frontend\": %lld, \"backend\": %lld, \"shadows\": %lld, \"gpu\": %lld",
+					frame.totalMicroSec, frame.demoMicroSec, frame.frontEndMicroSec, frame.backEndMicroSec, frame.shadowMicroSec, frame.gpuMicroSec );
+				for ( int j = 0; j < MAX_JOBLISTS; j++ ) {
+					if ( usedJobLists[j] ) {
+						f->Printf( ", \"%s\": %lld", GetJobListName( (jobListId_t)j ), frame.jobListMicroSec[j] );
+					}
+				}
+				f->Printf( " }%s\n", ( i < frames.Num() - 1 ) ? "," : "" );
+			}
+			f->Printf( "\t]\n" );
+			f->Printf( "}\n" );
+		}
+		common->Printf( "wrote %s\n", f->GetFullPath() );
+		delete f;
+	}
+
+	if ( quit ) {
+		cmdSystem->BufferCommandText( CMD_EXEC_APPEND, "quit\n" );
+	}
+}
 
 /*
 ================
@@ -389,7 +558,7 @@ void idCommonLocal::CompressDemoFile( const char *scheme, const char *demoName )
 idCommonLocal::AdvanceRenderDemo
 ===============
 */
-void idCommonLocal::AdvanceRenderDemo( bool singleFrameOnly ) {
+bool idCommonLocal::AdvanceRenderDemo( bool singleFrameOnly ) {
 	int	ds = DS_FINISHED;
 	readDemo->ReadInt( ds );
 
@@ -401,7 +570,7 @@ void idCommonLocal::AdvanceRenderDemo( bool singleFrameOnly ) {
 			Stop();
 			StartMenu();
 		}
-		return;
+		return false;
 	case DS_RENDER:
 		if ( renderWorld->ProcessDemoCommand( readDemo, &currentDemoRenderView, &demoTimeOffset ) ) {
 			// a view is ready to render
@@ -414,6 +583,7 @@ void idCommonLocal::AdvanceRenderDemo( bool singleFrameOnly ) {
 	default:
 		common->Error( "Bad render demo token" );
 	}
+	return true;
 }
 
 /*
@@ -499,6 +669,21 @@ CONSOLE_COMMAND( timeDemoQuit, "times a demo and quits", idCmdSystem::ArgComplet
 	commonLocal.TimeRenderDemo( va( "demos/%s", args.Argv(1) ), true );
 }
 
+/*
+================
+Common_BenchmarkDemo_f
+================
+*/
+CONSOLE_COMMAND( benchmarkDemo, "times every frame of a demo and writes the results to a json or csv file", idCmdSystem::ArgCompletion_DemoName ) {
+	if ( args.Argc() < 2 ) {
+		common->Printf( "usage: benchmarkDemo <demo> [results.json|results.csv] [quit]\n" );
+		return;
+	}
+	idStr resultName = ( args.Argc() > 2 ) ? args.Argv(2) : va( "benchmarks/%s.json", args.Argv(1) );
+	const bool quit = ( args.Argc() > 3 ) && ( idStr::Icmp( args.Argv(3), "quit" ) == 0 );
+	commonLocal.BenchmarkRenderDemo( va( "demos/%s", args.Argv(1) ), resultName, quit );
+}
+
 /*
 ================
 Common_AVIDemo_f
@@ -48,6 +48,104 @@ extern idCVar g_demoMode;
 // This is for the dirty hack to get a dialog to show up before we capture the screen for autorender.
 const int NumScreenUpdatesToShowDialog = 25;
 
+enum loadStage_t {
+	LOAD_STAGE_UNLOAD,
+	LOAD_STAGE_FREE,
+	LOAD_STAGE_PRELOAD,
+	LOAD_STAGE_WORLD,
+	LOAD_STAGE_GAME,
+	LOAD_STAGE_SPAWN_FRAME,
+	LOAD_STAGE_END_LEVEL_LOAD,
+	LOAD_STAGE_INITIAL_FRAMES,
+	LOAD_STAGE_INTERACTIONS,
+	LOAD_STAGE_NUM
+};
+
+static const char * loadStageNames[LOAD_STAGE_NUM] = {
+	"unload map",
+	"free assets",
+	"preload",
+	"render world",
+	"game init",
+	"spawn frame",
+	"end level load",
+	"initial frames",
+	"interactions"
+};
+
+static int	loadStageMsec[LOAD_STAGE_NUM];
+
+// state for the loadBenchmark command, which reloads the same map a number of times
+struct loadBenchmark_t {
+	idStr	mapName;
+	int		loadsLeft;
+	int		numLoads;
+	int		totalMsec[LOAD_STAGE_NUM + 1];
+	int		minMsec[LOAD_STAGE_NUM + 1];
+	int		maxMsec[LOAD_STAGE_NUM + 1];
+};
+static loadBenchmark_t loadBenchmark;
+
+/*
+========================
+EndLoadStage
+
+Records the wall time of a level load stage and returns the start time of the next one.
+========================
+*/
+static int EndLoadStage( loadStage_t stage, int stageStart ) {
+	const int now = Sys_Milliseconds();
+	loadStageMsec[stage] = now - stageStart;
+	return now;
+}
+
+/*
+========================
+PrintLoadStages
+========================
+*/
+static void PrintLoadStages( int totalMsec ) {
+	common->Printf( "----- Level load stages -----\n" );
+	for ( int i = 0; i < LOAD_STAGE_NUM; i++ ) {
+		common->Printf( "%6d msec %s\n", loadStageMsec[i], loadStageNames[i] );
+	}
+	common->Printf( "%6d msec total\n", totalMsec );
+}
+
+/*
+========================
+UpdateLoadBenchmark
+
+Accumulates the stage times of the level load that just finished and queues the next load.
+========================
+*/
+static void UpdateLoadBenchmark( int totalMsec ) {
+	if ( loadBenchmark.loadsLeft <= 0 ) {
+		return;
+	}
+
+	for ( int i = 0; i <= LOAD_STAGE_NUM; i++ ) {
+		const int msec = ( i < LOAD_STAGE_NUM ) ? loadStageMsec[i] : totalMsec;
+		loadBenchmark.totalMsec[i] += msec;
+		loadBenchmark.minMsec[i] = ( loadBenchmark.numLoads == 0 ) ? msec : Min( loadBenchmark.minMsec[i], msec );
+		loadBenchmark.maxMsec[i] = ( loadBenchmark.numLoads == 0 ) ? msec : Max( loadBenchmark.maxMsec[i], msec );
+	}
+	loadBenchmark.numLoads++;
+	loadBenchmark.loadsLeft--;
+
+	if ( loadBenchmark.loadsLeft > 0 ) {
+		cmdSystem->AppendCommandText( va( "map %s\n", loadBenchmark.mapName.c_str() ) );
+		return;
+	}
+
+	common->Printf( "----- Load benchmark: %s, %d loads -----\n", loadBenchmark.mapName.c_str(), loadBenchmark.numLoads );
+	common->Printf( "   avg    min    max  stage\n" );
+	for ( int i = 0; i <= LOAD_STAGE_NUM; i++ ) {
+		common->Printf( "%6d %6d %6d  %s\n", loadBenchmark.totalMsec[i] / loadBenchmark.numLoads, loadBenchmark.minMsec[i], loadBenchmark.maxMsec[i],
+			( i < LOAD_STAGE_NUM ) ? loadStageNames[i] : "total" );
+	}
+}
+
 /*
 ================
 idCommonLocal::LaunchExternalTitle
@@ -462,6 +560,7 @@ void idCommonLocal::ExecuteMapChange() {
 	UnloadMap();
 	int ms = Sys_Milliseconds() - sm;
 	common->Printf( "%6d msec to unload map\n", ms );
+	int stageStart = EndLoadStage( LOAD_STAGE_UNLOAD, sm );
 
 	// Free media from previous level and
 	// note which media we are going to need to load
@@ -472,6 +571,7 @@ void idCommonLocal::ExecuteMapChange() {
 	uiManager->BeginLevelLoad();
 	ms = Sys_Milliseconds() - sm;
 	common->Printf( "%6d msec to free assets\n", ms );
+	stageStart = EndLoadStage( LOAD_STAGE_FREE, stageStart );
 
 	//Sys_DumpMemory( true );
 
@@ -491,10 +591,17 @@ void idCommonLocal::ExecuteMapChange() {
 		manifestName += ".preload";
 		idPreloadManifest manifest;
 		manifest.LoadManifest( manifestName );
+
+		// start reading the level's files in the background, EndLevelLoad stops it
+		idStrList preloadFiles;
+		manifest.GetGeneratedFileNames( preloadFiles );
+		fileSystem->StartPreload( preloadFiles );
+
 		renderSystem->Preload( manifest, currentMapName );
 		soundSystem->Preload( manifest );
 		game->Preload( manifest );
 	}
+	stageStart = EndLoadStage( LOAD_STAGE_PRELOAD, stageStart );
 
 	if ( common->IsMultiplayer() ) {
 		// In multiplayer, make sure the player is either 60Hz or 120Hz
@@ -519,6 +626,7 @@ void idCommonLocal::ExecuteMapChange() {
 	if ( !renderWorld->InitFromMap( fullMapName ) ) {
 		common->Error( "couldn't load %s", fullMapName.c_str() );
 	}
+	stageStart = EndLoadStage( LOAD_STAGE_WORLD, stageStart );
 
 	// for the synchronous networking we needed to roll the angles over from
 	// level to level, but now we can just clear everything
@@ -541,6 +649,8 @@ void idCommonLocal::ExecuteMapChange() {
 		game->InitFromNewMap( fullMapName, renderWorld, soundWorld, matchParameters.gameMode, Sys_Milliseconds() );
 	}
 
+	stageStart = EndLoadStage( LOAD_STAGE_GAME, stageStart );
+
 	game->Shell_CreateMenu( true );
 
 	// Reset some values important to multiplayer
@@ -573,11 +683,14 @@ void idCommonLocal::ExecuteMapChange() {
 		}
 	}
 
+	stageStart = EndLoadStage( LOAD_STAGE_SPAWN_FRAME, stageStart );
+
 	renderSystem->EndLevelLoad();
 	soundSystem->EndLevelLoad();
 	declManager->EndLevelLoad();
 	uiManager->EndLevelLoad( currentMapName );
 	fileSystem->EndLevelLoad();
+	stageStart = EndLoadStage( LOAD_STAGE_END_LEVEL_LOAD, stageStart );
 
 	if ( !mapSpawnData.savegameFile && !IsMultiplayer() ) {
 		common->Printf( "----- Running initial game frames -----\n" );
@@ -597,10 +710,13 @@ void idCommonLocal::ExecuteMapChange() {
 		SaveGame( "autosave" );
 	}
 
+	stageStart = EndLoadStage( LOAD_STAGE_INITIAL_FRAMES, stageStart );
+
 	common->Printf( "----- Generating Interactions -----\n" );
 
 	// let the renderSystem generate interactions now that everything is spawned
 	renderWorld->GenerateAllInteractions();
+	EndLoadStage( LOAD_STAGE_INTERACTIONS, stageStart );
 
 	{
 		int vertexMemUsedKB = vertexCache.staticData.vertexMemUsed.GetValue() / 1024;
@@ -650,7 +766,9 @@ void idCommonLocal::ExecuteMapChange() {
 
 
 	int	msec = Sys_Milliseconds() - start;
+	PrintLoadStages( msec );
 	common->Printf( "%6d msec to load %s\n", msec, currentMapName.c_str() );
+	UpdateLoadBenchmark( msec );
 	//Sys_DumpMemory( false );	
 
 	// Issue a render at the very end of the load process to update soundTime before the first frame
@@ -1147,6 +1265,25 @@ CONSOLE_COMMAND_SHIP( map, "loads a map", idCmdSystem::ArgCompletion_MapName ) {
 	commonLocal.StartNewGame( args.Argv(1), false, GAME_MODE_SINGLEPLAYER );
 }
 
+/*
+==================
+Common_LoadBenchmark_f
+
+Loads a map a number of times and reports the average wall time of each load stage
+==================
+*/
+CONSOLE_COMMAND( loadBenchmark, "loads a map repeatedly and reports the time of each load stage", idCmdSystem::ArgCompletion_MapName ) {
+	if ( args.Argc() < 2 ) {
+		common->Printf( "usage: loadBenchmark <map> [count]\n" );
+		return;
+	}
+	memset( &loadBenchmark.totalMsec, 0, sizeof( loadBenchmark.totalMsec ) );
+	loadBenchmark.mapName = args.Argv( 1 );
+	loadBenchmark.loadsLeft = ( args.Argc() > 2 ) ? Max( atoi( args.Argv( 2 ) ), 1 ) : 3;
+	loadBenchmark.numLoads = 0;
+	cmdSystem->AppendCommandText( va( "map %s\n", loadBenchmark.mapName.c_str() ) );
+}
+
 /*
 ==================
 Common_RestartMap_f
@@ -233,6 +233,7 @@ public:	// These are public because they are called directly by static functions
 	void	StopPlayingRenderDemo();
 	void	CompressDemoFile( const char *scheme, const char *name );
 	void	TimeRenderDemo( const char *name, bool twice = false, bool quit = false );
+	void	BenchmarkRenderDemo( const char *name, const char *resultName, bool quit );
 	void	AVIRenderDemo( const char *name );
 	void	AVIGame( const char *name );
 
@@ -451,7 +452,7 @@ private:
 	void	BeginAVICapture( const char *name );
 	void	EndAVICapture();
 
-	void	AdvanceRenderDemo( bool singleFrameOnly );
+	bool	AdvanceRenderDemo( bool singleFrameOnly );
 
 	void	ProcessGameReturn( const gameReturn_t & ret );
 
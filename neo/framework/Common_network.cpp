@@ -29,10 +29,13 @@ If you have questions concerning this license or the applicable additional terms
 #pragma hdrstop
 
 #include "Common_local.h"
+#include "../sys/PacketSimulator.h"
 
 idCVar net_clientMaxPrediction( "net_clientMaxPrediction", "5000", CVAR_SYSTEM | CVAR_INTEGER | CVAR_NOCHEAT, "maximum number of milliseconds a client can predict ahead of server." );
 idCVar net_snapRate( "net_snapRate", "100", CVAR_SYSTEM | CVAR_INTEGER, "How many milliseconds between sending snapshots" );
 idCVar net_ucmdRate( "net_ucmdRate", "40", CVAR_SYSTEM | CVAR_INTEGER, "How many milliseconds between sending usercmds" );
+idCVar net_ucmdPacked( "net_ucmdPacked", "1", CVAR_SYSTEM | CVAR_BOOL, "Send usercmds as bit packed deltas instead of byte aligned ones" );
+idCVar net_ucmdRedundancy( "net_ucmdRedundancy", "8", CVAR_SYSTEM | CVAR_INTEGER, "How many of the newest usercmds each usercmd packet carries, so the host can fill in for lost packets", 1, NUM_USERCMD_SEND );
 
 idCVar net_debug_snapShotTime( "net_debug_snapShotTime", "0", CVAR_BOOL | CVAR_ARCHIVE, "" );
 idCVar com_forceLatestSnap( "com_forceLatestSnap", "0", CVAR_BOOL, "" );
@@ -75,6 +78,73 @@ idCVar net_maxExtrapolationInMS( "net_maxExtrapolationInMS", "0", CVAR_INTEGER,
 
 static const int SNAP_USERCMDS = 8192;
 
+// Set in the usercmd count byte when the commands that follow are in the bit packed format
+static const int USERCMD_COUNT_PACKED = BIT( 7 );
+
+/*
+===============
+WriteUsercmds
+
+Each command is a delta from the one before it, the first from an empty command.
+===============
+*/
+static void WriteUsercmds( idBitMsg & msg, usercmd_t * const * cmds, int numCmds, bool packed ) {
+	usercmd_t empty;
+	const usercmd_t * last = &empty;
+
+	if ( packed ) {
+		msg.WriteByte( numCmds | USERCMD_COUNT_PACKED );
+		for ( int i = 0; i < numCmds; i++ ) {
+			cmds[i]->WriteDeltaBits( msg, *last );
+			last = cmds[i];
+		}
+	} else {
+		idSerializer ser( msg, true );
+		msg.WriteByte( numCmds );
+		for ( int i = 0; i < numCmds; i++ ) {
+			cmds[i]->Serialize( ser, *last );
+			last = cmds[i];
+		}
+	}
+}
+
+/*
+===============
+ReadUsercmds
+
+Reads either format and keeps the commands newer than newestMilliseconds, which drops the
+redundant copies of commands that already arrived in earlier packets.
+===============
+*/
+static void ReadUsercmds( idBitMsg & msg, int newestMilliseconds, idStaticList< usercmd_t, NUM_USERCMD_RELAY > & newCmds ) {
+	idSerializer ser( msg, false );
+
+	usercmd_t lastCmd;
+
+	const int countByte = msg.ReadByte();
+	const bool packed = ( countByte & USERCMD_COUNT_PACKED ) != 0;
+	const int numCmds = countByte & ~USERCMD_COUNT_PACKED;
+
+	for ( int i = 0; i < numCmds; i++ ) {
+		usercmd_t newCmd;
+		if ( packed ) {
+			newCmd.ReadDeltaBits( msg, lastCmd );
+		} else {
+			newCmd.Serialize( ser, lastCmd );
+		}
+		lastCmd = newCmd;
+
+		int newMilliseconds = newCmd.clientGameMilliseconds;
+
+		if ( newMilliseconds > newestMilliseconds ) {
+			if ( verify( i < NUM_USERCMD_RELAY ) ) {
+				newCmds.Append( newCmd );
+				newestMilliseconds = newMilliseconds;
+			}
+		}
+	}
+}
+
 /*
 ===============
 idCommonLocal::IsMultiplayer
@@ -179,23 +249,15 @@ void idCommonLocal::SendUsercmds( int localClientNum ) {
 	if ( lobby.IsHost() ) {
 		return;
 	}
-	// We always send the last NUM_USERCMD_SEND usercmds
+	// We always send the last net_ucmdRedundancy usercmds
 	// Which may result in duplicate usercmds being sent in the case of a low net_ucmdRate
-	// But the LZW compressor means the extra usercmds are not large and the redundancy can smooth packet loss
+	// But the delta encoding means the extra usercmds are not large and the redundancy can smooth packet loss
 	byte buffer[idPacketProcessor::MAX_FINAL_PACKET_SIZE];
 	idBitMsg msg( buffer, sizeof( buffer ) );
-	idSerializer ser( msg, true );
-	usercmd_t empty;
-	usercmd_t * last = &empty;
 	
 	usercmd_t * cmdBuffer[NUM_USERCMD_SEND];
-	const int numCmds = userCmdMgr.GetPlayerCmds( localClientNum, cmdBuffer, NUM_USERCMD_SEND );
-	msg.WriteByte( numCmds );
-	for ( int i = 0; i < numCmds; i++ ) {
-		cmdBuffer[i]->Serialize( ser, *last );
-		
-		last = cmdBuffer[i];
-	}
+	const int numCmds = userCmdMgr.GetPlayerCmds( localClientNum, cmdBuffer, idMath::ClampInt( 1, NUM_USERCMD_SEND, net_ucmdRedundancy.GetInteger() ) );
+	WriteUsercmds( msg, cmdBuffer, numCmds, net_ucmdPacked.GetBool() );
 	session->SendUsercmds( msg );
 
 	nextUsercmdSendTime = MSEC_ALIGN_TO_FRAME( currentTime + net_ucmdRate.GetInteger() );
@@ -325,38 +387,10 @@ void idCommonLocal::NetReadUsercmds( int clientNum, idBitMsg & msg ) {
 		return;
 	}
 
-	idSerializer ser( msg, false );
-	
-	usercmd_t fakeCmd;
-	usercmd_t * base = &fakeCmd;
-
-	usercmd_t lastCmd;
-
-	bool										gotNewCmd = false;
 	idStaticList< usercmd_t, NUM_USERCMD_RELAY >	newCmdBuffer;
 
-	usercmd_t baseCmd = userCmdMgr.NewestUserCmdForPlayer( clientNum );
-	int curMilliseconds = baseCmd.clientGameMilliseconds;
-
-	const int numCmds = msg.ReadByte();
-
-	for ( int i = 0; i < numCmds; i++ ) {
-		usercmd_t newCmd;
-		newCmd.Serialize( ser, *base );
-		
-		lastCmd = newCmd;
-		base = &lastCmd;
-
-		int newMilliseconds = newCmd.clientGameMilliseconds;
-
-		if ( newMilliseconds > curMilliseconds ) {
-			if ( verify( i < NUM_USERCMD_RELAY ) ) {
-				newCmdBuffer.Append( newCmd );
-				gotNewCmd = true;
-				curMilliseconds = newMilliseconds;
-			}
-		}
-	}
+	const usercmd_t & baseCmd = userCmdMgr.NewestUserCmdForPlayer( clientNum );
+	ReadUsercmds( msg, baseCmd.clientGameMilliseconds, newCmdBuffer );
 	
 	// Push the commands into the buffer.
 	for ( int i = 0; i < newCmdBuffer.Num(); ++i ) {
@@ -637,3 +671,258 @@ void idCommonLocal::ResetNetworkingState() {
 	nextUsercmdSendTime = 0;
 	nextSnapshotSendTime = 0;
 }
+
+/*
+================================================================================================
+
+	usercmd stream benchmark
+
+================================================================================================
+*/
+
+extern idCVar net_simLatency;
+extern idCVar net_simJitter;
+extern idCVar net_simLoss;
+extern idCVar net_simReorder;
+extern idCVar net_simDuplicate;
+extern idCVar net_simSeed;
+
+static const int USERCMD_BENCH_FRAME_MSEC = 16;
+
+struct usercmdBenchResult_t {
+	usercmdBenchResult_t() : packetsSent( 0 ), payloadBytes( 0 ), cmdsReceived( 0 ), cmdsLost( 0 ), cmdsInexact( 0 ) {}
+
+	int				packetsSent;
+	int				payloadBytes;		// compressed usercmd packet contents, as handed to the packet processor
+	int				cmdsReceived;
+	int				cmdsLost;			// never reached the host, every packet carrying them was dropped
+	int				cmdsInexact;		// reached the host with different values than the client sent
+	idList< int >	latencies;			// time from a command being made to the host having it
+};
+
+/*
+========================
+UsercmdBench_Generate
+
+Makes a deterministic stream of commands that looks like someone playing: smoothed mouse look,
+movement keys held for a while, bursts of fire and the occasional weapon change.
+========================
+*/
+static void UsercmdBench_Generate( idList< usercmd_t > & cmds, int numCmds, int seed ) {
+	idRandom random( seed );
+
+	idVec3 pos( 1024.5f, -768.25f, 64.125f );
+	idVec3 velocity( vec3_zero );
+	float yawSpeed = 0.0f;
+	float pitchSpeed = 0.0f;
+	float yaw = 0.0f;
+	float pitch = 0.0f;
+	usercmd_t cmd;
+
+	cmds.SetNum( numCmds );
+	for ( int i = 0; i < numCmds; i++ ) {
+		cmd.clientGameMilliseconds = ( i + 1 ) * USERCMD_BENCH_FRAME_MSEC;
+		cmd.serverGameMilliseconds = Max( 0, cmd.clientGameMilliseconds - 100 );
+
+		if ( random.RandomInt( 30 ) == 0 ) {
+			cmd.forwardmove = (signed char)( ( random.RandomInt( 3 ) - 1 ) * 127 );
+			cmd.rightmove = (signed char)( ( random.RandomInt( 3 ) - 1 ) * 127 );
+		}
+		if ( random.RandomInt( 40 ) == 0 ) {
+			cmd.buttons ^= BUTTON_ATTACK;
+		}
+		if ( random.RandomInt( 200 ) == 0 ) {
+			cmd.buttons ^= BUTTON_CROUCH;
+		}
+		if ( ( cmd.buttons & BUTTON_ATTACK ) != 0 && ( i % 6 ) == 0 ) {
+			cmd.fireCount++;
+		}
+		if ( random.RandomInt( 600 ) == 0 ) {
+			cmd.impulse = (byte)random.RandomInt( 10 );
+			cmd.impulseSequence++;
+		}
+
+		yawSpeed = yawSpeed * 0.9f + random.CRandomFloat() * 0.4f;
+		pitchSpeed = pitchSpeed * 0.8f + random.CRandomFloat() * 0.1f;
+		yaw = idMath::AngleNormalize360( yaw + yawSpeed );
+		pitch = idMath::ClampFloat( -80.0f, 80.0f, pitch + pitchSpeed );
+		cmd.angles[PITCH] = ANGLE2SHORT( pitch );
+		cmd.angles[YAW] = ANGLE2SHORT( yaw );
+
+		idVec3 forward, right;
+		idAngles( 0.0f, yaw, 0.0f ).ToVectors( &forward, &right );
+		const idVec3 wishVelocity = ( forward * cmd.forwardmove - right * cmd.rightmove ) * ( 320.0f / 127.0f );
+		velocity += ( wishVelocity - velocity ) * 0.1f;
+		pos += velocity * ( USERCMD_BENCH_FRAME_MSEC * 0.001f );
+		cmd.pos = pos;
+		cmd.speedSquared = velocity.LengthSqr();
+
+		cmds[i] = cmd;
+	}
+}
+
+/*
+========================
+UsercmdBench_Exact
+
+usercmd_t::operator== skips the position, this compares everything that goes over the wire.
+========================
+*/
+static bool UsercmdBench_Exact( const usercmd_t & a, const usercmd_t & b ) {
+	return ( a.buttons == b.buttons &&
+			a.forwardmove == b.forwardmove &&
+			a.rightmove == b.rightmove &&
+			a.angles[0] == b.angles[0] &&
+			a.angles[1] == b.angles[1] &&
+			a.angles[2] == b.angles[2] &&
+			a.pos == b.pos &&
+			a.clientGameMilliseconds == b.clientGameMilliseconds &&
+			a.serverGameMilliseconds == b.serverGameMilliseconds &&
+			a.fireCount == b.fireCount &&
+			a.speedSquared == b.speedSquared &&
+			a.impulse == b.impulse &&
+			a.impulseSequence == b.impulseSequence );
+}
+
+/*
+========================
+UsercmdBench_Run
+
+Sends cmds from a client to the host the way SendUsercmds and idSessionLocal::SendUsercmds do,
+and reads them back the way the host's idLobby and NetReadUsercmds do.
+========================
+*/
+static void UsercmdBench_Run( const idList< usercmd_t > & cmds, const idPacketSimulator::linkParms_t & linkParms, int sendInterval, int redundancy, bool packed, usercmdBenchResult_t & result ) {
+	static const int HOST = 0;
+	static const int CLIENT = 1;
+
+	idPacketSimulator sim;
+	sim.Init( 2, net_simSeed.GetInteger() );
+	sim.SetLinkParms( linkParms );
+
+	lzwCompressionData_t lzwData;
+	byte cmdBuffer[ idPacketProcessor::MAX_FINAL_PACKET_SIZE ];
+	byte packetBuffer[ idPacketProcessor::MAX_FINAL_PACKET_SIZE ];
+
+	// Keep running after the last command so everything in flight lands
+	const int drainFrames = ( linkParms.latency * 2 + linkParms.jitter * 2 + 1000 ) / USERCMD_BENCH_FRAME_MSEC;
+	int nextSendTime = 0;
+	int newestMilliseconds = 0;
+
+	for ( int frame = 1; frame <= cmds.Num() + drainFrames; frame++ ) {
+		const int time = frame * USERCMD_BENCH_FRAME_MSEC;
+		const int numMade = Min( frame, cmds.Num() );
+
+		if ( frame <= cmds.Num() && time >= nextSendTime ) {
+			usercmd_t * sendCmds[ NUM_USERCMD_SEND ];
+			const int numSend = Min( numMade, redundancy );
+			for ( int i = 0; i < numSend; i++ ) {
+				sendCmds[i] = const_cast< usercmd_t * >( &cmds[ numMade - numSend + i ] );
+			}
+			idBitMsg msg( cmdBuffer, sizeof( cmdBuffer ) );
+			WriteUsercmds( msg, sendCmds, numSend, packed );
+
+			idLZWCompressor lzwCompressor( &lzwData );
+			lzwCompressor.Start( packetBuffer, sizeof( packetBuffer ) );
+			lzwCompressor.WriteAgnostic( result.packetsSent );		// stands in for the snapshot ack
+			lzwCompressor.WriteAgnostic( (uint16)0 );				// and the bandwidth report
+			lzwCompressor.Write( msg.GetReadData(), msg.GetSize() );
+			lzwCompressor.End();
+
+			sim.Send( time, CLIENT, HOST, packetBuffer, lzwCompressor.Length() );
+			result.packetsSent++;
+			result.payloadBytes += lzwCompressor.Length();
+			nextSendTime = time + sendInterval;
+		}
+
+		int from = 0;
+		int size = 0;
+		while ( sim.Receive( time, HOST, from, packetBuffer, size, sizeof( packetBuffer ) ) ) {
+			int snapNum = 0;
+			uint16 receivedBps = 0;
+
+			idLZWCompressor lzwCompressor( &lzwData );
+			lzwCompressor.Start( packetBuffer, size );
+			lzwCompressor.ReadAgnostic( snapNum );
+			lzwCompressor.ReadAgnostic( receivedBps );
+			const int cmdSize = lzwCompressor.Read( cmdBuffer, sizeof( cmdBuffer ), true );
+			lzwCompressor.End();
+
+			idBitMsg msg( (const byte *)cmdBuffer, cmdSize );
+			idStaticList< usercmd_t, NUM_USERCMD_RELAY > newCmds;
+			ReadUsercmds( msg, newestMilliseconds, newCmds );
+
+			for ( int i = 0; i < newCmds.Num(); i++ ) {
+				const int milliseconds = newCmds[i].clientGameMilliseconds;
+				const int index = milliseconds / USERCMD_BENCH_FRAME_MSEC - 1;
+				if ( !verify( index >= 0 && index < cmds.Num() ) ) {
+					continue;
+				}
+				result.cmdsLost += ( milliseconds - newestMilliseconds ) / USERCMD_BENCH_FRAME_MSEC - 1;
+				result.cmdsReceived++;
+				if ( !UsercmdBench_Exact( newCmds[i], cmds[index] ) ) {
+					result.cmdsInexact++;
+				}
+				result.latencies.Append( time - milliseconds );
+				newestMilliseconds = milliseconds;
+			}
+		}
+	}
+
+	// Commands at the end that never made it
+	result.cmdsLost += cmds.Num() - newestMilliseconds / USERCMD_BENCH_FRAME_MSEC;
+
+	result.latencies.SortWithTemplate( idSort_QuickDefault< int >() );
+}
+
+/*
+========================
+UsercmdBench_Print
+========================
+*/
+static void UsercmdBench_Print( const char * name, const usercmdBenchResult_t & result, int seconds ) {
+	const int numLatencies = result.latencies.Num();
+	idLib::Printf( "%s: %.0f bytes/s, %.1f bytes/packet over %d packets\n", name, (float)result.payloadBytes / seconds,
+		result.packetsSent > 0 ? (float)result.payloadBytes / result.packetsSent : 0.0f, result.packetsSent );
+	if ( numLatencies > 0 ) {
+		idLib::Printf( "    host input latency: p50 %d ms, p90 %d ms, p99 %d ms, max %d ms\n",
+			result.latencies[numLatencies / 2], result.latencies[numLatencies * 9 / 10], result.latencies[numLatencies * 99 / 100], result.latencies[numLatencies - 1] );
+	}
+	idLib::Printf( "    %d usercmds received, %d lost, %d not bit exact\n", result.cmdsReceived, result.cmdsLost, result.cmdsInexact );
+}
+
+/*
+========================
+netUsercmdBenchmark
+
+Plays the same synthetic usercmd stream over the same simulated link (the net_sim* cvars)
+with the byte aligned encoding and with the bit packed one, and compares what it costs and
+how long the host waits for input.
+========================
+*/
+CONSOLE_COMMAND( netUsercmdBenchmark, "usage: netUsercmdBenchmark [seconds] [redundancy]", 0 ) {
+	const int seconds		= args.Argc() > 1 ? Max( 1, atoi( args.Argv( 1 ) ) ) : 60;
+	const int redundancy	= args.Argc() > 2 ? idMath::ClampInt( 1, NUM_USERCMD_SEND, atoi( args.Argv( 2 ) ) ) : net_ucmdRedundancy.GetInteger();
+	const int sendInterval	= Max( USERCMD_BENCH_FRAME_MSEC, net_ucmdRate.GetInteger() );
+
+	idPacketSimulator::linkParms_t linkParms;
+	linkParms.latency	= net_simLatency.GetInteger();
+	linkParms.jitter	= net_simJitter.GetInteger();
+	linkParms.loss		= net_simLoss.GetFloat() / 100.0f;
+	linkParms.reorder	= net_simReorder.GetFloat() / 100.0f;
+	linkParms.duplicate	= net_simDuplicate.GetFloat() / 100.0f;
+
+	idList< usercmd_t > cmds;
+	UsercmdBench_Generate( cmds, seconds * 1000 / USERCMD_BENCH_FRAME_MSEC, net_simSeed.GetInteger() );
+
+	usercmdBenchResult_t legacy;
+	usercmdBenchResult_t packed;
+	UsercmdBench_Run( cmds, linkParms, sendInterval, NUM_USERCMD_SEND, false, legacy );
+	UsercmdBench_Run( cmds, linkParms, sendInterval, redundancy, true, packed );
+
+	idLib::Printf( "netUsercmdBenchmark: %d usercmds over %d seconds, sent every %d ms\n", cmds.Num(), seconds, sendInterval );
+	idLib::Printf( "link: %d ms +%d ms jitter, %.1f%% loss, %.1f%% reorder, %.1f%% duplicate, seed %d\n", linkParms.latency, linkParms.jitter,
+		linkParms.loss * 100.0f, linkParms.reorder * 100.0f, linkParms.duplicate * 100.0f, net_simSeed.GetInteger() );
+	UsercmdBench_Print( va( "byte aligned, %d per packet", NUM_USERCMD_SEND ), legacy, seconds );
+	UsercmdBench_Print( va( "bit packed, %d per packet", redundancy ), packed, seconds );
+}
@@ -292,6 +292,42 @@ idConsoleLocal::DrawMemoryUsage
 ==================
 */
 float idConsoleLocal::DrawMemoryUsage( float y ) {
+	static const int NUM_TAGS_SHOWN = 8;
+
+	memTagStats_t stats[TAG_NUM_TAGS];
+	Mem_GetTagStats( stats );
+
+	int64 totalBytes = 0;
+	for ( int i = 0; i < TAG_NUM_TAGS; i++ ) {
+		totalBytes += stats[i].bytes;
+	}
+
+	idStr memStr;
+	memStr.Format( "%lld MB", totalBytes >> 20 );
+	int w = memStr.LengthWithoutColors() * BIGCHAR_WIDTH;
+	renderSystem->DrawBigStringExt( LOCALSAFE_RIGHT - w, idMath::Ftoi( y ) + 2, memStr.c_str(), colorWhite, true );
+	y += BIGCHAR_HEIGHT + 4;
+
+	// the tags with the most memory allocated
+	bool shown[TAG_NUM_TAGS] = {};
+	for ( int i = 0; i < NUM_TAGS_SHOWN; i++ ) {
+		int best = -1;
+		for ( int j = 0; j < TAG_NUM_TAGS; j++ ) {
+			if ( !shown[j] && stats[j].bytes > 0 && ( best == -1 || stats[j].bytes > stats[best].bytes ) ) {
+				best = j;
+			}
+		}
+		if ( best == -1 ) {
+			break;
+		}
+		shown[best] = true;
+
+		memStr.Format( "%s: %6.1f MB", Mem_GetTagName( (memTag_t)best ), stats[best].bytes / ( 1024.0f * 1024.0f ) );
+		w = memStr.LengthWithoutColors() * SMALLCHAR_WIDTH;
+		renderSystem->DrawSmallStringExt( LOCALSAFE_RIGHT - w, idMath::Ftoi( y ) + 2, memStr.c_str(), colorWhite, false );
+		y += SMALLCHAR_HEIGHT + 4;
+	}
+
 	return y;
 }
 
@@ -0,0 +1,431 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").  
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "../idlib/precompiled.h"
+#pragma hdrstop
+
+#include "DeclCache.h"
+
+static const int DECL_CACHE_MAGIC	= ( 'B' << 24 ) | ( 'D' << 16 ) | ( 'C' << 8 ) | 'L';
+static const int DECL_CACHE_VERSION	= 1;
+
+static const int INTS_PER_RECORD	= sizeof( declScanRecord_t ) / sizeof( int );
+
+/*
+========================
+PadToInt
+========================
+*/
+static ID_INLINE int PadToInt( int size ) {
+	return ( size + 3 ) & ~3;
+}
+
+/*
+================================================================================================
+
+	idDeclCacheReader
+
+	Walks the loaded cache file, flagging any read past the end of it.
+
+================================================================================================
+*/
+class idDeclCacheReader {
+public:
+					idDeclCacheReader( const byte * data, int length ) : data( data ), length( length ), offset( 0 ), ok( true ) {}
+
+	int				ReadInt() {
+						if ( !Skip( sizeof( int ) ) ) {
+							return 0;
+						}
+						int value;
+						memcpy( &value, data + offset - sizeof( int ), sizeof( int ) );
+						return LittleLong( value );
+					}
+
+	const byte *	ReadBlock( int size ) {
+						if ( size < 0 || !Skip( PadToInt( size ) ) ) {
+							Fail();
+							return NULL;
+						}
+						return data + offset - PadToInt( size );
+					}
+
+	void			Fail() { ok = false; }
+	bool			IsOK() const { return ok; }
+	bool			AtEnd() const { return offset == length; }
+
+private:
+	const byte *	data;
+	int				length;
+	int				offset;
+	bool			ok;
+
+	bool			Skip( int size ) {
+						if ( !ok || size > length - offset ) {
+							Fail();
+							return false;
+						}
+						offset += size;
+						return true;
+					}
+};
+
+/*
+========================
+idDeclFileScan::idDeclFileScan
+========================
+*/
+idDeclFileScan::idDeclFileScan() {
+	numLines = 0;
+	hadWarnings = false;
+	names.SetGranularity( 1024 );
+}
+
+/*
+========================
+idDeclFileScan::Clear
+========================
+*/
+void idDeclFileScan::Clear() {
+	numLines = 0;
+	hadWarnings = false;
+	records.SetNum( 0 );
+	names.SetNum( 0 );
+}
+
+/*
+========================
+idDeclFileScan::AddRecord
+========================
+*/
+void idDeclFileScan::AddRecord( declType_t type, const char * name, int textOffset, int textLength, int line ) {
+	const int nameLength = idStr::Length( name ) + 1;
+
+	declScanRecord_t & record = records.Alloc();
+	record.type = type;
+	record.nameOffset = names.Num();
+	record.textOffset = textOffset;
+	record.textLength = textLength;
+	record.line = line;
+
+	names.AssureSize( record.nameOffset + nameLength );
+	memcpy( &names[ record.nameOffset ], name, nameLength );
+}
+
+/*
+========================
+idDeclFileScan::operator==
+========================
+*/
+bool idDeclFileScan::operator==( const idDeclFileScan & other ) const {
+	if ( numLines != other.numLines || records.Num() != other.records.Num() ) {
+		return false;
+	}
+	for ( int i = 0; i < records.Num(); i++ ) {
+		const declScanRecord_t & a = records[i];
+		const declScanRecord_t & b = other.records[i];
+		if ( a.type != b.type || a.textOffset != b.textOffset || a.textLength != b.textLength || a.line != b.line ) {
+			return false;
+		}
+		if ( idStr::Cmp( GetName( i ), other.GetName( i ) ) != 0 ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+========================
+idDeclCache::idDeclCache
+========================
+*/
+idDeclCache::idDeclCache() {
+	buffer = NULL;
+	dirty = false;
+}
+
+/*
+========================
+idDeclCache::~idDeclCache
+========================
+*/
+idDeclCache::~idDeclCache() {
+	Clear();
+}
+
+/*
+========================
+idDeclCache::Clear
+========================
+*/
+void idDeclCache::Clear() {
+	for ( int i = 0; i < entries.Num(); i++ ) {
+		FreeEntry( entries[i] );
+	}
+	entries.Clear();
+	hash.Free();
+	if ( buffer != NULL ) {
+		fileSystem->FreeFile( buffer );
+		buffer = NULL;
+	}
+	cacheFileName.Clear();
+	dirty = false;
+}
+
+/*
+========================
+idDeclCache::FreeEntry
+========================
+*/
+void idDeclCache::FreeEntry( entry_t & entry ) {
+	if ( entry.ownedData != NULL ) {
+		Mem_Free( entry.ownedData );
+		entry.ownedData = NULL;
+	}
+	entry.records = NULL;
+	entry.names = NULL;
+}
+
+/*
+========================
+idDeclCache::FindEntry
+========================
+*/
+int idDeclCache::FindEntry( const char * sourceFile ) const {
+	const int key = hash.GenerateKey( sourceFile, false );
+	for ( int i = hash.First( key ); i != -1; i = hash.Next( i ) ) {
+		if ( entries[i].fileName.Icmp( sourceFile ) == 0 ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+========================
+idDeclCache::Load
+========================
+*/
+void idDeclCache::Load( const char * fileName ) {
+	Clear();
+	cacheFileName = fileName;
+
+	// the cache is a loose file written under fs_basepath and never inside a resource container,
+	// so fs_mapResourceFiles doesn't map it and it is read into one buffer the entries point into
+	void * data = NULL;
+	const int length = fileSystem->ReadFile( cacheFileName, &data );
+	if ( length <= 0 || data == NULL ) {
+		return;
+	}
+	buffer = (byte *)data;
+
+	idDeclCacheReader reader( buffer, length );
+	if ( reader.ReadInt() != DECL_CACHE_MAGIC || reader.ReadInt() != DECL_CACHE_VERSION ) {
+		common->DPrintf( "...ignoring outdated decl cache '%s'\n", cacheFileName.c_str() );
+		fileSystem->FreeFile( buffer );
+		buffer = NULL;
+		return;
+	}
+
+	const int numEntries = reader.ReadInt();
+	if ( numEntries < 0 || numEntries > length ) {
+		reader.Fail();
+	}
+	for ( int i = 0; i < numEntries && reader.IsOK(); i++ ) {
+		const int nameLength = reader.ReadInt();
+		const char * name = (const char *)reader.ReadBlock( nameLength + 1 );
+		if ( name == NULL || nameLength <= 0 || name[nameLength] != '\0' ) {
+			reader.Fail();
+			break;
+		}
+
+		entry_t & entry = entries.Alloc();
+		entry.fileName = name;
+		entry.fileSize = reader.ReadInt();
+		entry.checksum = reader.ReadInt();
+		entry.typesChecksum = reader.ReadInt();
+		entry.numLines = reader.ReadInt();
+		entry.numRecords = reader.ReadInt();
+		entry.namesSize = reader.ReadInt();
+		entry.ownedData = NULL;
+
+		const int maxRecords = length / ( INTS_PER_RECORD * sizeof( int ) );
+		entry.records = (const int *)reader.ReadBlock( entry.numRecords >= 0 && entry.numRecords <= maxRecords ? entry.numRecords * INTS_PER_RECORD * sizeof( int ) : -1 );
+		entry.names = (const char *)reader.ReadBlock( entry.namesSize );
+
+		hash.Add( hash.GenerateKey( entry.fileName, false ), entries.Num() - 1 );
+	}
+
+	if ( !reader.IsOK() || !reader.AtEnd() ) {
+		idLib::Warning( "Decl cache '%s' is corrupt, ignoring it", cacheFileName.c_str() );
+		const idStr name = cacheFileName;
+		Clear();
+		cacheFileName = name;
+		return;
+	}
+
+	common->DPrintf( "...loaded %d entries from decl cache '%s'\n", entries.Num(), cacheFileName.c_str() );
+}
+
+/*
+========================
+idDeclCache::Write
+========================
+*/
+void idDeclCache::Write() {
+	if ( cacheFileName.IsEmpty() ) {
+		return;
+	}
+
+	idFileLocal file( fileSystem->OpenFileWrite( cacheFileName, "fs_basepath" ) );
+	if ( file == NULL ) {
+		idLib::Warning( "Couldn't write decl cache '%s'", cacheFileName.c_str() );
+		return;
+	}
+
+	static const byte padding[4] = { 0, 0, 0, 0 };
+
+	file->WriteInt( DECL_CACHE_MAGIC );
+	file->WriteInt( DECL_CACHE_VERSION );
+	file->WriteInt( entries.Num() );
+	for ( int i = 0; i < entries.Num(); i++ ) {
+		const entry_t & entry = entries[i];
+		const int nameLength = entry.fileName.Length();
+		const int recordsSize = entry.numRecords * INTS_PER_RECORD * sizeof( int );
+
+		file->WriteInt( nameLength );
+		file->Write( entry.fileName.c_str(), nameLength + 1 );
+		file->Write( padding, PadToInt( nameLength + 1 ) - ( nameLength + 1 ) );
+		file->WriteInt( entry.fileSize );
+		file->WriteInt( entry.checksum );
+		file->WriteInt( entry.typesChecksum );
+		file->WriteInt( entry.numLines );
+		file->WriteInt( entry.numRecords );
+		file->WriteInt( entry.namesSize );
+		// records are kept little endian in memory
+		file->Write( entry.records, recordsSize );
+		file->Write( entry.names, entry.namesSize );
+		file->Write( padding, PadToInt( entry.namesSize ) - entry.namesSize );
+	}
+
+	dirty = false;
+}
+
+/*
+========================
+idDeclCache::Find
+========================
+*/
+bool idDeclCache::Find( const char * sourceFile, int fileSize, int checksum, int typesChecksum, idDeclFileScan & scan ) const {
+	const int index = FindEntry( sourceFile );
+	if ( index == -1 ) {
+		return false;
+	}
+
+	const entry_t & entry = entries[index];
+	if ( entry.fileSize != fileSize || entry.checksum != checksum || entry.typesChecksum != typesChecksum ) {
+		return false;
+	}
+	if ( entry.namesSize > 0 && entry.names[ entry.namesSize - 1 ] != '\0' ) {
+		return false;
+	}
+
+	scan.Clear();
+	scan.numLines = entry.numLines;
+	scan.records.SetNum( entry.numRecords );
+
+	const int * src = entry.records;
+	for ( int i = 0; i < entry.numRecords; i++, src += INTS_PER_RECORD ) {
+		declScanRecord_t & record = scan.records[i];
+		record.type = LittleLong( src[0] );
+		record.nameOffset = LittleLong( src[1] );
+		record.textOffset = LittleLong( src[2] );
+		record.textLength = LittleLong( src[3] );
+		record.line = LittleLong( src[4] );
+
+		if ( record.type < 0 || record.type >= declManager->GetNumDeclTypes() ||
+				record.nameOffset < 0 || record.nameOffset >= entry.namesSize ||
+				record.textOffset < 0 || record.textLength < 0 || record.textOffset > fileSize - record.textLength ) {
+			scan.Clear();
+			return false;
+		}
+	}
+
+	scan.names.SetNum( entry.namesSize );
+	if ( entry.namesSize > 0 ) {
+		memcpy( scan.names.Ptr(), entry.names, entry.namesSize );
+	}
+	return true;
+}
+
+/*
+========================
+idDeclCache::Store
+========================
+*/
+void idDeclCache::Store( const char * sourceFile, int fileSize, int checksum, int typesChecksum, const idDeclFileScan & scan ) {
+	int index = FindEntry( sourceFile );
+	if ( index == -1 ) {
+		entry_t & newEntry = entries.Alloc();
+		newEntry.fileName = sourceFile;
+		newEntry.ownedData = NULL;
+		index = entries.Num() - 1;
+		hash.Add( hash.GenerateKey( sourceFile, false ), index );
+	} else {
+		FreeEntry( entries[index] );
+	}
+
+	entry_t & entry = entries[index];
+	entry.fileSize = fileSize;
+	entry.checksum = checksum;
+	entry.typesChecksum = typesChecksum;
+	entry.numLines = scan.numLines;
+	entry.numRecords = scan.Num();
+	entry.namesSize = scan.names.Num();
+
+	const int recordsSize = entry.numRecords * INTS_PER_RECORD * sizeof( int );
+	entry.ownedData = (byte *)Mem_Alloc( Max( recordsSize + entry.namesSize, 1 ), TAG_DECL );
+
+	int * dest = (int *)entry.ownedData;
+	for ( int i = 0; i < scan.Num(); i++, dest += INTS_PER_RECORD ) {
+		const declScanRecord_t & record = scan[i];
+		dest[0] = LittleLong( record.type );
+		dest[1] = LittleLong( record.nameOffset );
+		dest[2] = LittleLong( record.textOffset );
+		dest[3] = LittleLong( record.textLength );
+		dest[4] = LittleLong( record.line );
+	}
+	if ( entry.namesSize > 0 ) {
+		memcpy( entry.ownedData + recordsSize, scan.names.Ptr(), entry.namesSize );
+	}
+
+	entry.records = (const int *)entry.ownedData;
+	entry.names = (const char *)entry.ownedData + recordsSize;
+
+	dirty = true;
+}
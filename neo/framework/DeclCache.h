@@ -0,0 +1,122 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").  
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __DECLCACHE_H__
+#define __DECLCACHE_H__
+
+/*
+===============================================================================
+
+	Binary decl cache.
+
+	Finding the extent of every declaration in a decl file means tokenizing
+	the whole file with idLexer, which is most of the decl manager's startup
+	cost. The cache keeps the result of that scan for each source file, keyed
+	by the size and checksum of the file text, so an unchanged file only has
+	to be read, not tokenized.
+
+	The cache is a single file that is read into memory in one go and used in
+	place. Decl text itself is still taken from the source file, so a stale
+	or missing cache can never change what a decl parses to.
+
+===============================================================================
+*/
+
+// one declaration found by scanning a decl file
+struct declScanRecord_t {
+	int				type;			// declType_t
+	int				nameOffset;		// offset of the decl name in the name pool
+	int				textOffset;		// offset of the decl text in the source file
+	int				textLength;		// length of the decl text in the source file
+	int				line;			// line the declaration starts on
+};
+
+class idDeclFileScan {
+public:
+					idDeclFileScan();
+
+	void			Clear();
+	void			AddRecord( declType_t type, const char * name, int textOffset, int textLength, int line );
+
+	int				Num() const { return records.Num(); }
+	const declScanRecord_t & operator[]( int index ) const { return records[ index ]; }
+	const char *	GetName( int index ) const { return &names[ records[ index ].nameOffset ]; }
+
+	bool			operator==( const idDeclFileScan & other ) const;
+
+public:
+	int				numLines;
+	bool			hadWarnings;	// scans with warnings are not cached so the warnings keep showing
+	idList< declScanRecord_t, TAG_DECL >	records;
+	idList< char, TAG_DECL >				names;	// NUL terminated decl names
+};
+
+class idDeclCache {
+public:
+					idDeclCache();
+					~idDeclCache();
+
+					// Reads the cache file, an invalid or outdated file is silently ignored.
+	void			Load( const char * cacheFileName );
+					// Writes all entries back to the file they were loaded from.
+	void			Write();
+	void			Clear();
+
+					// Fills in scan if there is an entry for the source file with a matching
+					// size and checksum that was scanned with the same set of decl types.
+	bool			Find( const char * sourceFile, int fileSize, int checksum, int typesChecksum, idDeclFileScan & scan ) const;
+	void			Store( const char * sourceFile, int fileSize, int checksum, int typesChecksum, const idDeclFileScan & scan );
+
+	bool			IsDirty() const { return dirty; }
+	int				Num() const { return entries.Num(); }
+
+private:
+	struct entry_t {
+		idStr		fileName;
+		int			fileSize;
+		int			checksum;
+		int			typesChecksum;
+		int			numLines;
+		int			numRecords;
+		int			namesSize;
+		const int *	records;		// numRecords * 5 little endian ints
+		const char *names;			// namesSize bytes
+		byte *		ownedData;		// set if records and names are not in the loaded buffer
+	};
+
+	idStr			cacheFileName;
+	byte *			buffer;			// the loaded cache file
+	idList< entry_t, TAG_DECL >		entries;
+	idHashIndex		hash;
+	bool			dirty;
+
+	int				FindEntry( const char * sourceFile ) const;
+	void			FreeEntry( entry_t & entry );
+};
+
+#endif /* !__DECLCACHE_H__ */
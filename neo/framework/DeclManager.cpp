@@ -29,6 +29,8 @@ If you have questions concerning this license or the applicable additional terms
 #include "../idlib/precompiled.h"
 #pragma hdrstop
 
+#include "DeclCache.h"
+
 /*
 
 GUIs and script remain separately parsed
@@ -64,6 +66,8 @@ missing reload over a previously explicit definition
 #define USE_COMPRESSED_DECLS
 //#define GET_HUFFMAN_FREQUENCIES
 
+#define DECL_CACHE_FILE		"generated/decls.bdcache"
+
 class idDeclType {
 public:
 	idStr						typeName;
@@ -80,6 +84,14 @@ public:
 
 class idDeclFile;
 
+// decl text in the form it is kept in memory
+struct declText_t {
+	char *						textSource;
+	int							textLength;
+	int							compressedLength;
+	int							checksum;
+};
+
 class idDeclLocal : public idDeclBase {
 	friend class idDeclFile;
 	friend class idDeclManagerLocal;
@@ -129,6 +141,9 @@ protected:
 								// Set textSource possible with compression.
 	void						SetTextLocal( const char *text, const int length );
 
+								// Takes over text that was already compressed.
+	void						SetCompressedText( declText_t &declText );
+
 private:
 	idDecl *					self;
 
@@ -153,13 +168,22 @@ private:
 	idDeclLocal *				nextInFile;				// next decl in the decl file
 };
 
+struct declFileLoad_t;
+
 class idDeclFile {
 public:
 								idDeclFile();
 								idDeclFile( const char *fileName, declType_t defaultType );
 
 	void						Reload( bool force );
+	bool						NeedsReload( bool force ) const;
 	int							LoadAndParse();
+	bool						Scan( const char *buffer, int length, idDeclFileScan &scan, bool warnings = true ) const;
+
+								// LoadAndParse in steps, Prepare can run on a job thread
+	void						Read( declFileLoad_t &load );
+	void						Prepare( declFileLoad_t &load ) const;
+	int							Register( declFileLoad_t &load );
 
 public:
 	idStr						fileName;
@@ -173,8 +197,25 @@ public:
 	idDeclLocal *				decls;
 };
 
+// a decl file on its way through idDeclFile::Read, Prepare and Register
+struct declFileLoad_t {
+								declFileLoad_t();
+								~declFileLoad_t();
+
+	idDeclFile *				file;
+	char *						buffer;
+	int							length;
+	int							checksum;
+	bool						cached;			// the scan came from the binary decl cache
+	bool						scanned;		// false if the text couldn't be scanned
+	bool						warningsShown;	// false if the scan ran with warnings disabled
+	idDeclFileScan				scan;
+	idList< declText_t, TAG_DECL >	texts;		// compressed text for each scan record
+};
+
 class idDeclManagerLocal : public idDeclManager {
 	friend class idDeclLocal;
+	friend class idDeclFile;
 
 public:
 	virtual void				Init();
@@ -226,6 +267,9 @@ public:
 
 	void						ConvertPDAsToStrings( const idCmdArgs &args );
 
+	bool						FindCachedScan( const char *fileName, int fileSize, int fileChecksum, idDeclFileScan &scan ) const;
+	void						StoreCachedScan( const char *fileName, int fileSize, int fileChecksum, const idDeclFileScan &scan );
+
 private:
 	idSysMutex					mutex;
 
@@ -242,15 +286,30 @@ private:
 	int							indent;			// for MediaPrint
 	bool						insideLevelLoad;
 
+	idDeclCache					declCache;		// scan results of unchanged decl files
+	int							typesChecksum;	// checksum of the registered decl type names
+	int							numFilesScanned;
+	int							numFilesCached;
+	uint64						loadMicroseconds;
+
 	static idCVar				decl_show;
+	static idCVar				decl_binaryCache;
+	static idCVar				decl_parallelLoad;
 
 private:
+	void						UpdateTypesChecksum();
+	void						WriteDeclCache();
+	void						LoadDeclFiles( const idList< idDeclFile * > &files );
+
 	static void					ListDecls_f( const idCmdArgs &args );
 	static void					ReloadDecls_f( const idCmdArgs &args );
 	static void					TouchDecl_f( const idCmdArgs &args );
+	static void					DeclCacheBenchmark_f( const idCmdArgs &args );
 };
 
 idCVar idDeclManagerLocal::decl_show( "decl_show", "0", CVAR_SYSTEM, "set to 1 to print parses, 2 to also print references", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
+idCVar idDeclManagerLocal::decl_parallelLoad( "decl_parallelLoad", "1", CVAR_SYSTEM | CVAR_BOOL, "scan and compress decl files on the job threads" );
+idCVar idDeclManagerLocal::decl_binaryCache( "decl_binaryCache", "1", CVAR_SYSTEM | CVAR_BOOL | CVAR_INIT, "keep the declarations found in each decl file in " DECL_CACHE_FILE " so unchanged files don't need to be scanned" );
 
 idDeclManagerLocal	declManagerLocal;
 idDeclManager *		declManager = &declManagerLocal;
@@ -472,8 +531,6 @@ int HuffmanCompressText( const char *text, int textLength, byte *compressed, int
 	int i, j;
 	idBitMsg msg;
 
-	totalUncompressedLength += textLength;
-
 	msg.InitWrite( compressed, maxCompressedSize );
 	msg.BeginWriting();
 	for ( i = 0; i < textLength; i++ ) {
@@ -486,11 +543,22 @@ int HuffmanCompressText( const char *text, int textLength, byte *compressed, int
 		}
 	}
 
-	totalCompressedLength += msg.GetSize();
-
 	return msg.GetSize();
 }
 
+/*
+================
+HuffmanCompressedSize
+================
+*/
+int HuffmanCompressedSize( const char *text, int textLength ) {
+	int numBits = 0;
+	for ( int i = 0; i < textLength; i++ ) {
+		numBits += huffmanCodes[(unsigned char)text[i]].numBits;
+	}
+	return ( numBits + 7 ) >> 3;
+}
+
 /*
 ================
 HuffmanDecompressText
@@ -516,6 +584,36 @@ int HuffmanDecompressText( char *text, int textLength, const byte *compressed, i
 	return msg.GetReadCount();
 }
 
+/*
+================
+CompressDeclText
+
+Only reads the huffman tables, so decl files can be prepared on the job threads
+================
+*/
+void CompressDeclText( const char *text, const int length, declText_t &declText ) {
+	declText.checksum = MD5_BlockChecksum( text, length );
+
+#ifdef GET_HUFFMAN_FREQUENCIES
+	for( int i = 0; i < length; i++ ) {
+		huffmanFrequencies[((const unsigned char *)text)[i]]++;
+	}
+#endif
+
+#ifdef USE_COMPRESSED_DECLS
+	const int compressedSize = HuffmanCompressedSize( text, length );
+	declText.textSource = (char *)Mem_Alloc( compressedSize, TAG_DECLTEXT );
+	declText.compressedLength = HuffmanCompressText( text, length, (byte *)declText.textSource, compressedSize );
+	assert( declText.compressedLength == compressedSize );
+#else
+	declText.compressedLength = length;
+	declText.textSource = (char *) Mem_Alloc( length + 1, TAG_DECLTEXT );
+	memcpy( declText.textSource, text, length );
+	declText.textSource[length] = '\0';
+#endif
+	declText.textLength = length;
+}
+
 /*
 ================
 ListHuffmanFrequencies_f
@@ -549,6 +647,46 @@ void ConvertPDAsToStrings_f( const idCmdArgs &args ) {
 ====================================================================================
 */
 
+/*
+================
+declFileLoad_t::declFileLoad_t
+================
+*/
+declFileLoad_t::declFileLoad_t() {
+	file = NULL;
+	buffer = NULL;
+	length = 0;
+	checksum = 0;
+	cached = false;
+	scanned = false;
+	warningsShown = false;
+}
+
+/*
+================
+declFileLoad_t::~declFileLoad_t
+================
+*/
+declFileLoad_t::~declFileLoad_t() {
+	// text of decls that weren't registered
+	for ( int i = 0; i < texts.Num(); i++ ) {
+		Mem_Free( texts[i].textSource );
+	}
+	if ( buffer != NULL ) {
+		fileSystem->FreeFile( buffer );
+	}
+}
+
+/*
+================
+DeclFilePrepareJob
+================
+*/
+static void DeclFilePrepareJob( declFileLoad_t *load ) {
+	load->file->Prepare( *load );
+}
+REGISTER_PARALLEL_JOB( DeclFilePrepareJob, "DeclFilePrepareJob" );
+
 /*
 ================
 idDeclFile::idDeclFile
@@ -587,65 +725,53 @@ ForceReload will cause it to reload even if the timestamp hasn't changed
 ================
 */
 void idDeclFile::Reload( bool force ) {
+	if ( NeedsReload( force ) ) {
+		// parse the text
+		LoadAndParse();
+	}
+}
+
+/*
+================
+idDeclFile::NeedsReload
+================
+*/
+bool idDeclFile::NeedsReload( bool force ) const {
 	// check for an unchanged timestamp
 	if ( !force && timestamp != 0 ) {
 		ID_TIME_T	testTimeStamp;
 		fileSystem->ReadFile( fileName, NULL, &testTimeStamp );
 
 		if ( testTimeStamp == timestamp ) {
-			return;
+			return false;
 		}
 	}
-
-	// parse the text
-	LoadAndParse();
+	return true;
 }
 
 /*
 ================
-idDeclFile::LoadAndParse
+idDeclFile::Scan
 
-This is used during both the initial load, and any reloads
+Finds the type, name and extent of every declaration in the file text
 ================
 */
-int c_savedMemory = 0;
-
-int idDeclFile::LoadAndParse() {
+bool idDeclFile::Scan( const char *buffer, int length, idDeclFileScan &scan, bool warnings ) const {
 	int			i, numTypes;
 	idLexer		src;
 	idToken		token;
 	int			startMarker;
-	char *		buffer;
-	int			length, size;
+	int			size;
 	int			sourceLine;
 	idStr		name;
-	idDeclLocal *newDecl;
-	bool		reparse;
 
-	// load the text
-	common->DPrintf( "...loading '%s'\n", fileName.c_str() );
-	length = fileSystem->ReadFile( fileName, (void **)&buffer, &timestamp );
-	if ( length == -1 ) {
-		common->FatalError( "couldn't load %s", fileName.c_str() );
-		return 0;
-	}
+	scan.Clear();
 
 	if ( !src.LoadMemory( buffer, length, fileName ) ) {
-		common->Error( "Couldn't parse %s", fileName.c_str() );
-		Mem_Free( buffer );
-		return 0;
+		return false;
 	}
 
-	// mark all the defs that were from the last reload of this file
-	for ( idDeclLocal *decl = decls; decl; decl = decl->nextInFile ) {
-		decl->redefinedInReload = false;
-	}
-
-	src.SetFlags( DECL_LEXER_FLAGS );
-
-	checksum = MD5_BlockChecksum( buffer, length );
-
-	fileSize = length;
+	src.SetFlags( DECL_LEXER_FLAGS | ( warnings ? 0 : LEXFL_NOWARNINGS ) );
 
 	// scan through, identifying each individual declaration
 	while( 1 ) {
@@ -675,6 +801,7 @@ int idDeclFile::LoadAndParse() {
 			if ( token.Icmp( "{" ) == 0 ) {
 
 				// if we ever see an open brace, we somehow missed the [type] <name> prefix
+				scan.hadWarnings = true;
 				src.Warning( "Missing decl name" );
 				src.SkipBracedSection( false );
 				continue;
@@ -682,6 +809,7 @@ int idDeclFile::LoadAndParse() {
 			} else {
 
 				if ( defaultType == DECL_MAX_TYPES ) {
+					scan.hadWarnings = true;
 					src.Warning( "No type" );
 					continue;
 				}
@@ -693,12 +821,14 @@ int idDeclFile::LoadAndParse() {
 
 		// now parse the name
 		if ( !src.ReadToken( &token ) ) {
+			scan.hadWarnings = true;
 			src.Warning( "Type without definition at end of file" );
 			break;
 		}
 
 		if ( !token.Icmp( "{" ) ) {
 			// if we ever see an open brace, we somehow missed the [type] <name> prefix
+			scan.hadWarnings = true;
 			src.Warning( "Missing decl name" );
 			src.SkipBracedSection( false );
 			continue;
@@ -714,10 +844,12 @@ int idDeclFile::LoadAndParse() {
 
 		// make sure there's a '{'
 		if ( !src.ReadToken( &token ) ) {
+			scan.hadWarnings = true;
 			src.Warning( "Type without definition at end of file" );
 			break;
 		}
 		if ( token != "{" ) {
+			scan.hadWarnings = true;
 			src.Warning( "Expecting '{' but found '%s'", token.c_str() );
 			continue;
 		}
@@ -727,14 +859,130 @@ int idDeclFile::LoadAndParse() {
 		src.SkipBracedSection();
 		size = src.GetFileOffset() - startMarker;
 
+		scan.AddRecord( identifiedType, name, startMarker, size, sourceLine );
+	}
+
+	scan.numLines = src.GetLineNum();
+	if ( src.HadError() ) {
+		scan.hadWarnings = true;
+	}
+
+	return true;
+}
+
+/*
+================
+idDeclFile::LoadAndParse
+
+This is used during both the initial load, and any reloads
+================
+*/
+int c_savedMemory = 0;
+
+int idDeclFile::LoadAndParse() {
+	declFileLoad_t load;
+	Read( load );
+	Prepare( load );
+	return Register( load );
+}
+
+/*
+================
+idDeclFile::Read
+================
+*/
+void idDeclFile::Read( declFileLoad_t &load ) {
+	common->DPrintf( "...loading '%s'\n", fileName.c_str() );
+
+	load.file = this;
+	load.length = fileSystem->ReadFile( fileName, (void **)&load.buffer, &timestamp );
+	if ( load.length == -1 ) {
+		common->FatalError( "couldn't load %s", fileName.c_str() );
+	}
+}
+
+/*
+================
+idDeclFile::Prepare
+
+Does all the work that doesn't touch the decl lists, so it can run on the job threads
+================
+*/
+void idDeclFile::Prepare( declFileLoad_t &load ) const {
+	load.checksum = MD5_BlockChecksum( load.buffer, load.length );
+
+	// identify each individual declaration, the binary cache can only
+	// skip the scan if it was made from exactly the same text
+	load.cached = declManagerLocal.FindCachedScan( fileName, load.length, load.checksum, load.scan );
+	if ( !load.cached ) {
+		// warnings can only be printed from the main thread, Register rescans if there were any
+		load.warningsShown = idLib::IsMainThread();
+		load.scanned = Scan( load.buffer, load.length, load.scan, load.warningsShown );
+		if ( !load.scanned ) {
+			return;
+		}
+	}
+
+	load.texts.SetNum( load.scan.Num() );
+	for ( int i = 0; i < load.scan.Num(); i++ ) {
+		const declScanRecord_t &record = load.scan[i];
+		CompressDeclText( load.buffer + record.textOffset, record.textLength, load.texts[i] );
+	}
+}
+
+/*
+================
+idDeclFile::Register
+
+Adds the declarations found by Prepare to the decl lists in file order
+================
+*/
+int idDeclFile::Register( declFileLoad_t &load ) {
+	idDeclLocal *newDecl;
+	bool		reparse;
+
+	if ( !load.cached && !load.scanned ) {
+		common->Error( "Couldn't parse %s", fileName.c_str() );
+		return 0;
+	}
+
+	if ( load.scan.hadWarnings && !load.warningsShown ) {
+		// scan again to print the warnings a job thread had to swallow
+		idDeclFileScan warningScan;
+		Scan( load.buffer, load.length, warningScan );
+	}
+
+	if ( load.cached ) {
+		declManagerLocal.numFilesCached++;
+	} else {
+		declManagerLocal.numFilesScanned++;
+		if ( !load.scan.hadWarnings ) {
+			declManagerLocal.StoreCachedScan( fileName, load.length, load.checksum, load.scan );
+		}
+	}
+
+	checksum = load.checksum;
+	fileSize = load.length;
+
+	// mark all the defs that were from the last reload of this file
+	for ( idDeclLocal *decl = decls; decl; decl = decl->nextInFile ) {
+		decl->redefinedInReload = false;
+	}
+
+	const idDeclFileScan &scan = load.scan;
+	for ( int i = 0; i < scan.Num(); i++ ) {
+		const declScanRecord_t &record = scan[i];
+		const declType_t identifiedType = (declType_t)record.type;
+		const char *name = scan.GetName( i );
+
 		// look it up, possibly getting a newly created default decl
 		reparse = false;
 		newDecl = declManagerLocal.FindTypeWithoutParsing( identifiedType, name, false );
 		if ( newDecl ) {
 			// update the existing copy
 			if ( newDecl->sourceFile != this || newDecl->redefinedInReload ) {
-				src.Warning( "%s '%s' previously defined at %s:%i", declManagerLocal.GetDeclNameFromType( identifiedType ),
-								name.c_str(), newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine );
+				common->Warning( "%s(%d) : %s '%s' previously defined at %s:%i", fileName.c_str(), record.line,
+								declManagerLocal.GetDeclNameFromType( identifiedType ), name, newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine );
 				continue;
 			}
 			if ( newDecl->declState != DS_UNPARSED ) {
@@ -749,16 +997,11 @@ int idDeclFile::LoadAndParse() {
 
 		newDecl->redefinedInReload = true;
 
-		if ( newDecl->textSource ) {
-			Mem_Free( newDecl->textSource );
-			newDecl->textSource = NULL;
-		}
-
-		newDecl->SetTextLocal( buffer + startMarker, size );
+		newDecl->SetCompressedText( load.texts[i] );
 		newDecl->sourceFile = this;
-		newDecl->sourceTextOffset = startMarker;
-		newDecl->sourceTextLength = size;
-		newDecl->sourceLine = sourceLine;
+		newDecl->sourceTextOffset = record.textOffset;
+		newDecl->sourceTextLength = record.textLength;
+		newDecl->sourceLine = record.line;
 		newDecl->declState = DS_UNPARSED;
 
 		// if it is currently in use, reparse it immedaitely
@@ -767,9 +1010,7 @@ int idDeclFile::LoadAndParse() {
 		}
 	}
 
-	numLines = src.GetLineNum();
-
-	Mem_Free( buffer );
+	numLines = scan.numLines;
 
 	// any defs that weren't redefinedInReload should now be defaulted
 	for ( idDeclLocal *decl = decls ; decl ; decl = decl->nextInFile ) {
@@ -804,6 +1045,14 @@ void idDeclManagerLocal::Init() {
 	common->Printf( "----- Initializing Decls -----\n" );
 
 	checksum = 0;
+	typesChecksum = 0;
+	numFilesScanned = 0;
+	numFilesCached = 0;
+	loadMicroseconds = 0;
+
+	if ( decl_binaryCache.GetBool() ) {
+		declCache.Load( DECL_CACHE_FILE );
+	}
 
 #ifdef USE_COMPRESSED_DECLS
 	SetupHuffman();
@@ -836,6 +1085,7 @@ void idDeclManagerLocal::Init() {
 
 	cmdSystem->AddCommand( "reloadDecls", ReloadDecls_f, CMD_FL_SYSTEM, "reloads decls" );
 	cmdSystem->AddCommand( "touch", TouchDecl_f, CMD_FL_SYSTEM, "touches a decl" );
+	cmdSystem->AddCommand( "declCacheBenchmark", DeclCacheBenchmark_f, CMD_FL_SYSTEM, "times scanning all decl files against using the binary decl cache" );
 
 	cmdSystem->AddCommand( "listTables", idListDecls_f<DECL_TABLE>, CMD_FL_SYSTEM, "lists tables", idCmdSystem::ArgCompletion_String<listDeclStrings> );
 	cmdSystem->AddCommand( "listMaterials", idListDecls_f<DECL_MATERIAL>, CMD_FL_SYSTEM, "lists materials", idCmdSystem::ArgCompletion_String<listDeclStrings> );
@@ -888,6 +1138,9 @@ void idDeclManagerLocal::Shutdown() {
 	int			i, j;
 	idDeclLocal *decl;
 
+	WriteDeclCache();
+	declCache.Clear();
+
 	// free decls
 	for ( i = 0; i < DECL_MAX_TYPES; i++ ) {
 		for ( j = 0; j < linearLists[i].Num(); j++ ) {
@@ -924,8 +1177,62 @@ idDeclManagerLocal::Reload
 ===================
 */
 void idDeclManagerLocal::Reload( bool force ) {
+	idList< idDeclFile * > files;
 	for ( int i = 0; i < loadedFiles.Num(); i++ ) {
-		loadedFiles[i]->Reload( force );
+		if ( loadedFiles[i]->NeedsReload( force ) ) {
+			files.Append( loadedFiles[i] );
+		}
+	}
+	LoadDeclFiles( files );
+}
+
+/*
+===================
+idDeclManagerLocal::LoadDeclFiles
+
+The files are read here and scanned and compressed on the job threads. Everything
+that touches the decl lists and hash tables is done afterwards in file order, so
+the result is the same as loading the files one by one. Parsing the decls stays
+on demand and on this thread, most decl types look up other decls and media while
+parsing.
+===================
+*/
+void idDeclManagerLocal::LoadDeclFiles( const idList< idDeclFile * > &files ) {
+	if ( files.Num() == 0 ) {
+		return;
+	}
+
+	idList< declFileLoad_t * > loads;
+	loads.SetNum( files.Num() );
+	for ( int i = 0; i < files.Num(); i++ ) {
+		loads[i] = new (TAG_DECL) declFileLoad_t;
+		files[i]->Read( *loads[i] );
+	}
+
+#ifdef GET_HUFFMAN_FREQUENCIES
+	// the frequency counts are not thread safe
+	const bool parallel = false;
+#else
+	const bool parallel = decl_parallelLoad.GetBool() && files.Num() > 1;
+#endif
+
+	if ( parallel ) {
+		idParallelJobList *jobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, loads.Num(), 0, NULL );
+		for ( int i = 0; i < loads.Num(); i++ ) {
+			jobList->AddJob( (jobRun_t)DeclFilePrepareJob, loads[i] );
+		}
+		jobList->Submit( NULL, JOBLIST_PARALLELISM_MAX_CORES );
+		jobList->Wait();
+		parallelJobManager->FreeJobList( jobList );
+	} else {
+		for ( int i = 0; i < loads.Num(); i++ ) {
+			files[i]->Prepare( *loads[i] );
+		}
+	}
+
+	for ( int i = 0; i < loads.Num(); i++ ) {
+		files[i]->Register( *loads[i] );
+		delete loads[i];
 	}
 }
 
@@ -956,6 +1263,9 @@ idDeclManagerLocal::EndLevelLoad
 void idDeclManagerLocal::EndLevelLoad() {
 	insideLevelLoad = false;
 
+	// all decl folders have been registered by now
+	WriteDeclCache();
+
 	// we don't need to do anything here, but the image manager, model manager,
 	// and sound sample manager will need to free media that was not referenced
 }
@@ -982,6 +1292,70 @@ void idDeclManagerLocal::RegisterDeclType( const char *typeName, declType_t type
 		declTypes.AssureSize( (int)type + 1, NULL );
 	}
 	declTypes[type] = declType;
+
+	UpdateTypesChecksum();
+}
+
+/*
+===================
+idDeclManagerLocal::UpdateTypesChecksum
+
+A file scans differently depending on which type names are known,
+so cached scans are only valid for the same set of decl types
+===================
+*/
+void idDeclManagerLocal::UpdateTypesChecksum() {
+	idStr typeNames;
+	for ( int i = 0; i < declTypes.Num(); i++ ) {
+		if ( declTypes[i] != NULL ) {
+			typeNames += va( "%s %d;", declTypes[i]->typeName.c_str(), declTypes[i]->type );
+		}
+	}
+	typesChecksum = MD5_BlockChecksum( typeNames.c_str(), typeNames.Length() );
+}
+
+/*
+===================
+idDeclManagerLocal::FindCachedScan
+===================
+*/
+bool idDeclManagerLocal::FindCachedScan( const char *fileName, int fileSize, int fileChecksum, idDeclFileScan &scan ) const {
+	if ( decl_binaryCache.GetBool() && declCache.Find( fileName, fileSize, fileChecksum, typesChecksum, scan ) ) {
+		int i;
+		for ( i = 0; i < scan.Num(); i++ ) {
+			const int type = scan[i].type;
+			if ( type < 0 || type >= declTypes.Num() || declTypes[type] == NULL || type == DECL_MODELEXPORT ) {
+				break;
+			}
+		}
+		if ( i == scan.Num() ) {
+			return true;
+		}
+		scan.Clear();
+	}
+	return false;
+}
+
+/*
+===================
+idDeclManagerLocal::StoreCachedScan
+===================
+*/
+void idDeclManagerLocal::StoreCachedScan( const char *fileName, int fileSize, int fileChecksum, const idDeclFileScan &scan ) {
+	if ( decl_binaryCache.GetBool() ) {
+		declCache.Store( fileName, fileSize, fileChecksum, typesChecksum, scan );
+	}
+}
+
+/*
+===================
+idDeclManagerLocal::WriteDeclCache
+===================
+*/
+void idDeclManagerLocal::WriteDeclCache() {
+	if ( decl_binaryCache.GetBool() && declCache.IsDirty() ) {
+		declCache.Write();
+	}
 }
 
 /*
@@ -1016,6 +1390,7 @@ void idDeclManagerLocal::RegisterDeclFolder( const char *folder, const char *ext
 	fileList = fileSystem->ListFiles( declFolder->folder, declFolder->extension, true );
 
 	// load and parse decl files
+	idList< idDeclFile * > files;
 	for ( i = 0; i < fileList->GetNumFiles(); i++ ) {
 		fileName = declFolder->folder + "/" + fileList->GetFile( i );
 
@@ -1031,10 +1406,14 @@ void idDeclManagerLocal::RegisterDeclFolder( const char *folder, const char *ext
 			df = new (TAG_DECL) idDeclFile( fileName, defaultType );
 			loadedFiles.Append( df );
 		}
-		df->LoadAndParse();
+		files.Append( df );
 	}
 
 	fileSystem->FreeFileList( fileList );
+
+	const uint64 loadStart = Sys_Microseconds();
+	LoadDeclFiles( files );
+	loadMicroseconds += Sys_Microseconds() - loadStart;
 }
 
 /*
@@ -1717,6 +2096,99 @@ void idDeclManagerLocal::TouchDecl_f( const idCmdArgs &args ) {
 	}
 }
 
+/*
+===================
+idDeclManagerLocal::DeclCacheBenchmark_f
+
+Times identifying the declarations in every loaded decl file by scanning the
+text against looking the scan up in the binary decl cache. Reading the files and
+checksumming them costs the same either way, so both are left out of the timing.
+===================
+*/
+void idDeclManagerLocal::DeclCacheBenchmark_f( const idCmdArgs &args ) {
+	idDeclManagerLocal &dm = declManagerLocal;
+	const int iterations = ( args.Argc() > 1 ) ? Max( atoi( args.Argv( 1 ) ), 1 ) : 10;
+
+	common->Printf( "startup: %d decl files loaded in %d msec, %d scanned, %d from the binary cache (decl_binaryCache %d)\n",
+		dm.numFilesScanned + dm.numFilesCached, (int)( dm.loadMicroseconds / 1000 ), dm.numFilesScanned, dm.numFilesCached, decl_binaryCache.GetInteger() );
+
+	// keep all the decl text in memory for the timed passes
+	idList< char *, TAG_DECL >	buffers;
+	idList< int, TAG_DECL >		lengths;
+	idList< int, TAG_DECL >		checksums;
+	buffers.SetNum( dm.loadedFiles.Num() );
+	lengths.SetNum( dm.loadedFiles.Num() );
+	checksums.SetNum( dm.loadedFiles.Num() );
+
+	idDeclFileScan scan;
+	idDeclFileScan cachedScan;
+	int totalBytes = 0;
+	int numStored = 0;
+	int numMismatched = 0;
+	for ( int i = 0; i < dm.loadedFiles.Num(); i++ ) {
+		const idDeclFile *df = dm.loadedFiles[i];
+		lengths[i] = fileSystem->ReadFile( df->fileName, (void **)&buffers[i] );
+		if ( lengths[i] == -1 ) {
+			buffers[i] = NULL;
+			continue;
+		}
+		checksums[i] = MD5_BlockChecksum( buffers[i], lengths[i] );
+		totalBytes += lengths[i];
+
+		// make sure every file is in the cache, and that the cache agrees with a fresh scan
+		df->Scan( buffers[i], lengths[i], scan, false );
+		if ( dm.declCache.Find( df->fileName, lengths[i], checksums[i], dm.typesChecksum, cachedScan ) ) {
+			if ( !( cachedScan == scan ) ) {
+				common->Warning( "decl cache entry for '%s' doesn't match the file", df->fileName.c_str() );
+				dm.declCache.Store( df->fileName, lengths[i], checksums[i], dm.typesChecksum, scan );
+				numMismatched++;
+			}
+		} else {
+			dm.declCache.Store( df->fileName, lengths[i], checksums[i], dm.typesChecksum, scan );
+			numStored++;
+		}
+	}
+
+	uint64 scanMicroseconds = 0;
+	uint64 cacheMicroseconds = 0;
+	int numRecords = 0;
+	for ( int iteration = 0; iteration < iterations; iteration++ ) {
+		uint64 start = Sys_Microseconds();
+		for ( int i = 0; i < dm.loadedFiles.Num(); i++ ) {
+			if ( buffers[i] != NULL ) {
+				dm.loadedFiles[i]->Scan( buffers[i], lengths[i], scan, false );
+				numRecords += scan.Num();
+			}
+		}
+		scanMicroseconds += Sys_Microseconds() - start;
+
+		start = Sys_Microseconds();
+		for ( int i = 0; i < dm.loadedFiles.Num(); i++ ) {
+			if ( buffers[i] != NULL ) {
+				dm.declCache.Find( dm.loadedFiles[i]->fileName, lengths[i], checksums[i], dm.typesChecksum, cachedScan );
+				numRecords -= cachedScan.Num();
+			}
+		}
+		cacheMicroseconds += Sys_Microseconds() - start;
+	}
+
+	for ( int i = 0; i < buffers.Num(); i++ ) {
+		if ( buffers[i] != NULL ) {
+			fileSystem->FreeFile( buffers[i] );
+		}
+	}
+
+	common->Printf( "%d decl files, %d kB, %d cache entries added, %d mismatched\n", dm.loadedFiles.Num(), totalBytes >> 10, numStored, numMismatched );
+	common->Printf( "scanning text: %6.2f msec per pass\n", scanMicroseconds / ( iterations * 1000.0f ) );
+	common->Printf( "binary cache:  %6.2f msec per pass\n", cacheMicroseconds / ( iterations * 1000.0f ) );
+	if ( cacheMicroseconds > 0 ) {
+		common->Printf( "speedup: %.1fx\n", (float)scanMicroseconds / cacheMicroseconds );
+	}
+	if ( numRecords != 0 ) {
+		common->Warning( "cached passes found a different number of decls" );
+	}
+}
+
 /*
 ===================
 idDeclManagerLocal::FindTypeWithoutParsing
@@ -2118,30 +2590,30 @@ idDeclLocal::SetTextLocal
 =================
 */
 void idDeclLocal::SetTextLocal( const char *text, const int length ) {
+	declText_t declText;
+	CompressDeclText( text, length, declText );
+	SetCompressedText( declText );
+}
 
-	Mem_Free( textSource );
+/*
+=================
+idDeclLocal::SetCompressedText
+=================
+*/
+void idDeclLocal::SetCompressedText( declText_t &declText ) {
 
-	checksum = MD5_BlockChecksum( text, length );
+	Mem_Free( textSource );
 
-#ifdef GET_HUFFMAN_FREQUENCIES
-	for( int i = 0; i < length; i++ ) {
-		huffmanFrequencies[((const unsigned char *)text)[i]]++;
-	}
-#endif
+	textSource = declText.textSource;
+	textLength = declText.textLength;
+	compressedLength = declText.compressedLength;
+	checksum = declText.checksum;
+	declText.textSource = NULL;
 
 #ifdef USE_COMPRESSED_DECLS
-	int maxBytesPerCode = ( maxHuffmanBits + 7 ) >> 3;
-	byte *compressed = (byte *)_alloca( length * maxBytesPerCode );
-	compressedLength = HuffmanCompressText( text, length, compressed, length * maxBytesPerCode );
-	textSource = (char *)Mem_Alloc( compressedLength, TAG_DECLTEXT );
-	memcpy( textSource, compressed, compressedLength );
-#else
-	compressedLength = length;
-	textSource = (char *) Mem_Alloc( length + 1, TAG_DECLTEXT );
-	memcpy( textSource, text, length );
-	textSource[length] = '\0';
+	totalUncompressedLength += textLength;
+	totalCompressedLength += compressedLength;
 #endif
-	textLength = length;
 }
 
 /*
@@ -31,6 +31,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "Unzip.h"
 #include "Zip.h"
+#include "File_Prefetch.h"
 
 #ifdef WIN32
 	#include <io.h>	// for _read
@@ -215,6 +216,7 @@ public:
 	static void				ExtractResourceFile_f( const idCmdArgs &args );
 	static void				UpdateResourceFile_f( const idCmdArgs &args );
 	static void				GenerateResourceCRCs_f( const idCmdArgs &args );
+	static void				PrefetchStats_f( const idCmdArgs &args );
 	static void				CreateCRCsForResourceFileList( const idFileList & list );
 
 	void					BuildOrderedStartupContainer();
@@ -243,6 +245,10 @@ private:
 	int		resourceBufferAvailable;
 	int		numFilesOpenedAsCached;
 
+	idFilePrefetchQueue		prefetchQueue;
+	idSysMutex				resourceBufferLock;		// claiming the level load buffer
+	idSysMutex				resourceReadLock;		// seek and read on a container handle
+
 private:
 
 	// .resource file creation
@@ -288,6 +294,7 @@ idCVar  idFileSystemLocal::fs_game_base( "fs_game_base", "", CVAR_SYSTEM | CVAR_
 idCVar	fs_basepath( "fs_basepath", "", CVAR_SYSTEM | CVAR_INIT, "" );
 idCVar	fs_savepath( "fs_savepath", "", CVAR_SYSTEM | CVAR_INIT, "" );
 idCVar	fs_resourceLoadPriority( "fs_resourceLoadPriority", "1", CVAR_SYSTEM , "if 1, open requests will be honored from resource files first; if 0, the resource files are checked after normal search paths" );
+idCVar	fs_mapResourceFiles( "fs_mapResourceFiles", "0", CVAR_SYSTEM | CVAR_BOOL | CVAR_INIT, "memory map resource files and read inner resources directly from the mapping" );
 idCVar	fs_enableBackgroundCaching( "fs_enableBackgroundCaching", "1", CVAR_SYSTEM , "if 1 allow the 360 to precache game files in the background" );
 
 idFileSystemLocal	fileSystemLocal;
@@ -299,6 +306,8 @@ idFileSystemLocal::ReadFromBGL
 ================
 */
 int idFileSystemLocal::ReadFromBGL( idFile *_resourceFile, void * _buffer, int _offset, int _len ) {
+	// the container handles are shared by every thread that opens resources
+	idScopedCriticalSection lock( resourceReadLock );
 	if ( _resourceFile->Tell() != _offset ) {
 		_resourceFile->Seek( _offset, FS_SEEK_SET );
 	}
@@ -311,6 +320,41 @@ idFileSystemLocal::StartPreload
 ================
 */
 void idFileSystemLocal::StartPreload( const idStrList & _preload ) {
+	if ( resourceFiles.Num() == 0 ) {
+		return;
+	}
+
+	idList< filePrefetch_t * > entries;
+	entries.Resize( _preload.Num() );
+	idList< bool > containerUsed;
+	containerUsed.AssureSize( resourceFiles.Num(), false );
+
+	idResourceCacheEntry rc;
+	for ( int i = 0; i < _preload.Num(); i++ ) {
+		if ( !GetResourceCacheEntry( _preload[ i ], rc ) || rc.length <= 0 ) {
+			continue;
+		}
+		filePrefetch_t * entry = new (TAG_IDFILE) filePrefetch_t;
+		entry->fileName = rc.filename;
+		entry->containerIndex = rc.containerIndex;
+		entry->offset = rc.offset;
+		entry->length = rc.length;
+		entry->buffer = NULL;
+		entries.Append( entry );
+		containerUsed[ rc.containerIndex ] = true;
+	}
+
+	// the prefetch threads open their own handles, the containers' handles belong to the main thread
+	idList< prefetchSource_t > sources;
+	sources.SetNum( resourceFiles.Num() );
+	for ( int i = 0; i < resourceFiles.Num(); i++ ) {
+		sources[ i ].mapping = containerUsed[ i ] ? resourceFiles[ i ]->GetMapping() : NULL;
+		if ( containerUsed[ i ] && sources[ i ].mapping == NULL ) {
+			sources[ i ].fileName = resourceFiles[ i ]->GetFileName();
+		}
+	}
+
+	prefetchQueue.Start( entries, sources );
 }
 
 /*
@@ -319,6 +363,13 @@ idFileSystemLocal::StopPreload
 ================
 */
 void idFileSystemLocal::StopPreload() {
+	if ( !prefetchQueue.IsActive() ) {
+		return;
+	}
+	prefetchQueue.Stop();
+	if ( fs_debug.GetBool() ) {
+		prefetchQueue.PrintStats();
+	}
 }
 
 /*
@@ -597,7 +648,11 @@ void idFileSystemLocal::BeginLevelLoad( const char *name, char *_blockBuffer, in
 	manifestName.StripPath();
 	
 	if ( resourceFiles.Num() > 0 ) {
-		AddResourceFile( va( "%s.resources", manifestName.c_str() ) );
+		const int index = AddResourceFile( va( "%s.resources", manifestName.c_str() ) );
+		if ( index >= 0 ) {
+			// everything in the map container is about to be read, have the OS start on it
+			resourceFiles[ index ]->Advise( FILEMAP_ADVICE_WILLNEED );
+		}
 	}
 
 }
@@ -667,6 +722,12 @@ void idFileSystemLocal::EndLevelLoad() {
 
 	EnableBackgroundCache( true );
 
+	StopPreload();
+
+	for ( int i = 0; i < resourceFiles.Num(); i++ ) {
+		resourceFiles[ i ]->Advise( FILEMAP_ADVICE_NORMAL );
+	}
+
 	resourceBufferPtr = NULL;
 	resourceBufferAvailable = 0;
 	resourceBufferSize = 0;
@@ -1679,7 +1740,7 @@ int idFileSystemLocal::ReadFile( const char *relativePath, void **buffer, ID_TIM
 	} 
 
 	if ( buffer == NULL && timestamp != NULL && resourceFiles.Num() > 0 ) {
-		static idResourceCacheEntry rc;
+		idResourceCacheEntry rc;
 		int size = 0;
 		if ( GetResourceCacheEntry( relativePath, rc ) ) {
 			*timestamp = 0;
@@ -2281,6 +2342,15 @@ void idFileSystemLocal::Path_f( const idCmdArgs &args ) {
 	}
 }
 
+/*
+============
+idFileSystemLocal::PrefetchStats_f
+============
+*/
+void idFileSystemLocal::PrefetchStats_f( const idCmdArgs &args ) {
+	fileSystemLocal.prefetchQueue.PrintStats();
+}
+
 /*
 ============
 idFileSystemLocal::TouchFile_f
@@ -2656,6 +2726,7 @@ void idFileSystemLocal::Startup() {
 	cmdSystem->AddCommand( "updateResourceFile", UpdateResourceFile_f, CMD_FL_SYSTEM, "updates or appends the supplied files in the supplied resource file" );
 
 	cmdSystem->AddCommand( "generateResourceCRCs", GenerateResourceCRCs_f, CMD_FL_SYSTEM, "Generates CRC checksums for all the resource files." );
+	cmdSystem->AddCommand( "prefetchStats", PrefetchStats_f, CMD_FL_SYSTEM, "shows how much of the last level load was prefetched" );
 
 	// print the current search paths
 	Path_f( idCmdArgs() );
@@ -2732,6 +2803,7 @@ void idFileSystemLocal::Shutdown( bool reloading ) {
 	gameFolder.Clear();
 	searchPaths.Clear();
 
+	prefetchQueue.Shutdown();
 	resourceFiles.DeleteContents();
 
 
@@ -2810,18 +2882,31 @@ idFile * idFileSystemLocal::GetResourceFile( const char *fileName, bool memFile
 		return NULL;
 	}
 
-	static idResourceCacheEntry rc;
+	// level loading opens files from job threads, so nothing here may be static
+	idResourceCacheEntry rc;
 	if ( GetResourceCacheEntry( fileName, rc ) ) {
 		if ( fs_debugResources.GetBool() ) {
 			idLib::Printf( "RES: loading file %s\n", rc.filename.c_str() );
 		}
+		idFile * prefetched = prefetchQueue.Claim( rc.filename );
+		if ( prefetched != NULL ) {
+			return prefetched;
+		}
+		// a mapped container hands out a read only view, no copy or seek is needed
+		idFile * mapped = resourceFiles[ rc.containerIndex ]->OpenMappedFile( rc.filename, rc.offset, rc.length );
+		if ( mapped != NULL ) {
+			return mapped;
+		}
 		idFile_InnerResource *file = new idFile_InnerResource( rc.filename, resourceFiles[ rc.containerIndex ]->resourceFile, rc.offset, rc.length );
 		if ( file != NULL && ( memFile || rc.length <= resourceBufferAvailable ) || rc.length < 8 * 1024 * 1024 ) {
 			byte *buf = NULL;
+			resourceBufferLock.Lock();
 			if ( rc.length < resourceBufferAvailable ) {
 				buf = resourceBufferPtr;
 				resourceBufferAvailable = 0;
-			} else {
+			}
+			resourceBufferLock.Unlock();
+			if ( buf == NULL ) {
 		if ( fs_debugResources.GetBool() ) {
 				idLib::Printf( "MEM: Allocating %05d bytes for a resource load\n", rc.length );
 }
@@ -29,6 +29,8 @@ If you have questions concerning this license or the applicable additional terms
 #include "../idlib/precompiled.h"
 #pragma hdrstop
 
+#include "../renderer/Image.h"
+
 
 /*
 ================================================================================================
@@ -59,6 +61,63 @@ delete inFile;
 	return false;
 }
 
+/*
+========================
+idPreloadManifest::GetGeneratedFileNames
+
+Mirrors the names the loading code builds for each resource type.
+========================
+*/
+void idPreloadManifest::GetGeneratedFileNames( idStrList & list ) const {
+	list.Resize( list.Num() + entries.Num() );
+	idStr fileName;
+	idStr imageName;
+	idStr ext;
+	for ( int i = 0; i < entries.Num(); i++ ) {
+		const preloadEntry_s & p = entries[ i ];
+		switch ( p.resType ) {
+			case PRELOAD_IMAGE:
+				// same as idImage::ActuallyLoadImage
+				imageName = p.resourceName;
+				idImage::GetGeneratedName( imageName, ( textureUsage_t )p.imgData.usage, ( cubeFiles_t )p.imgData.cubeMap );
+				idBinaryImage::GetGeneratedFileName( fileName, imageName );
+				break;
+			case PRELOAD_MODEL:
+				fileName = "generated/rendermodels/";
+				fileName += p.resourceName;
+				fileName.ExtractFileExtension( ext );
+				fileName.SetFileExtension( va( "b%s", ext.c_str() ) );
+				break;
+			case PRELOAD_SAMPLE:
+				if ( p.resourceName.Find( "/vo/", false ) >= 0 ) {
+					continue;
+				}
+				fileName = "generated/";
+				fileName += p.resourceName;
+				fileName.SetFileExtension( "idwav" );
+				break;
+			case PRELOAD_ANIM:
+				fileName = "generated/anim/";
+				fileName.AppendPath( p.resourceName );
+				fileName.SetFileExtension( ".bMD5anim" );
+				break;
+			case PRELOAD_COLLISION:
+				fileName = "generated/collision/";
+				fileName.AppendPath( p.resourceName );
+				fileName.SetFileExtension( "bcmodel" );
+				break;
+			case PRELOAD_PARTICLE:
+				fileName = "generated/particles/";
+				fileName += p.resourceName;
+				fileName += ".bprt";
+				break;
+			default:
+				continue;
+		}
+		list.Append( fileName );
+	}
+}
+
 /*
 ================================================================================================
 
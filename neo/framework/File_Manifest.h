@@ -263,6 +263,9 @@ public:
 		return -1;
 	}
 
+	// names of the generated files the entries are loaded from
+	void GetGeneratedFileNames( idStrList & list ) const;
+
 	void Print() {
 		idLib::Printf( "dump for preload manifest %s\n", GetManifestName() );
 		idLib::Printf( "---------------------------------------\n" );
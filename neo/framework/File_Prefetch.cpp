@@ -0,0 +1,388 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").  
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#pragma hdrstop
+#include "../idlib/precompiled.h"
+
+#include "File_Prefetch.h"
+
+idCVar fs_prefetchThreads( "fs_prefetchThreads", "2", CVAR_SYSTEM | CVAR_INTEGER, "number of threads reading the preload manifest ahead of level loading, 0 disables prefetching", 0, 4 );
+idCVar fs_prefetchMemory( "fs_prefetchMemory", "64", CVAR_SYSTEM | CVAR_INTEGER, "megabytes of prefetched data that may wait to be opened" );
+
+class idSort_PrefetchOffset : public idSort_Quick< filePrefetch_t *, idSort_PrefetchOffset > {
+public:
+	int Compare( filePrefetch_t * const & a, filePrefetch_t * const & b ) const {
+		if ( a->containerIndex != b->containerIndex ) {
+			return a->containerIndex - b->containerIndex;
+		}
+		// the offsets can be too far apart to subtract
+		if ( a->offset != b->offset ) {
+			return ( a->offset < b->offset ) ? -1 : 1;
+		}
+		return 0;
+	}
+};
+
+/*
+================================================
+idFilePrefetchThread
+================================================
+*/
+class idFilePrefetchThread : public idSysThread {
+public:
+						idFilePrefetchThread( idFilePrefetchQueue * queue_, int threadNum_ ) : queue( queue_ ), threadNum( threadNum_ ) {}
+
+	virtual int			Run() {
+		queue->Process( threadNum );
+		return 0;
+	}
+
+private:
+	idFilePrefetchQueue *	queue;
+	int						threadNum;
+};
+
+/*
+========================
+idFilePrefetchQueue::idFilePrefetchQueue
+========================
+*/
+idFilePrefetchQueue::idFilePrefetchQueue() :
+	active( false ),
+	stopping( false ),
+	numThreads( 0 ) {
+	memset( threads, 0, sizeof( threads ) );
+	memset( &stats, 0, sizeof( stats ) );
+}
+
+/*
+========================
+idFilePrefetchQueue::~idFilePrefetchQueue
+========================
+*/
+idFilePrefetchQueue::~idFilePrefetchQueue() {
+	Shutdown();
+}
+
+/*
+========================
+idFilePrefetchQueue::Start
+
+Takes ownership of the entries and the mapping references of the sources.
+========================
+*/
+void idFilePrefetchQueue::Start( idList< filePrefetch_t * > & newEntries, const idList< prefetchSource_t > & newSources ) {
+	Stop();
+
+	const int wantThreads = fs_prefetchThreads.GetInteger();
+	if ( wantThreads <= 0 || newEntries.Num() == 0 ) {
+		newEntries.DeleteContents();
+		for ( int i = 0; i < newSources.Num(); i++ ) {
+			if ( newSources[i].mapping != NULL ) {
+				newSources[i].mapping->Release();
+			}
+		}
+		return;
+	}
+
+	entries = newEntries;
+	newEntries.Clear();
+	sources = newSources;
+
+	// read in file order so the reads are sequential on disk
+	entries.SortWithTemplate( idSort_PrefetchOffset() );
+
+	memset( &stats, 0, sizeof( stats ) );
+	entryHash.Clear( 4096, entries.Num() );
+	for ( int i = 0; i < entries.Num(); i++ ) {
+		entryHash.Add( entryHash.GenerateKey( entries[i]->fileName, false ), i );
+		stats.bytesQueued += entries[i]->length;
+	}
+	stats.numFiles = entries.Num();
+
+	nextEntry.SetValue( 0 );
+	bytesBuffered.SetValue( 0 );
+	stopping = false;
+	active = true;
+
+	for ( ; numThreads < Min( wantThreads, MAX_PREFETCH_THREADS ); numThreads++ ) {
+		threads[numThreads] = new (TAG_IDFILE) idFilePrefetchThread( this, numThreads );
+		threads[numThreads]->StartWorkerThread( va( "FilePrefetch%d", numThreads ), CORE_ANY, THREAD_BELOW_NORMAL );
+	}
+
+	// the file system isn't safe to use from the prefetch threads, so their handles are opened here
+	const int useThreads = Min( wantThreads, numThreads );
+	for ( int t = 0; t < useThreads; t++ ) {
+		threadFiles[t].AssureSize( sources.Num(), NULL );
+		for ( int i = 0; i < sources.Num(); i++ ) {
+			if ( sources[i].mapping == NULL && sources[i].fileName.Length() > 0 ) {
+				threadFiles[t][i] = fileSystem->OpenFileRead( sources[i].fileName );
+			}
+		}
+	}
+	for ( int i = 0; i < useThreads; i++ ) {
+		threads[i]->SignalWork();
+	}
+}
+
+/*
+========================
+idFilePrefetchQueue::Stop
+
+Waits for the prefetch threads and frees everything that was not opened.
+========================
+*/
+void idFilePrefetchQueue::Stop() {
+	if ( !active ) {
+		return;
+	}
+
+	stopping = true;
+	bufferReleased.Raise();
+	for ( int i = 0; i < numThreads; i++ ) {
+		threads[i]->WaitForThread();
+	}
+
+	for ( int i = 0; i < entries.Num(); i++ ) {
+		filePrefetch_t * entry = entries[i];
+		if ( entry->state.GetValue() == PREFETCH_DONE ) {
+			stats.bytesUnused += entry->length;
+		}
+		Mem_Free( entry->buffer );
+	}
+	entries.DeleteContents( true );
+	entryHash.Free();
+
+	CloseFiles();
+	for ( int i = 0; i < sources.Num(); i++ ) {
+		if ( sources[i].mapping != NULL ) {
+			sources[i].mapping->Release();
+		}
+	}
+	sources.Clear();
+
+	active = false;
+}
+
+/*
+========================
+idFilePrefetchQueue::CloseFiles
+========================
+*/
+void idFilePrefetchQueue::CloseFiles() {
+	for ( int t = 0; t < MAX_PREFETCH_THREADS; t++ ) {
+		for ( int i = 0; i < threadFiles[t].Num(); i++ ) {
+			delete threadFiles[t][i];
+		}
+		threadFiles[t].Clear();
+	}
+}
+
+/*
+========================
+idFilePrefetchQueue::Shutdown
+========================
+*/
+void idFilePrefetchQueue::Shutdown() {
+	Stop();
+	for ( int i = 0; i < numThreads; i++ ) {
+		threads[i]->StopThread();
+		delete threads[i];
+		threads[i] = NULL;
+	}
+	numThreads = 0;
+}
+
+/*
+========================
+idFilePrefetchQueue::FindEntry
+========================
+*/
+filePrefetch_t * idFilePrefetchQueue::FindEntry( const char * fileName ) {
+	const int key = entryHash.GenerateKey( fileName, false );
+	for ( int i = entryHash.First( key ); i != -1; i = entryHash.Next( i ) ) {
+		if ( entries[i]->fileName.Icmp( fileName ) == 0 ) {
+			return entries[i];
+		}
+	}
+	return NULL;
+}
+
+/*
+========================
+idFilePrefetchQueue::Claim
+========================
+*/
+idFile * idFilePrefetchQueue::Claim( const char * fileName ) {
+	if ( !active ) {
+		return NULL;
+	}
+	filePrefetch_t * entry = FindEntry( fileName );
+	if ( entry == NULL ) {
+		return NULL;
+	}
+
+	// take it away from the prefetch threads if they haven't started on it yet
+	int state = entry->state.CompareExchange( PREFETCH_QUEUED, PREFETCH_CLAIMED );
+	if ( state == PREFETCH_QUEUED ) {
+		idScopedCriticalSection lock( statsLock );
+		stats.bytesMissed += entry->length;
+		return NULL;
+	}
+
+	bool stalled = false;
+	if ( state == PREFETCH_READING ) {
+		const uint64 stallStart = Sys_Microseconds();
+		while ( entry->state.GetValue() == PREFETCH_READING ) {
+			entryDone.Wait( 1 );
+		}
+		stalled = true;
+		idScopedCriticalSection lock( statsLock );
+		stats.stallMicroseconds += (int)( Sys_Microseconds() - stallStart );
+	}
+
+	// the file may be opened more than once, only the first open gets the buffer
+	if ( entry->state.CompareExchange( PREFETCH_DONE, PREFETCH_CLAIMED ) != PREFETCH_DONE ) {
+		return NULL;
+	}
+
+	{
+		idScopedCriticalSection lock( statsLock );
+		if ( stalled ) {
+			stats.bytesStalled += entry->length;
+		} else {
+			stats.bytesPrefetched += entry->length;
+		}
+	}
+
+	if ( entry->buffer == NULL ) {
+		// memory mapped, the pages are resident now
+		return NULL;
+	}
+
+	idFile_Memory * file = new (TAG_IDFILE) idFile_Memory( entry->fileName, (const char *)entry->buffer, entry->length );
+	file->TakeDataOwnership();
+	entry->buffer = NULL;
+	bytesBuffered.Sub( entry->length );
+	bufferReleased.Raise();
+	return file;
+}
+
+/*
+========================
+idFilePrefetchQueue::ReadEntry
+========================
+*/
+void idFilePrefetchQueue::ReadEntry( filePrefetch_t * entry, idFile * file ) {
+	const prefetchSource_t & source = sources[entry->containerIndex];
+
+	if ( source.mapping != NULL ) {
+		// touch every page so the loading code doesn't fault on them
+		const byte * data = source.mapping->GetData() + entry->offset;
+		volatile byte sum = 0;
+		for ( int i = 0; i < entry->length; i += 4096 ) {
+			sum += data[i];
+		}
+		return;
+	}
+
+	if ( file == NULL ) {
+		return;
+	}
+
+	byte * buffer = (byte *)Mem_Alloc( entry->length, TAG_IDFILE );
+	file->Seek( entry->offset, FS_SEEK_SET );
+	const int read = file->Read( buffer, entry->length );
+
+	if ( read != entry->length ) {
+		Mem_Free( buffer );
+		return;
+	}
+	entry->buffer = buffer;
+}
+
+/*
+========================
+idFilePrefetchQueue::Process
+========================
+*/
+void idFilePrefetchQueue::Process( int threadNum ) {
+	const int maxBuffered = fs_prefetchMemory.GetInteger() * 1024 * 1024;
+
+	while ( !stopping ) {
+		const int index = nextEntry.Increment() - 1;
+		if ( index >= entries.Num() ) {
+			break;
+		}
+		filePrefetch_t * entry = entries[index];
+
+		const bool mapped = ( sources[entry->containerIndex].mapping != NULL );
+		if ( !mapped ) {
+			// don't run too far ahead of the loading code
+			while ( !stopping && bytesBuffered.GetValue() > 0 && bytesBuffered.GetValue() + entry->length > maxBuffered ) {
+				bufferReleased.Wait( 10 );
+			}
+		}
+
+		if ( entry->state.CompareExchange( PREFETCH_QUEUED, PREFETCH_READING ) != PREFETCH_QUEUED ) {
+			continue;
+		}
+
+		idFile * file = ( entry->containerIndex < threadFiles[threadNum].Num() ) ? threadFiles[threadNum][entry->containerIndex] : NULL;
+		ReadEntry( entry, file );
+		if ( entry->buffer != NULL ) {
+			bytesBuffered.Add( entry->length );
+		}
+
+		if ( entry->buffer == NULL && !mapped ) {
+			// the read failed, let the loading code read it
+			entry->state.SetValue( PREFETCH_CLAIMED );
+		} else {
+			entry->state.SetValue( PREFETCH_DONE );
+		}
+		entryDone.Raise();
+	}
+}
+
+/*
+========================
+idFilePrefetchQueue::PrintStats
+========================
+*/
+void idFilePrefetchQueue::PrintStats() const {
+	const int64 handedOver = stats.bytesPrefetched + stats.bytesStalled + stats.bytesMissed;
+	const float scale = 1.0f / ( 1024.0f * 1024.0f );
+	idLib::Printf( "%d files, %.1f MB queued%s\n", stats.numFiles, stats.bytesQueued * scale, active ? " (active)" : "" );
+	idLib::Printf( "%8.1f MB prefetched\n", stats.bytesPrefetched * scale );
+	idLib::Printf( "%8.1f MB stalled, waited %.1f msec\n", stats.bytesStalled * scale, stats.stallMicroseconds * 0.001f );
+	idLib::Printf( "%8.1f MB missed\n", stats.bytesMissed * scale );
+	idLib::Printf( "%8.1f MB unused\n", stats.bytesUnused * scale );
+	if ( handedOver > 0 ) {
+		idLib::Printf( "%.1f%% of the opened bytes were ready\n", 100.0f * stats.bytesPrefetched / handedOver );
+	}
+}
@@ -0,0 +1,124 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").  
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __FILE_PREFETCH_H__
+#define __FILE_PREFETCH_H__
+
+/*
+==============================================================
+
+  Background prefetching of resource files.
+
+  A level's preload manifest lists most of the files that will be opened during the load.
+  The prefetch queue sorts them by container and offset and reads them ahead of the loading
+  code on a small pool of threads. When the file is opened the prefetched buffer is handed
+  over instead of reading it again. Entries of memory mapped containers are only paged in,
+  the loading code keeps reading them straight from the mapping.
+
+==============================================================
+*/
+
+enum prefetchState_t {
+	PREFETCH_QUEUED,
+	PREFETCH_READING,
+	PREFETCH_DONE,
+	PREFETCH_CLAIMED
+};
+
+struct filePrefetch_t {
+	idStrStatic< MAX_OSPATH >	fileName;
+	int							containerIndex;
+	int							offset;
+	int							length;
+	byte *						buffer;		// stays NULL for memory mapped containers
+	idSysInterlockedInteger		state;
+};
+
+// where the prefetch threads read the entries of one container from
+struct prefetchSource_t {
+	idResourceMapping *	mapping;		// the container mapping if there is one, the queue holds a reference
+	idStr				fileName;		// otherwise each prefetch thread opens its own handle on this
+};
+
+struct prefetchStats_t {
+	int					numFiles;
+	int64				bytesQueued;
+	int64				bytesPrefetched;	// handed over without waiting
+	int64				bytesStalled;		// handed over after waiting on the read
+	int64				bytesMissed;		// opened before a prefetch thread got to them
+	int64				bytesUnused;		// prefetched but never opened
+	int					stallMicroseconds;
+};
+
+class idFilePrefetchThread;
+
+class idFilePrefetchQueue {
+public:
+						idFilePrefetchQueue();
+						~idFilePrefetchQueue();
+
+	void				Start( idList< filePrefetch_t * > & entries, const idList< prefetchSource_t > & sources );
+	void				Stop();
+	void				Shutdown();
+
+	bool				IsActive() const { return active; }
+
+	// Returns the prefetched contents of the file or NULL if it has to be read normally.
+	// Waits if a prefetch thread is reading the file.
+	idFile *			Claim( const char * fileName );
+
+	void				PrintStats() const;
+	const prefetchStats_t &	GetStats() const { return stats; }
+
+	// called from the prefetch threads
+	void				Process( int threadNum );
+
+private:
+	static const int	MAX_PREFETCH_THREADS = 4;
+
+	bool				active;
+	bool				stopping;
+	idList< filePrefetch_t * >	entries;		// sorted by container and offset
+	idHashIndex			entryHash;
+	idList< prefetchSource_t >	sources;
+	idList< idFile * >	threadFiles[MAX_PREFETCH_THREADS];	// a private handle per thread and container, so the reads don't wait on each other
+	idSysInterlockedInteger	nextEntry;
+	idSysInterlockedInteger	bytesBuffered;
+	idSysSignal			entryDone;
+	idSysSignal			bufferReleased;
+	idFilePrefetchThread *	threads[MAX_PREFETCH_THREADS];
+	int					numThreads;
+	prefetchStats_t		stats;
+	idSysMutex			statsLock;
+
+	void				ReadEntry( filePrefetch_t * entry, idFile * file );
+	void				CloseFiles();
+	filePrefetch_t *	FindEntry( const char * fileName );
+};
+
+#endif /* !__FILE_PREFETCH_H__ */
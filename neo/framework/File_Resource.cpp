@@ -29,6 +29,77 @@ If you have questions concerning this license or the applicable additional terms
 #include "../idlib/precompiled.h"
 #pragma hdrstop
 
+extern idCVar fs_mapResourceFiles;
+
+/*
+================================================================================================
+
+idResourceMapping
+
+================================================================================================
+*/
+
+/*
+========================
+idResourceMapping::idResourceMapping
+
+The creator holds the first reference.
+========================
+*/
+idResourceMapping::idResourceMapping( const byte * data_, int length_ ) {
+	data = data_;
+	length = length_;
+	refCount.SetValue( 1 );
+}
+
+/*
+========================
+idResourceMapping::~idResourceMapping
+========================
+*/
+idResourceMapping::~idResourceMapping() {
+	Sys_UnmapFile( data, length );
+}
+
+/*
+========================
+idResourceMapping::Release
+========================
+*/
+void idResourceMapping::Release() {
+	if ( refCount.Decrement() == 0 ) {
+		delete this;
+	}
+}
+
+/*
+================================================================================================
+
+idFile_MappedResource
+
+================================================================================================
+*/
+
+/*
+========================
+idFile_MappedResource::idFile_MappedResource
+========================
+*/
+idFile_MappedResource::idFile_MappedResource( const char * name, idResourceMapping * mapping_, int offset, int length ) :
+	idFile_Memory( name, ( const char * )mapping_->GetData() + offset, length ) {
+	mapping = mapping_;
+	mapping->AddRef();
+}
+
+/*
+========================
+idFile_MappedResource::~idFile_MappedResource
+========================
+*/
+idFile_MappedResource::~idFile_MappedResource() {
+	mapping->Release();
+}
+
 /*
 ================================================================================================
 
@@ -43,8 +114,95 @@ idResourceContainer::ReOpen
 ========================
 */ 
 void idResourceContainer::ReOpen() {
+	Unmap();
 	delete resourceFile;
 	resourceFile = fileSystem->OpenFileRead( fileName );
+	Map();
+}
+
+/*
+========================
+idResourceContainer::Map
+
+Maps the whole container read only, so inner resources can be read without seeking and
+copying through the file handle. Falls back to normal reads if the file can't be mapped.
+========================
+*/
+void idResourceContainer::Map() {
+	if ( !fs_mapResourceFiles.GetBool() || resourceFile == NULL ) {
+		return;
+	}
+	idFile_Permanent * file = dynamic_cast< idFile_Permanent * >( resourceFile );
+	if ( file == NULL ) {
+		return;
+	}
+	const int length = file->Length();
+	const byte * data = (const byte *)Sys_MapFile( file->GetFilePtr(), length );
+	if ( data == NULL ) {
+		idLib::Warning( "Unable to memory map resource file %s", file->GetName() );
+		return;
+	}
+	mapping = new (TAG_RESOURCE) idResourceMapping( data, length );
+}
+
+/*
+========================
+idResourceContainer::Unmap
+========================
+*/
+void idResourceContainer::Unmap() {
+	// files still reading from the mapping keep it alive
+	if ( mapping != NULL ) {
+		mapping->Release();
+		mapping = NULL;
+	}
+}
+
+/*
+========================
+idResourceContainer::GetMappedData
+========================
+*/
+const byte * idResourceContainer::GetMappedData( int offset, int length ) const {
+	if ( mapping == NULL || offset < 0 || length < 0 || offset > mapping->GetLength() - length ) {
+		return NULL;
+	}
+	return mapping->GetData() + offset;
+}
+
+/*
+========================
+idResourceContainer::OpenMappedFile
+========================
+*/
+idFile * idResourceContainer::OpenMappedFile( const char * name, int offset, int length ) {
+	if ( GetMappedData( offset, length ) == NULL ) {
+		return NULL;
+	}
+	return new (TAG_IDFILE) idFile_MappedResource( name, mapping, offset, length );
+}
+
+/*
+========================
+idResourceContainer::GetMapping
+========================
+*/
+idResourceMapping * idResourceContainer::GetMapping() {
+	if ( mapping != NULL ) {
+		mapping->AddRef();
+	}
+	return mapping;
+}
+
+/*
+========================
+idResourceContainer::Advise
+========================
+*/
+void idResourceContainer::Advise( fileMapAdvice_t advice ) {
+	if ( mapping != NULL ) {
+		Sys_AdviseMappedFile( mapping->GetData(), mapping->GetLength(), advice );
+	}
 }
 
 /*
@@ -72,13 +230,20 @@ bool idResourceContainer::Init( const char *_fileName, uint8 containerIndex ) {
 
 	fileName = _fileName;
 
+	Map();
+
 	resourceFile->ReadBig( tableOffset );
 	resourceFile->ReadBig( tableLength );
 	// read this into a memory buffer with a single read
-	char * const buf = (char *)Mem_Alloc( tableLength, TAG_RESOURCE );
-	resourceFile->Seek( tableOffset, FS_SEEK_SET );
-	resourceFile->Read( buf, tableLength );
-	idFile_Memory memFile( "resourceHeader", (const char *)buf, tableLength );
+	char * buf = NULL;
+	const char * table = (const char *)GetMappedData( tableOffset, tableLength );
+	if ( table == NULL ) {
+		buf = (char *)Mem_Alloc( tableLength, TAG_RESOURCE );
+		resourceFile->Seek( tableOffset, FS_SEEK_SET );
+		resourceFile->Read( buf, tableLength );
+		table = buf;
+	}
+	idFile_Memory memFile( "resourceHeader", table, tableLength );
 
 	// Parse the resourceFile header, which includes every resource used
 	// by the game.
@@ -67,6 +67,50 @@ public:
 	uint8				containerIndex;
 };
 
+/*
+================================================
+idResourceMapping
+
+A memory mapped resource container. The container and every file that reads
+straight from the mapping hold a reference, the file is unmapped when the last
+reference is released. This keeps the files valid when the container is closed
+or reopened while they are still open.
+================================================
+*/
+class idResourceMapping {
+public:
+						idResourceMapping( const byte * data, int length );
+
+	void				AddRef() { refCount.Increment(); }
+	void				Release();
+
+	const byte *		GetData() const { return data; }
+	int					GetLength() const { return length; }
+
+private:
+						~idResourceMapping();
+
+	const byte *		data;
+	int					length;
+	idSysInterlockedInteger	refCount;
+};
+
+/*
+================================================
+idFile_MappedResource
+
+Read only view of an inner resource of a memory mapped container.
+================================================
+*/
+class idFile_MappedResource : public idFile_Memory {
+public:
+						idFile_MappedResource( const char * name, idResourceMapping * mapping, int offset, int length );
+	virtual				~idFile_MappedResource();
+
+private:
+	idResourceMapping *	mapping;
+};
+
 static const uint32 RESOURCE_FILE_MAGIC = 0xD000000D;
 class idResourceContainer {
 	friend class	idFileSystemLocal;
@@ -78,8 +122,10 @@ public:
 		tableLength = 0;
 		resourceMagic = 0;
 		numFileResources = 0;
+		mapping = NULL;
 	}
 	~idResourceContainer() {
+		Unmap();
 		delete resourceFile;
 		cacheTable.Clear();
 	}
@@ -93,7 +139,19 @@ public:
 	const char * GetFileName() const { return fileName.c_str(); }
 	void SetContainerIndex( const int & _idx );
 	void ReOpen();
+	// returns a read only view of an inner resource if the container is memory mapped
+	const byte * GetMappedData( int offset, int length ) const;
+	// returns a file reading straight from the mapping or NULL if the container is not memory mapped
+	idFile * OpenMappedFile( const char * name, int offset, int length );
+	// the mapping with a reference added for the caller, NULL if the container is not memory mapped
+	idResourceMapping * GetMapping();
+	bool IsMapped() const { return mapping != NULL; }
+	void Advise( fileMapAdvice_t advice );
 private:
+	void Map();
+	void Unmap();
+
+
 	idStrStatic< 256 > fileName;
 	idFile *	resourceFile;			// open file handle
 	// offset should probably be a 64 bit value for development, but 4 gigs won't fit on
@@ -104,6 +162,7 @@ private:
 	int		numFileResources;		// number of file resources in this container
 	idList< idResourceCacheEntry, TAG_RESOURCE>	cacheTable;
 	idHashIndex	cacheHash;
+	idResourceMapping *	mapping;	// the whole file when fs_mapResourceFiles is set
 };
 
 
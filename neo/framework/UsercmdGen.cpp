@@ -85,6 +85,106 @@ void usercmd_t::Serialize( idSerializer & ser, const usercmd_t & base ) {
 	ser.SerializeDelta( impulseSequence, base.impulseSequence );
 }
 
+/*
+================
+WriteDeltaBitsInt
+
+Writes a changed bit, and when value differs from base a 2 bit size class followed by the
+zigzag encoded difference. Per frame changes in times, angles and position bits land in the
+smaller classes.
+================
+*/
+static const int usercmdDeltaClassBits[4] = { 4, 10, 20, 32 };
+
+static void WriteDeltaBitsInt( idBitMsg & msg, int32 value, int32 base ) {
+	if ( value == base ) {
+		msg.WriteBits( 0, 1 );
+		return;
+	}
+	msg.WriteBits( 1, 1 );
+
+	const int32 delta = (int32)( (uint32)value - (uint32)base );
+	const uint32 zigzag = ( ( (uint32)delta << 1 ) ^ (uint32)( delta >> 31 ) ) - 1;	// never 0, so store one less
+
+	int sizeClass = 0;
+	while ( sizeClass < 3 && zigzag >= ( 1u << usercmdDeltaClassBits[sizeClass] ) ) {
+		sizeClass++;
+	}
+	msg.WriteBits( sizeClass, 2 );
+	msg.WriteBits( (int)zigzag, usercmdDeltaClassBits[sizeClass] );
+}
+
+/*
+================
+ReadDeltaBitsInt
+================
+*/
+static int32 ReadDeltaBitsInt( const idBitMsg & msg, int32 base ) {
+	if ( msg.ReadBits( 1 ) == 0 ) {
+		return base;
+	}
+	const int sizeClass = msg.ReadBits( 2 ) & 3;
+	const uint32 zigzag = (uint32)msg.ReadBits( usercmdDeltaClassBits[sizeClass] ) + 1;
+	const int32 delta = (int32)( zigzag >> 1 ) ^ -(int32)( zigzag & 1 );
+	return (int32)( (uint32)base + (uint32)delta );
+}
+
+/*
+================
+usercmd_t::WriteDeltaBits
+
+Bit packed alternative to Serialize for the usercmd stream. Every field costs a single bit when
+it matches base, and floats are sent as differences of their bit patterns so the receiver gets
+back exactly what the client predicted with.
+================
+*/
+void usercmd_t::WriteDeltaBits( idBitMsg & msg, const usercmd_t & base ) const {
+	WriteDeltaBitsInt( msg, buttons, base.buttons );
+	WriteDeltaBitsInt( msg, forwardmove, base.forwardmove );
+	WriteDeltaBitsInt( msg, rightmove, base.rightmove );
+	WriteDeltaBitsInt( msg, angles[0], base.angles[0] );
+	WriteDeltaBitsInt( msg, angles[1], base.angles[1] );
+	WriteDeltaBitsInt( msg, angles[2], base.angles[2] );
+	WriteDeltaBitsInt( msg, *reinterpret_cast<const int32 *>( &pos.x ), *reinterpret_cast<const int32 *>( &base.pos.x ) );
+	WriteDeltaBitsInt( msg, *reinterpret_cast<const int32 *>( &pos.y ), *reinterpret_cast<const int32 *>( &base.pos.y ) );
+	WriteDeltaBitsInt( msg, *reinterpret_cast<const int32 *>( &pos.z ), *reinterpret_cast<const int32 *>( &base.pos.z ) );
+	WriteDeltaBitsInt( msg, clientGameMilliseconds, base.clientGameMilliseconds );
+	WriteDeltaBitsInt( msg, serverGameMilliseconds, base.serverGameMilliseconds );
+	WriteDeltaBitsInt( msg, fireCount, base.fireCount );
+	WriteDeltaBitsInt( msg, *reinterpret_cast<const int32 *>( &speedSquared ), *reinterpret_cast<const int32 *>( &base.speedSquared ) );
+	WriteDeltaBitsInt( msg, impulse, base.impulse );
+	WriteDeltaBitsInt( msg, impulseSequence, base.impulseSequence );
+}
+
+/*
+================
+usercmd_t::ReadDeltaBits
+================
+*/
+void usercmd_t::ReadDeltaBits( const idBitMsg & msg, const usercmd_t & base ) {
+	buttons					= (byte)ReadDeltaBitsInt( msg, base.buttons );
+	forwardmove				= (signed char)ReadDeltaBitsInt( msg, base.forwardmove );
+	rightmove				= (signed char)ReadDeltaBitsInt( msg, base.rightmove );
+	angles[0]				= (short)ReadDeltaBitsInt( msg, base.angles[0] );
+	angles[1]				= (short)ReadDeltaBitsInt( msg, base.angles[1] );
+	angles[2]				= (short)ReadDeltaBitsInt( msg, base.angles[2] );
+	int32 posBits[3];
+	posBits[0]				= ReadDeltaBitsInt( msg, *reinterpret_cast<const int32 *>( &base.pos.x ) );
+	posBits[1]				= ReadDeltaBitsInt( msg, *reinterpret_cast<const int32 *>( &base.pos.y ) );
+	posBits[2]				= ReadDeltaBitsInt( msg, *reinterpret_cast<const int32 *>( &base.pos.z ) );
+	clientGameMilliseconds	= ReadDeltaBitsInt( msg, base.clientGameMilliseconds );
+	serverGameMilliseconds	= ReadDeltaBitsInt( msg, base.serverGameMilliseconds );
+	fireCount				= (uint16)ReadDeltaBitsInt( msg, base.fireCount );
+	int32 speedBits			= ReadDeltaBitsInt( msg, *reinterpret_cast<const int32 *>( &base.speedSquared ) );
+	impulse					= (byte)ReadDeltaBitsInt( msg, base.impulse );
+	impulseSequence			= (byte)ReadDeltaBitsInt( msg, base.impulseSequence );
+
+	pos.x = *reinterpret_cast<float *>( &posBits[0] );
+	pos.y = *reinterpret_cast<float *>( &posBits[1] );
+	pos.z = *reinterpret_cast<float *>( &posBits[2] );
+	speedSquared = *reinterpret_cast<float *>( &speedBits );
+}
+
 /*
 ================
 usercmd_t::operator==
@@ -120,6 +120,8 @@ public:
 
 public:
 	void		Serialize( class idSerializer & s, const usercmd_t & base );
+	void		WriteDeltaBits( idBitMsg & msg, const usercmd_t & base ) const;	// lossless bit packed delta, see usercmd_t::WriteDeltaBits
+	void		ReadDeltaBits( const idBitMsg & msg, const usercmd_t & base );
 	void		ByteSwap();						// on big endian systems, byte swap the shorts and ints
 	bool		operator==( const usercmd_t &rhs ) const;
 };
@@ -139,6 +139,14 @@ int idGameThread::Run() {
 
 	commonLocal.frameTiming.finishDrawTime = Sys_Microseconds();
 
+	if ( idParallelJobTrace::IsCapturing() ) {
+		if ( com_smp.GetBool() ) {
+			idParallelJobTrace::SetThreadName( GetName() );
+		}
+		idParallelJobTrace::AddEvent( "GameTic", "frame", commonLocal.frameTiming.startGameTime, commonLocal.frameTiming.finishGameTime );
+		idParallelJobTrace::AddEvent( "Draw", "frame", commonLocal.frameTiming.finishGameTime, commonLocal.frameTiming.finishDrawTime );
+	}
+
 	SetThreadRenderTime( ( commonLocal.frameTiming.finishDrawTime - commonLocal.frameTiming.finishGameTime ) / 1000 );
 
 	SetThreadTotalTime( ( commonLocal.frameTiming.finishDrawTime - commonLocal.frameTiming.startGameTime ) / 1000 );
@@ -371,6 +379,8 @@ void idCommonLocal::Frame() {
 		// This is the only place this is incremented
 		idLib::frameNumber++;
 
+		idParallelJobTrace::FrameBoundary();
+
 		// allow changing SIMD usage on the fly
 		if ( com_forceGenericSIMD.IsModified() ) {
 			idSIMD::InitProcessor( "doom", com_forceGenericSIMD.GetBool() );
@@ -387,6 +397,9 @@ void idCommonLocal::Frame() {
 		// write config file if anything changed
 		WriteConfiguration(); 
 
+		// pick up command text posted from other threads since last frame
+		cmdSystem->BufferPostedCommands();
+
 		eventLoop->RunEventLoop();
 
 		// Activate the shell if it's been requested
@@ -439,6 +452,7 @@ void idCommonLocal::Frame() {
 			renderSystem->SwapCommandBuffers_FinishRendering( &time_frontend, &time_backend, &time_shadows, &time_gpu );
 		}
 		frameTiming.finishSyncTime = Sys_Microseconds();
+		idParallelJobTrace::AddEvent( "SwapCommandBuffers", "frame", frameTiming.startSyncTime, frameTiming.finishSyncTime );
 
 		//--------------------------------------------
 		// Determine how many game tics we are going to run,
@@ -639,6 +653,7 @@ void idCommonLocal::Frame() {
 			Sys_Sleep( com_sleepRender.GetInteger() );
 		}
 		frameTiming.finishRenderTime = Sys_Microseconds();
+		idParallelJobTrace::AddEvent( "RenderCommandBuffers", "frame", frameTiming.startRenderTime, frameTiming.finishRenderTime );
 
 		// make sure the game / draw thread has completed
 		// This may block if the game is taking longer than the render back end
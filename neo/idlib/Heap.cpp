@@ -37,6 +37,383 @@ If you have questions concerning this license or the applicable additional terms
 
 #undef new
 
+/*
+================================================================================================
+
+	Small Object Heap
+
+	Allocations up to HEAP_MAX_SMALL_SIZE bytes (including the block header) are rounded up
+	to one of a set of size classes and carved out of HEAP_SPAN_SIZE spans. Every thread that
+	allocates gets its own cache with a free list per size class, so the common case of
+	allocating and freeing on the same thread never takes a lock or touches shared memory.
+
+	A block freed on a thread other than the one that allocated it is pushed on a lock free
+	stack of the owning cache, which the owner drains on its next allocation. Free lists that
+	grow too long return a batch of blocks to the central lists, which are protected by a mutex
+	and shared between all threads. The statistics of a small block always stay with the cache
+	that allocated it.
+
+	When a thread exits its cache returns all free blocks to the central lists and is put
+	aside. The next thread that needs a cache takes it over, together with the statistics of
+	the blocks that are still allocated from it. Blocks freed while a cache has no thread go
+	straight to the central lists.
+
+	Larger allocations go straight to the system allocator and are freed right away on any
+	thread, their statistics are kept under the mutex. All blocks carry a 16 byte header
+	with the tag and size so per tag statistics can be kept without any additional lookup.
+
+================================================================================================
+*/
+
+// comment this out to send all allocations to the system allocator
+#define USE_SMALL_OBJECT_HEAP
+
+static const int HEAP_HEADER_SIZE		= 16;
+static const int HEAP_MAX_SMALL_SIZE	= 4096;
+static const int HEAP_SPAN_SIZE			= 64 * 1024;
+static const int HEAP_NUM_SIZE_CLASSES	= 40;
+static const int HEAP_LARGE_CLASS		= 0xFF;
+static const int HEAP_MAX_CACHES		= 64;
+static const unsigned int HEAP_MAGIC	= 0x1D4EA9B1;
+
+static const int HEAP_FLAG_TRACKED		= BIT( 0 );		// counted in the tag statistics
+
+struct heapHeader_t {
+	unsigned int	size;			// padded size requested by the caller
+	byte			tag;
+	byte			sizeClass;		// HEAP_LARGE_CLASS for blocks from the system allocator
+	byte			owner;			// index + 1 of the thread cache that allocated a small block, 0 if none
+	byte			flags;
+	unsigned int	magic;
+	heapHeader_t *	next;			// only valid while the block is free, overlaps the user data on 64 bit
+};
+
+struct heapTagStats_t {
+	int64			bytes[TAG_NUM_TAGS];
+	int				count[TAG_NUM_TAGS];
+	int				allocs[TAG_NUM_TAGS];
+};
+
+struct heapThreadCache_t {
+	heapHeader_t *	freeLists[HEAP_NUM_SIZE_CLASSES];
+	int				freeCounts[HEAP_NUM_SIZE_CLASSES];
+	void *			remoteFrees;	// blocks freed by other threads
+	int				index;
+	volatile bool	orphaned;		// the thread exited, protected by heapMutex
+	heapThreadCache_t *	nextOrphan;
+	heapTagStats_t	stats;			// only written by the owning thread, or under heapMutex while orphaned
+};
+
+static bool					heapInitialized;
+static mutexHandle_t		heapMutex;
+static heapHeader_t *		heapCentralLists[HEAP_NUM_SIZE_CLASSES];
+static int					heapCentralCounts[HEAP_NUM_SIZE_CLASSES];
+static heapThreadCache_t *	heapCaches[HEAP_MAX_CACHES];
+static interlockedInt_t		heapNumCaches;
+static heapThreadCache_t *	heapOrphanedCaches;	// caches of exited threads, protected by heapMutex
+static ID_TLS				heapCacheIndex;		// index + 1 of the cache of the calling thread, -1 if none
+static heapTagStats_t		heapSharedStats;	// threads without a cache, protected by heapMutex
+static int64				heapPeakBytes[TAG_NUM_TAGS];
+static int64				heapSpanBytes;
+
+static const char * memTagNames[] = {
+#define MEM_TAG( x )	#x,
+#include "sys/sys_alloc_tags.h"
+};
+compile_time_assert( sizeof( memTagNames ) / sizeof( memTagNames[0] ) == TAG_NUM_TAGS );
+compile_time_assert( offsetof( heapHeader_t, next ) <= HEAP_HEADER_SIZE );
+
+/*
+========================
+Heap_SizeClass
+
+16 byte steps up to 256, 64 byte steps up to 1024 and 256 byte steps up to 4096.
+========================
+*/
+static ID_INLINE int Heap_SizeClass( int blockSize ) {
+	if ( blockSize <= 256 ) {
+		return ( blockSize - 1 ) >> 4;
+	}
+	if ( blockSize <= 1024 ) {
+		return 16 + ( ( blockSize - 257 ) >> 6 );
+	}
+	return 28 + ( ( blockSize - 1025 ) >> 8 );
+}
+
+/*
+========================
+Heap_ClassSize
+========================
+*/
+static ID_INLINE int Heap_ClassSize( int sizeClass ) {
+	if ( sizeClass < 16 ) {
+		return ( sizeClass + 1 ) << 4;
+	}
+	if ( sizeClass < 28 ) {
+		return 256 + ( ( sizeClass - 15 ) << 6 );
+	}
+	return 1024 + ( ( sizeClass - 27 ) << 8 );
+}
+
+/*
+========================
+Heap_BatchSize
+
+Number of blocks moved between a thread cache and the central lists at once.
+========================
+*/
+static ID_INLINE int Heap_BatchSize( int sizeClass ) {
+	return idMath::ClampInt( 4, 64, 8192 / Heap_ClassSize( sizeClass ) );
+}
+
+/*
+========================
+Heap_GetThreadCache
+========================
+*/
+static heapThreadCache_t * Heap_GetThreadCache() {
+	if ( !heapInitialized ) {
+		return NULL;
+	}
+	const ptrdiff_t index = heapCacheIndex;
+	if ( index > 0 ) {
+		return heapCaches[index - 1];
+	}
+	if ( index < 0 ) {
+		return NULL;
+	}
+
+	Sys_MutexLock( heapMutex, true );
+
+	// take over the cache of a thread that exited
+	heapThreadCache_t * cache = heapOrphanedCaches;
+	if ( cache != NULL ) {
+		heapOrphanedCaches = cache->nextOrphan;
+		cache->nextOrphan = NULL;
+		cache->orphaned = false;
+	} else {
+		const int slot = heapNumCaches;
+		if ( slot >= HEAP_MAX_CACHES ) {
+			Sys_MutexUnlock( heapMutex );
+			heapCacheIndex = -1;
+			return NULL;
+		}
+		cache = (heapThreadCache_t *)_aligned_malloc( sizeof( heapThreadCache_t ), CACHE_LINE_SIZE );
+		memset( cache, 0, sizeof( *cache ) );
+		cache->index = slot;
+		heapCaches[slot] = cache;
+		SYS_MEMORYBARRIER;
+		Sys_InterlockedIncrement( heapNumCaches );
+	}
+
+	Sys_MutexUnlock( heapMutex );
+
+	heapCacheIndex = cache->index + 1;
+	return cache;
+}
+
+/*
+========================
+Heap_AddStats
+========================
+*/
+static ID_INLINE void Heap_AddStats( heapTagStats_t & stats, const heapHeader_t * header ) {
+	stats.bytes[header->tag] += header->size;
+	stats.count[header->tag]++;
+	stats.allocs[header->tag]++;
+}
+
+/*
+========================
+Heap_RemoveStats
+========================
+*/
+static ID_INLINE void Heap_RemoveStats( heapTagStats_t & stats, const heapHeader_t * header ) {
+	stats.bytes[header->tag] -= header->size;
+	stats.count[header->tag]--;
+}
+
+/*
+========================
+Heap_DrainRemoteFrees
+
+Finishes freeing the blocks other threads have freed. They go back on the free lists of the
+cache, or on the central lists if the cache is orphaned and heapMutex is held.
+========================
+*/
+static void Heap_DrainRemoteFrees( heapThreadCache_t * cache ) {
+	heapHeader_t * header = (heapHeader_t *)Sys_InterlockedExchangePointer( cache->remoteFrees, NULL );
+	while ( header != NULL ) {
+		heapHeader_t * next = header->next;
+		assert( header->sizeClass != HEAP_LARGE_CLASS );
+		if ( header->flags & HEAP_FLAG_TRACKED ) {
+			Heap_RemoveStats( cache->stats, header );
+		}
+		if ( cache->orphaned ) {
+			header->next = heapCentralLists[header->sizeClass];
+			heapCentralLists[header->sizeClass] = header;
+			heapCentralCounts[header->sizeClass]++;
+		} else {
+			header->next = cache->freeLists[header->sizeClass];
+			cache->freeLists[header->sizeClass] = header;
+			cache->freeCounts[header->sizeClass]++;
+		}
+		header = next;
+	}
+}
+
+/*
+========================
+Heap_Refill
+========================
+*/
+static heapHeader_t * Heap_Refill( heapThreadCache_t * cache, int sizeClass ) {
+	if ( cache->remoteFrees != NULL ) {
+		Heap_DrainRemoteFrees( cache );
+		if ( cache->freeLists[sizeClass] != NULL ) {
+			return cache->freeLists[sizeClass];
+		}
+	}
+
+	const int batchSize = Heap_BatchSize( sizeClass );
+
+	Sys_MutexLock( heapMutex, true );
+
+	if ( heapCentralLists[sizeClass] == NULL ) {
+		// carve a new span into the central list
+		const int classSize = Heap_ClassSize( sizeClass );
+		const int numBlocks = HEAP_SPAN_SIZE / classSize;
+		byte * span = (byte *)_aligned_malloc( HEAP_SPAN_SIZE, 16 );
+		if ( span == NULL ) {
+			Sys_MutexUnlock( heapMutex );
+			return NULL;
+		}
+		for ( int i = numBlocks - 1; i >= 0; i-- ) {
+			heapHeader_t * header = (heapHeader_t *)( span + i * classSize );
+			header->sizeClass = (byte)sizeClass;
+			header->magic = HEAP_MAGIC;
+			header->next = heapCentralLists[sizeClass];
+			heapCentralLists[sizeClass] = header;
+		}
+		heapCentralCounts[sizeClass] += numBlocks;
+		heapSpanBytes += HEAP_SPAN_SIZE;
+	}
+
+	for ( int i = 0; i < batchSize && heapCentralLists[sizeClass] != NULL; i++ ) {
+		heapHeader_t * header = heapCentralLists[sizeClass];
+		heapCentralLists[sizeClass] = header->next;
+		heapCentralCounts[sizeClass]--;
+		header->next = cache->freeLists[sizeClass];
+		cache->freeLists[sizeClass] = header;
+		cache->freeCounts[sizeClass]++;
+	}
+
+	Sys_MutexUnlock( heapMutex );
+
+	return cache->freeLists[sizeClass];
+}
+
+/*
+========================
+Heap_Flush
+
+Returns a batch of blocks from a thread cache to the central list.
+========================
+*/
+static void Heap_Flush( heapThreadCache_t * cache, int sizeClass, int numBlocks ) {
+	Sys_MutexLock( heapMutex, true );
+	for ( int i = 0; i < numBlocks && cache->freeLists[sizeClass] != NULL; i++ ) {
+		heapHeader_t * header = cache->freeLists[sizeClass];
+		cache->freeLists[sizeClass] = header->next;
+		cache->freeCounts[sizeClass]--;
+		header->next = heapCentralLists[sizeClass];
+		heapCentralLists[sizeClass] = header;
+		heapCentralCounts[sizeClass]++;
+	}
+	Sys_MutexUnlock( heapMutex );
+}
+
+/*
+========================
+Heap_FreeToCentral
+========================
+*/
+static void Heap_FreeToCentral( heapHeader_t * header ) {
+	Sys_MutexLock( heapMutex, true );
+	header->next = heapCentralLists[header->sizeClass];
+	heapCentralLists[header->sizeClass] = header;
+	heapCentralCounts[header->sizeClass]++;
+	Sys_MutexUnlock( heapMutex );
+}
+
+/*
+==================
+Mem_Init
+==================
+*/
+void Mem_Init() {
+	if ( heapInitialized ) {
+		return;
+	}
+	Sys_MutexCreate( heapMutex );
+	heapInitialized = true;
+}
+
+/*
+==================
+Mem_Shutdown
+
+Memory held by the thread caches and the central lists is not released, blocks freed after
+this are put back on the central lists.
+==================
+*/
+void Mem_Shutdown() {
+	heapInitialized = false;
+}
+
+/*
+==================
+Mem_ReleaseThreadCache
+
+Called by a thread before it exits. The free blocks of its cache go back to the central lists
+and the cache is kept for the next thread, so the slots don't run out and the blocks the
+thread still has allocated can be accounted for when they are freed.
+==================
+*/
+void Mem_ReleaseThreadCache() {
+	if ( !heapInitialized ) {
+		return;
+	}
+	const ptrdiff_t index = heapCacheIndex;
+	if ( index <= 0 ) {
+		return;
+	}
+	heapThreadCache_t * cache = heapCaches[index - 1];
+
+	Sys_MutexLock( heapMutex, true );
+
+	cache->orphaned = true;
+	Heap_DrainRemoteFrees( cache );
+
+	for ( int i = 0; i < HEAP_NUM_SIZE_CLASSES; i++ ) {
+		while ( cache->freeLists[i] != NULL ) {
+			heapHeader_t * header = cache->freeLists[i];
+			cache->freeLists[i] = header->next;
+			header->next = heapCentralLists[i];
+			heapCentralLists[i] = header;
+			heapCentralCounts[i]++;
+		}
+		cache->freeCounts[i] = 0;
+	}
+
+	cache->nextOrphan = heapOrphanedCaches;
+	heapOrphanedCaches = cache;
+
+	Sys_MutexUnlock( heapMutex );
+
+	heapCacheIndex = 0;
+}
+
 /*
 ==================
 Mem_Alloc16
@@ -47,7 +424,55 @@ void * Mem_Alloc16( const int size, const memTag_t tag ) {
 		return NULL;
 	}
 	const int paddedSize = ( size + 15 ) & ~15;
-	return _aligned_malloc( paddedSize, 16 );
+
+	heapThreadCache_t * cache = Heap_GetThreadCache();
+	heapHeader_t * header = NULL;
+
+	if ( cache != NULL && cache->remoteFrees != NULL ) {
+		Heap_DrainRemoteFrees( cache );
+	}
+
+#ifdef USE_SMALL_OBJECT_HEAP
+	if ( cache != NULL && paddedSize <= HEAP_MAX_SMALL_SIZE - HEAP_HEADER_SIZE ) {
+		const int sizeClass = Heap_SizeClass( paddedSize + HEAP_HEADER_SIZE );
+		header = cache->freeLists[sizeClass];
+		if ( header == NULL ) {
+			header = Heap_Refill( cache, sizeClass );
+		}
+		if ( header != NULL ) {
+			assert( header->magic == HEAP_MAGIC && header->sizeClass == sizeClass );
+			cache->freeLists[sizeClass] = header->next;
+			cache->freeCounts[sizeClass]--;
+			header->owner = (byte)( cache->index + 1 );
+		}
+	}
+#endif
+
+	if ( header == NULL ) {
+		header = (heapHeader_t *)_aligned_malloc( paddedSize + HEAP_HEADER_SIZE, 16 );
+		if ( header == NULL ) {
+			return NULL;
+		}
+		header->sizeClass = HEAP_LARGE_CLASS;
+		header->magic = HEAP_MAGIC;
+		header->owner = 0;
+	}
+
+	header->size = paddedSize;
+	header->tag = (byte)tag;
+	header->flags = 0;
+
+	if ( header->owner != 0 ) {
+		header->flags |= HEAP_FLAG_TRACKED;
+		Heap_AddStats( cache->stats, header );
+	} else if ( heapInitialized ) {
+		header->flags |= HEAP_FLAG_TRACKED;
+		Sys_MutexLock( heapMutex, true );
+		Heap_AddStats( heapSharedStats, header );
+		Sys_MutexUnlock( heapMutex );
+	}
+
+	return (byte *)header + HEAP_HEADER_SIZE;
 }
 
 /*
@@ -59,7 +484,138 @@ void Mem_Free16( void *ptr ) {
 	if ( ptr == NULL ) {
 		return;
 	}
-	_aligned_free( ptr );
+	heapHeader_t * header = (heapHeader_t *)( (byte *)ptr - HEAP_HEADER_SIZE );
+	assert( header->magic == HEAP_MAGIC );
+
+	const bool tracked = ( header->flags & HEAP_FLAG_TRACKED ) != 0 && heapInitialized;
+
+	if ( header->owner == 0 || !heapInitialized ) {
+		// allocated without a thread cache, or the heap is shut down
+		if ( tracked ) {
+			Sys_MutexLock( heapMutex, true );
+			Heap_RemoveStats( heapSharedStats, header );
+			Sys_MutexUnlock( heapMutex );
+		}
+		if ( header->sizeClass == HEAP_LARGE_CLASS ) {
+			_aligned_free( header );
+		} else {
+			Heap_FreeToCentral( header );
+		}
+		return;
+	}
+
+	assert( header->sizeClass != HEAP_LARGE_CLASS );
+	heapThreadCache_t * owner = heapCaches[header->owner - 1];
+	const int sizeClass = header->sizeClass;
+
+	if ( owner == Heap_GetThreadCache() ) {
+		if ( tracked ) {
+			Heap_RemoveStats( owner->stats, header );
+		}
+		header->next = owner->freeLists[sizeClass];
+		owner->freeLists[sizeClass] = header;
+		if ( ++owner->freeCounts[sizeClass] > Heap_BatchSize( sizeClass ) * 2 ) {
+			Heap_Flush( owner, sizeClass, Heap_BatchSize( sizeClass ) );
+		}
+		return;
+	}
+
+	// hand the block back to the cache that allocated it, which also removes the statistics
+	void * head;
+	do {
+		head = owner->remoteFrees;
+		header->next = (heapHeader_t *)head;
+	} while ( Sys_InterlockedCompareExchangePointer( owner->remoteFrees, head, header ) != head );
+
+	// Mem_ReleaseThreadCache sets orphaned before its last drain, so if the flag isn't set
+	// after the push the owner is still going to drain it, otherwise it may have missed it
+	if ( owner->orphaned ) {
+		Sys_MutexLock( heapMutex, true );
+		if ( owner->orphaned ) {
+			Heap_DrainRemoteFrees( owner );
+		}
+		Sys_MutexUnlock( heapMutex );
+	}
+}
+
+/*
+==================
+Mem_GetTagName
+==================
+*/
+const char * Mem_GetTagName( const memTag_t tag ) {
+	if ( tag < 0 || tag >= TAG_NUM_TAGS ) {
+		return "?";
+	}
+	return memTagNames[tag];
+}
+
+/*
+==================
+Mem_GetTagStats
+
+Sums the statistics of all thread caches. The values are only a snapshot, other threads keep
+allocating while they are gathered.
+==================
+*/
+void Mem_GetTagStats( memTagStats_t stats[TAG_NUM_TAGS] ) {
+	memset( stats, 0, sizeof( memTagStats_t ) * TAG_NUM_TAGS );
+	if ( !heapInitialized ) {
+		return;
+	}
+
+	const int numCaches = Min( (int)heapNumCaches, HEAP_MAX_CACHES );
+	for ( int i = 0; i < numCaches; i++ ) {
+		const heapThreadCache_t * cache = heapCaches[i];
+		if ( cache == NULL ) {
+			continue;
+		}
+		for ( int j = 0; j < TAG_NUM_TAGS; j++ ) {
+			stats[j].bytes += cache->stats.bytes[j];
+			stats[j].count += cache->stats.count[j];
+			stats[j].totalCount += cache->stats.allocs[j];
+		}
+	}
+
+	Sys_MutexLock( heapMutex, true );
+	for ( int j = 0; j < TAG_NUM_TAGS; j++ ) {
+		stats[j].bytes += heapSharedStats.bytes[j];
+		stats[j].count += heapSharedStats.count[j];
+		stats[j].totalCount += heapSharedStats.allocs[j];
+		heapPeakBytes[j] = Max( heapPeakBytes[j], stats[j].bytes );
+		stats[j].peakBytes = heapPeakBytes[j];
+	}
+	Sys_MutexUnlock( heapMutex );
+}
+
+/*
+==================
+Mem_GetHeapStats
+==================
+*/
+void Mem_GetHeapStats( memHeapStats_t & stats ) {
+	memset( &stats, 0, sizeof( stats ) );
+	if ( !heapInitialized ) {
+		return;
+	}
+	stats.numThreadCaches = Min( (int)heapNumCaches, HEAP_MAX_CACHES );
+
+	Sys_MutexLock( heapMutex, true );
+	stats.spanBytes = heapSpanBytes;
+	for ( int i = 0; i < HEAP_NUM_SIZE_CLASSES; i++ ) {
+		stats.centralFreeBytes += (int64)heapCentralCounts[i] * Heap_ClassSize( i );
+	}
+	Sys_MutexUnlock( heapMutex );
+
+	for ( int i = 0; i < stats.numThreadCaches; i++ ) {
+		const heapThreadCache_t * cache = heapCaches[i];
+		if ( cache == NULL ) {
+			continue;
+		}
+		for ( int j = 0; j < HEAP_NUM_SIZE_CLASSES; j++ ) {
+			stats.cachedFreeBytes += (int64)cache->freeCounts[j] * Heap_ClassSize( j );
+		}
+	}
 }
 
 /*
@@ -84,3 +640,45 @@ char *Mem_CopyString( const char *in ) {
 	return out;
 }
 
+/*
+==================
+Mem_ListTags_f
+==================
+*/
+static int SortTagsByBytes( const void * a, const void * b ) {
+	const memTagStats_t * sa = (const memTagStats_t *)a;
+	const memTagStats_t * sb = (const memTagStats_t *)b;
+	if ( sa->bytes == sb->bytes ) {
+		return 0;
+	}
+	return ( sa->bytes < sb->bytes ) ? 1 : -1;
+}
+
+CONSOLE_COMMAND( listMemTags, "lists the memory allocated per tag, usage: listMemTags [all]", 0 ) {
+	const bool all = ( args.Argc() > 1 && idStr::Icmp( args.Argv( 1 ), "all" ) == 0 );
+
+	memTagStats_t stats[TAG_NUM_TAGS];
+	Mem_GetTagStats( stats );
+	for ( int i = 0; i < TAG_NUM_TAGS; i++ ) {
+		stats[i].tag = (memTag_t)i;
+	}
+	qsort( stats, TAG_NUM_TAGS, sizeof( stats[0] ), SortTagsByBytes );
+
+	int64 totalBytes = 0;
+	int totalCount = 0;
+	idLib::Printf( "%-24s %10s %10s %8s %10s\n", "tag", "kB", "peak kB", "count", "allocs" );
+	for ( int i = 0; i < TAG_NUM_TAGS; i++ ) {
+		totalBytes += stats[i].bytes;
+		totalCount += stats[i].count;
+		if ( stats[i].count == 0 && !all ) {
+			continue;
+		}
+		idLib::Printf( "%-24s %10lld %10lld %8d %10d\n", Mem_GetTagName( stats[i].tag ), stats[i].bytes >> 10, stats[i].peakBytes >> 10, stats[i].count, stats[i].totalCount );
+	}
+	idLib::Printf( "%-24s %10lld %10s %8d\n", "total", totalBytes >> 10, "", totalCount );
+
+	memHeapStats_t heapStats;
+	Mem_GetHeapStats( heapStats );
+	idLib::Printf( "small object heap: %lld kB in spans, %lld kB free in %d thread caches, %lld kB free in central lists\n",
+		heapStats.spanBytes >> 10, heapStats.cachedFreeBytes >> 10, heapStats.numThreadCaches, heapStats.centralFreeBytes >> 10 );
+}
@@ -46,8 +46,24 @@ enum memTag_t {
 
 static const int MAX_TAGS = 256;
 
+struct memTagStats_t {
+	memTag_t	tag;
+	int64		bytes;			// bytes currently allocated with the tag
+	int64		peakBytes;		// highest value of bytes seen by Mem_GetTagStats
+	int			count;			// number of outstanding allocations
+	int			totalCount;		// number of allocations since startup
+};
 
+struct memHeapStats_t {
+	int64		spanBytes;			// memory taken from the system for small objects
+	int64		cachedFreeBytes;	// free small blocks held by the thread caches
+	int64		centralFreeBytes;	// free small blocks on the central lists
+	int			numThreadCaches;
+};
 
+void		Mem_Init();
+void		Mem_Shutdown();
+void		Mem_ReleaseThreadCache();		// called by threads before they exit
 
 void *		Mem_Alloc16( const int size, const memTag_t tag );
 void		Mem_Free16( void *ptr );
@@ -58,6 +74,10 @@ ID_INLINE void		Mem_Free( void *ptr ) { Mem_Free16( ptr ); }
 void *		Mem_ClearedAlloc( const int size, const memTag_t tag );
 char *		Mem_CopyString( const char *in );
 
+const char *Mem_GetTagName( const memTag_t tag );
+void		Mem_GetTagStats( memTagStats_t stats[TAG_NUM_TAGS] );
+void		Mem_GetHeapStats( memHeapStats_t & stats );
+
 ID_INLINE void *operator new( size_t s ) {
 	return Mem_Alloc( s, TAG_NEW );
 }
@@ -68,6 +68,9 @@ void idLib::Init() {
 	// initialize little/big endian conversion
 	Swap_Init();
 
+	// init the small object heap
+	Mem_Init();
+
 	// init string memory allocator
 	idStr::InitMemory();
 
@@ -104,6 +107,9 @@ void idLib::ShutDown() {
 
 	// shut down the SIMD engine
 	idSIMD::Shutdown();
+
+	// stop using the thread caches of the small object heap
+	Mem_Shutdown();
 }
 
 
@@ -316,6 +316,8 @@ public:
 #include "Swap.h"
 #include "Callback.h"
 #include "ParallelJobList.h"
+#include "ParallelJobGraph.h"
+#include "ParallelJobTrace.h"
 
 #include "SoftwareCache.h"
 
@@ -0,0 +1,287 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").  
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+#pragma hdrstop
+#include "precompiled.h"
+#include "ParallelJobGraph.h"
+
+
+/*
+========================
+GraphWorkerJob
+========================
+*/
+static void GraphWorkerJob( idParallelJobGraph ** graph ) {
+	(*graph)->RunJobs();
+}
+REGISTER_PARALLEL_JOB( GraphWorkerJob, "GraphWorkerJob" );
+
+/*
+========================
+idParallelJobGraph::idParallelJobGraph
+========================
+*/
+idParallelJobGraph::idParallelJobGraph( jobListId_t id, jobListPriority_t priority, unsigned int maxJobs, const idColor * color ) :
+	readySignal( true ) {
+	jobList = parallelJobManager->AllocJobList( id, priority, MAX_GRAPH_WORKERS, 0, color );
+	jobs.SetNum( maxJobs );
+	for ( int i = 0; i < MAX_GRAPH_WORKERS; i++ ) {
+		workers[i] = this;
+	}
+}
+
+/*
+========================
+idParallelJobGraph::~idParallelJobGraph
+========================
+*/
+idParallelJobGraph::~idParallelJobGraph() {
+	Wait();
+	parallelJobManager->FreeJobList( jobList );
+}
+
+/*
+========================
+idParallelJobGraph::PushReadyJob
+========================
+*/
+void idParallelJobGraph::PushReadyJob( graphJob_t * job ) {
+	for ( ; ; ) {
+		graphJob_t * head = readyJobs.Get();
+		job->next = head;
+		if ( readyJobs.CompareExchange( head, job ) == head ) {
+			return;
+		}
+	}
+}
+
+/*
+========================
+idParallelJobGraph::PopReadyJob
+
+Every job is pushed only once per submission so there is no ABA problem.
+========================
+*/
+graphJob_t * idParallelJobGraph::PopReadyJob() {
+	for ( ; ; ) {
+		graphJob_t * head = readyJobs.Get();
+		if ( head == NULL ) {
+			return NULL;
+		}
+		if ( readyJobs.CompareExchange( head, head->next ) == head ) {
+			return head;
+		}
+	}
+}
+
+/*
+========================
+idParallelJobGraph::ReleaseContinuations
+========================
+*/
+void idParallelJobGraph::ReleaseContinuations( idParallelJobCounter * counter ) {
+	// the exchange guarantees only one thread releases each waiting job
+	graphJob_t * job = counter->continuations.Set( NULL );
+	while ( job != NULL ) {
+		graphJob_t * next = job->next;
+		PushReadyJob( job );
+		job = next;
+	}
+	WakeWorkers();
+}
+
+/*
+========================
+idParallelJobGraph::AddJob
+========================
+*/
+void idParallelJobGraph::AddJob( jobRun_t function, void * data, idParallelJobCounter * signal, idParallelJobCounter * waitFor ) {
+	int index = numAllocated.Increment() - 1;
+	if ( index >= jobs.Num() ) {
+		idLib::Error( "Can't add job to graph %s, too many jobs %d", GetJobListName( jobList->GetId() ), jobs.Num() );
+	}
+
+	graphJob_t * job = &jobs[index];
+	job->function = function;
+	job->data = data;
+	job->signal = signal;
+	job->next = NULL;
+
+	// the pending count and the signal must be raised before a parent job finishes
+	numPending.Increment();
+	if ( signal != NULL ) {
+		signal->count.Increment();
+	}
+
+	if ( waitFor == NULL ) {
+		PushReadyJob( job );
+		WakeWorkers();
+		return;
+	}
+
+	for ( ; ; ) {
+		graphJob_t * head = waitFor->continuations.Get();
+		job->next = head;
+		if ( waitFor->continuations.CompareExchange( head, job ) == head ) {
+			break;
+		}
+	}
+	// the counter may have dropped to zero before the job was linked in
+	if ( waitFor->count.GetValue() <= 0 ) {
+		ReleaseContinuations( waitFor );
+	}
+}
+
+/*
+========================
+idParallelJobGraph::FinishJob
+========================
+*/
+void idParallelJobGraph::FinishJob( graphJob_t * job ) {
+	if ( job->signal != NULL ) {
+		if ( job->signal->count.Decrement() == 0 ) {
+			ReleaseContinuations( job->signal );
+		}
+	}
+	if ( numPending.Decrement() == 0 ) {
+		// let the sleeping workers see that the graph is done
+		WakeWorkers();
+	}
+}
+
+/*
+========================
+idParallelJobGraph::WakeWorkers
+
+Only raises the signal if a worker sleeps, a worker that goes to sleep
+after the check finds the job or the finished graph when it checks again.
+========================
+*/
+void idParallelJobGraph::WakeWorkers() {
+	if ( numSleeping.GetValue() > 0 ) {
+		readySignal.Raise();
+	}
+}
+
+/*
+========================
+idParallelJobGraph::WaitForReadyJob
+
+The signal is cleared before checking for work, so any job pushed after
+the check raises it again and the wait returns right away.
+========================
+*/
+void idParallelJobGraph::WaitForReadyJob() {
+	numSleeping.Increment();
+	readySignal.Clear();
+	if ( readyJobs.Get() == NULL && numPending.GetValue() > 0 ) {
+		readySignal.Wait();
+	}
+	numSleeping.Decrement();
+}
+
+/*
+========================
+idParallelJobGraph::RunJobs
+========================
+*/
+void idParallelJobGraph::RunJobs() {
+	while ( numPending.GetValue() > 0 ) {
+		graphJob_t * job = PopReadyJob();
+		if ( job == NULL ) {
+			// other workers are still running jobs that may add or release more jobs
+			WaitForReadyJob();
+			continue;
+		}
+		job->function( job->data );
+		FinishJob( job );
+	}
+}
+
+/*
+========================
+idParallelJobGraph::Submit
+========================
+*/
+void idParallelJobGraph::Submit( idParallelJobList * waitForJobList, int parallelism ) {
+	assert( !jobList->IsSubmitted() );
+
+	if ( numAllocated.GetValue() == 0 ) {
+		return;
+	}
+
+	int numWorkers = parallelJobManager->GetNumProcessingUnits();
+	if ( parallelism > 0 ) {
+		numWorkers = parallelism;
+	}
+	numWorkers = idMath::ClampInt( 1, MAX_GRAPH_WORKERS, Min( numWorkers, numAllocated.GetValue() ) );
+
+	for ( int i = 0; i < numWorkers; i++ ) {
+		// each worker job has different data so they are not flagged as duplicates
+		jobList->AddJob( (jobRun_t)GraphWorkerJob, &workers[i] );
+	}
+	jobList->Submit( waitForJobList, parallelism );
+}
+
+/*
+========================
+idParallelJobGraph::Wait
+========================
+*/
+void idParallelJobGraph::Wait() {
+	if ( jobList->IsSubmitted() ) {
+		jobList->Wait();
+	} else if ( numPending.GetValue() > 0 ) {
+		// never submitted so run everything right here
+		RunJobs();
+	}
+	assert( numPending.GetValue() == 0 );
+	assert( readyJobs.Get() == NULL );
+	numAllocated.SetValue( 0 );
+}
+
+/*
+========================
+idParallelJobGraph::TryWait
+========================
+*/
+bool idParallelJobGraph::TryWait() {
+	if ( numPending.GetValue() > 0 ) {
+		return false;
+	}
+	Wait();
+	return true;
+}
+
+/*
+========================
+idParallelJobGraph::IsSubmitted
+========================
+*/
+bool idParallelJobGraph::IsSubmitted() const {
+	return jobList->IsSubmitted();
+}
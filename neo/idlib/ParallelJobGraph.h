@@ -0,0 +1,144 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").  
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+#ifndef __PARALLELJOBGRAPH_H__
+#define __PARALLELJOBGRAPH_H__
+
+class idParallelJobCounter;
+
+struct graphJob_t {
+	jobRun_t				function;
+	void *					data;
+	idParallelJobCounter *	signal;
+	graphJob_t *			next;
+};
+
+/*
+================================================
+idParallelJobCounter
+
+Counts the unfinished jobs of an idParallelJobGraph that signal it.
+Jobs that wait for a counter are not run before the counter drops
+to zero. A job that adds child jobs signalling its own counter
+keeps that counter from dropping to zero until the children are
+done as well.
+
+Jobs that wait for a counter should be added after the jobs that
+signal it, otherwise they may run as soon as they are added.
+================================================
+*/
+class idParallelJobCounter {
+	friend class idParallelJobGraph;
+public:
+								idParallelJobCounter() {}
+
+	int							GetValue() const { return count.GetValue(); }
+	bool						IsDone() const { return count.GetValue() <= 0; }
+
+private:
+	idSysInterlockedInteger		count;
+	idSysInterlockedPointer< graphJob_t >	continuations;	// jobs waiting for the count to drop to zero
+
+								idParallelJobCounter( const idParallelJobCounter & c ) {}
+	void						operator=( const idParallelJobCounter & c ) {}
+};
+
+/*
+================================================
+idParallelJobGraph
+
+A set of jobs with dependencies expressed through counters. Unlike
+idParallelJobList, jobs can be added while the graph is executing,
+from within any of its jobs, so a job can spawn sub tasks and a stage
+can start as soon as the jobs it depends on are done instead of
+waiting for a whole job list.
+
+The graph is executed by a job list with one job per processing unit
+that keeps running ready jobs until all added jobs are done. A worker
+that finds no ready job sleeps until a job becomes ready or the graph
+is done.
+
+	idParallelJobCounter modelsDone;
+	for ( ... ) {
+		graph->AddJob( (jobRun_t)AddModelJob, model, &modelsDone );
+	}
+	graph->AddJob( (jobRun_t)AfterModelsJob, data, NULL, &modelsDone );
+	graph->Submit();
+	graph->Wait();
+================================================
+*/
+class idParallelJobGraph {
+public:
+								idParallelJobGraph( jobListId_t id, jobListPriority_t priority, unsigned int maxJobs, const idColor * color );
+								~idParallelJobGraph();
+
+	// Adds a job to the graph, can be called before Submit() or from any job of this graph
+	// while it executes. The job does not run before 'waitFor' is zero and 'signal' is
+	// decremented when the job is done.
+	void						AddJob( jobRun_t function, void * data, idParallelJobCounter * signal = NULL, idParallelJobCounter * waitFor = NULL );
+
+	// Submit the jobs in the graph.
+	void						Submit( idParallelJobList * waitForJobList = NULL, int parallelism = JOBLIST_PARALLELISM_DEFAULT );
+	// Wait for all jobs in the graph, including the ones added while executing, to finish.
+	void						Wait();
+	// Returns true and finishes the graph if all jobs are done, returns immediately either way.
+	bool						TryWait();
+	// returns true if the graph has been submitted.
+	bool						IsSubmitted() const;
+
+	// Get the number of jobs added since the last Wait().
+	int							GetNumJobs() const { return numAllocated.GetValue(); }
+	// Get the job list that executes the graph for profiling.
+	idParallelJobList *			GetJobList() const { return jobList; }
+
+	// Runs ready jobs until all jobs of the graph are done, called by the executing job list.
+	void						RunJobs();
+
+private:
+	static const int			MAX_GRAPH_WORKERS = 32;
+
+	idParallelJobList *			jobList;
+	idList< graphJob_t, TAG_JOBLIST >	jobs;			// never reallocated so jobs can be added from other threads
+	idSysInterlockedInteger		numAllocated;
+	idSysInterlockedInteger		numPending;				// jobs added but not finished
+	idSysInterlockedPointer< graphJob_t >	readyJobs;	// stack of jobs that can run right away
+	idSysInterlockedInteger		numSleeping;			// workers waiting for readySignal
+	idSysSignal					readySignal;			// raised when jobs became ready or all jobs are done
+	idParallelJobGraph *		workers[MAX_GRAPH_WORKERS];	// data for the jobs that execute the graph
+
+	void						PushReadyJob( graphJob_t * job );
+	graphJob_t *				PopReadyJob();
+	void						ReleaseContinuations( idParallelJobCounter * counter );
+	void						FinishJob( graphJob_t * job );
+	void						WakeWorkers();
+	void						WaitForReadyJob();
+
+								idParallelJobGraph( const idParallelJobGraph & g ) {}
+	void						operator=( const idParallelJobGraph & g ) {}
+};
+
+#endif // !__PARALLELJOBGRAPH_H__
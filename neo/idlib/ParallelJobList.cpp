@@ -28,6 +28,7 @@ If you have questions concerning this license or the applicable additional terms
 #pragma hdrstop
 #include "precompiled.h"
 #include "ParallelJobList.h"
+#include "ParallelJobTrace.h"
 
 /*
 ================================================================================================
@@ -51,7 +52,13 @@ struct registeredJob {
 static int numRegisteredJobs;
 
 const char * GetJobListName( jobListId_t id ) {
-	return jobNames[id];
+	// jobNames[] is not indexed by id past the renderer lists
+	switch ( id ) {
+		case JOBLIST_RENDERER_FRONTEND:	return jobNames[0];
+		case JOBLIST_RENDERER_BACKEND:	return jobNames[1];
+		case JOBLIST_UTILITY:			return jobNames[2];
+		default:						return "JOBLIST_UNKNOWN";
+	}
 }
 
 /*
@@ -163,6 +170,47 @@ struct threadStats_t {
 	uint64			threadTotalTime[MAX_THREADS];
 };
 
+/*
+================================================
+idJobStealDeque
+
+Chase-Lev work stealing deque. Only the owning thread pushes and pops at the bottom,
+any other thread may steal from the top. Items are ranges of jobs from a single job
+list which are lazily split in half when popped, so the deque never holds more than
+a couple of items per job list and can be a small fixed size ring.
+================================================
+*/
+struct stealJobRange_t {
+	idParallelJobList_Threads *	jobList;
+	int							firstJob;
+	int							numJobs;
+	unsigned int				parallelism;	// copied so thieves never look at a job list they did not steal from
+};
+
+class idJobStealDeque {
+public:
+	static const int		MAX_STEAL_RANGES = 256;
+
+							idJobStealDeque() {}
+
+	// owner only
+	bool					Push( const stealJobRange_t & range );
+	bool					Pop( stealJobRange_t & range );
+	// any thread
+	bool					Steal( stealJobRange_t & range, unsigned int threadNum );
+	bool					IsEmpty() const { return Size( top.GetValue(), bottom.GetValue() ) <= 0; }
+
+private:
+	idSysInterlockedInteger	top;
+	idSysInterlockedInteger	bottom;
+	stealJobRange_t			ranges[MAX_STEAL_RANGES];
+
+	// the indices are free running and allowed to wrap
+	static int				Size( int t, int b ) { return (int)( (unsigned int)b - (unsigned int)t ); }
+};
+
+compile_time_assert( CONST_ISPOWEROFTWO( idJobStealDeque::MAX_STEAL_RANGES ) );
+
 class idParallelJobList_Threads {
 public:
 							idParallelJobList_Threads( jobListId_t id, jobListPriority_t priority, unsigned int maxJobs, unsigned int maxSyncs );
@@ -195,6 +243,14 @@ public:
 
 	bool					WaitForOtherJobList();
 
+	//------------------------
+	// Work stealing backend, called from the stealing job threads.
+	//------------------------
+	unsigned int			GetStealParallelism() const { return stealParallelism; }
+	void					SetStealParallelism( unsigned int parallelism ) { stealParallelism = parallelism; }
+	void					PushStealSegment( idJobStealDeque & deque );
+	void					RunStealJobs( unsigned int threadNum, stealJobRange_t & range, idJobStealDeque & deque );
+
 	//------------------------
 	// This is thread safe and called from the job threads.
 	//------------------------
@@ -237,7 +293,17 @@ private:
 	threadStats_t						deferredThreadStats;
 	threadStats_t						threadStats;
 
+	// the work stealing backend ignores the signal counts and instead runs the jobs
+	// between two synchronization points as a single segment
+	idList< int, TAG_JOBLIST >			stealJobs;			// indices of the jobs that are not sync points
+	idList< int, TAG_JOBLIST >			stealSegmentEnds;	// one past the last steal job of each segment
+	int									stealSegment;		// segment currently being executed
+	idSysInterlockedInteger				stealJobsPending;	// jobs of the current segment that have not finished yet
+	unsigned int						stealParallelism;
+
 	int						RunJobsInternal( unsigned int threadNum, threadJobListState_t & state, bool singleJob );
+	void					PrepareStealSegments();
+	void					FinishStealing();
 
 	static void				Nop( void * data ) {}
 
@@ -265,7 +331,9 @@ idParallelJobList_Threads::idParallelJobList_Threads( jobListId_t id, jobListPri
 	lastSignalJob( 0 ),
 	waitForGuard( NULL ),
 	currentDoneGuard( 0 ),
-	jobList() {
+	jobList(),
+	stealSegment( 0 ),
+	stealParallelism( 0 ) {
 
 	assert( listPriority != JOBLIST_PRIORITY_NONE );
 
@@ -412,7 +480,16 @@ void idParallelJobList_Threads::Submit( idParallelJobList_Threads * waitForJobLi
 
 	if ( threaded ) {
 		// hand over to the manager
+		bool IsWorkStealingActive();
 		void SubmitJobList( idParallelJobList_Threads * jobList, int parallelism );
+		if ( IsWorkStealingActive() ) {
+			PrepareStealSegments();
+			if ( stealJobs.Num() == 0 ) {
+				// only sync points
+				FinishStealing();
+				return;
+			}
+		}
 		SubmitJobList( this, parallelism );
 	} else {
 		// run all the jobs right here
@@ -453,6 +530,10 @@ void idParallelJobList_Threads::Wait() {
 
 		uint64 waitEnd = Sys_Microseconds();
 		deferredThreadStats.waitTime = waited ? ( waitEnd - waitStart ) : 0;
+
+		if ( waited && idParallelJobTrace::IsCapturing() ) {
+			idParallelJobTrace::AddEvent( GetJobListName( listId ), "wait", waitStart, waitEnd );
+		}
 	}
 	memcpy( & threadStats, & deferredThreadStats, sizeof( threadStats ) );
 	done = true;
@@ -635,6 +716,10 @@ int idParallelJobList_Threads::RunJobsInternal( unsigned int threadNum, threadJo
 			uint64 jobEnd = Sys_Microseconds();
 			deferredThreadStats.threadExecTime[threadNum] += jobEnd - jobStart;
 
+			if ( idParallelJobTrace::IsCapturing() ) {
+				idParallelJobTrace::AddEvent( GetJobName( jobList[state.nextJobIndex].function ), "job", jobStart, jobEnd );
+			}
+
 #ifndef _DEBUG
 			if ( jobs_longJobMicroSec.GetInteger() > 0 ) {
 				if ( jobEnd - jobStart > jobs_longJobMicroSec.GetInteger()
@@ -699,6 +784,143 @@ bool idParallelJobList_Threads::WaitForOtherJobList() {
 	return false;
 }
 
+void WakeStealThreads( int count );
+
+/*
+========================
+idParallelJobList_Threads::PrepareStealSegments
+========================
+*/
+void idParallelJobList_Threads::PrepareStealSegments() {
+	stealJobs.SetNum( 0 );
+	stealSegmentEnds.SetNum( 0 );
+	stealJobs.AssureSize( jobList.Num() );
+
+	// A sync point only requires the jobs before the preceding signal to be done, but
+	// waiting for all preceding jobs is always safe and keeps the segments contiguous.
+	for ( int i = 0; i < jobList.Num(); i++ ) {
+		const void * data = jobList[i].data;
+		if ( data == & JOB_SIGNAL || data == & JOB_LIST_DONE ) {
+			continue;
+		}
+		if ( data == & JOB_SYNCHRONIZE ) {
+			if ( stealSegmentEnds.Num() == 0 || stealSegmentEnds[stealSegmentEnds.Num() - 1] != stealJobs.Num() ) {
+				stealSegmentEnds.Append( stealJobs.Num() );
+			}
+			continue;
+		}
+		stealJobs.Append( i );
+	}
+	if ( stealSegmentEnds.Num() == 0 || stealSegmentEnds[stealSegmentEnds.Num() - 1] != stealJobs.Num() ) {
+		stealSegmentEnds.Append( stealJobs.Num() );
+	}
+
+	stealSegment = 0;
+	stealJobsPending.SetValue( stealSegmentEnds[0] );
+	SYS_MEMORYBARRIER;
+}
+
+/*
+========================
+idParallelJobList_Threads::PushStealSegment
+========================
+*/
+void idParallelJobList_Threads::PushStealSegment( idJobStealDeque & deque ) {
+	stealJobRange_t range;
+	range.jobList = this;
+	range.parallelism = stealParallelism;
+	range.firstJob = ( stealSegment > 0 ) ? stealSegmentEnds[stealSegment - 1] : 0;
+	range.numJobs = stealSegmentEnds[stealSegment] - range.firstJob;
+	if ( !deque.Push( range ) ) {
+		idLib::Error( "Work stealing deque overflow for job list %s", GetJobListName( GetId() ) );
+	}
+}
+
+/*
+========================
+idParallelJobList_Threads::FinishStealing
+========================
+*/
+void idParallelJobList_Threads::FinishStealing() {
+	deferredThreadStats.endTime = Sys_Microseconds();
+	// satisfy the signal counts that Wait() and TryWait() check
+	for ( int i = 0; i < signalJobCount.Num(); i++ ) {
+		signalJobCount[i].SetValue( 0 );
+	}
+	SYS_MEMORYBARRIER;
+	doneGuards[currentDoneGuard].Decrement();
+}
+
+/*
+========================
+idParallelJobList_Threads::RunStealJobs
+
+Splits the range in half until a single job remains, leaving the other halves
+on the deque for the owning thread or thieves, and runs that job.
+========================
+*/
+void idParallelJobList_Threads::RunStealJobs( unsigned int threadNum, stealJobRange_t & range, idJobStealDeque & deque ) {
+	assert( threadNum < MAX_THREADS );
+
+	uint64 start = Sys_Microseconds();
+
+	numThreadsExecuting.Increment();
+
+	if ( deferredThreadStats.startTime == 0 ) {
+		deferredThreadStats.startTime = start;	// first time any thread is running jobs from this list
+	}
+
+	while ( range.numJobs > 1 ) {
+		stealJobRange_t upper;
+		upper.jobList = this;
+		upper.parallelism = stealParallelism;
+		upper.numJobs = range.numJobs >> 1;
+		upper.firstJob = range.firstJob + range.numJobs - upper.numJobs;
+		if ( !deque.Push( upper ) ) {
+			break;
+		}
+		range.numJobs -= upper.numJobs;
+		WakeStealThreads( 1 );
+	}
+
+	// if the deque was full the remainder of the range is run in place
+	int numFinished = 0;
+	for ( int i = 0; i < range.numJobs; i++ ) {
+		job_t & job = jobList[stealJobs[range.firstJob + i]];
+
+		uint64 jobStart = Sys_Microseconds();
+
+		job.function( job.data );
+		job.executed = 1;
+
+		uint64 jobEnd = Sys_Microseconds();
+		deferredThreadStats.threadExecTime[threadNum] += jobEnd - jobStart;
+		numFinished++;
+
+		if ( idParallelJobTrace::IsCapturing() ) {
+			idParallelJobTrace::AddEvent( GetJobName( job.function ), "job", jobStart, jobEnd );
+		}
+	}
+
+	if ( stealJobsPending.Sub( numFinished ) == 0 ) {
+		// this thread finished the last job of the segment
+		if ( ++stealSegment < stealSegmentEnds.Num() ) {
+			stealJobsPending.SetValue( stealSegmentEnds[stealSegment] - stealSegmentEnds[stealSegment - 1] );
+			SYS_MEMORYBARRIER;
+			PushStealSegment( deque );
+			WakeStealThreads( stealParallelism - 1 );
+		} else {
+			FinishStealing();
+			// job lists waiting for this one may be claimed now
+			WakeStealThreads( MAX_THREADS );
+		}
+	}
+
+	deferredThreadStats.threadTotalTime[threadNum] += Sys_Microseconds() - start;
+
+	numThreadsExecuting.Decrement();
+}
+
 /*
 ================================================================================================
 
@@ -991,6 +1213,9 @@ int idJobThread::Run() {
 	threadJobListState_t threadJobListState[MAX_JOBLISTS];
 	int numJobLists = 0;
 	int lastStalledJobList = -1;
+	uint64 stallStart = 0;
+
+	idParallelJobTrace::SetThreadName( GetName() );
 
 	while ( !IsTerminating() ) {
 
@@ -1037,6 +1262,16 @@ int idJobThread::Run() {
 		// try running one or more jobs from the current job list
 		int result = threadJobListState[currentJobList].jobList->RunJobs( threadNum, threadJobListState[currentJobList], singleJob );
 
+		// record the time spent stalled on sync points without making any progress
+		if ( ( result & ( idParallelJobList_Threads::RUN_PROGRESS | idParallelJobList_Threads::RUN_DONE ) ) != 0 ) {
+			if ( stallStart != 0 ) {
+				idParallelJobTrace::AddEvent( "sync point stall", "stall", stallStart, Sys_Microseconds() );
+				stallStart = 0;
+			}
+		} else if ( stallStart == 0 && idParallelJobTrace::IsCapturing() ) {
+			stallStart = Sys_Microseconds();
+		}
+
 		if ( ( result & idParallelJobList_Threads::RUN_DONE ) != 0 ) {
 			// done with this job list so remove it from the local list
 			for ( int i = currentJobList; i < numJobLists - 1; i++ ) {
@@ -1062,6 +1297,198 @@ int idJobThread::Run() {
 /*
 ================================================================================================
 
+idJobStealThread
+
+================================================================================================
+*/
+
+/*
+========================
+idJobStealDeque::Push
+========================
+*/
+bool idJobStealDeque::Push( const stealJobRange_t & range ) {
+	int b = bottom.GetValue();
+	int t = top.GetValue();
+	if ( Size( t, b ) >= MAX_STEAL_RANGES ) {
+		return false;
+	}
+	ranges[b & ( MAX_STEAL_RANGES - 1 )] = range;
+	// make sure the range is visible before the new bottom
+	SYS_MEMORYBARRIER;
+	bottom.SetValue( b + 1 );
+	return true;
+}
+
+/*
+========================
+idJobStealDeque::Pop
+========================
+*/
+bool idJobStealDeque::Pop( stealJobRange_t & range ) {
+	int b = bottom.GetValue() - 1;
+	bottom.SetValue( b );
+	// the new bottom must be visible to thieves before top is read
+	SYS_MEMORYBARRIER;
+	int t = top.GetValue();
+	int size = Size( t, b );
+	if ( size < 0 ) {
+		// empty
+		bottom.SetValue( t );
+		return false;
+	}
+	range = ranges[b & ( MAX_STEAL_RANGES - 1 )];
+	if ( size > 0 ) {
+		return true;
+	}
+	// last item so race against thieves
+	bool won = ( top.CompareExchange( t, t + 1 ) == t );
+	bottom.SetValue( t + 1 );
+	return won;
+}
+
+/*
+========================
+idJobStealDeque::Steal
+========================
+*/
+bool idJobStealDeque::Steal( stealJobRange_t & range, unsigned int threadNum ) {
+	int t = top.GetValue();
+	SYS_MEMORYBARRIER;
+	int b = bottom.GetValue();
+	if ( Size( t, b ) <= 0 ) {
+		return false;
+	}
+	range = ranges[t & ( MAX_STEAL_RANGES - 1 )];
+	// don't steal from job lists that were submitted with a lower parallelism
+	if ( threadNum >= range.parallelism ) {
+		return false;
+	}
+	return ( top.CompareExchange( t, t + 1 ) == t );
+}
+
+static idCVar jobs_workStealing( "jobs_workStealing", "0", CVAR_BOOL | CVAR_INIT, "use per thread work stealing deques instead of the shared job list fetch" );
+static idCVar jobs_stealThreads( "jobs_stealThreads", "0", CVAR_INTEGER | CVAR_INIT, "number of work stealing job threads, 0 = one less than the number of logical cores", 0, MAX_THREADS );
+static idCVar jobs_stealSpins( "jobs_stealSpins", "64", CVAR_INTEGER | CVAR_NOCHEAT, "number of failed steal attempts before a job thread parks" );
+
+bool FindStealWork( unsigned int threadNum, unsigned int & randomSeed, stealJobRange_t & range );
+bool FetchStealJobList( unsigned int threadNum, idJobStealDeque & deque );
+bool HasStealWork( unsigned int threadNum );
+
+class idJobStealThread : public idSysThread {
+public:
+								idJobStealThread();
+
+	void						Start( core_t core, unsigned int threadNum );
+	void						Stop();
+
+	// wakes up the thread if it is parked, returns false if it was running
+	bool						Wake();
+
+	idJobStealDeque &			GetDeque() { return deque; }
+
+private:
+	idJobStealDeque				deque;
+	idSysSignal					wakeSignal;
+	idSysInterlockedInteger		parked;
+	unsigned int				threadNum;
+	unsigned int				randomSeed;
+
+	virtual int					Run();
+};
+
+/*
+========================
+idJobStealThread::idJobStealThread
+========================
+*/
+idJobStealThread::idJobStealThread() :
+		threadNum( 0 ),
+		randomSeed( 0 ) {
+}
+
+/*
+========================
+idJobStealThread::Start
+========================
+*/
+void idJobStealThread::Start( core_t core, unsigned int threadNum ) {
+	this->threadNum = threadNum;
+	this->randomSeed = 0x9E3779B9 * ( threadNum + 1 );
+	StartThread( va( "JobStealProcessor_%d", threadNum ), core, THREAD_NORMAL, JOB_THREAD_STACK_SIZE );
+}
+
+/*
+========================
+idJobStealThread::Stop
+========================
+*/
+void idJobStealThread::Stop() {
+	StopThread( false );
+	wakeSignal.Raise();
+	WaitForThread();
+}
+
+/*
+========================
+idJobStealThread::Wake
+========================
+*/
+bool idJobStealThread::Wake() {
+	if ( parked.GetValue() == 0 ) {
+		return false;
+	}
+	wakeSignal.Raise();
+	return true;
+}
+
+/*
+========================
+idJobStealThread::Run
+========================
+*/
+int idJobStealThread::Run() {
+	int idleCount = 0;
+
+	idParallelJobTrace::SetThreadName( GetName() );
+
+	while ( !IsTerminating() ) {
+		stealJobRange_t range;
+
+		// work on our own deque first, then try to steal, then look for newly submitted job lists
+		if ( deque.Pop( range ) || FindStealWork( threadNum, randomSeed, range ) ) {
+			range.jobList->RunStealJobs( threadNum, range, deque );
+			idleCount = 0;
+			continue;
+		}
+		if ( FetchStealJobList( threadNum, deque ) ) {
+			idleCount = 0;
+			continue;
+		}
+
+		if ( ++idleCount < jobs_stealSpins.GetInteger() ) {
+			Sys_Yield();
+			continue;
+		}
+
+		// park until new work is pushed, the flag must be visible before checking
+		// for work again so a concurrent push will raise the signal
+		parked.SetValue( 1 );
+		SYS_MEMORYBARRIER;
+		if ( !HasStealWork( threadNum ) && !IsTerminating() ) {
+			uint64 parkStart = Sys_Microseconds();
+			wakeSignal.Wait( idSysSignal::WAIT_INFINITE );
+			idParallelJobTrace::AddEvent( "parked", "stall", parkStart, Sys_Microseconds() );
+		}
+		parked.SetValue( 0 );
+		idleCount = 0;
+	}
+	return 0;
+}
+
+/*
+================================================================================================
+
 idParallelJobManagerLocal
 
 ================================================================================================
@@ -1125,6 +1552,12 @@ public:
 
 	void						Submit( idParallelJobList_Threads * jobList, int parallelism );
 
+	bool						IsWorkStealing() const { return workStealing; }
+	void						WakeStealThreads( int count );
+	bool						FindStealWork( unsigned int threadNum, unsigned int & randomSeed, stealJobRange_t & range );
+	bool						FetchStealJobList( unsigned int threadNum, idJobStealDeque & deque );
+	bool						HasStealWork( unsigned int threadNum );
+
 private:
 	idJobThread						threads[MAX_JOB_THREADS];
 	unsigned int					maxThreads;
@@ -1132,6 +1565,14 @@ private:
 	int								numLogicalCpuCores;
 	int								numCpuPackages;
 	idStaticList< idParallelJobList *, MAX_JOBLISTS >	jobLists;
+
+	// work stealing backend
+	bool							workStealing;
+	idJobStealThread				stealThreads[MAX_THREADS];
+	unsigned int					numStealThreads;
+	idSysMutex						stealQueueMutex;
+	idStaticList< idParallelJobList_Threads *, MAX_JOBLISTS >	stealQueue;	// submitted job lists not yet claimed by a thread
+	idSysInterlockedInteger			numStealQueued;
 };
 
 idParallelJobManagerLocal parallelJobManagerLocal;
@@ -1146,6 +1587,51 @@ void SubmitJobList( idParallelJobList_Threads * jobList, int parallelism ) {
 	parallelJobManagerLocal.Submit( jobList, parallelism );
 }
 
+/*
+========================
+IsWorkStealingActive
+========================
+*/
+bool IsWorkStealingActive() {
+	return parallelJobManagerLocal.IsWorkStealing();
+}
+
+/*
+========================
+WakeStealThreads
+========================
+*/
+void WakeStealThreads( int count ) {
+	parallelJobManagerLocal.WakeStealThreads( count );
+}
+
+/*
+========================
+FindStealWork
+========================
+*/
+bool FindStealWork( unsigned int threadNum, unsigned int & randomSeed, stealJobRange_t & range ) {
+	return parallelJobManagerLocal.FindStealWork( threadNum, randomSeed, range );
+}
+
+/*
+========================
+FetchStealJobList
+========================
+*/
+bool FetchStealJobList( unsigned int threadNum, idJobStealDeque & deque ) {
+	return parallelJobManagerLocal.FetchStealJobList( threadNum, deque );
+}
+
+/*
+========================
+HasStealWork
+========================
+*/
+bool HasStealWork( unsigned int threadNum ) {
+	return parallelJobManagerLocal.HasStealWork( threadNum );
+}
+
 /*
 ========================
 idParallelJobManagerLocal::Init
@@ -1156,12 +1642,27 @@ void idParallelJobManagerLocal::Init() {
 	core_t cores[] = JOB_THREAD_CORES;
 	assert( sizeof( cores ) / sizeof( cores[0] ) >= MAX_JOB_THREADS );
 
+	Sys_CPUCount( numPhysicalCpuCores, numLogicalCpuCores, numCpuPackages );
+
+	workStealing = jobs_workStealing.GetBool();
+	if ( workStealing ) {
+		numStealThreads = jobs_stealThreads.GetInteger();
+		if ( numStealThreads == 0 ) {
+			numStealThreads = numLogicalCpuCores - 1;
+		}
+		numStealThreads = idMath::ClampInt( 1, MAX_THREADS, numStealThreads );
+		for ( unsigned int i = 0; i < numStealThreads; i++ ) {
+			stealThreads[i].Start( CORE_ANY, i );
+		}
+		maxThreads = numStealThreads;
+		idLib::Printf( "Job system: %d work stealing threads\n", numStealThreads );
+		return;
+	}
+
 	for ( int i = 0; i < MAX_JOB_THREADS; i++ ) {
 		threads[i].Start( cores[i], i );
 	}
 	maxThreads = jobs_numThreads.GetInteger();
-
-	Sys_CPUCount( numPhysicalCpuCores, numLogicalCpuCores, numCpuPackages );
 }
 
 /*
@@ -1170,6 +1671,12 @@ idParallelJobManagerLocal::Shutdown
 ========================
 */
 void idParallelJobManagerLocal::Shutdown() {
+	if ( workStealing ) {
+		for ( unsigned int i = 0; i < numStealThreads; i++ ) {
+			stealThreads[i].Stop();
+		}
+		return;
+	}
 	for ( int i = 0; i < MAX_JOB_THREADS; i++ ) {
 		threads[i].StopThread();
 	}
@@ -1201,8 +1708,11 @@ void idParallelJobManagerLocal::FreeJobList( idParallelJobList * jobList ) {
 		return;
 	}
 	// wait for all job threads to finish because job list deletion is not thread safe
-	for ( unsigned int i = 0; i < maxThreads; i++ ) {
-		threads[i].WaitForThread();
+	// the work stealing threads never hold on to a job list once it is done
+	if ( !workStealing ) {
+		for ( unsigned int i = 0; i < maxThreads; i++ ) {
+			threads[i].WaitForThread();
+		}
 	}
 	int index = jobLists.FindIndex( jobList );
 	assert( index >= 0 && jobLists[index] == jobList );
@@ -1265,6 +1775,27 @@ idParallelJobManagerLocal::Submit
 ========================
 */
 void idParallelJobManagerLocal::Submit( idParallelJobList_Threads * jobList, int parallelism ) {
+	if ( workStealing ) {
+		int numThreads = numStealThreads;
+		if ( parallelism >= 0 ) {
+			numThreads = Min( parallelism, (int)numStealThreads );
+		}
+		if ( numThreads <= 0 ) {
+			threadJobListState_t state( jobList->GetVersion() );
+			jobList->RunJobs( 0, state, false );
+			return;
+		}
+		jobList->SetStealParallelism( numThreads );
+
+		stealQueueMutex.Lock();
+		stealQueue.Append( jobList );
+		numStealQueued.Increment();
+		stealQueueMutex.Unlock();
+
+		WakeStealThreads( numThreads );
+		return;
+	}
+
 	if ( jobs_numThreads.IsModified() ) {
 		maxThreads = idMath::ClampInt( 0, MAX_JOB_THREADS, jobs_numThreads.GetInteger() );
 		jobs_numThreads.ClearModified();
@@ -1294,4 +1825,205 @@ void idParallelJobManagerLocal::Submit( idParallelJobList_Threads * jobList, int
 		threads[i].AddJobList( jobList );
 		threads[i].SignalWork();
 	}
-}
\ No newline at end of file
+}
+
+/*
+========================
+idParallelJobManagerLocal::WakeStealThreads
+========================
+*/
+void idParallelJobManagerLocal::WakeStealThreads( int count ) {
+	// the new work must be visible before the parked flags are checked
+	SYS_MEMORYBARRIER;
+	for ( unsigned int i = 0; i < numStealThreads && count > 0; i++ ) {
+		if ( stealThreads[i].Wake() ) {
+			count--;
+		}
+	}
+}
+
+/*
+========================
+idParallelJobManagerLocal::FindStealWork
+========================
+*/
+bool idParallelJobManagerLocal::FindStealWork( unsigned int threadNum, unsigned int & randomSeed, stealJobRange_t & range ) {
+	if ( numStealThreads <= 1 ) {
+		return false;
+	}
+	// start at a random victim so thieves don't all hammer the same deque
+	randomSeed ^= randomSeed << 13;
+	randomSeed ^= randomSeed >> 17;
+	randomSeed ^= randomSeed << 5;
+	unsigned int first = randomSeed % numStealThreads;
+	for ( unsigned int i = 0; i < numStealThreads; i++ ) {
+		unsigned int victim = ( first + i ) % numStealThreads;
+		if ( victim == threadNum ) {
+			continue;
+		}
+		if ( stealThreads[victim].GetDeque().Steal( range, threadNum ) ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+========================
+idParallelJobManagerLocal::FetchStealJobList
+
+Claims the highest priority submitted job list and pushes its first segment on the given deque.
+========================
+*/
+bool idParallelJobManagerLocal::FetchStealJobList( unsigned int threadNum, idJobStealDeque & deque ) {
+	if ( numStealQueued.GetValue() == 0 ) {
+		return false;
+	}
+
+	stealQueueMutex.Lock();
+	int best = -1;
+	for ( int i = 0; i < stealQueue.Num(); i++ ) {
+		idParallelJobList_Threads * jobList = stealQueue[i];
+		if ( threadNum >= jobList->GetStealParallelism() || jobList->WaitForOtherJobList() ) {
+			continue;
+		}
+		if ( best < 0 || jobList->GetPriority() > stealQueue[best]->GetPriority() ) {
+			best = i;
+		}
+	}
+	idParallelJobList_Threads * jobList = NULL;
+	if ( best >= 0 ) {
+		jobList = stealQueue[best];
+		// keep the submission order for lists with equal priority
+		stealQueue.RemoveIndex( best );
+		numStealQueued.Decrement();
+	}
+	stealQueueMutex.Unlock();
+
+	if ( jobList == NULL ) {
+		return false;
+	}
+
+	jobList->PushStealSegment( deque );
+	WakeStealThreads( jobList->GetStealParallelism() - 1 );
+	return true;
+}
+
+/*
+========================
+idParallelJobManagerLocal::HasStealWork
+========================
+*/
+bool idParallelJobManagerLocal::HasStealWork( unsigned int threadNum ) {
+	if ( numStealQueued.GetValue() > 0 ) {
+		// job lists that wait for another job list don't count, finishing that list wakes up all threads
+		bool claimable = false;
+		stealQueueMutex.Lock();
+		for ( int i = 0; i < stealQueue.Num(); i++ ) {
+			if ( threadNum < stealQueue[i]->GetStealParallelism() && !stealQueue[i]->WaitForOtherJobList() ) {
+				claimable = true;
+				break;
+			}
+		}
+		stealQueueMutex.Unlock();
+		if ( claimable ) {
+			return true;
+		}
+	}
+	for ( unsigned int i = 0; i < numStealThreads; i++ ) {
+		if ( !stealThreads[i].GetDeque().IsEmpty() ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+================================================================================================
+
+	Job scaling benchmark
+
+================================================================================================
+*/
+
+struct jobBenchmarkParms_t {
+	int		iterations;
+	float	result;
+};
+
+/*
+========================
+JobBenchmark_Work
+========================
+*/
+static void JobBenchmark_Work( jobBenchmarkParms_t * parms ) {
+	float x = (float)parms->iterations;
+	for ( int i = 0; i < parms->iterations; i++ ) {
+		x = x * 0.999f + idMath::Sqrt( x + 1.0f );
+	}
+	parms->result = x;
+}
+REGISTER_PARALLEL_JOB( JobBenchmark_Work, "JobBenchmark_Work" );
+
+/*
+========================
+jobs_benchmark
+
+Runs the same job list with 1 to N processing units and prints the throughput.
+========================
+*/
+CONSOLE_COMMAND( jobs_benchmark, "measures job throughput with 1 to N job threads, usage: jobs_benchmark [numJobs] [iterations] [numSyncs]", 0 ) {
+	const int numJobs = ( args.Argc() > 1 ) ? Max( 1, atoi( args.Argv( 1 ) ) ) : 4096;
+	const int iterations = ( args.Argc() > 2 ) ? Max( 1, atoi( args.Argv( 2 ) ) ) : 1000;
+	const int numSyncs = ( args.Argc() > 3 ) ? Max( 0, atoi( args.Argv( 3 ) ) ) : 0;
+	const int numRuns = 8;
+
+	idList< jobBenchmarkParms_t, TAG_JOBLIST > parms;
+	parms.SetNum( numJobs );
+	for ( int i = 0; i < numJobs; i++ ) {
+		parms[i].iterations = iterations;
+		parms[i].result = 0.0f;
+	}
+
+	idParallelJobList * jobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, numJobs, numSyncs, NULL );
+
+	const int numUnits = parallelJobManager->GetNumProcessingUnits();
+	idLib::Printf( "%d jobs x %d iterations, %d sync points, %s backend\n", numJobs, iterations, numSyncs, IsWorkStealingActive() ? "work stealing" : "shared list" );
+	idLib::Printf( "threads      msec    jobs/sec  speedup  wasted\n" );
+
+	uint64 singleTime = 0;
+	for ( int numThreads = 1; numThreads <= numUnits; numThreads++ ) {
+		uint64 bestTime = 0;
+		uint64 wastedTime = 0;
+		for ( int run = 0; run < numRuns; run++ ) {
+			const int jobsPerSync = numJobs / ( numSyncs + 1 );
+			int syncs = 0;
+			for ( int i = 0; i < numJobs; i++ ) {
+				if ( syncs < numSyncs && i > 0 && ( i % jobsPerSync ) == 0 ) {
+					jobList->InsertSyncPoint( SYNC_SIGNAL );
+					jobList->InsertSyncPoint( SYNC_SYNCHRONIZE );
+					syncs++;
+				}
+				jobList->AddJob( (jobRun_t)JobBenchmark_Work, &parms[i] );
+			}
+			uint64 start = Sys_Microseconds();
+			jobList->Submit( NULL, numThreads );
+			jobList->Wait();
+			uint64 time = Sys_Microseconds() - start;
+			if ( run == 0 || time < bestTime ) {
+				bestTime = time;
+				wastedTime = jobList->GetTotalWastedTimeMicroSec();
+			}
+		}
+		if ( numThreads == 1 ) {
+			singleTime = bestTime;
+		}
+		const float msec = bestTime * ( 1.0f / 1000.0f );
+		const float jobsPerSec = ( bestTime > 0 ) ? numJobs * 1000000.0f / bestTime : 0.0f;
+		const float speedup = ( bestTime > 0 ) ? (float)singleTime / bestTime : 0.0f;
+		const float wasted = ( bestTime > 0 ) ? 100.0f * wastedTime / ( bestTime * numThreads ) : 0.0f;
+		idLib::Printf( "%7d  %8.2f  %10.0f  %6.2fx  %5.1f%%\n", numThreads, msec, jobsPerSec, speedup, wasted );
+	}
+
+	parallelJobManager->FreeJobList( jobList );
+}
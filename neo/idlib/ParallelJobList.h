@@ -157,6 +157,8 @@ public:
 
 extern idParallelJobManager *	parallelJobManager;
 
+const char * GetJobListName( jobListId_t id );
+
 // jobRun_t functions can have the debug name associated with them
 // by explicitly calling this, or using the REGISTER_PARALLEL_JOB()
 // static variable macro.
@@ -0,0 +1,307 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").  
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+#pragma hdrstop
+#include "precompiled.h"
+#include "ParallelJobTrace.h"
+
+/*
+================================================================================================
+
+	Per thread event rings
+
+================================================================================================
+*/
+
+static const int MAX_TRACE_THREADS		= 64;
+static const int MAX_TRACE_EVENTS		= 16384;	// per thread, older events are overwritten
+static const int MAX_TRACE_FRAMES		= 256;
+
+compile_time_assert( CONST_ISPOWEROFTWO( MAX_TRACE_EVENTS ) );
+
+struct traceEvent_t {
+	const char *	name;
+	const char *	category;
+	uint64			start;
+	uint64			end;
+};
+
+struct traceThread_t {
+	traceEvent_t *			events;			// allocated when the thread records its first event
+	idSysInterlockedInteger	head;			// only written by the owning thread
+	int						captureStart;	// value of head when the capture started
+	idSysInterlockedInteger	inUse;			// 1 while a running thread owns the slot
+	char					name[32];
+};
+
+static traceThread_t			traceThreads[MAX_TRACE_THREADS];
+static idSysInterlockedInteger	numTraceThreads;
+static ID_TLS					traceThreadSlot;	// slot + 1 of the calling thread
+
+volatile bool					idParallelJobTrace::capturing = false;
+
+static int						captureFramesRequested;
+static int						captureFramesDone;
+static idStrStatic< MAX_OSPATH >	captureFileName;
+static uint64					captureFrameTimes[MAX_TRACE_FRAMES + 1];
+
+/*
+========================
+GetTraceThread
+========================
+*/
+static traceThread_t * GetTraceThread() {
+	int slot = (int)(ptrdiff_t)traceThreadSlot;
+	if ( slot > 0 ) {
+		return &traceThreads[slot - 1];
+	}
+	for ( ; ; ) {
+		// reuse the slot of a thread that exited, threads that are created over and over would run out of slots otherwise
+		const int numThreads = Min( numTraceThreads.GetValue(), MAX_TRACE_THREADS );
+		for ( int i = 0; i < numThreads && slot == 0; i++ ) {
+			if ( traceThreads[i].inUse.CompareExchange( 0, 1 ) == 0 ) {
+				slot = i + 1;
+			}
+		}
+		if ( slot > 0 ) {
+			break;
+		}
+		slot = numTraceThreads.Increment();
+		if ( slot > MAX_TRACE_THREADS ) {
+			numTraceThreads.Decrement();
+			return NULL;
+		}
+		if ( traceThreads[slot - 1].inUse.CompareExchange( 0, 1 ) == 0 ) {
+			break;
+		}
+		// another thread looking for a free slot took the new one first
+		slot = 0;
+	}
+	traceThread_t * thread = &traceThreads[slot - 1];
+	idStr::snPrintf( thread->name, sizeof( thread->name ), "thread %d", slot - 1 );
+	traceThreadSlot = (ptrdiff_t)slot;
+	return thread;
+}
+
+/*
+========================
+idParallelJobTrace::ReleaseThread
+========================
+*/
+void idParallelJobTrace::ReleaseThread() {
+	const int slot = (int)(ptrdiff_t)traceThreadSlot;
+	if ( slot <= 0 ) {
+		return;
+	}
+	traceThreadSlot = 0;
+	// the events stay in the ring, so a running capture still writes them
+	SYS_MEMORYBARRIER;
+	traceThreads[slot - 1].inUse.SetValue( 0 );
+}
+
+/*
+========================
+idParallelJobTrace::SetThreadName
+========================
+*/
+void idParallelJobTrace::SetThreadName( const char * name ) {
+	traceThread_t * thread = GetTraceThread();
+	if ( thread != NULL ) {
+		idStr::Copynz( thread->name, name, sizeof( thread->name ) );
+	}
+}
+
+/*
+========================
+idParallelJobTrace::AddEvent
+========================
+*/
+void idParallelJobTrace::AddEvent( const char * name, const char * category, uint64 startMicroSec, uint64 endMicroSec ) {
+	if ( !capturing ) {
+		return;
+	}
+	traceThread_t * thread = GetTraceThread();
+	if ( thread == NULL ) {
+		return;
+	}
+	if ( thread->events == NULL ) {
+		// only threads that record events during a capture need a ring
+		thread->events = (traceEvent_t *)Mem_ClearedAlloc( MAX_TRACE_EVENTS * sizeof( traceEvent_t ), TAG_JOBLIST );
+	}
+	int head = thread->head.GetValue();
+	traceEvent_t & event = thread->events[head & ( MAX_TRACE_EVENTS - 1 )];
+	event.name = name;
+	event.category = category;
+	event.start = startMicroSec;
+	event.end = endMicroSec;
+	// publish the event after it is completely written
+	SYS_MEMORYBARRIER;
+	thread->head.SetValue( head + 1 );
+}
+
+/*
+========================
+idParallelJobTrace::StartCapture
+========================
+*/
+void idParallelJobTrace::StartCapture( int numFrames, const char * fileName ) {
+	if ( capturing || captureFramesRequested > 0 ) {
+		idLib::Printf( "A job trace capture is already running\n" );
+		return;
+	}
+	captureFramesRequested = idMath::ClampInt( 1, MAX_TRACE_FRAMES, numFrames );
+	captureFramesDone = 0;
+	captureFileName = fileName;
+	captureFileName.DefaultFileExtension( ".json" );
+}
+
+/*
+========================
+idParallelJobTrace::FrameBoundary
+========================
+*/
+void idParallelJobTrace::FrameBoundary() {
+	if ( captureFramesRequested == 0 ) {
+		return;
+	}
+
+	const uint64 now = Sys_Microseconds();
+
+	if ( !capturing ) {
+		SetThreadName( "Main" );
+		// start recording with this frame
+		for ( int i = 0; i < numTraceThreads.GetValue(); i++ ) {
+			traceThreads[i].captureStart = traceThreads[i].head.GetValue();
+		}
+		captureFrameTimes[0] = now;
+		SYS_MEMORYBARRIER;
+		capturing = true;
+		return;
+	}
+
+	captureFrameTimes[++captureFramesDone] = now;
+	if ( captureFramesDone < captureFramesRequested ) {
+		return;
+	}
+
+	capturing = false;
+	SYS_MEMORYBARRIER;
+	WriteCapture();
+	captureFramesRequested = 0;
+}
+
+/*
+========================
+WriteTraceString
+========================
+*/
+static void WriteTraceString( idFile * file, const char * string ) {
+	file->Write( "\"", 1 );
+	for ( const char * s = string; *s != '\0'; s++ ) {
+		if ( *s == '"' || *s == '\\' ) {
+			file->Write( "\\", 1 );
+		}
+		file->Write( s, 1 );
+	}
+	file->Write( "\"", 1 );
+}
+
+/*
+========================
+idParallelJobTrace::WriteCapture
+========================
+*/
+void idParallelJobTrace::WriteCapture() {
+	idFile * file = fileSystem->OpenFileWrite( captureFileName.c_str() );
+	if ( file == NULL ) {
+		idLib::Warning( "Couldn't open %s for writing", captureFileName.c_str() );
+		return;
+	}
+
+	const uint64 base = captureFrameTimes[0];
+	const uint64 last = captureFrameTimes[captureFramesDone];
+	int numEvents = 0;
+	int numLost = 0;
+
+	file->Printf( "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+	file->Printf( "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"doom\"}}" );
+
+	for ( int frame = 0; frame < captureFramesDone; frame++ ) {
+		file->Printf( ",\n{\"name\":\"frame %d\",\"cat\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%lld}",
+						frame, (int64)( captureFrameTimes[frame] - base ) );
+	}
+
+	const int numThreads = Min( numTraceThreads.GetValue(), MAX_TRACE_THREADS );
+	for ( int i = 0; i < numThreads; i++ ) {
+		const traceThread_t & thread = traceThreads[i];
+		if ( thread.events == NULL ) {
+			continue;
+		}
+		const int head = thread.head.GetValue();
+		int first = thread.captureStart;
+		if ( head - first > MAX_TRACE_EVENTS ) {
+			numLost += head - first - MAX_TRACE_EVENTS;
+			first = head - MAX_TRACE_EVENTS;
+		}
+
+		file->Printf( ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", i + 1 );
+		WriteTraceString( file, thread.name );
+		file->Printf( "}}" );
+
+		for ( int j = first; j < head; j++ ) {
+			const traceEvent_t & event = thread.events[j & ( MAX_TRACE_EVENTS - 1 )];
+			if ( event.end < base || event.start > last ) {
+				continue;
+			}
+			file->Printf( ",\n{\"name\":" );
+			WriteTraceString( file, event.name );
+			file->Printf( ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld}",
+							event.category, i + 1, (int64)( event.start - base ), (int64)( event.end - event.start ) );
+			numEvents++;
+		}
+	}
+
+	file->Printf( "\n]}\n" );
+	delete file;
+
+	idLib::Printf( "Wrote %d frames with %d events to %s", captureFramesDone, numEvents, captureFileName.c_str() );
+	if ( numLost > 0 ) {
+		idLib::Printf( ", %d events were overwritten", numLost );
+	}
+	idLib::Printf( "\n" );
+}
+
+/*
+========================
+jobs_traceCapture
+========================
+*/
+CONSOLE_COMMAND( jobs_traceCapture, "captures a timeline of jobs, usage: jobs_traceCapture [numFrames] [fileName]", 0 ) {
+	const int numFrames = ( args.Argc() > 1 ) ? atoi( args.Argv( 1 ) ) : 10;
+	const char * fileName = ( args.Argc() > 2 ) ? args.Argv( 2 ) : "jobtrace.json";
+	idParallelJobTrace::StartCapture( numFrames, fileName );
+}
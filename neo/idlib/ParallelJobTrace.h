@@ -0,0 +1,70 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").  
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+#ifndef __PARALLELJOBTRACE_H__
+#define __PARALLELJOBTRACE_H__
+
+/*
+================================================
+idParallelJobTrace
+
+Records a timeline of jobs, waits and frame boundaries while a capture
+is running and writes it as Chrome trace event JSON, which can be
+loaded in chrome://tracing or ui.perfetto.dev.
+
+Every thread records into its own ring buffer so recording is lock
+free. Nothing is recorded unless a capture was started with the
+"jobs_traceCapture" console command.
+================================================
+*/
+class idParallelJobTrace {
+public:
+	// Returns true while frames are being captured.
+	static bool				IsCapturing() { return capturing; }
+
+	// Names the calling thread in the trace.
+	static void				SetThreadName( const char * name );
+
+	// Called when a thread exits, the next new thread records into its slot.
+	static void				ReleaseThread();
+
+	// Records an event on the calling thread. The name and category must be static strings.
+	static void				AddEvent( const char * name, const char * category, uint64 startMicroSec, uint64 endMicroSec );
+
+	// Called once per frame from the main thread, starts and finishes captures.
+	static void				FrameBoundary();
+
+	// Captures the given number of frames, starting with the next frame, and writes them to the given file.
+	static void				StartCapture( int numFrames, const char * fileName );
+
+private:
+	static volatile bool	capturing;
+
+	static void				WriteCapture();
+};
+
+#endif // !__PARALLELJOBTRACE_H__
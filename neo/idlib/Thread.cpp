@@ -218,6 +218,10 @@ int idSysThread::ThreadProc( idSysThread * thread ) {
 		exit( 0 );
 	}
 
+	// let the next thread use the memory cached for this one
+	Mem_ReleaseThreadCache();
+	idParallelJobTrace::ReleaseThread();
+
 	thread->isRunning = false;
 
 	return retVal;
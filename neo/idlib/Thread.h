@@ -116,6 +116,10 @@ public:
 	// atomically subtracts a value from the integer and returns the new value
 	int					Sub( int v ) { return Sys_InterlockedSub( value, (interlockedInt_t) v ); }
 
+	// atomically sets the integer to 'exchange' only if the current value is equal to 'comparand'
+	// and returns the previous value
+	int					CompareExchange( int comparand, int exchange ) { return Sys_InterlockedCompareExchange( value, (interlockedInt_t) comparand, (interlockedInt_t) exchange ); }
+
 	// returns the current value of the integer
 	int					GetValue() const { return value; }
 
@@ -155,6 +159,45 @@ private:
 	T *		ptr;
 };
 
+/*
+================================================
+idSysInterlockedQueue is a lock free, intrusive, multiple producer single consumer queue.
+Any thread can Add elements, while only one thread at a time may take them out with GetAll.
+Elements added by the same thread come out in the order that thread added them. The element
+type needs a 'type * queueNext' member, which the queue owns while the element is queued.
+================================================
+*/
+template< typename type >
+class idSysInterlockedQueue {
+public:
+	// adds an element, safe to call from any thread
+	void		Add( type * element ) {
+					type * oldHead;
+					do {
+						oldHead = head.Get();
+						element->queueNext = oldHead;
+					} while ( head.CompareExchange( oldHead, element ) != oldHead );
+				}
+
+	// removes all queued elements and returns them linked through queueNext, oldest first
+	type *		GetAll() {
+					type * element = head.Set( NULL );
+					type * first = NULL;
+					while ( element != NULL ) {
+						type * next = element->queueNext;
+						element->queueNext = first;
+						first = element;
+						element = next;
+					}
+					return first;
+				}
+
+	bool		IsEmpty() const { return head.Get() == NULL; }
+
+private:
+	idSysInterlockedPointer< type >	head;
+};
+
 /*
 ================================================
 idSysThread is an abstract base class, to be extended by classes implementing the
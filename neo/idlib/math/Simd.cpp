@@ -31,6 +31,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "Simd_Generic.h"
 #include "Simd_SSE.h"
+#include "Simd_AVX.h"
 
 idSIMDProcessor	*	processor = NULL;			// pointer to SIMD processor
 idSIMDProcessor *	generic = NULL;				// pointer to generic SIMD implementation
@@ -66,7 +67,9 @@ void idSIMD::InitProcessor( const char *module, bool forceGeneric ) {
 	} else {
 
 		if ( processor == NULL ) {
-			if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) ) {
+			if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) && idSIMD_AVX2::IsAvailable( cpuid ) ) {
+				processor = new (TAG_MATH) idSIMD_AVX2;
+			} else if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) ) {
 				processor = new (TAG_MATH) idSIMD_SSE;
 			} else {
 				processor = generic;
@@ -1220,9 +1223,45 @@ void TestMath() {
 	PrintClocks( "     idAngles::ToMat3()", 1, bestClocks );
 }
 
+/*
+============
+CreateTestProcessor
+
+Returns the generic processor or a new processor of the named type, NULL if the CPU can't run it.
+============
+*/
+static idSIMDProcessor * CreateTestProcessor( const char * name, idSIMDProcessor * generic ) {
+	cpuid_t cpuid = idLib::sys->GetProcessorId();
+
+	if ( idStr::Icmp( name, "generic" ) == 0 ) {
+		return generic;
+	} else if ( idStr::Icmp( name, "SSE" ) == 0 ) {
+		if ( !( cpuid & CPUID_MMX ) || !( cpuid & CPUID_SSE ) ) {
+			common->Printf( "CPU does not support MMX & SSE\n" );
+			return NULL;
+		}
+		return new (TAG_MATH) idSIMD_SSE;
+	} else if ( idStr::Icmp( name, "AVX2" ) == 0 ) {
+		if ( !( cpuid & CPUID_AVX2 ) || !( cpuid & CPUID_FMA3 ) ) {
+			common->Printf( "CPU does not support AVX2 & FMA\n" );
+			return NULL;
+		}
+		if ( !idSIMD_AVX2::IsAvailable( cpuid ) ) {
+			common->Printf( "AVX2 & FMA code was not compiled in\n" );
+			return NULL;
+		}
+		return new (TAG_MATH) idSIMD_AVX2;
+	}
+	common->Printf( "invalid argument, use: generic, SSE, AVX2\n" );
+	return NULL;
+}
+
 /*
 ============
 idSIMD::Test_f
+
+testSIMD [processor] [baseline]
+Times the given processor, the active one by default, against the baseline, generic by default.
 ============
 */
 void idSIMD::Test_f( const idCmdArgs &args ) {
@@ -1235,19 +1274,18 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 	p_generic = generic;
 
 	if ( idStr::Length( args.Argv( 1 ) ) != 0 ) {
-		cpuid_t cpuid = idLib::sys->GetProcessorId();
-		idStr argString = args.Args();
-
-		argString.Replace( " ", "" );
-
-		if ( idStr::Icmp( argString, "SSE" ) == 0 ) {
-			if ( !( cpuid & CPUID_MMX ) || !( cpuid & CPUID_SSE ) ) {
-				common->Printf( "CPU does not support MMX & SSE\n" );
-				return;
+		p_simd = CreateTestProcessor( args.Argv( 1 ), generic );
+		if ( p_simd == NULL ) {
+			return;
+		}
+	}
+	if ( idStr::Length( args.Argv( 2 ) ) != 0 ) {
+		p_generic = CreateTestProcessor( args.Argv( 2 ), generic );
+		if ( p_generic == NULL ) {
+			if ( p_simd != processor && p_simd != generic ) {
+				delete p_simd;
 			}
-			p_simd = new (TAG_MATH) idSIMD_SSE;
-		} else {
-			common->Printf( "invalid argument, use: MMX, 3DNow, SSE, SSE2, SSE3, AltiVec\n" );
+			p_simd = NULL;
 			return;
 		}
 	}
@@ -1255,6 +1293,7 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 	idLib::common->SetRefreshOnPrint( true );
 
 	idLib::common->Printf( "using %s for SIMD processing\n", p_simd->GetName() );
+	idLib::common->Printf( "using %s as the baseline\n", p_generic->GetName() );
 
 	GetBaseClocks();
 
@@ -1276,9 +1315,12 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 
 	idLib::common->SetRefreshOnPrint( false );
 
-	if ( p_simd != processor ) {
+	if ( p_simd != processor && p_simd != generic ) {
 		delete p_simd;
 	}
+	if ( p_generic != processor && p_generic != generic ) {
+		delete p_generic;
+	}
 	p_simd = NULL;
 	p_generic = NULL;
 #if defined( ID_PC_WIN )
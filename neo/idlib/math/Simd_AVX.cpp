@@ -0,0 +1,195 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").  
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#pragma hdrstop
+#include "../precompiled.h"
+#include "Simd_Generic.h"
+#include "Simd_SSE.h"
+#include "Simd_AVX.h"
+#include "Simd_AVX_Kernels.h"
+
+//===============================================================
+//
+//	AVX2 & FMA implementation of idSIMDProcessor
+//
+//	Only the routines that benefit from the wider registers or
+//	the fused multiply-adds are implemented here, everything else
+//	falls through to the SSE code. The vector code itself lives in
+//	Simd_AVX_Kernels.cpp, this file is compiled without AVX code
+//	generation.
+//
+//===============================================================
+
+/*
+============
+idSIMD_AVX2::idSIMD_AVX2
+============
+*/
+idSIMD_AVX2::idSIMD_AVX2() {
+	kernels = AVX2_GetKernels();
+	assert( kernels != NULL );
+}
+
+/*
+============
+idSIMD_AVX2::IsAvailable
+
+Returns true if the CPU supports AVX2 & FMA and the kernels were compiled in.
+============
+*/
+bool idSIMD_AVX2::IsAvailable( cpuid_t cpuid ) {
+	if ( !( cpuid & CPUID_AVX2 ) || !( cpuid & CPUID_FMA3 ) ) {
+		return false;
+	}
+	return AVX2_GetKernels() != NULL;
+}
+
+/*
+============
+idSIMD_AVX2::GetName
+============
+*/
+const char * idSIMD_AVX2::GetName() const {
+	return "MMX & SSE & AVX2 & FMA";
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+void VPCALL idSIMD_AVX2::MinMax( float &min, float &max, const float *src, const int count ) {
+	kernels->MinMaxFloat( &min, &max, src, count );
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+void VPCALL idSIMD_AVX2::MinMax( idVec2 &min, idVec2 &max, const idVec2 *src, const int count ) {
+	kernels->MinMaxVec2( min.ToFloatPtr(), max.ToFloatPtr(), src->ToFloatPtr(), count );
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+void VPCALL idSIMD_AVX2::MinMax( idVec3 &min, idVec3 &max, const idVec3 *src, const int count ) {
+	kernels->MinMaxVec3( min.ToFloatPtr(), max.ToFloatPtr(), src->ToFloatPtr(), count );
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+void VPCALL idSIMD_AVX2::MinMax( idVec3 &min, idVec3 &max, const idDrawVert *src, const int count ) {
+	assert( (int)(&((idDrawVert *)0)->xyz) == 0 );
+	kernels->MinMaxVerts( min.ToFloatPtr(), max.ToFloatPtr(), (const byte *)src, sizeof( idDrawVert ), count );
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+void VPCALL idSIMD_AVX2::MinMax( idVec3 &min, idVec3 &max, const idDrawVert *src, const triIndex_t *indexes, const int count ) {
+	if ( sizeof( triIndex_t ) != sizeof( unsigned short ) ) {
+		idSIMD_SSE::MinMax( min, max, src, indexes, count );
+		return;
+	}
+	assert( (int)(&((idDrawVert *)0)->xyz) == 0 );
+	kernels->MinMaxIndexedVerts( min.ToFloatPtr(), max.ToFloatPtr(), (const byte *)src, sizeof( idDrawVert ), (const unsigned short *)indexes, count );
+}
+
+/*
+============
+idSIMD_AVX2::BlendJoints
+============
+*/
+void VPCALL idSIMD_AVX2::BlendJoints( idJointQuat *joints, const idJointQuat *blendJoints, const float lerp, const int *index, const int numJoints ) {
+	assert( sizeof( idJointQuat ) == JOINTQUAT_SIZE );
+
+	if ( lerp <= 0.0f ) {
+		return;
+	} else if ( lerp >= 1.0f ) {
+		for ( int i = 0; i < numJoints; i++ ) {
+			int j = index[i];
+			joints[j] = blendJoints[j];
+		}
+		return;
+	}
+
+	const int done = kernels->BlendJoints( joints->ToFloatPtr(), blendJoints->ToFloatPtr(), lerp, index, numJoints );
+
+	if ( done < numJoints ) {
+		idSIMD_SSE::BlendJoints( joints, blendJoints, lerp, index + done, numJoints - done );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::ConvertJointQuatsToJointMats
+============
+*/
+void VPCALL idSIMD_AVX2::ConvertJointQuatsToJointMats( idJointMat *jointMats, const idJointQuat *jointQuats, const int numJoints ) {
+	assert( sizeof( idJointQuat ) == JOINTQUAT_SIZE );
+	assert( sizeof( idJointMat ) == JOINTMAT_SIZE );
+	assert( (int)(&((idJointQuat *)0)->t) == (int)(&((idJointQuat *)0)->q) + (int)sizeof( ((idJointQuat *)0)->q ) );
+
+	const int done = kernels->ConvertJointQuatsToJointMats( jointMats->ToFloatPtr(), jointQuats->ToFloatPtr(), numJoints );
+
+	if ( done < numJoints ) {
+		idSIMD_SSE::ConvertJointQuatsToJointMats( jointMats + done, jointQuats + done, numJoints - done );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::TransformJoints
+============
+*/
+void VPCALL idSIMD_AVX2::TransformJoints( idJointMat *jointMats, const int *parents, const int firstJoint, const int lastJoint ) {
+	kernels->TransformJoints( jointMats->ToFloatPtr(), parents, firstJoint, lastJoint );
+}
+
+/*
+============
+idSIMD_AVX2::UntransformJoints
+============
+*/
+void VPCALL idSIMD_AVX2::UntransformJoints( idJointMat *jointMats, const int *parents, const int firstJoint, const int lastJoint ) {
+#ifdef _DEBUG
+	for ( int joint = lastJoint; joint >= firstJoint; joint-- ) {
+		assert( parents[joint] < joint );
+	}
+#endif
+	kernels->UntransformJoints( jointMats->ToFloatPtr(), parents, firstJoint, lastJoint );
+}
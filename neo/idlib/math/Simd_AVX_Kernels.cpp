@@ -0,0 +1,722 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").  
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include <immintrin.h>
+#include "Simd_AVX_Kernels.h"
+
+//===============================================================
+//
+//	AVX2 & FMA kernels
+//
+//	Don't include anything from idLib here, see Simd_AVX_Kernels.h.
+//	Visual Studio 2012 is the first version with the AVX2 & FMA
+//	intrinsics, other compilers need -mavx2 -mfma for this file.
+//
+//===============================================================
+
+#if ( defined( __AVX2__ ) && defined( __FMA__ ) ) || ( defined( _MSC_VER ) && _MSC_VER >= 1700 )
+
+#define AVX2_INFINITY	1e30f		// same as idMath::INFINITY
+#define AVX2_PI			3.14159265358979323846f
+
+/*
+============
+LoadHalves
+
+Loads two 16 byte aligned vectors into the low and high lane of an AVX register.
+============
+*/
+static inline __m256 LoadHalves( const float * lo, const float * hi ) {
+	return _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_load_ps( lo ) ), _mm_load_ps( hi ), 1 );
+}
+
+/*
+============
+LoadHalvesUnaligned
+============
+*/
+static inline __m256 LoadHalvesUnaligned( const float * lo, const float * hi ) {
+	return _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( lo ) ), _mm_loadu_ps( hi ), 1 );
+}
+
+/*
+============
+StoreHalves
+============
+*/
+static inline void StoreHalves( float * lo, float * hi, const __m256 v ) {
+	_mm_store_ps( lo, _mm256_castps256_ps128( v ) );
+	_mm_store_ps( hi, _mm256_extractf128_ps( v, 1 ) );
+}
+
+/*
+============
+VertPos
+============
+*/
+static inline const float * VertPos( const unsigned char * verts, const int vertSize, const int index ) {
+	return (const float *)( verts + index * vertSize );
+}
+
+/*
+============
+AVX2_MinMaxFloat
+============
+*/
+static void AVX2_MinMaxFloat( float *min, float *max, const float *src, const int count ) {
+	__m256 vmin = _mm256_set1_ps( AVX2_INFINITY );
+	__m256 vmax = _mm256_set1_ps( -AVX2_INFINITY );
+
+	int i = 0;
+	for ( ; i + 7 < count; i += 8 ) {
+		const __m256 v = _mm256_loadu_ps( src + i );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+
+	__m128 min4 = _mm_min_ps( _mm256_castps256_ps128( vmin ), _mm256_extractf128_ps( vmin, 1 ) );
+	__m128 max4 = _mm_max_ps( _mm256_castps256_ps128( vmax ), _mm256_extractf128_ps( vmax, 1 ) );
+	min4 = _mm_min_ps( min4, _mm_movehl_ps( min4, min4 ) );
+	max4 = _mm_max_ps( max4, _mm_movehl_ps( max4, max4 ) );
+	min4 = _mm_min_ss( min4, _mm_shuffle_ps( min4, min4, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+	max4 = _mm_max_ss( max4, _mm_shuffle_ps( max4, max4, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+	_mm_store_ss( min, min4 );
+	_mm_store_ss( max, max4 );
+
+	for ( ; i < count; i++ ) {
+		if ( src[i] < *min ) {
+			*min = src[i];
+		}
+		if ( src[i] > *max ) {
+			*max = src[i];
+		}
+	}
+}
+
+/*
+============
+AVX2_MinMaxVec2
+============
+*/
+static void AVX2_MinMaxVec2( float min[2], float max[2], const float *src, const int count ) {
+	__m256 vmin = _mm256_set1_ps( AVX2_INFINITY );
+	__m256 vmax = _mm256_set1_ps( -AVX2_INFINITY );
+
+	// the lanes alternate between x and y
+	int i = 0;
+	for ( ; i + 3 < count; i += 4 ) {
+		const __m256 v = _mm256_loadu_ps( src + i * 2 );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+
+	__m128 min4 = _mm_min_ps( _mm256_castps256_ps128( vmin ), _mm256_extractf128_ps( vmin, 1 ) );
+	__m128 max4 = _mm_max_ps( _mm256_castps256_ps128( vmax ), _mm256_extractf128_ps( vmax, 1 ) );
+	min4 = _mm_min_ps( min4, _mm_movehl_ps( min4, min4 ) );
+	max4 = _mm_max_ps( max4, _mm_movehl_ps( max4, max4 ) );
+
+	float minf[4];
+	float maxf[4];
+	_mm_storeu_ps( minf, min4 );
+	_mm_storeu_ps( maxf, max4 );
+	min[0] = minf[0];
+	min[1] = minf[1];
+	max[0] = maxf[0];
+	max[1] = maxf[1];
+
+	for ( ; i < count; i++ ) {
+		const float * v = src + i * 2;
+		if ( v[0] < min[0] ) { min[0] = v[0]; }
+		if ( v[0] > max[0] ) { max[0] = v[0]; }
+		if ( v[1] < min[1] ) { min[1] = v[1]; }
+		if ( v[1] > max[1] ) { max[1] = v[1]; }
+	}
+}
+
+/*
+============
+AVX2_MinMaxVec3
+============
+*/
+static void AVX2_MinMaxVec3( float min[3], float max[3], const float *src, const int count ) {
+	__m256 vmin0 = _mm256_set1_ps( AVX2_INFINITY );
+	__m256 vmin1 = vmin0;
+	__m256 vmin2 = vmin0;
+	__m256 vmax0 = _mm256_set1_ps( -AVX2_INFINITY );
+	__m256 vmax1 = vmax0;
+	__m256 vmax2 = vmax0;
+
+	// eight vectors are three registers, and the component in each lane is the same every iteration
+	int i = 0;
+	for ( ; i + 7 < count; i += 8 ) {
+		const __m256 v0 = _mm256_loadu_ps( src + i * 3 +  0 );
+		const __m256 v1 = _mm256_loadu_ps( src + i * 3 +  8 );
+		const __m256 v2 = _mm256_loadu_ps( src + i * 3 + 16 );
+		vmin0 = _mm256_min_ps( vmin0, v0 );
+		vmin1 = _mm256_min_ps( vmin1, v1 );
+		vmin2 = _mm256_min_ps( vmin2, v2 );
+		vmax0 = _mm256_max_ps( vmax0, v0 );
+		vmax1 = _mm256_max_ps( vmax1, v1 );
+		vmax2 = _mm256_max_ps( vmax2, v2 );
+	}
+
+	float minf[24];
+	float maxf[24];
+	_mm256_storeu_ps( minf +  0, vmin0 );
+	_mm256_storeu_ps( minf +  8, vmin1 );
+	_mm256_storeu_ps( minf + 16, vmin2 );
+	_mm256_storeu_ps( maxf +  0, vmax0 );
+	_mm256_storeu_ps( maxf +  8, vmax1 );
+	_mm256_storeu_ps( maxf + 16, vmax2 );
+
+	min[0] = min[1] = min[2] = AVX2_INFINITY;
+	max[0] = max[1] = max[2] = -AVX2_INFINITY;
+	for ( int j = 0; j < 24; j++ ) {
+		if ( minf[j] < min[j % 3] ) { min[j % 3] = minf[j]; }
+		if ( maxf[j] > max[j % 3] ) { max[j % 3] = maxf[j]; }
+	}
+
+	for ( ; i < count; i++ ) {
+		const float * v = src + i * 3;
+		if ( v[0] < min[0] ) { min[0] = v[0]; }
+		if ( v[0] > max[0] ) { max[0] = v[0]; }
+		if ( v[1] < min[1] ) { min[1] = v[1]; }
+		if ( v[1] > max[1] ) { max[1] = v[1]; }
+		if ( v[2] < min[2] ) { min[2] = v[2]; }
+		if ( v[2] > max[2] ) { max[2] = v[2]; }
+	}
+}
+
+/*
+============
+AVX2_MinMaxVerts
+
+The position must be the first member of the vertex.
+============
+*/
+static void AVX2_MinMaxVerts( float min[3], float max[3], const unsigned char *verts, const int vertSize, const int count ) {
+	__m256 vmin0 = _mm256_set1_ps( AVX2_INFINITY );
+	__m256 vmin1 = vmin0;
+	__m256 vmax0 = _mm256_set1_ps( -AVX2_INFINITY );
+	__m256 vmax1 = vmax0;
+
+	// the fourth lane picks up the packed texture coordinates and is ignored
+	int i = 0;
+	for ( ; i + 3 < count; i += 4 ) {
+		const __m256 v0 = LoadHalvesUnaligned( VertPos( verts, vertSize, i+0 ), VertPos( verts, vertSize, i+1 ) );
+		const __m256 v1 = LoadHalvesUnaligned( VertPos( verts, vertSize, i+2 ), VertPos( verts, vertSize, i+3 ) );
+		vmin0 = _mm256_min_ps( vmin0, v0 );
+		vmin1 = _mm256_min_ps( vmin1, v1 );
+		vmax0 = _mm256_max_ps( vmax0, v0 );
+		vmax1 = _mm256_max_ps( vmax1, v1 );
+	}
+	for ( ; i < count; i++ ) {
+		const __m256 v = _mm256_castps128_ps256( _mm_loadu_ps( VertPos( verts, vertSize, i ) ) );
+		vmin0 = _mm256_blend_ps( vmin0, _mm256_min_ps( vmin0, v ), 0x0F );
+		vmax0 = _mm256_blend_ps( vmax0, _mm256_max_ps( vmax0, v ), 0x0F );
+	}
+
+	vmin0 = _mm256_min_ps( vmin0, vmin1 );
+	vmax0 = _mm256_max_ps( vmax0, vmax1 );
+	const __m128 min4 = _mm_min_ps( _mm256_castps256_ps128( vmin0 ), _mm256_extractf128_ps( vmin0, 1 ) );
+	const __m128 max4 = _mm_max_ps( _mm256_castps256_ps128( vmax0 ), _mm256_extractf128_ps( vmax0, 1 ) );
+
+	float minf[4];
+	float maxf[4];
+	_mm_storeu_ps( minf, min4 );
+	_mm_storeu_ps( maxf, max4 );
+	min[0] = minf[0];
+	min[1] = minf[1];
+	min[2] = minf[2];
+	max[0] = maxf[0];
+	max[1] = maxf[1];
+	max[2] = maxf[2];
+}
+
+/*
+============
+AVX2_MinMaxIndexedVerts
+============
+*/
+static void AVX2_MinMaxIndexedVerts( float min[3], float max[3], const unsigned char *verts, const int vertSize, const unsigned short *indexes, const int count ) {
+	__m256 vmin0 = _mm256_set1_ps( AVX2_INFINITY );
+	__m256 vmin1 = vmin0;
+	__m256 vmax0 = _mm256_set1_ps( -AVX2_INFINITY );
+	__m256 vmax1 = vmax0;
+
+	int i = 0;
+	for ( ; i + 3 < count; i += 4 ) {
+		const __m256 v0 = LoadHalvesUnaligned( VertPos( verts, vertSize, indexes[i+0] ), VertPos( verts, vertSize, indexes[i+1] ) );
+		const __m256 v1 = LoadHalvesUnaligned( VertPos( verts, vertSize, indexes[i+2] ), VertPos( verts, vertSize, indexes[i+3] ) );
+		vmin0 = _mm256_min_ps( vmin0, v0 );
+		vmin1 = _mm256_min_ps( vmin1, v1 );
+		vmax0 = _mm256_max_ps( vmax0, v0 );
+		vmax1 = _mm256_max_ps( vmax1, v1 );
+	}
+	for ( ; i < count; i++ ) {
+		const __m256 v = _mm256_castps128_ps256( _mm_loadu_ps( VertPos( verts, vertSize, indexes[i] ) ) );
+		vmin0 = _mm256_blend_ps( vmin0, _mm256_min_ps( vmin0, v ), 0x0F );
+		vmax0 = _mm256_blend_ps( vmax0, _mm256_max_ps( vmax0, v ), 0x0F );
+	}
+
+	vmin0 = _mm256_min_ps( vmin0, vmin1 );
+	vmax0 = _mm256_max_ps( vmax0, vmax1 );
+	const __m128 min4 = _mm_min_ps( _mm256_castps256_ps128( vmin0 ), _mm256_extractf128_ps( vmin0, 1 ) );
+	const __m128 max4 = _mm_max_ps( _mm256_castps256_ps128( vmax0 ), _mm256_extractf128_ps( vmax0, 1 ) );
+
+	float minf[4];
+	float maxf[4];
+	_mm_storeu_ps( minf, min4 );
+	_mm_storeu_ps( maxf, max4 );
+	min[0] = minf[0];
+	min[1] = minf[1];
+	min[2] = minf[2];
+	max[0] = maxf[0];
+	max[1] = maxf[1];
+	max[2] = maxf[2];
+}
+
+/*
+============
+AVX2_BlendJoints
+
+Same as the SSE version, but blends eight joints at a time. The quaternions of joints
+n0-n3 go in the low lanes and those of n4-n7 in the high lanes, so the SSE transpose
+works unchanged on both halves. Expects 0 < lerp < 1.
+============
+*/
+static int AVX2_BlendJoints( float *joints, const float *blendJoints, const float lerp, const int *index, const int numJoints ) {
+	const __m256 vlerp = _mm256_set1_ps( lerp );
+	const __m128 vlerp4 = _mm_set1_ps( lerp );
+
+	const __m256 vector_float_one		= _mm256_set1_ps( 1.0f );
+	const __m256 vector_float_sign_bit	= _mm256_castsi256_ps( _mm256_set1_epi32( 0x80000000 ) );
+	const __m256 vector_float_rsqrt_c0	= _mm256_set1_ps( -3.0f );
+	const __m256 vector_float_rsqrt_c1	= _mm256_set1_ps( -0.5f );
+	const __m256 vector_float_tiny		= _mm256_set1_ps( 1e-10f );
+	const __m256 vector_float_half_pi	= _mm256_set1_ps( AVX2_PI*0.5f );
+
+	const __m256 vector_float_sin_c0	= _mm256_set1_ps( -2.39e-08f );
+	const __m256 vector_float_sin_c1	= _mm256_set1_ps(  2.7526e-06f );
+	const __m256 vector_float_sin_c2	= _mm256_set1_ps( -1.98409e-04f );
+	const __m256 vector_float_sin_c3	= _mm256_set1_ps(  8.3333315e-03f );
+	const __m256 vector_float_sin_c4	= _mm256_set1_ps( -1.666666664e-01f );
+
+	const __m256 vector_float_atan_c0	= _mm256_set1_ps(  0.0028662257f );
+	const __m256 vector_float_atan_c1	= _mm256_set1_ps( -0.0161657367f );
+	const __m256 vector_float_atan_c2	= _mm256_set1_ps(  0.0429096138f );
+	const __m256 vector_float_atan_c3	= _mm256_set1_ps( -0.0752896400f );
+	const __m256 vector_float_atan_c4	= _mm256_set1_ps(  0.1065626393f );
+	const __m256 vector_float_atan_c5	= _mm256_set1_ps( -0.1420889944f );
+	const __m256 vector_float_atan_c6	= _mm256_set1_ps(  0.1999355085f );
+	const __m256 vector_float_atan_c7	= _mm256_set1_ps( -0.3333314528f );
+
+	int i = 0;
+	for ( ; i < numJoints - 7; i += 8 ) {
+		const int * n = index + i;
+
+		for ( int k = 0; k < 8; k++ ) {
+			const __m128 jt = _mm_load_ps( joints + n[k] * 8 + 4 );
+			const __m128 bt = _mm_load_ps( blendJoints + n[k] * 8 + 4 );
+			_mm_store_ps( joints + n[k] * 8 + 4, _mm_fmadd_ps( vlerp4, _mm_sub_ps( bt, jt ), jt ) );
+		}
+
+		__m256 jqa = LoadHalves( joints + n[0] * 8, joints + n[4] * 8 );
+		__m256 jqb = LoadHalves( joints + n[1] * 8, joints + n[5] * 8 );
+		__m256 jqc = LoadHalves( joints + n[2] * 8, joints + n[6] * 8 );
+		__m256 jqd = LoadHalves( joints + n[3] * 8, joints + n[7] * 8 );
+
+		__m256 bqa = LoadHalves( blendJoints + n[0] * 8, blendJoints + n[4] * 8 );
+		__m256 bqb = LoadHalves( blendJoints + n[1] * 8, blendJoints + n[5] * 8 );
+		__m256 bqc = LoadHalves( blendJoints + n[2] * 8, blendJoints + n[6] * 8 );
+		__m256 bqd = LoadHalves( blendJoints + n[3] * 8, blendJoints + n[7] * 8 );
+
+		__m256 jqr = _mm256_unpacklo_ps( jqa, jqc );
+		__m256 jqs = _mm256_unpackhi_ps( jqa, jqc );
+		__m256 jqt = _mm256_unpacklo_ps( jqb, jqd );
+		__m256 jqu = _mm256_unpackhi_ps( jqb, jqd );
+
+		__m256 bqr = _mm256_unpacklo_ps( bqa, bqc );
+		__m256 bqs = _mm256_unpackhi_ps( bqa, bqc );
+		__m256 bqt = _mm256_unpacklo_ps( bqb, bqd );
+		__m256 bqu = _mm256_unpackhi_ps( bqb, bqd );
+
+		__m256 jqx = _mm256_unpacklo_ps( jqr, jqt );
+		__m256 jqy = _mm256_unpackhi_ps( jqr, jqt );
+		__m256 jqz = _mm256_unpacklo_ps( jqs, jqu );
+		__m256 jqw = _mm256_unpackhi_ps( jqs, jqu );
+
+		__m256 bqx = _mm256_unpacklo_ps( bqr, bqt );
+		__m256 bqy = _mm256_unpackhi_ps( bqr, bqt );
+		__m256 bqz = _mm256_unpacklo_ps( bqs, bqu );
+		__m256 bqw = _mm256_unpackhi_ps( bqs, bqu );
+
+		__m256 cosomg = _mm256_mul_ps( jqx, bqx );
+		cosomg = _mm256_fmadd_ps( jqy, bqy, cosomg );
+		cosomg = _mm256_fmadd_ps( jqz, bqz, cosomg );
+		cosomg = _mm256_fmadd_ps( jqw, bqw, cosomg );
+
+		__m256 sign = _mm256_and_ps( cosomg, vector_float_sign_bit );
+		__m256 cosom = _mm256_xor_ps( cosomg, sign );
+		__m256 ss = _mm256_fnmadd_ps( cosom, cosom, vector_float_one );
+
+		ss = _mm256_max_ps( ss, vector_float_tiny );
+
+		__m256 rs = _mm256_rsqrt_ps( ss );
+		__m256 sq = _mm256_mul_ps( rs, rs );
+		__m256 sh = _mm256_mul_ps( rs, vector_float_rsqrt_c1 );
+		__m256 sx = _mm256_fmadd_ps( ss, sq, vector_float_rsqrt_c0 );
+		__m256 sinom = _mm256_mul_ps( sh, sx );							// sinom = sqrt( ss );
+
+		ss = _mm256_mul_ps( ss, sinom );
+
+		__m256 min = _mm256_min_ps( ss, cosom );
+		__m256 max = _mm256_max_ps( ss, cosom );
+		__m256 mask = _mm256_cmp_ps( min, cosom, _CMP_EQ_OQ );
+		__m256 masksign = _mm256_and_ps( mask, vector_float_sign_bit );
+		__m256 maskPI = _mm256_and_ps( mask, vector_float_half_pi );
+
+		__m256 rcpa = _mm256_rcp_ps( max );
+		__m256 rcpb = _mm256_mul_ps( max, rcpa );
+		__m256 rcpd = _mm256_add_ps( rcpa, rcpa );
+		__m256 rcp = _mm256_fnmadd_ps( rcpb, rcpa, rcpd );				// 1 / y or 1 / x
+		__m256 ata = _mm256_mul_ps( min, rcp );							// x / y or y / x
+
+		__m256 atb = _mm256_xor_ps( ata, masksign );					// -x / y or y / x
+		__m256 atc = _mm256_mul_ps( atb, atb );
+		__m256 atd = _mm256_fmadd_ps( atc, vector_float_atan_c0, vector_float_atan_c1 );
+
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c2 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c3 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c4 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c5 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c6 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c7 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_one );
+
+		__m256 omega_a = _mm256_fmadd_ps( atd, atb, maskPI );
+		__m256 omega_b = _mm256_mul_ps( vlerp, omega_a );
+		omega_a = _mm256_sub_ps( omega_a, omega_b );
+
+		__m256 sinsa = _mm256_mul_ps( omega_a, omega_a );
+		__m256 sinsb = _mm256_mul_ps( omega_b, omega_b );
+		__m256 sina = _mm256_fmadd_ps( sinsa, vector_float_sin_c0, vector_float_sin_c1 );
+		__m256 sinb = _mm256_fmadd_ps( sinsb, vector_float_sin_c0, vector_float_sin_c1 );
+		sina = _mm256_fmadd_ps( sina, sinsa, vector_float_sin_c2 );
+		sinb = _mm256_fmadd_ps( sinb, sinsb, vector_float_sin_c2 );
+		sina = _mm256_fmadd_ps( sina, sinsa, vector_float_sin_c3 );
+		sinb = _mm256_fmadd_ps( sinb, sinsb, vector_float_sin_c3 );
+		sina = _mm256_fmadd_ps( sina, sinsa, vector_float_sin_c4 );
+		sinb = _mm256_fmadd_ps( sinb, sinsb, vector_float_sin_c4 );
+		sina = _mm256_fmadd_ps( sina, sinsa, vector_float_one );
+		sinb = _mm256_fmadd_ps( sinb, sinsb, vector_float_one );
+		sina = _mm256_mul_ps( sina, omega_a );
+		sinb = _mm256_mul_ps( sinb, omega_b );
+		__m256 scalea = _mm256_mul_ps( sina, sinom );
+		__m256 scaleb = _mm256_mul_ps( sinb, sinom );
+
+		scaleb = _mm256_xor_ps( scaleb, sign );
+
+		jqx = _mm256_mul_ps( jqx, scalea );
+		jqy = _mm256_mul_ps( jqy, scalea );
+		jqz = _mm256_mul_ps( jqz, scalea );
+		jqw = _mm256_mul_ps( jqw, scalea );
+
+		jqx = _mm256_fmadd_ps( bqx, scaleb, jqx );
+		jqy = _mm256_fmadd_ps( bqy, scaleb, jqy );
+		jqz = _mm256_fmadd_ps( bqz, scaleb, jqz );
+		jqw = _mm256_fmadd_ps( bqw, scaleb, jqw );
+
+		__m256 tp0 = _mm256_unpacklo_ps( jqx, jqz );
+		__m256 tp1 = _mm256_unpackhi_ps( jqx, jqz );
+		__m256 tp2 = _mm256_unpacklo_ps( jqy, jqw );
+		__m256 tp3 = _mm256_unpackhi_ps( jqy, jqw );
+
+		__m256 p0 = _mm256_unpacklo_ps( tp0, tp2 );
+		__m256 p1 = _mm256_unpackhi_ps( tp0, tp2 );
+		__m256 p2 = _mm256_unpacklo_ps( tp1, tp3 );
+		__m256 p3 = _mm256_unpackhi_ps( tp1, tp3 );
+
+		StoreHalves( joints + n[0] * 8, joints + n[4] * 8, p0 );
+		StoreHalves( joints + n[1] * 8, joints + n[5] * 8, p1 );
+		StoreHalves( joints + n[2] * 8, joints + n[6] * 8, p2 );
+		StoreHalves( joints + n[3] * 8, joints + n[7] * 8, p3 );
+	}
+
+	return i;
+}
+
+/*
+============
+AVX2_ConvertJointQuatsToJointMats
+
+Same as the SSE version with one joint in each lane, so four joints are converted
+per iteration.
+============
+*/
+static int AVX2_ConvertJointQuatsToJointMats( float *jointMats, const float *jointQuats, const int numJoints ) {
+	const float * jointQuatPtr = jointQuats;
+	float * jointMatPtr = jointMats;
+
+	const __m256 vector_float_first_sign_bit		= _mm256_castsi256_ps( _mm256_setr_epi32( 0x80000000, 0x00000000, 0x00000000, 0x00000000, 0x80000000, 0x00000000, 0x00000000, 0x00000000 ) );
+	const __m256 vector_float_last_three_sign_bits	= _mm256_castsi256_ps( _mm256_setr_epi32( 0x00000000, 0x80000000, 0x80000000, 0x80000000, 0x00000000, 0x80000000, 0x80000000, 0x80000000 ) );
+	const __m256 vector_float_first_pos_half		= _mm256_setr_ps(   0.5f,   0.0f,   0.0f,   0.0f,   0.5f,   0.0f,   0.0f,   0.0f );	// +.5 0 0 0
+	const __m256 vector_float_first_neg_half		= _mm256_setr_ps(  -0.5f,   0.0f,   0.0f,   0.0f,  -0.5f,   0.0f,   0.0f,   0.0f );	// -.5 0 0 0
+	const __m256 vector_float_quat2mat_mad1			= _mm256_setr_ps(  -1.0f,  -1.0f,  +1.0f,  -1.0f,  -1.0f,  -1.0f,  +1.0f,  -1.0f );	//  - - + -
+	const __m256 vector_float_quat2mat_mad2			= _mm256_setr_ps(  -1.0f,  +1.0f,  -1.0f,  -1.0f,  -1.0f,  +1.0f,  -1.0f,  -1.0f );	//  - + - -
+	const __m256 vector_float_quat2mat_mad3			= _mm256_setr_ps(  +1.0f,  -1.0f,  -1.0f,  +1.0f,  +1.0f,  -1.0f,  -1.0f,  +1.0f );	//  + - - +
+
+	int i = 0;
+	for ( ; i + 3 < numJoints; i += 4 ) {
+
+		// each joint quat is a quaternion followed by a translation, gather the quaternions
+		// and translations of two joints in the low and high lanes
+		const __m256 ja = _mm256_loadu_ps( &jointQuatPtr[i*8+0*8] );
+		const __m256 jb = _mm256_loadu_ps( &jointQuatPtr[i*8+1*8] );
+		const __m256 jc = _mm256_loadu_ps( &jointQuatPtr[i*8+2*8] );
+		const __m256 jd = _mm256_loadu_ps( &jointQuatPtr[i*8+3*8] );
+
+		__m256 q0 = _mm256_permute2f128_ps( ja, jb, 0x20 );
+		__m256 t0 = _mm256_permute2f128_ps( ja, jb, 0x31 );
+		__m256 q1 = _mm256_permute2f128_ps( jc, jd, 0x20 );
+		__m256 t1 = _mm256_permute2f128_ps( jc, jd, 0x31 );
+
+		__m256 d0 = _mm256_add_ps( q0, q0 );
+		__m256 d1 = _mm256_add_ps( q1, q1 );
+
+		__m256 sa0 = _mm256_permute_ps( q0, _MM_SHUFFLE( 1, 0, 0, 1 ) );						//   y,   x,   x,   y
+		__m256 sb0 = _mm256_permute_ps( d0, _MM_SHUFFLE( 2, 2, 1, 1 ) );						//  y2,  y2,  z2,  z2
+		__m256 sc0 = _mm256_permute_ps( q0, _MM_SHUFFLE( 3, 3, 3, 2 ) );						//   z,   w,   w,   w
+		__m256 sd0 = _mm256_permute_ps( d0, _MM_SHUFFLE( 0, 1, 2, 2 ) );						//  z2,  z2,  y2,  x2
+		__m256 sa1 = _mm256_permute_ps( q1, _MM_SHUFFLE( 1, 0, 0, 1 ) );						//   y,   x,   x,   y
+		__m256 sb1 = _mm256_permute_ps( d1, _MM_SHUFFLE( 2, 2, 1, 1 ) );						//  y2,  y2,  z2,  z2
+		__m256 sc1 = _mm256_permute_ps( q1, _MM_SHUFFLE( 3, 3, 3, 2 ) );						//   z,   w,   w,   w
+		__m256 sd1 = _mm256_permute_ps( d1, _MM_SHUFFLE( 0, 1, 2, 2 ) );						//  z2,  z2,  y2,  x2
+
+		sa0 = _mm256_xor_ps( sa0, vector_float_first_sign_bit );
+		sa1 = _mm256_xor_ps( sa1, vector_float_first_sign_bit );
+
+		sc0 = _mm256_xor_ps( sc0, vector_float_last_three_sign_bits );						// flip stupid inverse quaternions
+		sc1 = _mm256_xor_ps( sc1, vector_float_last_three_sign_bits );						// flip stupid inverse quaternions
+
+		__m256 ma0 = _mm256_fmadd_ps( sa0, sb0, vector_float_first_pos_half );				//  .5 - yy2,  xy2,  xz2,  yz2		//  .5 0 0 0
+		__m256 mb0 = _mm256_fmadd_ps( sc0, sd0, vector_float_first_neg_half );				// -.5 + zz2,  wz2,  wy2,  wx2		// -.5 0 0 0
+		__m256 mc0 = _mm256_fnmadd_ps( q0, d0, vector_float_first_pos_half );				//  .5 - xx2, -yy2, -zz2, -ww2		//  .5 0 0 0
+		__m256 ma1 = _mm256_fmadd_ps( sa1, sb1, vector_float_first_pos_half );				//  .5 - yy2,  xy2,  xz2,  yz2		//  .5 0 0 0
+		__m256 mb1 = _mm256_fmadd_ps( sc1, sd1, vector_float_first_neg_half );				// -.5 + zz2,  wz2,  wy2,  wx2		// -.5 0 0 0
+		__m256 mc1 = _mm256_fnmadd_ps( q1, d1, vector_float_first_pos_half );				//  .5 - xx2, -yy2, -zz2, -ww2		//  .5 0 0 0
+
+		__m256 mf0 = _mm256_shuffle_ps( ma0, mc0, _MM_SHUFFLE( 0, 0, 1, 1 ) );				//       xy2,  xy2, .5 - xx2, .5 - xx2	// 01, 01, 10, 10
+		__m256 md0 = _mm256_shuffle_ps( mf0, ma0, _MM_SHUFFLE( 3, 2, 0, 2 ) );				//  .5 - xx2,  xy2,  xz2,  yz2			// 10, 01, 02, 03
+		__m256 me0 = _mm256_shuffle_ps( ma0, mb0, _MM_SHUFFLE( 3, 2, 1, 0 ) );				//  .5 - yy2,  xy2,  wy2,  wx2			// 00, 01, 12, 13
+		__m256 mf1 = _mm256_shuffle_ps( ma1, mc1, _MM_SHUFFLE( 0, 0, 1, 1 ) );				//       xy2,  xy2, .5 - xx2, .5 - xx2	// 01, 01, 10, 10
+		__m256 md1 = _mm256_shuffle_ps( mf1, ma1, _MM_SHUFFLE( 3, 2, 0, 2 ) );				//  .5 - xx2,  xy2,  xz2,  yz2			// 10, 01, 02, 03
+		__m256 me1 = _mm256_shuffle_ps( ma1, mb1, _MM_SHUFFLE( 3, 2, 1, 0 ) );				//  .5 - yy2,  xy2,  wy2,  wx2			// 00, 01, 12, 13
+
+		__m256 ra0 = _mm256_fmadd_ps( mb0, vector_float_quat2mat_mad1, ma0 );				// 1 - yy2 - zz2, xy2 - wz2, xz2 + wy2,					// - - + -
+		__m256 rb0 = _mm256_fmadd_ps( mb0, vector_float_quat2mat_mad2, md0 );				// 1 - xx2 - zz2, xy2 + wz2,          , yz2 - wx2		// - + - -
+		__m256 rc0 = _mm256_fmadd_ps( me0, vector_float_quat2mat_mad3, md0 );				// 1 - xx2 - yy2,          , xz2 - wy2, yz2 + wx2		// + - - +
+		__m256 ra1 = _mm256_fmadd_ps( mb1, vector_float_quat2mat_mad1, ma1 );				// 1 - yy2 - zz2, xy2 - wz2, xz2 + wy2,					// - - + -
+		__m256 rb1 = _mm256_fmadd_ps( mb1, vector_float_quat2mat_mad2, md1 );				// 1 - xx2 - zz2, xy2 + wz2,          , yz2 - wx2		// - + - -
+		__m256 rc1 = _mm256_fmadd_ps( me1, vector_float_quat2mat_mad3, md1 );				// 1 - xx2 - yy2,          , xz2 - wy2, yz2 + wx2		// + - - +
+
+		__m256 ta0 = _mm256_shuffle_ps( ra0, t0, _MM_SHUFFLE( 0, 0, 2, 2 ) );
+		__m256 tb0 = _mm256_shuffle_ps( rb0, t0, _MM_SHUFFLE( 1, 1, 3, 3 ) );
+		__m256 tc0 = _mm256_shuffle_ps( rc0, t0, _MM_SHUFFLE( 2, 2, 0, 0 ) );
+		__m256 ta1 = _mm256_shuffle_ps( ra1, t1, _MM_SHUFFLE( 0, 0, 2, 2 ) );
+		__m256 tb1 = _mm256_shuffle_ps( rb1, t1, _MM_SHUFFLE( 1, 1, 3, 3 ) );
+		__m256 tc1 = _mm256_shuffle_ps( rc1, t1, _MM_SHUFFLE( 2, 2, 0, 0 ) );
+
+		ra0 = _mm256_shuffle_ps( ra0, ta0, _MM_SHUFFLE( 2, 0, 1, 0 ) );						// 00 01 02 10
+		rb0 = _mm256_shuffle_ps( rb0, tb0, _MM_SHUFFLE( 2, 0, 0, 1 ) );						// 01 00 03 11
+		rc0 = _mm256_shuffle_ps( rc0, tc0, _MM_SHUFFLE( 2, 0, 3, 2 ) );						// 02 03 00 12
+		ra1 = _mm256_shuffle_ps( ra1, ta1, _MM_SHUFFLE( 2, 0, 1, 0 ) );						// 00 01 02 10
+		rb1 = _mm256_shuffle_ps( rb1, tb1, _MM_SHUFFLE( 2, 0, 0, 1 ) );						// 01 00 03 11
+		rc1 = _mm256_shuffle_ps( rc1, tc1, _MM_SHUFFLE( 2, 0, 3, 2 ) );						// 02 03 00 12
+
+		StoreHalves( &jointMatPtr[i*12+0*12+0], &jointMatPtr[i*12+1*12+0], ra0 );
+		StoreHalves( &jointMatPtr[i*12+0*12+4], &jointMatPtr[i*12+1*12+4], rb0 );
+		StoreHalves( &jointMatPtr[i*12+0*12+8], &jointMatPtr[i*12+1*12+8], rc0 );
+		StoreHalves( &jointMatPtr[i*12+2*12+0], &jointMatPtr[i*12+3*12+0], ra1 );
+		StoreHalves( &jointMatPtr[i*12+2*12+4], &jointMatPtr[i*12+3*12+4], rb1 );
+		StoreHalves( &jointMatPtr[i*12+2*12+8], &jointMatPtr[i*12+3*12+8], rc1 );
+	}
+
+	return i;
+}
+
+/*
+============
+AVX2_TransformJoints
+
+Every joint depends on its parent so this can't be made wider, but the fused
+multiply-adds shorten the dependency chain from one joint to the next.
+============
+*/
+static void AVX2_TransformJoints( float *jointMats, const int *parents, const int firstJoint, const int lastJoint ) {
+	const __m128 vector_float_mask_keep_last	= _mm_castsi128_ps( _mm_set_epi32( 0xFFFFFFFF, 0x00000000, 0x00000000, 0x00000000 ) );
+
+	const float *__restrict firstMatrix = jointMats + ( firstJoint + firstJoint + firstJoint - 3 ) * 4;
+
+	__m128 pma = _mm_load_ps( firstMatrix + 0 );
+	__m128 pmb = _mm_load_ps( firstMatrix + 4 );
+	__m128 pmc = _mm_load_ps( firstMatrix + 8 );
+
+	for ( int joint = firstJoint; joint <= lastJoint; joint++ ) {
+		const int parent = parents[joint];
+		const float *__restrict parentMatrix = jointMats + ( parent + parent + parent ) * 4;
+		float *__restrict childMatrix = jointMats + ( joint + joint + joint ) * 4;
+
+		if ( parent != joint - 1 ) {
+			pma = _mm_load_ps( parentMatrix + 0 );
+			pmb = _mm_load_ps( parentMatrix + 4 );
+			pmc = _mm_load_ps( parentMatrix + 8 );
+		}
+
+		__m128 cma = _mm_load_ps( childMatrix + 0 );
+		__m128 cmb = _mm_load_ps( childMatrix + 4 );
+		__m128 cmc = _mm_load_ps( childMatrix + 8 );
+
+		__m128 ta = _mm_permute_ps( pma, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+		__m128 tb = _mm_permute_ps( pmb, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+		__m128 tc = _mm_permute_ps( pmc, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+
+		__m128 td = _mm_permute_ps( pma, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+		__m128 te = _mm_permute_ps( pmb, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+		__m128 tf = _mm_permute_ps( pmc, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+
+		__m128 tg = _mm_permute_ps( pma, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+		__m128 th = _mm_permute_ps( pmb, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+		__m128 ti = _mm_permute_ps( pmc, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+
+		pma = _mm_fmadd_ps( ta, cma, _mm_and_ps( pma, vector_float_mask_keep_last ) );
+		pmb = _mm_fmadd_ps( tb, cma, _mm_and_ps( pmb, vector_float_mask_keep_last ) );
+		pmc = _mm_fmadd_ps( tc, cma, _mm_and_ps( pmc, vector_float_mask_keep_last ) );
+
+		pma = _mm_fmadd_ps( td, cmb, pma );
+		pmb = _mm_fmadd_ps( te, cmb, pmb );
+		pmc = _mm_fmadd_ps( tf, cmb, pmc );
+
+		pma = _mm_fmadd_ps( tg, cmc, pma );
+		pmb = _mm_fmadd_ps( th, cmc, pmb );
+		pmc = _mm_fmadd_ps( ti, cmc, pmc );
+
+		_mm_store_ps( childMatrix + 0, pma );
+		_mm_store_ps( childMatrix + 4, pmb );
+		_mm_store_ps( childMatrix + 8, pmc );
+	}
+}
+
+/*
+============
+AVX2_UntransformJoints
+============
+*/
+static void AVX2_UntransformJoints( float *jointMats, const int *parents, const int firstJoint, const int lastJoint ) {
+	const __m128 vector_float_mask_keep_last	= _mm_castsi128_ps( _mm_set_epi32( 0xFFFFFFFF, 0x00000000, 0x00000000, 0x00000000 ) );
+
+	for ( int joint = lastJoint; joint >= firstJoint; joint-- ) {
+		const int parent = parents[joint];
+		const float *__restrict parentMatrix = jointMats + ( parent + parent + parent ) * 4;
+		float *__restrict childMatrix = jointMats + ( joint + joint + joint ) * 4;
+
+		__m128 pma = _mm_load_ps( parentMatrix + 0 );
+		__m128 pmb = _mm_load_ps( parentMatrix + 4 );
+		__m128 pmc = _mm_load_ps( parentMatrix + 8 );
+
+		__m128 cma = _mm_load_ps( childMatrix + 0 );
+		__m128 cmb = _mm_load_ps( childMatrix + 4 );
+		__m128 cmc = _mm_load_ps( childMatrix + 8 );
+
+		__m128 ta = _mm_permute_ps( pma, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+		__m128 tb = _mm_permute_ps( pma, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+		__m128 tc = _mm_permute_ps( pma, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+
+		__m128 td = _mm_permute_ps( pmb, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+		__m128 te = _mm_permute_ps( pmb, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+		__m128 tf = _mm_permute_ps( pmb, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+
+		__m128 tg = _mm_permute_ps( pmc, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+		__m128 th = _mm_permute_ps( pmc, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+		__m128 ti = _mm_permute_ps( pmc, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+
+		cma = _mm_sub_ps( cma, _mm_and_ps( pma, vector_float_mask_keep_last ) );
+		cmb = _mm_sub_ps( cmb, _mm_and_ps( pmb, vector_float_mask_keep_last ) );
+		cmc = _mm_sub_ps( cmc, _mm_and_ps( pmc, vector_float_mask_keep_last ) );
+
+		pma = _mm_mul_ps( ta, cma );
+		pmb = _mm_mul_ps( tb, cma );
+		pmc = _mm_mul_ps( tc, cma );
+
+		pma = _mm_fmadd_ps( td, cmb, pma );
+		pmb = _mm_fmadd_ps( te, cmb, pmb );
+		pmc = _mm_fmadd_ps( tf, cmb, pmc );
+
+		pma = _mm_fmadd_ps( tg, cmc, pma );
+		pmb = _mm_fmadd_ps( th, cmc, pmb );
+		pmc = _mm_fmadd_ps( ti, cmc, pmc );
+
+		_mm_store_ps( childMatrix + 0, pma );
+		_mm_store_ps( childMatrix + 4, pmb );
+		_mm_store_ps( childMatrix + 8, pmc );
+	}
+}
+
+static const avx2Kernels_t avx2Kernels = {
+	AVX2_MinMaxFloat,
+	AVX2_MinMaxVec2,
+	AVX2_MinMaxVec3,
+	AVX2_MinMaxVerts,
+	AVX2_MinMaxIndexedVerts,
+	AVX2_BlendJoints,
+	AVX2_ConvertJointQuatsToJointMats,
+	AVX2_TransformJoints,
+	AVX2_UntransformJoints
+};
+
+/*
+============
+AVX2_GetKernels
+============
+*/
+const avx2Kernels_t * AVX2_GetKernels() {
+	return &avx2Kernels;
+}
+
+#else
+
+/*
+============
+AVX2_GetKernels
+============
+*/
+const avx2Kernels_t * AVX2_GetKernels() {
+	return 0;
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").  
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __MATH_SIMD_AVX_KERNELS_H__
+#define __MATH_SIMD_AVX_KERNELS_H__
+
+/*
+===============================================================================
+
+	AVX2 & FMA kernels
+
+	The kernels are compiled with AVX2 code generation in a translation unit that
+	only includes the intrinsic headers. Nothing from idLib may be included there,
+	otherwise the linker could pick AVX encoded copies of shared inline functions
+	and run them on CPUs without AVX. The interface therefore only uses plain types.
+
+	Joint quats are 8 floats (quaternion, translation, pad) and joint mats are 12
+	floats, the same layout as idJointQuat and idJointMat.
+
+===============================================================================
+*/
+
+typedef struct avx2Kernels_s {
+	void	(*MinMaxFloat)( float *min, float *max, const float *src, const int count );
+	void	(*MinMaxVec2)( float min[2], float max[2], const float *src, const int count );
+	void	(*MinMaxVec3)( float min[3], float max[3], const float *src, const int count );
+	void	(*MinMaxVerts)( float min[3], float max[3], const unsigned char *verts, const int vertSize, const int count );
+	void	(*MinMaxIndexedVerts)( float min[3], float max[3], const unsigned char *verts, const int vertSize, const unsigned short *indexes, const int count );
+
+	// these return the number of joints that were processed, the caller handles the rest
+	int		(*BlendJoints)( float *joints, const float *blendJoints, const float lerp, const int *index, const int numJoints );
+	int		(*ConvertJointQuatsToJointMats)( float *jointMats, const float *jointQuats, const int numJoints );
+
+	void	(*TransformJoints)( float *jointMats, const int *parents, const int firstJoint, const int lastJoint );
+	void	(*UntransformJoints)( float *jointMats, const int *parents, const int firstJoint, const int lastJoint );
+} avx2Kernels_t;
+
+// returns NULL if the compiler used for the kernels doesn't support AVX2 & FMA
+const avx2Kernels_t *	AVX2_GetKernels();
+
+#endif /* !__MATH_SIMD_AVX_KERNELS_H__ */
@@ -115,6 +115,10 @@ public:
 	void		SetReferencedOutsideLevelLoad() { referencedOutsideLevelLoad = true; }
 	void		SetReferencedInsideLevelLoad() { levelLoadReferenced = true; }
 	void		ActuallyLoadImage( bool fromBackEnd );
+	// the steps of ActuallyLoadImage, only LoadBinaryImage may run on a job thread
+	void		PrepareBinaryImage( idBinaryImage & im );
+	void		LoadBinaryImage( idBinaryImage & im );
+	void		UploadBinaryImage( idBinaryImage & im );
 	//---------------------------------------------
 	// Platform specific implementations
 	//---------------------------------------------
@@ -274,6 +278,7 @@ public:
 
 	// Loads unloaded level images
 	int					LoadLevelImages( bool pacifier );
+	int					LoadLevelImagesParallel( bool pacifier );
 
 	// used to clear and then write the dds conversion batch file
 	void				StartBuild();
@@ -38,6 +38,24 @@ idImageManager	imageManager;
 idImageManager * globalImages = &imageManager;
 
 idCVar preLoad_Images( "preLoad_Images", "1", CVAR_SYSTEM | CVAR_BOOL, "preload images during beginlevelload" );
+idCVar image_parallelLoad( "image_parallelLoad", "1", CVAR_RENDERER | CVAR_BOOL, "read level images from resource files on job threads, only the upload stays on the render thread" );
+
+static const int IMAGE_LOAD_BATCH = 64;
+
+struct imageLoadJob_t {
+	idImage *		image;
+	idBinaryImage *	binaryImage;
+};
+
+/*
+===============
+R_LoadBinaryImageJob
+===============
+*/
+static void R_LoadBinaryImageJob( imageLoadJob_t * job ) {
+	job->image->LoadBinaryImage( *job->binaryImage );
+}
+REGISTER_PARALLEL_JOB( R_LoadBinaryImageJob, "R_LoadBinaryImageJob" );
 
 /*
 ===============
@@ -752,7 +770,11 @@ void idImageManager::Preload( const idPreloadManifest &manifest, const bool & ma
 		int	start = Sys_Milliseconds();
 		int numLoaded = 0;
 
-		//fileSystem->StartPreload( preloadImageFiles );
+		// inside a level load, only reference the images here so they can all be read in parallel
+		const bool deferLoad = insideLevelLoad && image_parallelLoad.GetBool() && fileSystem->UsingResourceFiles();
+		if ( deferLoad ) {
+			preloadingMapImages = false;
+		}
 		for ( int i = 0; i < manifest.NumResources(); i++ ) {
 			const preloadEntry_s & p = manifest.GetPreloadByIndex( i );
 			if ( p.resType == PRELOAD_IMAGE && !ExcludePreloadImage( p.resourceName ) ) {
@@ -760,7 +782,9 @@ void idImageManager::Preload( const idPreloadManifest &manifest, const bool & ma
 				numLoaded++;
 			}
 		}
-		//fileSystem->StopPreload();
+		if ( deferLoad ) {
+			LoadLevelImages( false );
+		}
 		int	end = Sys_Milliseconds();
 		common->Printf( "%05d images preloaded ( or were already loaded ) in %5.1f seconds\n", numLoaded, ( end - start ) * 0.001 );
 		common->Printf( "----------------------------------------\n" );
@@ -774,6 +798,10 @@ idImageManager::LoadLevelImages
 ===============
 */
 int idImageManager::LoadLevelImages( bool pacifier ) {
+	if ( image_parallelLoad.GetBool() && fileSystem->UsingResourceFiles() ) {
+		return LoadLevelImagesParallel( pacifier );
+	}
+
 	int	loadCount = 0;
 	for ( int i = 0 ; i < images.Num() ; i++ ) {
 		if ( pacifier ) {
@@ -793,6 +821,89 @@ int idImageManager::LoadLevelImages( bool pacifier ) {
 	return loadCount;
 }
 
+/*
+===============
+idImageManager::LoadLevelImagesParallel
+
+Reads the generated images in batches on the job threads. While one batch is read, the previous one
+is uploaded here, so the GL calls stay on the render thread.
+===============
+*/
+int idImageManager::LoadLevelImagesParallel( bool pacifier ) {
+	idList< idImage * > loadImages;
+	for ( int i = 0 ; i < images.Num() ; i++ ) {
+		idImage	*image = images[ i ];
+		if ( image->generatorFunction ) {
+			continue;
+		}
+		if ( image->levelLoadReferenced && !image->IsLoaded() ) {
+			loadImages.Append( image );
+		}
+	}
+	if ( loadImages.Num() == 0 ) {
+		return 0;
+	}
+
+	const int numBatches = ( loadImages.Num() + IMAGE_LOAD_BATCH - 1 ) / IMAGE_LOAD_BATCH;
+
+	idParallelJobList * jobLists[2];
+	imageLoadJob_t jobs[2][IMAGE_LOAD_BATCH];
+	for ( int i = 0; i < 2; i++ ) {
+		jobLists[i] = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, IMAGE_LOAD_BATCH, 0, NULL );
+	}
+
+	int waitMsec = 0;
+	int uploadMsec = 0;
+
+	for ( int batch = 0; batch <= numBatches; batch++ ) {
+		// start reading the next batch
+		if ( batch < numBatches ) {
+			idParallelJobList * jobList = jobLists[batch & 1];
+			const int first = batch * IMAGE_LOAD_BATCH;
+			const int num = Min( IMAGE_LOAD_BATCH, loadImages.Num() - first );
+			for ( int i = 0; i < num; i++ ) {
+				imageLoadJob_t & job = jobs[batch & 1][i];
+				job.image = loadImages[first + i];
+				job.binaryImage = new (TAG_IMAGE) idBinaryImage( job.image->GetName() );
+				// the image program parser is not re-entrant, so the timestamps are read here
+				job.image->PrepareBinaryImage( *job.binaryImage );
+				jobList->AddJob( (jobRun_t)R_LoadBinaryImageJob, &job );
+			}
+			// the jobs mostly wait on IO, so use every job thread
+			jobList->Submit( NULL, JOBLIST_PARALLELISM_MAX_THREADS );
+		}
+
+		// upload the previous batch
+		if ( batch > 0 ) {
+			const int prev = batch - 1;
+			int start = Sys_Milliseconds();
+			jobLists[prev & 1]->Wait();
+			waitMsec += Sys_Milliseconds() - start;
+
+			start = Sys_Milliseconds();
+			const int num = Min( IMAGE_LOAD_BATCH, loadImages.Num() - prev * IMAGE_LOAD_BATCH );
+			for ( int i = 0; i < num; i++ ) {
+				if ( pacifier ) {
+					common->UpdateLevelLoadPacifier();
+				}
+				imageLoadJob_t & job = jobs[prev & 1][i];
+				job.image->UploadBinaryImage( *job.binaryImage );
+				delete job.binaryImage;
+				job.binaryImage = NULL;
+			}
+			uploadMsec += Sys_Milliseconds() - start;
+		}
+	}
+
+	for ( int i = 0; i < 2; i++ ) {
+		parallelJobManager->FreeJobList( jobLists[i] );
+	}
+
+	common->DPrintf( "%d images loaded in parallel, %d msec waiting on reads, %d msec uploading\n", loadImages.Num(), waitMsec, uploadMsec );
+
+	return loadImages.Num();
+}
+
 /*
 ===============
 idImageManager::EndLevelLoad
@@ -276,6 +276,22 @@ void idImage::ActuallyLoadImage( bool fromBackEnd ) {
 		return;
 	}
 
+	idBinaryImage im( GetName() );
+	PrepareBinaryImage( im );
+	LoadBinaryImage( im );
+	UploadBinaryImage( im );
+}
+
+/*
+===============
+idImage::PrepareBinaryImage
+
+Gets the source timestamp and usage, derives the options and names im after the
+generated file. This goes through the image program parser, which is not re-entrant,
+so it must be called on the main thread.
+===============
+*/
+void idImage::PrepareBinaryImage( idBinaryImage & im ) {
 	if ( com_productionMode.GetInteger() != 0 ) {
 		sourceFileTime = FILE_NOT_FOUND_TIMESTAMP;
 		if ( cubeFiles != CF_2D ) {
@@ -299,7 +315,19 @@ void idImage::ActuallyLoadImage( bool fromBackEnd ) {
 	idStrStatic< MAX_OSPATH > generatedName = GetName();
 	GetGeneratedName( generatedName, usage, cubeFiles );
 
-	idBinaryImage im( generatedName );
+	im.SetName( generatedName );
+}
+
+/*
+===============
+idImage::LoadBinaryImage
+
+Reads the generated file named by PrepareBinaryImage into im without touching the GPU.
+Level loading calls this from job threads for many images at once.
+===============
+*/
+void idImage::LoadBinaryImage( idBinaryImage & im ) {
+	idStrStatic< MAX_OSPATH > generatedName = im.GetName();
 	binaryFileTime = im.LoadFromGeneratedFile( sourceFileTime );
 
 	// BFHACK, do not want to tweak on buildgame so catch these images here
@@ -338,6 +366,18 @@ void idImage::ActuallyLoadImage( bool fromBackEnd ) {
 			}
 		}
 	}
+}
+
+/*
+===============
+idImage::UploadBinaryImage
+
+Creates the texture from an image read by LoadBinaryImage, building and writing out the
+generated file first if it was missing or out of date. Must be called on the render thread.
+===============
+*/
+void idImage::UploadBinaryImage( idBinaryImage & im ) {
+	idStrStatic< MAX_OSPATH > generatedName = im.GetName();
 	const bimageFile_t & header = im.GetFileHeader();
 
 	if ( ( fileSystem->InProductionMode() && binaryFileTime != FILE_NOT_FOUND_TIMESTAMP ) || ( ( binaryFileTime != FILE_NOT_FOUND_TIMESTAMP )
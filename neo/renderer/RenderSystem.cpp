@@ -80,7 +80,8 @@ static void R_PerformanceCounters() {
 			tr.pc.c_lightUpdates, tr.pc.c_lightReferences );
 	}
 	if ( r_showMemory.GetBool() ) {
-		common->Printf( "frameData: %i (%i)\n", frameData->frameMemoryAllocated.GetValue(), frameData->highWaterAllocated );
+		common->Printf( "frameData: %i (%i) used: %i (%i)\n", frameData->frameMemoryAllocated.GetValue(), frameData->highWaterAllocated,
+			frameData->frameMemoryUsed.GetValue(), frameData->highWaterUsed );
 	}
 
 	memset( &tr.pc, 0, sizeof( tr.pc ) );
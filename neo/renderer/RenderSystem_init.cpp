@@ -1894,6 +1894,7 @@ void R_InitCommands() {
 	cmdSystem->AddCommand( "testVideo", R_TestVideo_f, CMD_FL_RENDERER | CMD_FL_CHEAT, "displays the given cinematic", idCmdSystem::ArgCompletion_VideoName );
 	cmdSystem->AddCommand( "reportSurfaceAreas", R_ReportSurfaceAreas_f, CMD_FL_RENDERER, "lists all used materials sorted by surface area" );
 	cmdSystem->AddCommand( "showInteractionMemory", R_ShowInteractionMemory_f, CMD_FL_RENDERER, "shows memory used by interactions" );
+	cmdSystem->AddCommand( "listFrameAllocs", R_ListFrameAllocs_f, CMD_FL_RENDERER, "lists the frame memory allocations by type" );
 	cmdSystem->AddCommand( "vid_restart", R_VidRestart_f, CMD_FL_RENDERER, "restarts renderSystem" );
 	cmdSystem->AddCommand( "listRenderEntityDefs", R_ListRenderEntityDefs_f, CMD_FL_RENDERER, "lists the entity defs" );
 	cmdSystem->AddCommand( "listRenderLightDefs", R_ListRenderLightDefs_f, CMD_FL_RENDERER, "lists the light defs" );
@@ -1947,6 +1948,7 @@ void idRenderSystemLocal::Clear() {
 	}
 
 	frontEndJobList = NULL;
+	frontEndJobGraph = NULL;
 }
 
 /*
@@ -2199,6 +2201,7 @@ void idRenderSystemLocal::Init() {
 	}
 
 	frontEndJobList = parallelJobManager->AllocJobList( JOBLIST_RENDERER_FRONTEND, JOBLIST_PRIORITY_MEDIUM, 2048, 0, NULL );
+	frontEndJobGraph = new (TAG_JOBLIST) idParallelJobGraph( JOBLIST_RENDERER_FRONTEND, JOBLIST_PRIORITY_MEDIUM, 8192, NULL );
 
 	// make sure the command buffers are ready to accept the first screen update
 	SwapCommandBuffers( NULL, NULL, NULL, NULL );
@@ -2240,6 +2243,7 @@ void idRenderSystemLocal::Shutdown() {
 	delete guiModel;
 
 	parallelJobManager->FreeJobList( frontEndJobList );
+	delete frontEndJobGraph;
 
 	Clear();
 
@@ -448,28 +448,13 @@ REGISTER_PARALLEL_JOB( R_AddSingleLight, "R_AddSingleLight" );
 
 /*
 =================
-R_AddLights
+R_CullViewLights
+
+Removes the lights that turned out to not be needed, adds the shadow only
+entities of the others to the view and sets up the pre-light shadow volumes.
 =================
 */
-void R_AddLights() {
-	SCOPED_PROFILE_EVENT( "R_AddLights" );
-
-	//-------------------------------------------------
-	// check each light individually, possibly in parallel
-	//-------------------------------------------------
-
-	if ( r_useParallelAddLights.GetBool() ) {
-		for ( viewLight_t * vLight = tr.viewDef->viewLights; vLight != NULL; vLight = vLight->next ) {
-			tr.frontEndJobList->AddJob( (jobRun_t)R_AddSingleLight, vLight );
-		}
-		tr.frontEndJobList->Submit();
-		tr.frontEndJobList->Wait();
-	} else {
-		for ( viewLight_t * vLight = tr.viewDef->viewLights; vLight != NULL; vLight = vLight->next ) {
-			R_AddSingleLight( vLight );
-		}
-	}
-
+static void R_CullViewLights( bool useJobGraph ) {
 	//-------------------------------------------------
 	// cull lights from the list if they turned out to not be needed
 	//-------------------------------------------------
@@ -504,10 +489,14 @@ void R_AddLights() {
 	// Add jobs to setup pre-light shadow volumes.
 	//-------------------------------------------------
 
-	if ( r_useParallelAddShadows.GetInteger() == 1 ) {
+	if ( r_useParallelAddShadows.GetInteger() >= 1 ) {
 		for ( viewLight_t * vLight = tr.viewDef->viewLights; vLight != NULL; vLight = vLight->next ) {
 			for ( preLightShadowVolumeParms_t * shadowParms = vLight->preLightShadowVolumes; shadowParms != NULL; shadowParms = shadowParms->next ) {
-				tr.frontEndJobList->AddJob( (jobRun_t)PreLightShadowVolumeJob, shadowParms );
+				if ( useJobGraph ) {
+					tr.frontEndJobGraph->AddJob( (jobRun_t)PreLightShadowVolumeJob, shadowParms );
+				} else {
+					tr.frontEndJobList->AddJob( (jobRun_t)PreLightShadowVolumeJob, shadowParms );
+				}
 			}
 			vLight->preLightShadowVolumes = NULL;
 		}
@@ -526,6 +515,55 @@ void R_AddLights() {
 	}
 }
 
+/*
+=================
+R_CullLightsJob
+
+Runs in the front end job graph as soon as all lights are checked.
+=================
+*/
+static void R_CullLightsJob( void * data ) {
+	R_CullViewLights( true );
+}
+
+REGISTER_PARALLEL_JOB( R_CullLightsJob, "R_CullLightsJob" );
+
+/*
+=================
+R_AddLights
+=================
+*/
+void R_AddLights() {
+	SCOPED_PROFILE_EVENT( "R_AddLights" );
+
+	if ( R_UseFrontEndJobGraph() ) {
+		// R_AddModels submits the graph, the models are added once the lights are culled
+		for ( viewLight_t * vLight = tr.viewDef->viewLights; vLight != NULL; vLight = vLight->next ) {
+			tr.frontEndJobGraph->AddJob( (jobRun_t)R_AddSingleLight, vLight, &tr.frontEndLightsDone );
+		}
+		tr.frontEndJobGraph->AddJob( (jobRun_t)R_CullLightsJob, NULL, &tr.frontEndLightsCulled, &tr.frontEndLightsDone );
+		return;
+	}
+
+	//-------------------------------------------------
+	// check each light individually, possibly in parallel
+	//-------------------------------------------------
+
+	if ( r_useParallelAddLights.GetBool() ) {
+		for ( viewLight_t * vLight = tr.viewDef->viewLights; vLight != NULL; vLight = vLight->next ) {
+			tr.frontEndJobList->AddJob( (jobRun_t)R_AddSingleLight, vLight );
+		}
+		tr.frontEndJobList->Submit();
+		tr.frontEndJobList->Wait();
+	} else {
+		for ( viewLight_t * vLight = tr.viewDef->viewLights; vLight != NULL; vLight = vLight->next ) {
+			R_AddSingleLight( vLight );
+		}
+	}
+
+	R_CullViewLights( false );
+}
+
 /*
 =====================
 R_OptimizeViewLightsList
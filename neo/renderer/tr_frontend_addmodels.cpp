@@ -32,10 +32,12 @@ If you have questions concerning this license or the applicable additional terms
 #include "tr_local.h"
 #include "Model_local.h"
 
+extern idCVar r_useParallelAddLights;
+
 idCVar r_skipStaticShadows( "r_skipStaticShadows", "0", CVAR_RENDERER | CVAR_BOOL, "skip static shadows" );
 idCVar r_skipDynamicShadows( "r_skipDynamicShadows", "0", CVAR_RENDERER | CVAR_BOOL, "skip dynamic shadows" );
 idCVar r_useParallelAddModels( "r_useParallelAddModels", "1", CVAR_RENDERER | CVAR_BOOL, "add all models in parallel with jobs" );
-idCVar r_useParallelAddShadows( "r_useParallelAddShadows", "1", CVAR_RENDERER | CVAR_INTEGER, "0 = off, 1 = threaded", 0, 1 );
+idCVar r_useParallelAddShadows( "r_useParallelAddShadows", "1", CVAR_RENDERER | CVAR_INTEGER, "0 = off, 1 = threaded, 2 = threaded and overlapped with adding models", 0, 2 );
 idCVar r_useShadowPreciseInsideTest( "r_useShadowPreciseInsideTest", "1", CVAR_RENDERER | CVAR_BOOL, "use a precise and more expensive test to determine whether the view is inside a shadow volume" );
 idCVar r_cullDynamicShadowTriangles( "r_cullDynamicShadowTriangles", "1", CVAR_RENDERER | CVAR_BOOL, "cull occluder triangles that are outside the light frustum so they do not contribute to the dynamic shadow volume" );
 idCVar r_cullDynamicLightTriangles( "r_cullDynamicLightTriangles", "1", CVAR_RENDERER | CVAR_BOOL, "cull surface triangles that are outside the light frustum so they do not get rendered for interactions" );
@@ -963,6 +965,30 @@ void R_AddSingleModel( viewEntity_t * vEntity ) {
 
 REGISTER_PARALLEL_JOB( R_AddSingleModel, "R_AddSingleModel" );
 
+/*
+===================
+R_AddSingleModelAndShadows
+
+Adds the shadow volume jobs of the entity to the front end job graph
+as soon as the entity is added, so the shadow volumes are generated
+while other entities are still being added.
+===================
+*/
+static void R_AddSingleModelAndShadows( viewEntity_t * vEntity ) {
+	R_AddSingleModel( vEntity );
+
+	for ( staticShadowVolumeParms_t * shadowParms = vEntity->staticShadowVolumes; shadowParms != NULL; shadowParms = shadowParms->next ) {
+		tr.frontEndJobGraph->AddJob( (jobRun_t)StaticShadowVolumeJob, shadowParms );
+	}
+	for ( dynamicShadowVolumeParms_t * shadowParms = vEntity->dynamicShadowVolumes; shadowParms != NULL; shadowParms = shadowParms->next ) {
+		tr.frontEndJobGraph->AddJob( (jobRun_t)DynamicShadowVolumeJob, shadowParms );
+	}
+	vEntity->staticShadowVolumes = NULL;
+	vEntity->dynamicShadowVolumes = NULL;
+}
+
+REGISTER_PARALLEL_JOB( R_AddSingleModelAndShadows, "R_AddSingleModelAndShadows" );
+
 /*
 =================
 R_LinkDrawSurfToView
@@ -991,6 +1017,78 @@ void R_LinkDrawSurfToView( drawSurf_t * drawSurf, viewDef_t * viewDef ) {
 	viewDef->numDrawSurfs++;
 }
 
+/*
+===================
+R_LinkDrawSurfs
+
+Moves the draw surfs of the view entities to the view and the light link chains.
+===================
+*/
+static void R_LinkDrawSurfs() {
+	tr.viewDef->numDrawSurfs = 0;	// clear the ambient surface list
+	tr.viewDef->maxDrawSurfs = 0;	// will be set to INITIAL_DRAWSURFS on R_LinkDrawSurfToView
+
+	for ( viewEntity_t * vEntity = tr.viewDef->viewEntitys; vEntity != NULL; vEntity = vEntity->next ) {
+		for ( drawSurf_t * ds = vEntity->drawSurfs; ds != NULL; ) {
+			drawSurf_t * next = ds->nextOnLight;
+			if ( ds->linkChain == NULL ) {
+				R_LinkDrawSurfToView( ds, tr.viewDef );
+			} else {
+				ds->nextOnLight = *ds->linkChain;
+				*ds->linkChain = ds;
+			}
+			ds = next;
+		}
+		vEntity->drawSurfs = NULL;
+	}
+}
+
+/*
+===================
+R_AddModelsJob
+
+Runs in the front end job graph once the lights are culled, which may have
+added the shadow only entities to the view. The model jobs signal the same
+counter as this job, so the models are only done when all of them are.
+===================
+*/
+static void R_AddModelsJob( void * data ) {
+	tr.viewDef->viewEntitys = R_SortViewEntities( tr.viewDef->viewEntitys );
+
+	for ( viewEntity_t * vEntity = tr.viewDef->viewEntitys; vEntity != NULL; vEntity = vEntity->next ) {
+		tr.frontEndJobGraph->AddJob( (jobRun_t)R_AddSingleModelAndShadows, vEntity, &tr.frontEndModelsDone );
+	}
+}
+
+REGISTER_PARALLEL_JOB( R_AddModelsJob, "R_AddModelsJob" );
+
+/*
+===================
+R_LinkDrawSurfsJob
+
+Runs in the front end job graph once all models are added, while the
+shadow volume jobs are still running. The shadow volume jobs only write
+the index counts and shadow volume results of their draw surfs, never the links.
+===================
+*/
+static void R_LinkDrawSurfsJob( void * data ) {
+	R_LinkDrawSurfs();
+}
+
+REGISTER_PARALLEL_JOB( R_LinkDrawSurfsJob, "R_LinkDrawSurfsJob" );
+
+/*
+===================
+R_UseFrontEndJobGraph
+
+True if R_AddLights and R_AddModels add their work to the front end job graph,
+the stages then start as soon as the jobs they depend on are done.
+===================
+*/
+bool R_UseFrontEndJobGraph() {
+	return r_useParallelAddLights.GetBool() && r_useParallelAddModels.GetBool() && r_useParallelAddShadows.GetInteger() == 2;
+}
+
 /*
 ===================
 R_AddModels
@@ -1003,6 +1101,16 @@ frameData and vertexCache allocations to support the drawSurfs.
 void R_AddModels() {
 	SCOPED_PROFILE_EVENT( "R_AddModels" );
 
+	if ( R_UseFrontEndJobGraph() ) {
+		// the light jobs added by R_AddLights are already in the graph
+		tr.frontEndJobGraph->AddJob( (jobRun_t)R_AddModelsJob, NULL, &tr.frontEndModelsDone, &tr.frontEndLightsCulled );
+		tr.frontEndJobGraph->AddJob( (jobRun_t)R_LinkDrawSurfsJob, NULL, NULL, &tr.frontEndModelsDone );
+		tr.frontEndJobGraph->Submit();
+		// wait here otherwise the shadow volume index buffer may be unmapped before all shadow volumes have been constructed
+		tr.frontEndJobGraph->Wait();
+		return;
+	}
+
 	tr.viewDef->viewEntitys = R_SortViewEntities( tr.viewDef->viewEntitys );
 
 	//-------------------------------------------------
@@ -1026,7 +1134,7 @@ void R_AddModels() {
 	// Kick off jobs to setup static and dynamic shadow volumes.
 	//-------------------------------------------------
 
-	if ( r_useParallelAddShadows.GetInteger() == 1 ) {
+	if ( r_useParallelAddShadows.GetInteger() >= 1 ) {
 		for ( viewEntity_t * vEntity = tr.viewDef->viewEntitys; vEntity != NULL; vEntity = vEntity->next ) {
 			for ( staticShadowVolumeParms_t * shadowParms = vEntity->staticShadowVolumes; shadowParms != NULL; shadowParms = shadowParms->next ) {
 				tr.frontEndJobList->AddJob( (jobRun_t)StaticShadowVolumeJob, shadowParms );
@@ -1062,20 +1170,5 @@ void R_AddModels() {
 	// Move the draw surfs to the view.
 	//-------------------------------------------------
 
-	tr.viewDef->numDrawSurfs = 0;	// clear the ambient surface list
-	tr.viewDef->maxDrawSurfs = 0;	// will be set to INITIAL_DRAWSURFS on R_LinkDrawSurfToView
-
-	for ( viewEntity_t * vEntity = tr.viewDef->viewEntitys; vEntity != NULL; vEntity = vEntity->next ) {
-		for ( drawSurf_t * ds = vEntity->drawSurfs; ds != NULL; ) {
-			drawSurf_t * next = ds->nextOnLight;
-			if ( ds->linkChain == NULL ) {
-				R_LinkDrawSurfToView( ds, tr.viewDef );
-			} else {
-				ds->nextOnLight = *ds->linkChain;
-				*ds->linkChain = ds;
-			}
-			ds = next;
-		}
-		vEntity->drawSurfs = NULL;
-	}
+	R_LinkDrawSurfs();
 }
@@ -43,16 +43,58 @@ static const unsigned int NUM_FRAME_DATA = 2;
 static const unsigned int FRAME_ALLOC_ALIGNMENT = 128;
 static const unsigned int MAX_FRAME_MEMORY = 64 * 1024 * 1024;	// larger so that we can noclip on PC for dev purposes
 
+// Every thread that allocates frame memory carves blocks of this size out of the frame
+// memory and allocates from those without touching the shared allocation counter.
+// Allocations that are a significant part of a block go straight to the frame memory.
+static const unsigned int FRAME_ARENA_SIZE = 64 * 1024;
+static const unsigned int FRAME_ARENA_MAX_ALLOC = FRAME_ARENA_SIZE / 4;
+static const int MAX_FRAME_ARENAS = 64;
+
 idFrameData		smpFrameData[NUM_FRAME_DATA];
 idFrameData *	frameData;
 unsigned int	smpFrame;
 
-//#define TRACK_FRAME_ALLOCS
+idCVar r_useFrameArenas( "r_useFrameArenas", "1", CVAR_RENDERER | CVAR_BOOL, "allocate frame memory from per thread blocks instead of one shared counter" );
 
-#if defined( TRACK_FRAME_ALLOCS )
-idSysInterlockedInteger frameAllocTypeCount[FRAME_ALLOC_MAX];
-int frameHighWaterTypeCount[FRAME_ALLOC_MAX];
-#endif
+struct frameArena_t {
+	byte *			current;
+	byte *			end;
+	unsigned int	frame;						// smpFrame the block was carved for
+	int				typeBytes[FRAME_ALLOC_MAX];	// bytes requested during 'frame'
+};
+
+// each arena is only touched by the thread that owns it, keep them on separate cache lines
+union frameArenaLine_t {
+	frameArena_t	arena;
+	byte			pad[( sizeof( frameArena_t ) + CACHE_LINE_SIZE - 1 ) & ~( CACHE_LINE_SIZE - 1 )];
+};
+
+static ALIGNTYPE128 frameArenaLine_t	frameArenas[MAX_FRAME_ARENAS];
+static idSysInterlockedInteger	numFrameArenas;
+static ID_TLS					frameArenaIndex;	// index + 1 of the arena of the calling thread
+
+static int frameAllocTypeBytes[FRAME_ALLOC_MAX];		// requested on the last completed frame
+static int frameHighWaterTypeBytes[FRAME_ALLOC_MAX];	// at the time of the highest frame memory allocation
+
+/*
+====================
+R_GetFrameArena
+====================
+*/
+static frameArena_t * R_GetFrameArena() {
+	int index = (int)(ptrdiff_t)frameArenaIndex;
+	if ( index == 0 ) {
+		index = numFrameArenas.Increment();
+		if ( index > MAX_FRAME_ARENAS ) {
+			// too many threads, this one will use the shared counter
+			numFrameArenas.Decrement();
+			return NULL;
+		}
+		frameArenas[index - 1].arena.frame = smpFrame - 1;
+		frameArenaIndex = (ptrdiff_t)index;
+	}
+	return &frameArenas[index - 1].arena;
+}
 
 /*
 ====================
@@ -60,18 +102,30 @@ R_ToggleSmpFrame
 ====================
 */
 void R_ToggleSmpFrame() {
+	// gather the per thread statistics of the frame that was just built
+	int used = 0;
+	memset( frameAllocTypeBytes, 0, sizeof( frameAllocTypeBytes ) );
+	const int numArenas = Min( numFrameArenas.GetValue(), MAX_FRAME_ARENAS );
+	for ( int i = 0; i < numArenas; i++ ) {
+		const frameArena_t & arena = frameArenas[i].arena;
+		if ( arena.frame != smpFrame ) {
+			continue;
+		}
+		for ( int j = 0; j < FRAME_ALLOC_MAX; j++ ) {
+			frameAllocTypeBytes[j] += arena.typeBytes[j];
+			used += arena.typeBytes[j];
+		}
+	}
+	frameData->frameMemoryUsed.SetValue( used );
+
 	// update the highwater mark
 	if ( frameData->frameMemoryAllocated.GetValue() > frameData->highWaterAllocated ) {
 		frameData->highWaterAllocated = frameData->frameMemoryAllocated.GetValue();
-#if defined( TRACK_FRAME_ALLOCS )
-		frameData->highWaterUsed = frameData->frameMemoryUsed.GetValue();
-		for ( int i = 0; i < FRAME_ALLOC_MAX; i++ ) {
-			frameHighWaterTypeCount[i] = frameAllocTypeCount[i].GetValue();
-		}
-#endif
+		frameData->highWaterUsed = used;
+		memcpy( frameHighWaterTypeBytes, frameAllocTypeBytes, sizeof( frameHighWaterTypeBytes ) );
 	}
 
-	// switch to the next frame
+	// switch to the next frame, this also retires the blocks of all arenas
 	smpFrame++;
 	frameData = &smpFrameData[smpFrame % NUM_FRAME_DATA];
 
@@ -80,12 +134,6 @@ void R_ToggleSmpFrame() {
 	frameData->frameMemoryAllocated.SetValue( bytesNeededForAlignment );
 	frameData->frameMemoryUsed.SetValue( 0 );
 
-#if defined( TRACK_FRAME_ALLOCS )
-	for ( int i = 0; i < FRAME_ALLOC_MAX; i++ ) {
-		frameAllocTypeCount[i].SetValue( 0 );
-	}
-#endif
-
 	// clear the command chain and make a RC_NOP command the only thing on the list
 	frameData->cmdHead = frameData->cmdTail = (emptyCommand_t *)R_FrameAlloc( sizeof( *frameData->cmdHead ), FRAME_ALLOC_DRAW_COMMAND );
 	frameData->cmdHead->commandId = RC_NOP;
@@ -123,6 +171,21 @@ void R_InitFrameData() {
 	R_ToggleSmpFrame();
 }
 
+/*
+================
+R_FrameAllocShared
+
+Thread safe allocation directly from the frame memory.
+================
+*/
+static byte * R_FrameAllocShared( int bytes ) {
+	int	end = frameData->frameMemoryAllocated.Add( bytes );
+	if ( end > MAX_FRAME_MEMORY ) {
+		idLib::Error( "R_FrameAlloc ran out of memory. bytes = %d, end = %d, highWaterAllocated = %d\n", bytes, end, frameData->highWaterAllocated );
+	}
+	return frameData->frameMemory + end - bytes;
+}
+
 /*
 ================
 R_FrameAlloc
@@ -140,20 +203,37 @@ All memory is cache-line-cleared for the best performance.
 ================
 */
 void *R_FrameAlloc( int bytes, frameAllocType_t type ) {
-#if defined( TRACK_FRAME_ALLOCS )
-	frameData->frameMemoryUsed.Add( bytes );
-	frameAllocTypeCount[type].Add( bytes );
-#endif
-
 	bytes = ( bytes + FRAME_ALLOC_ALIGNMENT - 1 ) & ~ ( FRAME_ALLOC_ALIGNMENT - 1 );
 
-	// thread safe add
-	int	end = frameData->frameMemoryAllocated.Add( bytes );
-	if ( end > MAX_FRAME_MEMORY ) {
-		idLib::Error( "R_FrameAlloc ran out of memory. bytes = %d, end = %d, highWaterAllocated = %d\n", bytes, end, frameData->highWaterAllocated );
+	byte * ptr = NULL;
+
+	frameArena_t * arena = R_GetFrameArena();
+	if ( arena != NULL ) {
+		if ( arena->frame != smpFrame ) {
+			// first allocation of this thread since the frame was toggled
+			arena->current = NULL;
+			arena->end = NULL;
+			arena->frame = smpFrame;
+			memset( arena->typeBytes, 0, sizeof( arena->typeBytes ) );
+		}
+		arena->typeBytes[type] += bytes;
+
+		if ( bytes <= arena->end - arena->current ) {
+			ptr = arena->current;
+			arena->current += bytes;
+		} else if ( bytes <= (int)FRAME_ARENA_MAX_ALLOC && r_useFrameArenas.GetBool() ) {
+			// the rest of the old block is wasted
+			arena->current = R_FrameAllocShared( FRAME_ARENA_SIZE );
+			arena->end = arena->current + FRAME_ARENA_SIZE;
+			ptr = arena->current;
+			arena->current += bytes;
+		}
 	}
 
-	byte * ptr = frameData->frameMemory + end - bytes;
+	if ( ptr == NULL ) {
+		// thread safe add
+		ptr = R_FrameAllocShared( bytes );
+	}
 
 	// cache line clear the memory
 	for ( int offset = 0; offset < bytes; offset += CACHE_LINE_SIZE ) {
@@ -173,6 +253,36 @@ void *R_ClearedFrameAlloc( int bytes, frameAllocType_t type ) {
 	return R_FrameAlloc( bytes, type );
 }
 
+/*
+==================
+R_ListFrameAllocs_f
+==================
+*/
+void R_ListFrameAllocs_f( const idCmdArgs &args ) {
+	static const char * typeNames[] = {
+		ASSERT_ENUM_STRING( FRAME_ALLOC_VIEW_DEF,				0 ),
+		ASSERT_ENUM_STRING( FRAME_ALLOC_VIEW_ENTITY,			1 ),
+		ASSERT_ENUM_STRING( FRAME_ALLOC_VIEW_LIGHT,				2 ),
+		ASSERT_ENUM_STRING( FRAME_ALLOC_SURFACE_TRIANGLES,		3 ),
+		ASSERT_ENUM_STRING( FRAME_ALLOC_DRAW_SURFACE,			4 ),
+		ASSERT_ENUM_STRING( FRAME_ALLOC_INTERACTION_STATE,		5 ),
+		ASSERT_ENUM_STRING( FRAME_ALLOC_SHADOW_ONLY_ENTITY,		6 ),
+		ASSERT_ENUM_STRING( FRAME_ALLOC_SHADOW_VOLUME_PARMS,	7 ),
+		ASSERT_ENUM_STRING( FRAME_ALLOC_SHADER_REGISTER,		8 ),
+		ASSERT_ENUM_STRING( FRAME_ALLOC_DRAW_SURFACE_POINTER,	9 ),
+		ASSERT_ENUM_STRING( FRAME_ALLOC_DRAW_COMMAND,			10 ),
+		ASSERT_ENUM_STRING( FRAME_ALLOC_UNKNOWN,				11 )
+	};
+	compile_time_assert( sizeof( typeNames ) / sizeof( typeNames[0] ) == FRAME_ALLOC_MAX );
+
+	common->Printf( "%-34s %10s %10s\n", "type", "last frame", "high water" );
+	for ( int i = 0; i < FRAME_ALLOC_MAX; i++ ) {
+		common->Printf( "%-34s %9dk %9dk\n", typeNames[i], frameAllocTypeBytes[i] >> 10, frameHighWaterTypeBytes[i] >> 10 );
+	}
+	common->Printf( "%d threads allocate from %dk blocks\n", Min( numFrameArenas.GetValue(), MAX_FRAME_ARENAS ), FRAME_ARENA_SIZE >> 10 );
+	common->Printf( "high water: %dk allocated, %dk used\n", frameData->highWaterAllocated >> 10, frameData->highWaterUsed >> 10 );
+}
+
 /*
 ==========================================================================================
 
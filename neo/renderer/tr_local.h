@@ -813,6 +813,10 @@ public:
 	drawSurf_t				testImageSurface_;
 
 	idParallelJobList *		frontEndJobList;
+	idParallelJobGraph *	frontEndJobGraph;
+	idParallelJobCounter	frontEndLightsDone;		// the stages of the front end job graph
+	idParallelJobCounter	frontEndLightsCulled;
+	idParallelJobCounter	frontEndModelsDone;
 
 	unsigned				timerQueryId;		// for GL_TIME_ELAPSED_EXT queries
 };
@@ -1103,6 +1107,7 @@ void R_ShutdownFrameData();
 void R_ToggleSmpFrame();
 void *R_FrameAlloc( int bytes, frameAllocType_t type = FRAME_ALLOC_UNKNOWN );
 void *R_ClearedFrameAlloc( int bytes, frameAllocType_t type = FRAME_ALLOC_UNKNOWN );
+void R_ListFrameAllocs_f( const idCmdArgs &args );
 
 void *R_StaticAlloc( int bytes, const memTag_t tag = TAG_RENDER_STATIC );		// just malloc with error checking
 void *R_ClearedStaticAlloc( int bytes );	// with memset
@@ -1146,6 +1151,7 @@ void R_SetupDrawSurfShader( drawSurf_t * drawSurf, const idMaterial * shader, co
 void R_SetupDrawSurfJoints( drawSurf_t * drawSurf, const srfTriangles_t * tri, const idMaterial * shader );
 void R_LinkDrawSurfToView( drawSurf_t * drawSurf, viewDef_t * viewDef );
 
+bool R_UseFrontEndJobGraph();
 void R_AddModels();
 
 /*
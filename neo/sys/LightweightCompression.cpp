@@ -29,6 +29,8 @@ If you have questions concerning this license or the applicable additional terms
 #include "../idLib/precompiled.h"
 #include "LightweightCompression.h"
 
+idCVar net_snapshotCodecModel( "net_snapshotCodecModel", "", CVAR_ARCHIVE, "Model written by snapshotCodecTrain for range coded snapshots, the built in model is used when empty. Host and clients need the same model." );
+
 /*
 ========================
 HashIndex
@@ -378,6 +380,481 @@ void idLZWCompressor::ClearHash() {
 	memset( hash, 0xFF, sizeof( hash ) ); 
 }
 
+/*
+========================
+idRangeCoderModel::GetContext
+========================
+*/
+int idRangeCoderModel::GetContext( int prevByte ) {
+	if ( prevByte == 0 ) {
+		return 0;				// zrle run length follows
+	}
+	const int delta = abs( (int8)prevByte );
+	if ( delta <= 8 ) {
+		return 1;
+	}
+	if ( delta <= 64 ) {
+		return 2;
+	}
+	return 3;
+}
+
+/*
+========================
+idRangeCoderModel::SetDefault
+========================
+*/
+void idRangeCoderModel::SetDefault() {
+	static uint32 counts[NUM_CONTEXTS][NUM_SYMBOLS];
+
+	// zrle'd deltas are mostly zero runs and small changes, run lengths are mostly short
+	for ( int c = 0; c < NUM_CONTEXTS; c++ ) {
+		const uint32 peak = ( c == 0 ) ? 2048 : ( 4096 >> c );
+		for ( int s = 0; s < 256; s++ ) {
+			const int distance = ( c == 0 ) ? s : abs( (int8)s );
+			counts[c][s] = 1 + peak / ( 1 + distance );
+		}
+		counts[c][0] = ( c == 0 ) ? 256 : peak;
+		counts[c][END_SYMBOL] = 1;
+	}
+	Train( counts );
+}
+
+/*
+========================
+idRangeCoderModel::Train
+========================
+*/
+void idRangeCoderModel::Train( const uint32 counts[NUM_CONTEXTS][NUM_SYMBOLS] ) {
+	for ( int c = 0; c < NUM_CONTEXTS; c++ ) {
+		uint64 total = 0;
+		int mostFrequent = 0;
+		for ( int s = 0; s < NUM_SYMBOLS; s++ ) {
+			total += counts[c][s];
+			if ( counts[c][s] > counts[c][mostFrequent] ) {
+				mostFrequent = s;
+			}
+		}
+
+		// every symbol needs a non zero frequency to be codable
+		int sum = 0;
+		for ( int s = 0; s < NUM_SYMBOLS; s++ ) {
+			const uint64 scaled = ( total > 0 ) ? ( (uint64)counts[c][s] * ( TOTAL - NUM_SYMBOLS ) / total ) : 0;
+			freq[c][s] = (uint16)( 1 + scaled );
+			sum += freq[c][s];
+		}
+		assert( sum <= TOTAL );
+		freq[c][mostFrequent] += (uint16)( TOTAL - sum );
+	}
+	BuildTables();
+}
+
+/*
+========================
+idRangeCoderModel::BuildTables
+========================
+*/
+void idRangeCoderModel::BuildTables() {
+	for ( int c = 0; c < NUM_CONTEXTS; c++ ) {
+		cumFreq[c][0] = 0;
+		for ( int s = 0; s < NUM_SYMBOLS; s++ ) {
+			assert( freq[c][s] > 0 );
+			cumFreq[c][s + 1] = cumFreq[c][s] + freq[c][s];
+			for ( int i = cumFreq[c][s]; i < cumFreq[c][s + 1]; i++ ) {
+				symbols[c][i] = (uint16)s;
+			}
+		}
+		assert( cumFreq[c][NUM_SYMBOLS] == TOTAL );
+	}
+	checksum = (uint16)( CRC32_BlockChecksum( freq, sizeof( freq ) ) & 0xFFFF );
+}
+
+static const int RANGE_MODEL_MAGIC		= ( 'S' << 24 ) | ( 'C' << 16 ) | ( 'M' << 8 ) | 1;
+
+/*
+========================
+idRangeCoderModel::Load
+========================
+*/
+bool idRangeCoderModel::Load( const char * fileName ) {
+	idFileLocal file( fileSystem->OpenFileRead( fileName ) );
+	if ( file == NULL ) {
+		return false;
+	}
+	int magic = 0;
+	file->ReadBig( magic );
+	if ( magic != RANGE_MODEL_MAGIC ) {
+		return false;
+	}
+	for ( int c = 0; c < NUM_CONTEXTS; c++ ) {
+		int sum = 0;
+		for ( int s = 0; s < NUM_SYMBOLS; s++ ) {
+			if ( file->ReadBig( freq[c][s] ) != sizeof( freq[c][s] ) || freq[c][s] == 0 ) {
+				return false;
+			}
+			sum += freq[c][s];
+		}
+		if ( sum != TOTAL ) {
+			return false;
+		}
+	}
+	BuildTables();
+	return true;
+}
+
+/*
+========================
+idRangeCoderModel::Save
+========================
+*/
+bool idRangeCoderModel::Save( const char * fileName ) const {
+	idFileLocal file( fileSystem->OpenFileWrite( fileName ) );
+	if ( file == NULL ) {
+		return false;
+	}
+	file->WriteBig( RANGE_MODEL_MAGIC );
+	for ( int c = 0; c < NUM_CONTEXTS; c++ ) {
+		file->WriteBigArray( freq[c], NUM_SYMBOLS );
+	}
+	return true;
+}
+
+static idRangeCoderModel	snapshotCodecModel;
+static bool					snapshotCodecModelLoaded = false;
+
+/*
+========================
+GetSnapshotCodecModel
+========================
+*/
+const idRangeCoderModel * GetSnapshotCodecModel() {
+	if ( !snapshotCodecModelLoaded ) {
+		ReloadSnapshotCodecModel();
+	}
+	return &snapshotCodecModel;
+}
+
+/*
+========================
+ReloadSnapshotCodecModel
+========================
+*/
+void ReloadSnapshotCodecModel() {
+	snapshotCodecModelLoaded = true;
+
+	const char * fileName = net_snapshotCodecModel.GetString();
+	if ( fileName[0] != '\0' ) {
+		if ( snapshotCodecModel.Load( fileName ) ) {
+			idLib::Printf( "Loaded snapshot codec model %s (%04x)\n", fileName, snapshotCodecModel.GetChecksum() );
+			return;
+		}
+		idLib::Warning( "Couldn't load snapshot codec model %s, using the default model", fileName );
+	}
+	snapshotCodecModel.SetDefault();
+}
+
+static const uint32 RANGE_TOP		= 1 << 24;
+static const uint32 RANGE_BOTTOM	= 1 << 16;
+
+/*
+========================
+idRangeCompressor::Start
+========================
+*/
+void idRangeCompressor::Start( const idRangeCoderModel * model_, uint8 * data_, int maxSize_, bool append ) {
+	if ( !append ) {
+		lzwData->rangeLow		= 0;
+		lzwData->rangeSize		= 0xFFFFFFFF;
+		lzwData->rangePrevByte	= 0x80;
+		lzwData->bytesWritten	= 0;
+	}
+
+	model		= model_;
+	data		= data_;
+	maxSize		= maxSize_;
+	overflowed	= false;
+
+	bytesRead	= 0;
+	low			= 0;
+	range		= 0;
+	code		= 0;
+	prevByte	= 0x80;
+	ended		= false;
+
+	Save();
+}
+
+/*
+========================
+idRangeCompressor::StartRead
+========================
+*/
+void idRangeCompressor::StartRead( const idRangeCoderModel * model_, const uint8 * data_, int size ) {
+	model		= model_;
+	data		= const_cast< uint8 * >( data_ );
+	maxSize		= size;
+	overflowed	= false;
+
+	bytesRead	= 0;
+	low			= 0;
+	range		= 0xFFFFFFFF;
+	code		= 0;
+	prevByte	= 0x80;
+	ended		= false;
+
+	for ( int i = 0; i < 4; i++ ) {
+		code = ( code << 8 ) | InputByte();
+	}
+}
+
+/*
+========================
+idRangeCompressor::OutputByte
+========================
+*/
+void idRangeCompressor::OutputByte( uint8 value ) {
+	if ( lzwData->bytesWritten >= maxSize ) {
+		overflowed = true;
+		return;
+	}
+	data[lzwData->bytesWritten++] = value;
+}
+
+/*
+========================
+idRangeCompressor::InputByte
+========================
+*/
+int idRangeCompressor::InputByte() {
+	// the decoder reads a few bytes past the end of the stream, those were flushed as zero
+	if ( bytesRead >= maxSize ) {
+		bytesRead++;
+		return 0;
+	}
+	return data[bytesRead++];
+}
+
+/*
+========================
+idRangeCompressor::EncodeSymbol
+========================
+*/
+void idRangeCompressor::EncodeSymbol( int context, int symbol ) {
+	uint32 & low = lzwData->rangeLow;
+	uint32 & range = lzwData->rangeSize;
+
+	range >>= idRangeCoderModel::TOTAL_BITS;
+	low += model->cumFreq[context][symbol] * range;
+	range *= model->freq[context][symbol];
+
+	// shift out the top byte once it can't change anymore, or force it when the range gets too small
+	for ( ;; ) {
+		if ( ( low ^ ( low + range ) ) >= RANGE_TOP ) {
+			if ( range >= RANGE_BOTTOM ) {
+				break;
+			}
+			range = ( 0 - low ) & ( RANGE_BOTTOM - 1 );
+		}
+		OutputByte( (uint8)( low >> 24 ) );
+		low <<= 8;
+		range <<= 8;
+	}
+}
+
+/*
+========================
+idRangeCompressor::WriteByte
+========================
+*/
+void idRangeCompressor::WriteByte( uint8 value ) {
+	EncodeSymbol( idRangeCoderModel::GetContext( lzwData->rangePrevByte ), value );
+	lzwData->rangePrevByte = value;
+
+	if ( lzwData->bytesWritten >= maxSize - END_BYTES ) {
+		overflowed = true;	// At any point, if we can't perform an End call, then trigger an overflow
+	}
+}
+
+/*
+========================
+idRangeCompressor::ReadByte
+========================
+*/
+int idRangeCompressor::ReadByte( bool ignoreOverflow ) {
+	if ( !ended ) {
+		const int context = idRangeCoderModel::GetContext( prevByte );
+
+		range >>= idRangeCoderModel::TOTAL_BITS;
+		const uint32 value = ( code - low ) / range;
+
+		if ( value < idRangeCoderModel::TOTAL ) {
+			const int symbol = model->symbols[context][value];
+
+			low += model->cumFreq[context][symbol] * range;
+			range *= model->freq[context][symbol];
+
+			for ( ;; ) {
+				if ( ( low ^ ( low + range ) ) >= RANGE_TOP ) {
+					if ( range >= RANGE_BOTTOM ) {
+						break;
+					}
+					range = ( 0 - low ) & ( RANGE_BOTTOM - 1 );
+				}
+				code = ( code << 8 ) | InputByte();
+				low <<= 8;
+				range <<= 8;
+			}
+
+			if ( symbol != idRangeCoderModel::END_SYMBOL ) {
+				prevByte = symbol;
+				return symbol;
+			}
+		}
+		// end of stream, or a corrupt one
+		ended = true;
+	}
+
+	if ( !ignoreOverflow ) {
+		overflowed = true;
+		assert( !"idRangeCompressor::ReadByte overflowed!" );
+	}
+	return -1;
+}
+
+/*
+========================
+idRangeCompressor::End
+========================
+*/
+int idRangeCompressor::End() {
+	assert( lzwData->bytesWritten <= maxSize - END_BYTES );
+
+	EncodeSymbol( idRangeCoderModel::GetContext( lzwData->rangePrevByte ), idRangeCoderModel::END_SYMBOL );
+
+	for ( int i = 0; i < 4; i++ ) {
+		OutputByte( (uint8)( lzwData->rangeLow >> 24 ) );
+		lzwData->rangeLow <<= 8;
+	}
+
+	if ( overflowed ) {
+		return -1;
+	}
+	return Length();
+}
+
+/*
+========================
+idRangeCompressor::Save
+========================
+*/
+void idRangeCompressor::Save() {
+	assert( !overflowed );
+
+	savedBytesWritten	= lzwData->bytesWritten;
+	savedLow			= lzwData->rangeLow;
+	savedRange			= lzwData->rangeSize;
+	savedPrevByte		= lzwData->rangePrevByte;
+}
+
+/*
+========================
+idRangeCompressor::Restore
+========================
+*/
+void idRangeCompressor::Restore() {
+	lzwData->bytesWritten	= savedBytesWritten;
+	lzwData->rangeLow		= savedLow;
+	lzwData->rangeSize		= savedRange;
+	lzwData->rangePrevByte	= savedPrevByte;
+	overflowed				= false;
+}
+
+/*
+========================
+idSnapshotCompressor::Start
+========================
+*/
+void idSnapshotCompressor::Start( uint8 * data_, int maxSize, bool append ) {
+	if ( !append ) {
+		codec = ( lzwData->codec == SNAPSHOT_CODEC_RANGE ) ? SNAPSHOT_CODEC_RANGE : SNAPSHOT_CODEC_LZW;
+	} else {
+		assert( lzwData->codec == codec );
+	}
+
+	const int headerSize = HeaderSize( codec );
+	overflowed = ( maxSize <= headerSize );
+	if ( overflowed ) {
+		return;
+	}
+
+	if ( codec == SNAPSHOT_CODEC_RANGE ) {
+		const idRangeCoderModel * model = GetSnapshotCodecModel();
+		if ( !append ) {
+			data_[0] = (uint8)codec;
+			data_[1] = (uint8)( model->GetChecksum() & 0xFF );
+			data_[2] = (uint8)( model->GetChecksum() >> 8 );
+		}
+		range.Start( model, data_ + headerSize, maxSize - headerSize, append );
+	} else {
+		if ( !append ) {
+			data_[0] = (uint8)codec;
+		}
+		lzw.Start( data_ + headerSize, maxSize - headerSize, append );
+	}
+}
+
+/*
+========================
+idSnapshotCompressor::StartRead
+========================
+*/
+bool idSnapshotCompressor::StartRead( const uint8 * data_, int size ) {
+	codec = SNAPSHOT_CODEC_LZW;
+	overflowed = true;
+
+	if ( size < 1 ) {
+		return false;
+	}
+
+	if ( data_[0] == SNAPSHOT_CODEC_RANGE ) {
+		const idRangeCoderModel * model = GetSnapshotCodecModel();
+		if ( size < HeaderSize( SNAPSHOT_CODEC_RANGE ) ) {
+			return false;
+		}
+		const uint16 checksum = data_[1] | ( data_[2] << 8 );
+		if ( checksum != model->GetChecksum() ) {
+			idLib::Warning( "Snapshot was range coded with model %04x, we have %04x", checksum, model->GetChecksum() );
+			return false;
+		}
+		codec = SNAPSHOT_CODEC_RANGE;
+		overflowed = false;
+		range.StartRead( model, data_ + HeaderSize( codec ), size - HeaderSize( codec ) );
+		return true;
+	}
+
+	if ( data_[0] == SNAPSHOT_CODEC_LZW ) {
+		overflowed = false;
+		lzw.Start( const_cast< uint8 * >( data_ ) + HeaderSize( codec ), size - HeaderSize( codec ) );
+		return true;
+	}
+
+	idLib::Warning( "Snapshot written with unknown codec %d", data_[0] );
+	return false;
+}
+
+/*
+========================
+idSnapshotCompressor::End
+========================
+*/
+int idSnapshotCompressor::End() {
+	if ( overflowed ) {
+		return -1;
+	}
+	const int length = ( codec == SNAPSHOT_CODEC_RANGE ) ? range.End() : lzw.End();
+	return ( length == -1 ) ? -1 : Length();
+}
+
 /*
 ========================
 idZeroRunLengthCompressor
@@ -385,7 +862,7 @@ Simple zero based run length encoder/decoder
 ========================
 */
 
-void idZeroRunLengthCompressor::Start( uint8 * dest_, idLZWCompressor * comp_, int maxSize_ ) {
+void idZeroRunLengthCompressor::Start( uint8 * dest_, idSnapshotCompressor * comp_, int maxSize_ ) {
 	zeroCount	= 0;
 	dest		= dest_;
 	comp		= comp_;
@@ -439,6 +916,22 @@ bool idZeroRunLengthCompressor::WriteByte( uint8 value ) {
 	return true;
 }
 
+bool idZeroRunLengthCompressor::WriteZeros( int count ) {
+	// Same output as count calls to WriteByte( 0 ), without touching each byte
+	while ( count > 0 ) {
+		if ( zeroCount >= 255 ) {
+			if ( !WriteRun() ) {
+				maxSize = -1;
+				return false;
+			}
+		}
+		const int num = Min( count, 255 - zeroCount );
+		zeroCount += num;
+		count -= num;
+	}
+	return true;
+}
+
 byte idZeroRunLengthCompressor::ReadByte() {
 	// See if we need to possibly read more data
 	if ( zeroCount == 0 ) {
@@ -44,6 +44,13 @@ struct lzwCompressionData_t {
 	uint64					tempValue;
 	int						tempBits;
 	int						bytesWritten;
+
+	// idRangeCompressor state, which also has to persist across appended streams
+	uint32					rangeLow;
+	uint32					rangeSize;
+	int						rangePrevByte;
+
+	int						codec;					// snapshotCodec_t of the stream idSnapshotCompressor is writing
 };
 
 /*
@@ -174,6 +181,182 @@ private:
 	int					savedTempBits;
 };
 
+/*
+========================
+idRangeCoderModel
+Static order-1 byte model for idRangeCompressor. The context is the class of the previous byte,
+which separates zrle run lengths and small deltas from everything else. Encoder and decoder have
+to use the same model, so it's trained offline from recorded snapshots instead of adapting per stream.
+========================
+*/
+class idRangeCoderModel {
+public:
+	static const int	NUM_CONTEXTS	= 4;
+	static const int	NUM_SYMBOLS		= 257;				// all byte values + end of stream
+	static const int	END_SYMBOL		= 256;
+	static const int	TOTAL_BITS		= 12;
+	static const int	TOTAL			= 1 << TOTAL_BITS;
+
+	// builds a model for zero-run-length encoded deltas without any training data
+	void			SetDefault();
+	// builds the model from symbol counts gathered with GetContext
+	void			Train( const uint32 counts[NUM_CONTEXTS][NUM_SYMBOLS] );
+
+	bool			Load( const char * fileName );
+	bool			Save( const char * fileName ) const;
+
+	uint16			GetChecksum() const { return checksum; }
+
+	static int		GetContext( int prevByte );
+
+	uint16			freq[NUM_CONTEXTS][NUM_SYMBOLS];
+	uint16			cumFreq[NUM_CONTEXTS][NUM_SYMBOLS + 1];
+	uint16			symbols[NUM_CONTEXTS][TOTAL];			// cumulative frequency to symbol, for decoding
+
+private:
+	void			BuildTables();
+
+	uint16			checksum;
+};
+
+/*
+========================
+idRangeCompressor
+Carry-less range coder over a static idRangeCoderModel, with the same stream interface as idLZWCompressor
+========================
+*/
+class idRangeCompressor {
+public:
+	idRangeCompressor( lzwCompressionData_t * lzwData_ ) : lzwData( lzwData_ ), model( NULL ) {}
+
+	static const int	END_BYTES		= 8;				// room always kept free so End can be called
+
+	void	Start( const idRangeCoderModel * model_, uint8 * data_, int maxSize_, bool append = false );
+	void	StartRead( const idRangeCoderModel * model_, const uint8 * data_, int size );
+	int		ReadByte( bool ignoreOverflow = false );
+	void	WriteByte( uint8 value );
+	int		End();
+
+	int		Length() const { return lzwData->bytesWritten; }
+	int		GetReadCount() const { return bytesRead; }
+
+	void	Save();
+	void	Restore();
+
+	bool	IsOverflowed() { return overflowed; }
+
+private:
+	void	EncodeSymbol( int context, int symbol );
+	void	OutputByte( uint8 value );
+	int		InputByte();
+
+	lzwCompressionData_t *		lzwData;
+	const idRangeCoderModel *	model;
+
+	uint8 *				data;
+	int					maxSize;
+	bool				overflowed;
+
+	// For reading
+	int					bytesRead;
+	uint32				low;
+	uint32				range;
+	uint32				code;
+	int					prevByte;
+	bool				ended;
+
+	// saving/restoring when overflow (when writing)
+	int					savedBytesWritten;
+	uint32				savedLow;
+	uint32				savedRange;
+	int					savedPrevByte;
+};
+
+enum snapshotCodec_t {
+	SNAPSHOT_CODEC_LZW		= 0,		// idLZWCompressor, dictionary rebuilt for every stream
+	SNAPSHOT_CODEC_RANGE	= 1,		// idRangeCompressor with the trained snapshot model
+	SNAPSHOT_CODEC_MAX
+};
+
+// The model used by SNAPSHOT_CODEC_RANGE streams, loaded from net_snapshotCodecModel when set
+const idRangeCoderModel *	GetSnapshotCodecModel();
+void						ReloadSnapshotCodecModel();
+
+/*
+========================
+idSnapshotCompressor
+Stream compressor used for snapshot deltas. Each stream starts with the codec it was written with
+(and the model checksum for range coded streams), so the reader doesn't need to know the sender's settings.
+========================
+*/
+class idSnapshotCompressor {
+public:
+	idSnapshotCompressor( lzwCompressionData_t * lzwData_ ) : lzwData( lzwData_ ), lzw( lzwData_ ), range( lzwData_ ), codec( SNAPSHOT_CODEC_LZW ), overflowed( false ) {}
+
+	// writes with lzwData->codec, appended streams continue with the codec they were started with
+	void	Start( uint8 * data_, int maxSize, bool append = false );
+	// returns false if the stream was written with a codec or model we don't have
+	bool	StartRead( const uint8 * data_, int size );
+
+	int		ReadByte( bool ignoreOverflow = false ) { return ( codec == SNAPSHOT_CODEC_RANGE ) ? range.ReadByte( ignoreOverflow ) : lzw.ReadByte( ignoreOverflow ); }
+	void	WriteByte( uint8 value ) { if ( codec == SNAPSHOT_CODEC_RANGE ) { range.WriteByte( value ); } else { lzw.WriteByte( value ); } }
+	int		End();
+
+	int		Length() const { return HeaderSize( codec ) + ( ( codec == SNAPSHOT_CODEC_RANGE ) ? range.Length() : lzw.Length() ); }
+	int		GetReadCount() const { return HeaderSize( codec ) + ( ( codec == SNAPSHOT_CODEC_RANGE ) ? range.GetReadCount() : lzw.GetReadCount() ); }
+
+	void	Save() { if ( codec == SNAPSHOT_CODEC_RANGE ) { range.Save(); } else { lzw.Save(); } }
+	void	Restore() { if ( codec == SNAPSHOT_CODEC_RANGE ) { range.Restore(); } else { lzw.Restore(); } }
+
+	bool	IsOverflowed() { return overflowed || ( ( codec == SNAPSHOT_CODEC_RANGE ) ? range.IsOverflowed() : lzw.IsOverflowed() ); }
+
+	snapshotCodec_t	GetCodec() const { return codec; }
+
+	static int	HeaderSize( snapshotCodec_t codec ) { return ( codec == SNAPSHOT_CODEC_RANGE ) ? 3 : 1; }
+
+	int		Write( const void * data, int length ) {
+		uint8 * src = (uint8*)data;
+		
+		for ( int i = 0; i < length && !IsOverflowed(); i++ ) {
+			WriteByte( src[i] );
+		}
+		
+		return length;
+	}
+
+	int		Read( void * data, int length, bool ignoreOverflow = false ) {
+		uint8 * src = (uint8*)data;
+		
+		for ( int i = 0; i < length; i++ ) {
+			int byte = ReadByte( ignoreOverflow );
+			
+			if ( byte == -1 ) {
+				return i;
+			}
+			
+			src[i] = (uint8)byte;
+		}
+		
+		return length;
+	}
+
+	template<class type> ID_INLINE size_t WriteAgnostic( const type & c ) {
+		return Write( &c, sizeof( c ) );
+	}
+
+	template<class type> ID_INLINE size_t ReadAgnostic( type & c, bool ignoreOverflow = false ) {
+		size_t r = Read( &c, sizeof( c ), ignoreOverflow );
+		return r;
+	}
+
+private:
+	lzwCompressionData_t *	lzwData;
+	idLZWCompressor			lzw;
+	idRangeCompressor		range;
+	snapshotCodec_t			codec;
+	bool					overflowed;
+};
+
 /*
 ========================
 idZeroRunLengthCompressor
@@ -185,9 +368,10 @@ public:
 	idZeroRunLengthCompressor() : zeroCount( 0 ), destStart( NULL ) {
 	}
 	
-	void Start( uint8 * dest_, idLZWCompressor * comp_, int maxSize_ );
+	void Start( uint8 * dest_, idSnapshotCompressor * comp_, int maxSize_ );
 	bool WriteRun();
 	bool WriteByte( uint8 value );
+	bool WriteZeros( int count );
 	byte ReadByte();
 	void ReadBytes( byte * dest, int count );
 	void WriteBytes( uint8 * src, int count );
@@ -199,7 +383,7 @@ private:
 	int ReadInternal();
 
 	int					zeroCount;		// Number of pending zeroes
-	idLZWCompressor *	comp;
+	idSnapshotCompressor *	comp;
 	uint8 *				destStart;
 	uint8 *				dest;
 	int					compressed;		// Compressed size
@@ -0,0 +1,446 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").  
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+#pragma hdrstop
+#include "../idlib/precompiled.h"
+#include "PacketSimulator.h"
+
+idCVar net_simLatency( "net_simLatency", "50", CVAR_INTEGER, "One way latency in milliseconds of the simulated network used by netSimBenchmark and netUsercmdBenchmark", 0, 2000 );
+idCVar net_simJitter( "net_simJitter", "10", CVAR_INTEGER, "Random milliseconds added to net_simLatency for each packet", 0, 1000 );
+idCVar net_simLoss( "net_simLoss", "2", CVAR_FLOAT, "Percentage chance the simulated network drops a packet", 0.0f, 100.0f );
+idCVar net_simReorder( "net_simReorder", "1", CVAR_FLOAT, "Percentage chance the simulated network delivers a packet after the ones sent after it", 0.0f, 100.0f );
+idCVar net_simDuplicate( "net_simDuplicate", "1", CVAR_FLOAT, "Percentage chance the simulated network delivers a packet twice", 0.0f, 100.0f );
+idCVar net_simSeed( "net_simSeed", "1234", CVAR_INTEGER, "Random seed of the simulated network, the same seed replays the same packet fates" );
+
+/*
+========================
+idPacketSimulator::idPacketSimulator
+========================
+*/
+idPacketSimulator::idPacketSimulator() :
+	numEndpoints( 0 ),
+	sendOrder( 0 )
+{
+	memset( &stats, 0, sizeof( stats ) );
+}
+
+/*
+========================
+idPacketSimulator::~idPacketSimulator
+========================
+*/
+idPacketSimulator::~idPacketSimulator() {
+	Shutdown();
+}
+
+/*
+========================
+idPacketSimulator::Init
+========================
+*/
+void idPacketSimulator::Init( int numEndpoints_, int seed ) {
+	Shutdown();
+
+	numEndpoints	= numEndpoints_;
+	sendOrder		= 0;
+	random.SetSeed( seed );
+	memset( &stats, 0, sizeof( stats ) );
+}
+
+/*
+========================
+idPacketSimulator::Shutdown
+========================
+*/
+void idPacketSimulator::Shutdown() {
+	for ( int i = 0; i < inFlight.Num(); i++ ) {
+		packetAllocator.Free( inFlight[i] );
+	}
+	inFlight.Clear();
+	packetAllocator.Shutdown();
+	numEndpoints = 0;
+}
+
+/*
+========================
+idPacketSimulator::QueuePacket
+========================
+*/
+void idPacketSimulator::QueuePacket( int deliverTime, int from, int to, const void * data, int size ) {
+	packet_t * packet = packetAllocator.Alloc();
+
+	packet->deliverTime	= deliverTime;
+	packet->sendOrder	= sendOrder++;
+	packet->from		= from;
+	packet->to			= to;
+	packet->size		= size;
+	memcpy( packet->data, data, size );
+
+	inFlight.Append( packet );
+}
+
+/*
+========================
+idPacketSimulator::Send
+========================
+*/
+void idPacketSimulator::Send( int time, int from, int to, const void * data, int size ) {
+	assert( from >= 0 && from < numEndpoints );
+	assert( to >= 0 && to < numEndpoints );
+
+	if ( !verify( size > 0 && size <= idPacketProcessor::MAX_FINAL_PACKET_SIZE ) ) {
+		return;
+	}
+
+	stats.packetsSent++;
+	stats.bytesSent += size;
+
+	if ( random.RandomFloat() < linkParms.loss ) {
+		stats.packetsDropped++;
+		return;
+	}
+
+	int delay = linkParms.latency;
+	if ( linkParms.jitter > 0 ) {
+		delay += random.RandomInt( linkParms.jitter + 1 );
+	}
+
+	if ( random.RandomFloat() < linkParms.reorder ) {
+		// Hold it back longer than any jitter, so packets sent after it get there first
+		delay += linkParms.jitter + Max( 1, linkParms.latency / 2 );
+		stats.packetsReordered++;
+	}
+
+	QueuePacket( time + delay, from, to, data, size );
+
+	if ( random.RandomFloat() < linkParms.duplicate ) {
+		QueuePacket( time + delay + random.RandomInt( linkParms.jitter + 1 ), from, to, data, size );
+		stats.packetsDuplicated++;
+	}
+}
+
+/*
+========================
+idPacketSimulator::Receive
+========================
+*/
+bool idPacketSimulator::Receive( int time, int to, int & from, void * data, int & size, int maxSize ) {
+	int best = -1;
+	for ( int i = 0; i < inFlight.Num(); i++ ) {
+		const packet_t * packet = inFlight[i];
+		if ( packet->to != to || packet->deliverTime > time ) {
+			continue;
+		}
+		if ( best == -1 || packet->deliverTime < inFlight[best]->deliverTime || 
+			( packet->deliverTime == inFlight[best]->deliverTime && packet->sendOrder < inFlight[best]->sendOrder ) ) {
+			best = i;
+		}
+	}
+
+	if ( best == -1 ) {
+		return false;
+	}
+
+	packet_t * packet = inFlight[best];
+	inFlight.RemoveIndexFast( best );
+
+	if ( !verify( packet->size <= maxSize ) ) {
+		packetAllocator.Free( packet );
+		return false;
+	}
+
+	from	= packet->from;
+	size	= packet->size;
+	memcpy( data, packet->data, packet->size );
+
+	stats.packetsDelivered++;
+	stats.bytesDelivered += packet->size;
+
+	packetAllocator.Free( packet );
+	return true;
+}
+
+/*
+================================================
+netSimPeer_t
+
+Both ends of one host <-> client connection in netSimBenchmark
+================================================
+*/
+struct netSimPeer_t {
+	netSimPeer_t() : lastInBandTime( 0 ), fullSnapsReceived( 0 ) {}
+
+	idPacketProcessor		hostPacketProc;		// host's connection to this client
+	idPacketProcessor		clientPacketProc;	// client's connection to the host
+	idSnapshotProcessor		hostSnapProc;
+	idSnapshotProcessor		clientSnapProc;
+	int						lastInBandTime;		// last time the host sent this client an in-band packet
+	int						fullSnapsReceived;
+};
+
+/*
+========================
+NetSim_SendFragments
+========================
+*/
+static int NetSim_SendFragments( idPacketSimulator & sim, idPacketProcessor & packetProc, int time, idPacketProcessor::sessionId_t sessionID, int from, int to ) {
+	byte buffer[ idPacketProcessor::MAX_FINAL_PACKET_SIZE ];
+	idBitMsg msg;
+	msg.InitWrite( buffer, sizeof( buffer ) );
+
+	int bytes = 0;
+	while ( packetProc.GetSendFragment( time, sessionID, msg ) ) {
+		sim.Send( time, from, to, msg.GetReadData(), msg.GetSize() );
+		bytes += msg.GetSize();
+	}
+	return bytes;
+}
+
+/*
+========================
+netSimBenchmark
+
+Drives a host and numClients clients through idSnapshotProcessor and idPacketProcessor over an
+idPacketSimulator link set up from the net_sim* cvars, with reliable messages queued alongside
+the snapshots, and reports what made it across.
+========================
+*/
+CONSOLE_COMMAND( netSimBenchmark, "usage: netSimBenchmark [numClients] [seconds] [numObjects]", 0 ) {
+	static const int FRAME_MSEC				= 16;
+	static const int SNAP_INTERVAL			= 3;		// frames between snapshots
+	static const int RELIABLE_INTERVAL		= 10;		// frames between reliable messages to each client
+	static const int RELIABLE_RESEND_MSEC	= 100;		// same as the in game minimum in idLobby::ResendReliables
+	static const int MAX_OBJ_SIZE			= 128;
+	static const int OBJ_MEMORY_SIZE		= 1024 * 128;
+	static const int RELIABLE_TYPE			= 1;
+
+	const int numClients	= args.Argc() > 1 ? idMath::ClampInt( 1, 31, atoi( args.Argv( 1 ) ) ) : 8;
+	const int seconds		= args.Argc() > 2 ? Max( 1, atoi( args.Argv( 2 ) ) ) : 30;
+	const int numObjects	= args.Argc() > 3 ? Max( 1, atoi( args.Argv( 3 ) ) ) : 256;
+	const int numFrames		= seconds * 1000 / FRAME_MSEC;
+
+	idPacketSimulator::linkParms_t linkParms;
+	linkParms.latency	= net_simLatency.GetInteger();
+	linkParms.jitter	= net_simJitter.GetInteger();
+	linkParms.loss		= net_simLoss.GetFloat() / 100.0f;
+	linkParms.reorder	= net_simReorder.GetFloat() / 100.0f;
+	linkParms.duplicate	= net_simDuplicate.GetFloat() / 100.0f;
+
+	idPacketSimulator sim;
+	sim.Init( numClients + 1, net_simSeed.GetInteger() );		// endpoint 0 is the host, client c is endpoint c + 1
+	sim.SetLinkParms( linkParms );
+
+	idRandom random( net_simSeed.GetInteger() );
+
+	idList< netSimPeer_t * > peers;
+	for ( int c = 0; c < numClients; c++ ) {
+		peers.Append( new (TAG_NETWORKING) netSimPeer_t() );
+	}
+
+	uint8 * objMemory = (uint8 *)Mem_Alloc16( OBJ_MEMORY_SIZE, TAG_NETWORKING );
+	lzwCompressionData_t * lzwData = (lzwCompressionData_t *)Mem_Alloc16( sizeof( lzwCompressionData_t ), TAG_NETWORKING );
+
+	idList< byte > objData;
+	objData.SetNum( numObjects * MAX_OBJ_SIZE );
+	for ( int i = 0; i < objData.Num(); i++ ) {
+		objData[i] = random.RandomInt( 8 ) == 0 ? (byte)random.RandomInt( 256 ) : 0;
+	}
+	idSnapShot ss;
+	for ( int i = 0; i < numObjects; i++ ) {
+		ss.S_AddObject( i, MAX_UNSIGNED_TYPE( uint32 ), &objData[i * MAX_OBJ_SIZE], MAX_OBJ_SIZE );
+	}
+
+	idList< int > reliableLatencies;
+	int reliablesQueued		= 0;
+	int reliablesOverflowed	= 0;
+	int payloadBytes		= 0;		// snapshot deltas and reliables, each counted once
+	int hostWireBytes		= 0;
+	int clientBytesReceived	= 0;
+	int snapDeltasSent		= 0;
+	int snapDeltasResent	= 0;
+
+	byte snapBuffer[ idPacketProcessor::MAX_MSG_SIZE ];
+	byte packetBuffer[ idPacketProcessor::MAX_FINAL_PACKET_SIZE ];
+	byte outBuffer[ idPacketProcessor::MAX_MSG_SIZE ];
+
+	const uint64 startMicroseconds = Sys_Microseconds();
+
+	for ( int frame = 0; frame < numFrames; frame++ ) {
+		const int time = frame * FRAME_MSEC;
+
+		// Deliver whatever has arrived by now
+		for ( int endpoint = 0; endpoint <= numClients; endpoint++ ) {
+			int from = 0;
+			int size = 0;
+			while ( sim.Receive( time, endpoint, from, packetBuffer, size, sizeof( packetBuffer ) ) ) {
+				const int c = ( endpoint == 0 ) ? from - 1 : endpoint - 1;
+				netSimPeer_t & peer = *peers[c];
+				idPacketProcessor & packetProc = ( endpoint == 0 ) ? peer.hostPacketProc : peer.clientPacketProc;
+
+				idBitMsg msg;
+				msg.InitRead( packetBuffer, size );
+				idBitMsg out;
+				out.InitWrite( outBuffer, sizeof( outBuffer ) );
+				int userData = 0;
+
+				if ( endpoint != 0 ) {
+					clientBytesReceived += size;
+				}
+
+				if ( packetProc.ProcessIncoming( time, (idPacketProcessor::sessionId_t)( 16 + c ), msg, out, userData, c ) != idPacketProcessor::RETURN_TYPE_INBAND ) {
+					continue;
+				}
+
+				for ( int r = 0; r < packetProc.GetNumReliables(); r++ ) {
+					idBitMsg reliableMsg( packetProc.GetReliable( r ), packetProc.GetReliableSize( r ) );
+					reliableMsg.SetSize( packetProc.GetReliableSize( r ) );
+					reliableMsg.ReadByte();		// type
+					const int sendTime = reliableMsg.ReadLong();
+					reliableLatencies.Append( time - sendTime );
+				}
+
+				if ( out.GetSize() == 0 ) {
+					continue;
+				}
+
+				if ( endpoint == 0 ) {
+					// Client ack, as idLobby reads it out of the usercmd packets
+					out.BeginReading();
+					peer.hostSnapProc.ApplySnapshotDelta( c + 1, out.ReadLong() );
+				} else {
+					idSnapShot localSnap;
+					int sequence = -1;
+					int baseSequence = -1;
+					bool fullSnap = false;
+					peer.clientSnapProc.ReceiveSnapshotDelta( out.GetReadData(), out.GetSize(), 0, sequence, baseSequence, localSnap, fullSnap );
+					if ( fullSnap ) {
+						peer.fullSnapsReceived++;
+					}
+				}
+			}
+		}
+
+		// Change some objects like entities moving around
+		for ( int i = 0; i < numObjects; i++ ) {
+			if ( random.RandomInt( 10 ) != 0 ) {
+				continue;
+			}
+			byte * data = &objData[i * MAX_OBJ_SIZE];
+			for ( int b = 0; b < 4; b++ ) {
+				data[random.RandomInt( MAX_OBJ_SIZE )] = (byte)random.RandomInt( 256 );
+			}
+			ss.S_AddObject( i, MAX_UNSIGNED_TYPE( uint32 ), data, MAX_OBJ_SIZE );
+		}
+		ss.SetTime( time );
+
+		for ( int c = 0; c < numClients; c++ ) {
+			netSimPeer_t & peer = *peers[c];
+			const idPacketProcessor::sessionId_t sessionID = (idPacketProcessor::sessionId_t)( 16 + c );
+
+			if ( ( frame % RELIABLE_INTERVAL ) == c % RELIABLE_INTERVAL ) {
+				byte reliableBuffer[ 256 ];
+				idBitMsg reliableMsg( reliableBuffer, sizeof( reliableBuffer ) );
+				reliableMsg.WriteLong( time );
+				const int padding = 16 + random.RandomInt( 128 );
+				for ( int i = 0; i < padding; i++ ) {
+					reliableMsg.WriteByte( (byte)random.RandomInt( 4 ) );
+				}
+				if ( peer.hostPacketProc.QueueReliableMessage( RELIABLE_TYPE, reliableMsg.GetReadData(), reliableMsg.GetSize() ) ) {
+					reliablesQueued++;
+					payloadBytes += 1 + reliableMsg.GetSize();
+				} else {
+					reliablesOverflowed++;
+				}
+			}
+
+			// Host -> client, a snapshot delta when it's time for one, otherwise resend reliables like idLobby::ResendReliables
+			int snapSize = 0;
+			if ( ( frame % SNAP_INTERVAL ) == 0 ) {
+				peer.hostSnapProc.TrySetPendingSnapshot( ss );
+				if ( peer.hostSnapProc.HasPendingSnap() && !peer.hostSnapProc.IsBusyConfirmingPartialSnap() ) {
+					peer.hostSnapProc.SubmitPendingSnap( c + 1, objMemory, OBJ_MEMORY_SIZE, lzwData );
+					snapSize = peer.hostSnapProc.GetPendingSnapDelta( snapBuffer, sizeof( snapBuffer ) );
+				}
+			}
+
+			if ( snapSize != 0 ) {
+				idBitMsg msg;
+				msg.InitRead( snapBuffer, abs( snapSize ) );
+				peer.hostPacketProc.ProcessOutgoing( time, msg, false, 0 );
+				peer.lastInBandTime = time;
+				if ( snapSize > 0 ) {
+					payloadBytes += snapSize;
+					snapDeltasSent++;
+				} else {
+					snapDeltasResent++;		// delta queue filled up, the last one went out again
+				}
+			} else if ( time - peer.lastInBandTime >= RELIABLE_RESEND_MSEC && ( peer.hostPacketProc.NumQueuedReliables() > 0 || peer.hostPacketProc.NeedToSendReliableAck() ) ) {
+				idBitMsg msg;
+				peer.hostPacketProc.ProcessOutgoing( time, msg, false, 0 );
+				peer.lastInBandTime = time;
+			}
+			hostWireBytes += NetSim_SendFragments( sim, peer.hostPacketProc, time, sessionID, 0, c + 1 );
+
+			// Client -> host, a snapshot ack every frame like the usercmd packets carry
+			byte ackBuffer[ 8 ];
+			idBitMsg ackMsg( ackBuffer, sizeof( ackBuffer ) );
+			ackMsg.WriteLong( peer.clientSnapProc.GetLastAppendedSequence() );
+			peer.clientPacketProc.ProcessOutgoing( time, ackMsg, false, 0 );
+			NetSim_SendFragments( sim, peer.clientPacketProc, time, sessionID, c + 1, 0 );
+		}
+	}
+
+	const uint64 totalMicroseconds = Sys_Microseconds() - startMicroseconds;
+
+	int fullSnaps = 0;
+	for ( int c = 0; c < numClients; c++ ) {
+		fullSnaps += peers[c]->fullSnapsReceived;
+	}
+
+	reliableLatencies.SortWithTemplate( idSort_QuickDefault< int >() );
+	const int numLatencies = reliableLatencies.Num();
+
+	const idPacketSimulator::stats_t & stats = sim.GetStats();
+	idLib::Printf( "netSimBenchmark: %d clients, %d objects, %d seconds simulated in %.1f ms\n", numClients, numObjects, seconds, totalMicroseconds / 1000.0f );
+	idLib::Printf( "link: %d ms +%d ms jitter, %.1f%% loss, %.1f%% reorder, %.1f%% duplicate, seed %d\n", linkParms.latency, linkParms.jitter,
+		linkParms.loss * 100.0f, linkParms.reorder * 100.0f, linkParms.duplicate * 100.0f, net_simSeed.GetInteger() );
+	idLib::Printf( "packets: %d sent, %d dropped, %d reordered, %d duplicated\n", stats.packetsSent, stats.packetsDropped, stats.packetsReordered, stats.packetsDuplicated );
+	idLib::Printf( "throughput: %.1f KB/s to each client, %.1f full snaps/s per client\n", clientBytesReceived / 1024.0f / seconds / numClients, (float)fullSnaps / seconds / numClients );
+	idLib::Printf( "snapshot deltas: %d sent, %d resent from a full delta queue\n", snapDeltasSent, snapDeltasResent );
+	idLib::Printf( "resend overhead: %d wire bytes for %d payload bytes (%.1f%%)\n", hostWireBytes, payloadBytes, payloadBytes > 0 ? 100.0f * ( hostWireBytes - payloadBytes ) / payloadBytes : 0.0f );
+	if ( numLatencies > 0 ) {
+		idLib::Printf( "reliable latency: p50 %d ms, p90 %d ms, p99 %d ms, max %d ms (%d of %d delivered, %d overflowed the queue)\n", 
+			reliableLatencies[numLatencies / 2], reliableLatencies[numLatencies * 9 / 10], reliableLatencies[numLatencies * 99 / 100], reliableLatencies[numLatencies - 1],
+			numLatencies, reliablesQueued, reliablesOverflowed );
+	} else {
+		idLib::Printf( "reliable latency: none delivered (%d queued, %d overflowed the queue)\n", reliablesQueued, reliablesOverflowed );
+	}
+
+	peers.DeleteContents( true );
+	Mem_Free16( objMemory );
+	Mem_Free16( lzwData );
+}
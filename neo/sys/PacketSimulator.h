@@ -0,0 +1,101 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").  
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+#ifndef __PACKET_SIMULATOR_H__
+#define __PACKET_SIMULATOR_H__
+
+/*
+================================================
+idPacketSimulator
+
+In-process stand-in for the UDP port that sits under idPacketProcessor. Packets sent between
+endpoints are held until their delivery time, and can be dropped, delayed, reordered or
+duplicated. Time is supplied by the caller and all randomness comes from a seeded idRandom,
+so a run with the same inputs always delivers the same packets in the same order.
+================================================
+*/
+class idPacketSimulator {
+public:
+	struct linkParms_t {
+		linkParms_t() : latency( 0 ), jitter( 0 ), loss( 0.0f ), reorder( 0.0f ), duplicate( 0.0f ) {}
+
+		int		latency;		// one way delay in milliseconds
+		int		jitter;			// up to this many milliseconds are randomly added to latency
+		float	loss;			// 0-1 chance a packet is dropped
+		float	reorder;		// 0-1 chance a packet is held back long enough to arrive after the next ones
+		float	duplicate;		// 0-1 chance a packet is delivered twice
+	};
+
+	struct stats_t {
+		int		packetsSent;
+		int		packetsDelivered;
+		int		packetsDropped;
+		int		packetsReordered;
+		int		packetsDuplicated;
+		int		bytesSent;
+		int		bytesDelivered;
+	};
+
+					idPacketSimulator();
+					~idPacketSimulator();
+
+	void			Init( int numEndpoints, int seed );
+	void			Shutdown();
+
+	void			SetLinkParms( const linkParms_t & parms ) { linkParms = parms; }
+	const linkParms_t & GetLinkParms() const { return linkParms; }
+
+	// Queues a packet from one endpoint to another, it can be read with Receive once time reaches its delivery time
+	void			Send( int time, int from, int to, const void * data, int size );
+	// Returns the next packet for endpoint to that has arrived by time, oldest delivery time first
+	bool			Receive( int time, int to, int & from, void * data, int & size, int maxSize );
+
+	int				NumInFlight() const { return inFlight.Num(); }
+	const stats_t &	GetStats() const { return stats; }
+
+private:
+	struct packet_t {
+		int			deliverTime;
+		int			sendOrder;		// breaks ties between packets delivered at the same time
+		int			from;
+		int			to;
+		int			size;
+		byte		data[ idPacketProcessor::MAX_FINAL_PACKET_SIZE ];
+	};
+
+	void			QueuePacket( int deliverTime, int from, int to, const void * data, int size );
+
+	linkParms_t										linkParms;
+	stats_t											stats;
+	idRandom										random;
+	int												numEndpoints;
+	int												sendOrder;
+	idList< packet_t *, TAG_NETWORKING >			inFlight;
+	idBlockAlloc< packet_t, 64, TAG_NETWORKING >	packetAllocator;
+};
+
+#endif /* !__PACKET_SIMULATOR_H__ */
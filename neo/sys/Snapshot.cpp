@@ -35,6 +35,7 @@ idCVar net_verboseSnapshotReport( "net_verboseSnapshotReport", "0", CVAR_INTEGER
 idCVar net_ssTemplateDebug( "net_ssTemplateDebug", "0", CVAR_BOOL, "Debug snapshot template states" );
 idCVar net_ssTemplateDebug_len( "net_ssTemplateDebug_len", "32", CVAR_INTEGER, "Offset to start template state debugging" );
 idCVar net_ssTemplateDebug_start( "net_ssTemplateDebug_start", "0", CVAR_INTEGER, "length of template state to print in debugging" );
+idCVar net_snapRelevanceMaxAge( "net_snapRelevanceMaxAge", "20", CVAR_INTEGER, "Snapshots a deferred object can wait before its age stops raising its priority", 1, 255 );
 
 /*
 ========================
@@ -206,6 +207,7 @@ void idSnapShot::operator=( const idSnapShot & other ) {
 			state.changedCount	= otherState.changedCount;
 			state.expectedSequence = otherState.expectedSequence;
 			state.createdFromTemplate = otherState.createdFromTemplate;
+			memcpy( state.relevance, otherState.relevance, sizeof( state.relevance ) );
 		}
 		time = other.time;
 		recvTime = other.recvTime;
@@ -219,9 +221,13 @@ idSnapShot::PeekDeltaSequence
 */
 void idSnapShot::PeekDeltaSequence( const char * deltaMem, int deltaSize, int & sequence, int & baseSequence ) {
 	lzwCompressionData_t	lzwData;
-	idLZWCompressor			lzwCompressor( &lzwData );
+	idSnapshotCompressor	lzwCompressor( &lzwData );
 	
-	lzwCompressor.Start( (uint8*)deltaMem, deltaSize );	
+	if ( !lzwCompressor.StartRead( (const uint8*)deltaMem, deltaSize ) ) {
+		sequence = 0;
+		baseSequence = 0;
+		return;
+	}
 	lzwCompressor.ReadAgnostic( sequence );
 	lzwCompressor.ReadAgnostic( baseSequence );
 }
@@ -238,10 +244,12 @@ bool idSnapShot::ReadDeltaForJob( const char * deltaMem, int deltaSize, int visI
 
 	lzwCompressionData_t		lzwData;
 	idZeroRunLengthCompressor	rleCompressor;
-	idLZWCompressor				lzwCompressor( &lzwData );
+	idSnapshotCompressor		lzwCompressor( &lzwData );
 	int bytesRead = 0; // how many uncompressed bytes we read in. Used to figure out compression ratio
 
-	lzwCompressor.Start( (uint8*)deltaMem, deltaSize );
+	if ( !lzwCompressor.StartRead( (const uint8*)deltaMem, deltaSize ) ) {
+		return false;
+	}
 
 	// Skip past sequence and baseSequence
 	int sequence		= 0;
@@ -440,6 +448,7 @@ void idSnapShot::SubmitObjectJob(	const submitDeltaJobsInfo_t &	submitDeltaJobsI
 	// Setup obj parms
 	assert( submitDeltaJobsInfo.visIndex < 256 );
 	curObjParm->visIndex	= submitDeltaJobsInfo.visIndex;
+	curObjParm->deltaCache	= submitDeltaJobsInfo.deltaCache;
 	curObjParm->destHeader	= curHeader;
 	curObjParm->dest		= curObjDest;
 
@@ -548,6 +557,153 @@ idSnapShot::objectState_t * idSnapShot::GetTemplateState( int objNum, idSnapShot
 	return oldState;
 }
 
+/*
+========================
+idSnapShot::AddDeltaObject
+========================
+*/
+void idSnapShot::AddDeltaObject( objectState_t * newState, objectState_t * oldState, bool isNew ) {
+	deltaObject_t & deltaObject = deltaObjects.Alloc();
+	deltaObject.newState	= newState;
+	deltaObject.oldState	= oldState;
+	deltaObject.score		= 0;
+	deltaObject.cost		= 0;
+	deltaObject.isNew		= isNew;
+	deltaObject.deferred	= false;
+}
+
+/*
+========================
+EstimateObjectDeltaSize
+Roughly what the zero run length encoded delta of an object will cost, 0 if it hasn't changed
+========================
+*/
+static int EstimateObjectDeltaSize( idSnapShot::objectState_t * newState, idSnapShot::objectState_t * oldState ) {
+	const int OBJ_HEADER_SIZE = sizeof( uint16 ) + sizeof( objectSize_t );
+
+	if ( newState == NULL || oldState == NULL ) {
+		return OBJ_HEADER_SIZE + ( newState != NULL ? newState->buffer.Size() : 0 );
+	}
+
+	const int newSize = newState->buffer.Size();
+	const int oldSize = oldState->buffer.Size();
+	const int compareSize = Min( newSize, oldSize );
+	const byte * newData = newState->buffer.Ptr();
+	const byte * oldData = oldState->buffer.Ptr();
+
+	int size = OBJ_HEADER_SIZE + ( newSize - compareSize );
+	bool changed = ( newSize != oldSize );
+	bool inZeroRun = false;
+
+	for ( int i = 0; i < compareSize; i++ ) {
+		if ( newData[i] != oldData[i] ) {
+			size++;
+			changed = true;
+			inZeroRun = false;
+		} else if ( !inZeroRun ) {
+			size += 2;		// zero, then run length
+			inZeroRun = true;
+		}
+	}
+
+	return changed ? size : 0;
+}
+
+/*
+================================================
+idSort_DeltaObjectScore
+================================================
+*/
+class idSort_DeltaObjectScore : public idSort_Quick< idSnapShot::deltaObject_t, idSort_DeltaObjectScore > {
+public:
+	int Compare( const idSnapShot::deltaObject_t & a, const idSnapShot::deltaObject_t & b ) const { 
+		if ( a.score != b.score ) {
+			return ( a.score > b.score ) ? -1 : 1;
+		}
+		return GetObjectNum( a ) - GetObjectNum( b );
+	}
+
+	static int GetObjectNum( const idSnapShot::deltaObject_t & d ) { return d.newState != NULL ? d.newState->objectNum : d.oldState->objectNum; }
+};
+
+/*
+================================================
+idSort_DeltaObjectNum
+================================================
+*/
+class idSort_DeltaObjectNum : public idSort_Quick< idSnapShot::deltaObject_t, idSort_DeltaObjectNum > {
+public:
+	int Compare( const idSnapShot::deltaObject_t & a, const idSnapShot::deltaObject_t & b ) const { 
+		return idSort_DeltaObjectScore::GetObjectNum( a ) - idSort_DeltaObjectScore::GetObjectNum( b );
+	}
+};
+
+/*
+========================
+idSnapShot::DeferLeastRelevantObjects
+When the changed objects won't all fit in relevanceBudget, the least relevant ones are held back.
+Deletes, visibility changes and RELEVANCE_ALWAYS_SEND objects are always written. Everything else
+is scored by its relevance to this peer, scaled by how many snaps ago the peer last acked a change to it,
+so deferred objects climb the list until they get through.
+========================
+*/
+void idSnapShot::DeferLeastRelevantObjects( const submitDeltaJobsInfo_t & submitDeltaJobsInfo ) {
+	const int visIndex = submitDeltaJobsInfo.visIndex;
+	if ( visIndex < 0 || visIndex >= MAX_RELEVANCE_INDEX ) {
+		return;
+	}
+
+	const int sequence	= submitDeltaJobsInfo.lzwInOutData->snapSequence + 1;
+	const int maxAge	= net_snapRelevanceMaxAge.GetInteger();
+	const uint32 visBit	= 1 << visIndex;
+	
+	int totalCost = 0;
+
+	for ( int i = 0; i < deltaObjects.Num(); i++ ) {
+		deltaObject_t & deltaObject = deltaObjects[i];
+		deltaObject.cost = EstimateObjectDeltaSize( deltaObject.newState, deltaObject.oldState );
+		totalCost += deltaObject.cost;
+
+		if ( deltaObject.newState == NULL || deltaObject.cost == 0 ) {
+			deltaObject.score = INT_MAX;
+			continue;
+		}
+
+		const uint8 relevance = deltaObject.newState->relevance[visIndex];
+		const bool visChanged = deltaObject.oldState != NULL && ( ( deltaObject.newState->visMask ^ deltaObject.oldState->visMask ) & visBit ) != 0;
+		if ( relevance == RELEVANCE_ALWAYS_SEND || visChanged ) {
+			deltaObject.score = INT_MAX;
+			continue;
+		}
+
+		const int age = deltaObject.isNew ? maxAge : idMath::ClampInt( 0, maxAge, sequence - deltaObject.oldState->changedCount );
+		deltaObject.score = ( relevance + 1 ) * ( age + 1 );
+	}
+
+	if ( totalCost <= submitDeltaJobsInfo.relevanceBudget ) {
+		return;		// everything fits
+	}
+
+	deltaObjects.SortWithTemplate( idSort_DeltaObjectScore() );
+
+	int cost = 0;
+	int numDeferred = 0;
+	for ( int i = 0; i < deltaObjects.Num(); i++ ) {
+		deltaObject_t & deltaObject = deltaObjects[i];
+		if ( deltaObject.score != INT_MAX && cost + deltaObject.cost > submitDeltaJobsInfo.relevanceBudget ) {
+			deltaObject.deferred = true;
+			numDeferred++;
+			continue;	// keep looking for smaller objects that still fit
+		}
+		cost += deltaObject.cost;
+	}
+
+	// Objects have to go out in ascending objectNum order
+	deltaObjects.SortWithTemplate( idSort_DeltaObjectNum() );
+
+	NET_VERBOSESNAPSHOT_PRINT_LEVEL( 3, va( "  visIndex %d: deferred %d of %d snap objects, estimated %d of %d bytes\n", visIndex, numDeferred, deltaObjects.Num(), cost, totalCost ) );
+}
+
 /*
 ========================
 idSnapShot::SubmitWriteDeltaToJobs
@@ -564,6 +720,8 @@ void idSnapShot::SubmitWriteDeltaToJobs( const submitDeltaJobsInfo_t & submitDel
 	submitDeltaJobInfo.lzwInOutData->lzwBytes		= 0;
 	submitDeltaJobInfo.lzwInOutData->fullSnap		= false;
 
+	deltaObjects.SetNum( 0 );
+
 	int j = 0;
 	
 	int numOldStates = submitDeltaJobInfo.oldSnap->objectStates.Num();
@@ -582,7 +740,7 @@ void idSnapShot::SubmitWriteDeltaToJobs( const submitDeltaJobsInfo_t & submitDel
 			// All objects are new from this point on.
 
 			objectState_t * oldState = GetTemplateState( newState.objectNum, submitDeltaJobInfo.templateStates, &newState );
-			SubmitObjectJob( submitDeltaJobInfo, &newState, oldState, baseObjParms, curObjParms, curHeader, curObjMemory, curlzwParms );
+			AddDeltaObject( &newState, oldState, true );
 			continue;
 		}
 
@@ -594,7 +752,7 @@ void idSnapShot::SubmitWriteDeltaToJobs( const submitDeltaJobsInfo_t & submitDel
 				continue;		// Don't delete objects that are stale and not marked as deleted
 			}
 
-			SubmitObjectJob( submitDeltaJobInfo, NULL, &oldState, baseObjParms, curObjParms, curHeader, curObjMemory, curlzwParms );
+			AddDeltaObject( NULL, &oldState, false );
 		}
 		
 		if ( j >= numOldStates ) {
@@ -606,18 +764,20 @@ void idSnapShot::SubmitWriteDeltaToJobs( const submitDeltaJobsInfo_t & submitDel
 		objectState_t * oldState = &submittedOldState;
 	
 		if ( newState.objectNum == oldState->objectNum ) {
+			bool isNew = false;
 			if ( oldState->buffer.Size() == 0 ) {
 				// New state (even though snapObj existed, its size was zero)
 				oldState = GetTemplateState( newState.objectNum, submitDeltaJobInfo.templateStates, &newState );
+				isNew = true;
 			}
 
-			SubmitObjectJob( submitDeltaJobInfo, &newState, oldState, baseObjParms, curObjParms, curHeader, curObjMemory, curlzwParms );
+			AddDeltaObject( &newState, oldState, isNew );
 			j++;
 		} else {
 			// Different object, this one is new, 
 			// Spawned
 			oldState = GetTemplateState( newState.objectNum, submitDeltaJobInfo.templateStates, &newState );
-			SubmitObjectJob( submitDeltaJobInfo, &newState, oldState, baseObjParms, curObjParms, curHeader, curObjMemory, curlzwParms );
+			AddDeltaObject( &newState, oldState, true );
 		}
 	}
 	// Finally, remove any entities at the end
@@ -628,9 +788,21 @@ void idSnapShot::SubmitWriteDeltaToJobs( const submitDeltaJobsInfo_t & submitDel
 			continue;		// Don't delete objects that are stale and not marked as deleted
 		}
 
-		SubmitObjectJob( submitDeltaJobInfo, NULL, &oldState, baseObjParms, curObjParms, curHeader, curObjMemory, curlzwParms );
+		AddDeltaObject( NULL, &oldState, false );
 	}
-				
+
+	if ( submitDeltaJobInfo.relevanceBudget > 0 ) {
+		DeferLeastRelevantObjects( submitDeltaJobInfo );
+	}
+
+	// Deferred objects are left out of the stream, which the peer reads as unchanged, so they go out in a later snap
+	for ( int i = 0; i < deltaObjects.Num(); i++ ) {
+		const deltaObject_t & deltaObject = deltaObjects[i];
+		if ( !deltaObject.deferred ) {
+			SubmitObjectJob( submitDeltaJobInfo, deltaObject.newState, deltaObject.oldState, baseObjParms, curObjParms, curHeader, curObjMemory, curlzwParms );
+		}
+	}
+
 	// Submit any objects that are left over (will be all if they all fit up to this point)
 	SubmitLZWJob( submitDeltaJobInfo, baseObjParms, curObjParms, curlzwParms, false );
 }
@@ -939,6 +1111,7 @@ idSnapShot::objectState_t * idSnapShot::S_AddObject( int objectNum, uint32 visMa
 	objectSize_t size = _size;
 	objectState_t & state = FindOrCreateObjectByID( objectNum );
 	state.visMask = visMask;
+	memset( state.relevance, RELEVANCE_ALWAYS_SEND, sizeof( state.relevance ) );
 	if ( state.buffer.Size() == size && state.buffer.NumRefs() == 1 ) {
 		// re-use the same buffer
 		memcpy( state.buffer.Ptr(), data, size );
@@ -950,6 +1123,21 @@ idSnapShot::objectState_t * idSnapShot::S_AddObject( int objectNum, uint32 visMa
 	return &state;
 }
 
+/*
+========================
+idSnapShot::SetObjectRelevance
+========================
+*/
+void idSnapShot::SetObjectRelevance( int objectNum, int visIndex, uint8 relevance ) {
+	if ( !verify( visIndex >= 0 && visIndex < MAX_RELEVANCE_INDEX ) ) {
+		return;
+	}
+	objectState_t * state = FindObjectByID( objectNum );
+	if ( state != NULL ) {
+		state->relevance[visIndex] = relevance;
+	}
+}
+
 /*
 ========================
 idSnapShot::CopyObject
@@ -973,6 +1161,7 @@ bool idSnapShot::CopyObject( const idSnapShot & oldss, int objectNum, bool force
 	newState.changedCount	= oldState.changedCount;
 	newState.expectedSequence = oldState.expectedSequence;
 	newState.createdFromTemplate = oldState.createdFromTemplate;
+	memcpy( newState.relevance, oldState.relevance, sizeof( newState.relevance ) );
 
 	if ( forceStale ) {
 		newState.visMask = 0;
@@ -1020,10 +1209,8 @@ int idSnapShot::CompareObject( const idSnapShot * oldss, int objectNum, int star
 		end = Min( commonSize, end );
 	}
 
-	for ( int b = start; b < end; b++ ) {
-		if ( verify( b >= 0 && b < (int)newState.buffer.Size() && b + oldOffset >= 0 && b + oldOffset < (int)oldState.buffer.Size() ) ) {
-			bytes += ( newState.buffer[b] != oldState.buffer[b + oldOffset] ) ? 1 : 0;
-		}
+	if ( end > start && verify( start >= 0 && end <= (int)newState.buffer.Size() && start + oldOffset >= 0 && end + oldOffset <= (int)oldState.buffer.Size() ) ) {
+		bytes += SnapObjCountDifferent( newState.buffer.Ptr() + start, oldState.buffer.Ptr() + start + oldOffset, end - start );
 	}
 
 	return bytes;
@@ -45,6 +45,9 @@ public:
 
 	void operator=( const idSnapShot & other );
 
+	static const int	MAX_RELEVANCE_INDEX		= 32;		// one relevance per visIndex, same range as visMask
+	static const uint8	RELEVANCE_ALWAYS_SEND	= 255;		// objects with this relevance are never deferred
+
 	// clears the snapshot
 	void Clear();
 
@@ -92,7 +95,7 @@ public:
 			createdFromTemplate( false ),
 			
 			expectedSequence( 0 )
-			{ }
+			{ memset( relevance, RELEVANCE_ALWAYS_SEND, sizeof( relevance ) ); }
 		void Print( const char * name );
 
 		uint16			objectNum;
@@ -103,6 +106,7 @@ public:
 		int				changedCount;	// Incremented each time the state changed
 		int				expectedSequence;
 		bool			createdFromTemplate;
+		uint8			relevance[MAX_RELEVANCE_INDEX];	// per visIndex, how much the peer cares about this object (server only)
 	};
 
 	struct submitDeltaJobsInfo_t {
@@ -122,6 +126,20 @@ public:
 		idSnapShot *		templateStates;			// states for new snapObj that arent in old states
 		
 		lzwInOutData_t *	lzwInOutData;
+
+		idSnapDeltaCache *	deltaCache;				// optional, encoded deltas shared with the other peers written this frame
+
+		int					relevanceBudget;		// if > 0, estimated delta bytes to fill with the most relevant changed objects
+	};
+
+	// Pairs up new and old states so a delta can be trimmed to fit before its jobs are submitted
+	struct deltaObject_t {
+		objectState_t *	newState;
+		objectState_t *	oldState;
+		int				score;
+		int				cost;
+		bool			isNew;			// oldState is a template state, the peer has never acked this object
+		bool			deferred;
 	};
 
 	void SubmitWriteDeltaToJobs( const submitDeltaJobsInfo_t & submitDeltaJobInfo );
@@ -132,6 +150,8 @@ public:
 	objectState_t * S_AddObject( int objectNum, uint32 visMask, const idBitMsg & msg, const char * tag = NULL ) { return S_AddObject( objectNum, visMask, msg.GetReadData(), msg.GetSize(), tag ); }
 	objectState_t * S_AddObject( int objectNum, uint32 visMask, const byte * buffer, int size, const char * tag = NULL ) { return S_AddObject( objectNum, visMask, (const char *)buffer, size, tag ); }
 	objectState_t * S_AddObject( int objectNum, uint32 visMask, const char * buffer, int size, const char * tag = NULL );
+	// Sets how relevant an object is to the peer at visIndex, call after S_AddObject which resets it to RELEVANCE_ALWAYS_SEND
+	void SetObjectRelevance( int objectNum, int visIndex, uint8 relevance );
 	bool CopyObject( const idSnapShot & oldss, int objectNum, bool forceStale = false );
 	int CompareObject( const idSnapShot * oldss, int objectNum, int start=0, int end=0, int oldStart=0 );
 
@@ -175,6 +195,8 @@ private:
 	int													time;
 	int													recvTime;
 
+	idList< deltaObject_t, TAG_NETWORKING >				deltaObjects;
+
 	int				BinarySearch( int objectNum ) const;
 	objectState_t &	FindOrCreateObjectByID( int objectNum );					// objIndex is optional parm for returning the index of the obj
 
@@ -194,6 +216,9 @@ private:
 		bool							saveDictionary		// If true, this is the first of several calls which will be appended
 	);		
 	
+	void			AddDeltaObject( objectState_t * newState, objectState_t * oldState, bool isNew );
+	void			DeferLeastRelevantObjects( const submitDeltaJobsInfo_t & submitDeltaJobsInfo );
+
 	void WriteObject( idFile * file, int visIndex, objectState_t * newState, objectState_t * oldState, int & lastobjectNum );
 	void FreeObjectState( int index );
 };
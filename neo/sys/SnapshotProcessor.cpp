@@ -29,8 +29,15 @@ If you have questions concerning this license or the applicable additional terms
 #include "../idlib/precompiled.h"
 
 idCVar net_optimalSnapDeltaSize( "net_optimalSnapDeltaSize", "1000", CVAR_INTEGER, "Optimal size of snapshot delta msgs." );
+idCVar net_snapRelevance( "net_snapRelevance", "1", CVAR_BOOL, "When a snapshot delta won't fit in net_optimalSnapDeltaSize, defer the objects least relevant to the peer instead of sending a partial snap" );
+idCVar net_snapRelevanceCompression( "net_snapRelevanceCompression", "1.5", CVAR_FLOAT, "Expected compression ratio of snapshot deltas, used to estimate how many changed objects fit in net_optimalSnapDeltaSize", 1.0f, 8.0f );
 idCVar net_debugBaseStates( "net_debugBaseStates", "0", CVAR_BOOL, "Log out base state information" );
 idCVar net_skipClientDeltaAppend( "net_skipClientDeltaAppend", "0", CVAR_BOOL, "Simulate delta receive buffer overflowing" );
+idCVar net_snapshotCodec( "net_snapshotCodec", "0", CVAR_INTEGER, "Codec for snapshot deltas sent by the host. 0 = lzw, 1 = range coding with the net_snapshotCodecModel model", 0, SNAPSHOT_CODEC_MAX - 1 );
+idCVar net_snapshotCapture( "net_snapshotCapture", "", 0, "Appends the uncompressed stream of every snapshot delta sent to this file, for snapshotCodecTrain and snapshotCodecReplay" );
+
+extern idCVar net_snapDeltaCacheMemory;
+extern idCVar net_snapshotCodecModel;
 
 /*
 ========================
@@ -131,7 +138,7 @@ static int g_maxlwMem = 100;
 idSnapshotProcessor::SubmitPendingSnap
 ========================
 */
-void idSnapshotProcessor::SubmitPendingSnap( int visIndex, uint8 * objMemory, int objMemorySize, lzwCompressionData_t * lzwData ) {
+void idSnapshotProcessor::SubmitPendingSnap( int visIndex, uint8 * objMemory, int objMemorySize, lzwCompressionData_t * lzwData, idSnapDeltaCache * deltaCache ) {
 
 	assert_16_byte_aligned( objMemory );
 	assert_16_byte_aligned( lzwData );
@@ -157,6 +164,7 @@ void idSnapshotProcessor::SubmitPendingSnap( int visIndex, uint8 * objMemory, in
 	jobMemory->lzwInOutData.optimalLength	= net_optimalSnapDeltaSize.GetInteger();
 	jobMemory->lzwInOutData.snapSequence	= snapSequence;
 	jobMemory->lzwInOutData.lastObjId		= 0;
+	jobMemory->lzwInOutData.codec			= idMath::ClampInt( 0, SNAPSHOT_CODEC_MAX - 1, net_snapshotCodec.GetInteger() );
 	jobMemory->lzwInOutData.lzwData			= lzwData;
 
 	idSnapShot::submitDeltaJobsInfo_t submitInfo;
@@ -183,10 +191,53 @@ void idSnapshotProcessor::SubmitPendingSnap( int visIndex, uint8 * objMemory, in
 	submitInfo.baseSequence		= baseSequence;
 		
 	submitInfo.lzwInOutData		= &jobMemory->lzwInOutData;
+	submitInfo.deltaCache		= deltaCache;
+	submitInfo.relevanceBudget	= net_snapRelevance.GetBool() ? idMath::Ftoi( net_optimalSnapDeltaSize.GetInteger() * net_snapRelevanceCompression.GetFloat() ) : 0;
 
 	pendingSnap.SubmitWriteDeltaToJobs( submitInfo );
 }
 
+static const int SNAPSHOT_CAPTURE_MAGIC = ( 'S' << 24 ) | ( 'N' << 16 ) | ( 'P' << 8 ) | 1;
+
+/*
+========================
+CaptureSnapshotDelta
+Decodes a delta back into the byte stream the codec saw, and appends it to net_snapshotCapture
+========================
+*/
+static void CaptureSnapshotDelta( const uint8 * deltaData, int size ) {
+	static idFile *	captureFile = NULL;
+	static idStr	captureName;
+	static idList< byte, TAG_NETWORKING > stream;
+
+	if ( captureFile == NULL || captureName.Icmp( net_snapshotCapture.GetString() ) != 0 ) {
+		delete captureFile;
+		captureName = net_snapshotCapture.GetString();
+		captureFile = fileSystem->OpenFileWrite( captureName );
+		if ( captureFile == NULL ) {
+			idLib::Warning( "Couldn't open %s for snapshot capture", captureName.c_str() );
+			net_snapshotCapture.SetString( "" );
+			return;
+		}
+		captureFile->WriteBig( SNAPSHOT_CAPTURE_MAGIC );
+		idLib::Printf( "Capturing snapshot deltas to %s\n", captureName.c_str() );
+	}
+
+	lzwCompressionData_t	lzwData;
+	idSnapshotCompressor	lzwCompressor( &lzwData );
+	if ( !lzwCompressor.StartRead( deltaData, size ) ) {
+		return;
+	}
+	stream.SetNum( 0 );
+	for ( int value = lzwCompressor.ReadByte( true ); value != -1; value = lzwCompressor.ReadByte( true ) ) {
+		stream.Append( (byte)value );
+	}
+
+	captureFile->WriteBig( stream.Num() );
+	captureFile->Write( stream.Ptr(), stream.Num() );
+	captureFile->Flush();
+}
+
 /*
 ========================
 idSnapshotProcessor::GetPendingSnapDelta
@@ -232,6 +283,10 @@ int idSnapshotProcessor::GetPendingSnapDelta( byte * outBuffer, int maxLength )
 		idLib::Error( "GetPendingSnapDelta: Size overflow." );
 	}
 
+	if ( net_snapshotCapture.GetString()[0] != '\0' ) {
+		CaptureSnapshotDelta( deltaData, size );
+	}
+
 	// Copy to out buffer
 	memcpy( outBuffer, deltaData, size );
 	
@@ -522,3 +577,306 @@ void idSnapshotProcessor::AddSnapObjTemplate( int objID, idBitMsg & msg ) {
 		state->expectedSequence = snapSequence;
 	}
 }
+
+/*
+========================
+SnapDeltaBenchmark_Run
+
+Runs the host side of the snapshot exchange for numClients simulated peers and returns the
+average microseconds spent encoding one snapshot for all of them.
+========================
+*/
+static float SnapDeltaBenchmark_Run( int numClients, int numObjects, int numFrames, bool useCache, int & outBytes, int & outHits, int & outMisses ) {
+	static const int MAX_BENCHMARK_OBJ_SIZE = 256;
+	static const int OBJ_MEMORY_SIZE		= 1024 * 128;
+
+	idRandom random( 0x5ea0 );		// same sequence of changes for every run
+
+	idList< idSnapshotProcessor * > clients;
+	for ( int c = 0; c < numClients; c++ ) {
+		clients.Append( new (TAG_NETWORKING) idSnapshotProcessor() );
+	}
+
+	uint8 * objMemory = (uint8 *)Mem_Alloc16( OBJ_MEMORY_SIZE, TAG_NETWORKING );
+	lzwCompressionData_t * lzwData = (lzwCompressionData_t *)Mem_Alloc16( sizeof( lzwCompressionData_t ), TAG_NETWORKING );
+
+	idSnapDeltaCache deltaCache;
+	if ( useCache ) {
+		deltaCache.Init( net_snapDeltaCacheMemory.GetInteger() * 1024 );
+	}
+
+	// object contents that get partially changed every frame like entity state does
+	idList< byte > objData;
+	idList< int > objSizes;
+	objData.SetNum( numObjects * MAX_BENCHMARK_OBJ_SIZE );
+	objSizes.SetNum( numObjects );
+	for ( int i = 0; i < objData.Num(); i++ ) {
+		objData[i] = random.RandomInt( 8 ) == 0 ? (byte)random.RandomInt( 256 ) : 0;
+	}
+	for ( int i = 0; i < numObjects; i++ ) {
+		objSizes[i] = 16 + random.RandomInt( MAX_BENCHMARK_OBJ_SIZE - 16 );
+	}
+
+	idSnapShot ss;
+	for ( int i = 0; i < numObjects; i++ ) {
+		ss.S_AddObject( i, MAX_UNSIGNED_TYPE( uint32 ), &objData[i * MAX_BENCHMARK_OBJ_SIZE], objSizes[i] );
+	}
+
+	byte buffer[ idPacketProcessor::MAX_MSG_SIZE ];
+	uint64 totalMicroseconds = 0;
+	outBytes	= 0;
+	outHits		= 0;
+	outMisses	= 0;
+
+	for ( int frame = 0; frame < numFrames; frame++ ) {
+		// change a few bytes of roughly a tenth of the objects
+		for ( int i = 0; i < numObjects; i++ ) {
+			if ( random.RandomInt( 10 ) != 0 ) {
+				continue;
+			}
+			byte * data = &objData[i * MAX_BENCHMARK_OBJ_SIZE];
+			for ( int b = 0; b < 4; b++ ) {
+				data[random.RandomInt( objSizes[i] )] = (byte)random.RandomInt( 256 );
+			}
+			ss.S_AddObject( i, MAX_UNSIGNED_TYPE( uint32 ), data, objSizes[i] );
+		}
+		ss.SetTime( frame * 16 );
+
+		uint64 start = Sys_Microseconds();
+
+		if ( useCache ) {
+			deltaCache.Clear();
+		}
+
+		for ( int c = 0; c < numClients; c++ ) {
+			idSnapshotProcessor & snapProc = *clients[c];
+			snapProc.TrySetPendingSnapshot( ss );
+			snapProc.SubmitPendingSnap( c + 1, objMemory, OBJ_MEMORY_SIZE, lzwData, useCache ? &deltaCache : NULL );
+			int size = snapProc.GetPendingSnapDelta( buffer, sizeof( buffer ) );
+			outBytes += abs( size );
+		}
+
+		totalMicroseconds += Sys_Microseconds() - start;
+
+		if ( useCache ) {
+			outHits		+= deltaCache.GetNumHits();
+			outMisses	+= deltaCache.GetNumMisses();
+			deltaCache.ResetStats();
+		}
+
+		// peers ack at different rates, so their base states drift apart
+		for ( int c = 0; c < numClients; c++ ) {
+			if ( ( frame % ( 1 + ( c % 3 ) ) ) == 0 ) {
+				clients[c]->ApplySnapshotDelta( c + 1, clients[c]->GetSnapSequence() );
+			}
+		}
+	}
+
+	clients.DeleteContents( true );
+	Mem_Free16( objMemory );
+	Mem_Free16( lzwData );
+
+	return (float)totalMicroseconds / numFrames;
+}
+
+/*
+========================
+snapDeltaBenchmark
+
+Soak test of host snapshot encoding CPU at 8, 16 and 32 peers, with and without net_snapDeltaCache.
+========================
+*/
+CONSOLE_COMMAND( snapDeltaBenchmark, "usage: snapDeltaBenchmark [numObjects] [numFrames]", 0 ) {
+	const int numObjects	= args.Argc() > 1 ? Max( 1, atoi( args.Argv( 1 ) ) ) : 512;
+	const int numFrames		= args.Argc() > 2 ? Max( 1, atoi( args.Argv( 2 ) ) ) : 300;
+	const int clientCounts[] = { 8, 16, 32 };
+
+	idLib::Printf( "snapshot encoding of %d objects over %d frames:\n", numObjects, numFrames );
+	idLib::Printf( "peers      uncached        cached   speedup   bytes/frame   cache hits\n" );
+
+	for ( int i = 0; i < sizeof( clientCounts ) / sizeof( clientCounts[0] ); i++ ) {
+		int bytes = 0;
+		int cachedBytes = 0;
+		int hits = 0;
+		int misses = 0;
+		const float uncached = SnapDeltaBenchmark_Run( clientCounts[i], numObjects, numFrames, false, bytes, hits, misses );
+		const float cached = SnapDeltaBenchmark_Run( clientCounts[i], numObjects, numFrames, true, cachedBytes, hits, misses );
+
+		// the cache must not change what goes on the wire
+		if ( bytes != cachedBytes ) {
+			idLib::Warning( "snapDeltaBenchmark: %d peers wrote %d bytes uncached but %d bytes cached", clientCounts[i], bytes, cachedBytes );
+		}
+
+		idLib::Printf( "%5d  %9.1f us  %9.1f us  %7.2fx  %12d  %10.1f%%\n", clientCounts[i], uncached, cached, cached > 0.0f ? uncached / cached : 0.0f,
+			bytes / numFrames, hits + misses > 0 ? 100.0f * hits / ( hits + misses ) : 0.0f );
+	}
+}
+
+/*
+========================
+LoadSnapshotCapture
+========================
+*/
+static bool LoadSnapshotCapture( const char * fileName, idList< byte > & data, idList< int > & offsets ) {
+	idFileLocal file( fileSystem->OpenFileRead( fileName ) );
+	if ( file == NULL ) {
+		idLib::Warning( "Couldn't open %s", fileName );
+		return false;
+	}
+	int magic = 0;
+	file->ReadBig( magic );
+	if ( magic != SNAPSHOT_CAPTURE_MAGIC ) {
+		idLib::Warning( "%s is not a snapshot capture", fileName );
+		return false;
+	}
+	data.SetNum( 0 );
+	offsets.SetNum( 0 );
+	offsets.Append( 0 );
+
+	int size = 0;
+	while ( file->ReadBig( size ) == sizeof( size ) ) {
+		if ( size < 0 || size > file->Length() ) {
+			idLib::Warning( "%s is corrupt", fileName );
+			return false;
+		}
+		const int start = data.Num();
+		data.SetNum( start + size );
+		if ( file->Read( data.Ptr() + start, size ) != size ) {
+			data.SetNum( start );
+			break;		// truncated by a capture that was still being written
+		}
+		offsets.Append( data.Num() );
+	}
+	return offsets.Num() > 1;
+}
+
+/*
+========================
+snapshotCodecTrain
+
+Builds a range coder model from the streams in a snapshot capture.
+========================
+*/
+CONSOLE_COMMAND( snapshotCodecTrain, "usage: snapshotCodecTrain <capture> <model>", 0 ) {
+	if ( args.Argc() < 3 ) {
+		idLib::Printf( "usage: snapshotCodecTrain <capture> <model>\n" );
+		return;
+	}
+
+	idList< byte > data;
+	idList< int > offsets;
+	if ( !LoadSnapshotCapture( args.Argv( 1 ), data, offsets ) ) {
+		return;
+	}
+
+	static uint32 counts[idRangeCoderModel::NUM_CONTEXTS][idRangeCoderModel::NUM_SYMBOLS];
+	memset( counts, 0, sizeof( counts ) );
+
+	for ( int i = 0; i < offsets.Num() - 1; i++ ) {
+		int prevByte = 0x80;
+		for ( int b = offsets[i]; b < offsets[i + 1]; b++ ) {
+			counts[idRangeCoderModel::GetContext( prevByte )][data[b]]++;
+			prevByte = data[b];
+		}
+		counts[idRangeCoderModel::GetContext( prevByte )][idRangeCoderModel::END_SYMBOL]++;
+	}
+
+	idRangeCoderModel * model = new (TAG_NETWORKING) idRangeCoderModel;
+	model->Train( counts );
+	if ( !model->Save( args.Argv( 2 ) ) ) {
+		idLib::Warning( "Couldn't write %s", args.Argv( 2 ) );
+	} else {
+		idLib::Printf( "Trained model %04x from %d snapshots (%d bytes), written to %s\n", model->GetChecksum(), offsets.Num() - 1, data.Num(), args.Argv( 2 ) );
+		if ( idStr::Icmp( args.Argv( 2 ), net_snapshotCodecModel.GetString() ) == 0 ) {
+			ReloadSnapshotCodecModel();
+		}
+	}
+	delete model;
+}
+
+/*
+========================
+snapshotCodecReplay
+
+Runs the streams in a snapshot capture through every snapshot codec and reports size and speed.
+========================
+*/
+CONSOLE_COMMAND( snapshotCodecReplay, "usage: snapshotCodecReplay <capture> [iterations]", 0 ) {
+	if ( args.Argc() < 2 ) {
+		idLib::Printf( "usage: snapshotCodecReplay <capture> [iterations]\n" );
+		return;
+	}
+	const int iterations = args.Argc() > 2 ? Max( 1, atoi( args.Argv( 2 ) ) ) : 10;
+
+	idList< byte > data;
+	idList< int > offsets;
+	if ( !LoadSnapshotCapture( args.Argv( 1 ), data, offsets ) ) {
+		return;
+	}
+	const int numSnapshots = offsets.Num() - 1;
+
+	int maxStream = 0;
+	for ( int i = 0; i < numSnapshots; i++ ) {
+		maxStream = Max( maxStream, offsets[i + 1] - offsets[i] );
+	}
+	const int maxCompressed = maxStream * 2 + 64;
+
+	idList< byte > compressed;
+	idList< int > compressedSizes;
+	idList< byte > decompressed;
+	compressed.SetNum( numSnapshots * maxCompressed );
+	compressedSizes.SetNum( numSnapshots );
+	decompressed.SetNum( maxStream + 1 );
+
+	lzwCompressionData_t * lzwData = (lzwCompressionData_t *)Mem_Alloc16( sizeof( lzwCompressionData_t ), TAG_NETWORKING );
+	idSnapshotCompressor * compressor = new (TAG_NETWORKING) idSnapshotCompressor( lzwData );
+
+	idLib::Printf( "%d snapshots, %.1f bytes per snapshot before entropy coding, model %04x\n", numSnapshots, (float)data.Num() / numSnapshots, GetSnapshotCodecModel()->GetChecksum() );
+	idLib::Printf( "codec   bytes/snap   ratio   encode ns/byte   decode ns/byte\n" );
+
+	const char * codecNames[SNAPSHOT_CODEC_MAX] = { "lzw", "range" };
+
+	for ( int codec = 0; codec < SNAPSHOT_CODEC_MAX; codec++ ) {
+		lzwData->codec = codec;
+
+		uint64 encodeMicroseconds = 0;
+		for ( int it = 0; it < iterations; it++ ) {
+			const uint64 start = Sys_Microseconds();
+			for ( int i = 0; i < numSnapshots; i++ ) {
+				compressor->Start( &compressed[i * maxCompressed], maxCompressed );
+				compressor->Write( &data[offsets[i]], offsets[i + 1] - offsets[i] );
+				compressedSizes[i] = compressor->End();
+			}
+			encodeMicroseconds += Sys_Microseconds() - start;
+		}
+
+		int totalCompressed = 0;
+		int mismatches = 0;
+		uint64 decodeMicroseconds = 0;
+		for ( int it = 0; it < iterations; it++ ) {
+			const uint64 start = Sys_Microseconds();
+			for ( int i = 0; i < numSnapshots; i++ ) {
+				const int size = offsets[i + 1] - offsets[i];
+				compressor->StartRead( &compressed[i * maxCompressed], compressedSizes[i] );
+				const int read = compressor->Read( decompressed.Ptr(), decompressed.Num(), true );
+				if ( it == 0 ) {
+					totalCompressed += compressedSizes[i];
+					if ( read != size || memcmp( decompressed.Ptr(), &data[offsets[i]], size ) != 0 ) {
+						mismatches++;
+					}
+				}
+			}
+			decodeMicroseconds += Sys_Microseconds() - start;
+		}
+
+		const float totalBytes = (float)data.Num() * iterations;
+		idLib::Printf( "%-5s   %10.1f   %5.3f   %14.2f   %14.2f\n", codecNames[codec], (float)totalCompressed / numSnapshots, (float)totalCompressed / data.Num(),
+			encodeMicroseconds * 1000.0f / totalBytes, decodeMicroseconds * 1000.0f / totalBytes );
+		if ( mismatches > 0 ) {
+			idLib::Warning( "%s: %d snapshots didn't survive a round trip", codecNames[codec], mismatches );
+		}
+	}
+
+	delete compressor;
+	Mem_Free16( lzwData );
+}
@@ -52,7 +52,8 @@ public:
 	bool ApplyDeltaToSnapshot( idSnapShot & snap, const char * deltaMem, int deltaSize, int visIndex );
 	// Attempts to write the currently pending snap to the supplied buffer, which can then be sent as an unreliable msg.
 	// SubmitPendingSnap will submit the pending snap to a job, so that it can be retrieved later for sending.
-	void SubmitPendingSnap( int visIndex, uint8 * objMemory, int objMemorySize, lzwCompressionData_t * lzwData );
+	// Peers written in the same frame can pass the same deltaCache to share the per object delta work.
+	void SubmitPendingSnap( int visIndex, uint8 * objMemory, int objMemorySize, lzwCompressionData_t * lzwData, idSnapDeltaCache * deltaCache = NULL );
 	// GetPendingSnapDelta
 	int GetPendingSnapDelta( byte * outBuffer, int maxLength );
 	// If PendingSnapReadyToSend is true, then GetPendingSnapDelta will return something to send
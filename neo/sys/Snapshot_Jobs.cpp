@@ -35,6 +35,133 @@ uint32 SnapObjChecksum( const uint8 * data, int length ) {
 	return CRC32_BlockChecksum( data, length );
 }
 
+// ID_WIN_X86_SSE2_INTRIN is off in the PC builds, but every x86 target they support has SSE2,
+// including the 32 bit Windows build which doesn't define __SSE2__
+#if defined( ID_WIN_X86_SSE2_INTRIN ) || defined( __SSE2__ ) || defined( _M_X64 ) || defined( _M_IX86 )
+#define SNAP_OBJ_SSE2
+#endif
+
+/*
+========================
+SnapObjFindDifferent
+
+Object states are mostly unchanged from one snapshot to the next, so the
+common case is a long stretch of equal bytes that this skips 32 at a time.
+========================
+*/
+int SnapObjFindDifferent( const uint8 * a, const uint8 * b, int start, int end ) {
+	int i = start;
+#ifdef SNAP_OBJ_SSE2
+	for ( ; i + 32 <= end; i += 32 ) {
+		const __m128i eq0 = _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i *)( a + i ) ), _mm_loadu_si128( (const __m128i *)( b + i ) ) );
+		const __m128i eq1 = _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i *)( a + i + 16 ) ), _mm_loadu_si128( (const __m128i *)( b + i + 16 ) ) );
+		if ( _mm_movemask_epi8( _mm_and_si128( eq0, eq1 ) ) != 0xFFFF ) {
+			break;
+		}
+	}
+	for ( ; i + 16 <= end; i += 16 ) {
+		const __m128i eq = _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i *)( a + i ) ), _mm_loadu_si128( (const __m128i *)( b + i ) ) );
+		if ( _mm_movemask_epi8( eq ) != 0xFFFF ) {
+			break;
+		}
+	}
+#else
+	for ( ; i + 8 <= end; i += 8 ) {
+		uint64 wordA;
+		uint64 wordB;
+		memcpy( &wordA, a + i, 8 );
+		memcpy( &wordB, b + i, 8 );
+		if ( wordA != wordB ) {
+			break;
+		}
+	}
+#endif
+	while ( i < end && a[i] == b[i] ) {
+		i++;
+	}
+	return i;
+}
+
+/*
+========================
+SnapObjFindSame
+
+Changed spans are short, so this only scans bytes.
+========================
+*/
+int SnapObjFindSame( const uint8 * a, const uint8 * b, int start, int end ) {
+	int i = start;
+	while ( i < end && a[i] != b[i] ) {
+		i++;
+	}
+	return i;
+}
+
+/*
+========================
+SnapObjCountDifferent
+========================
+*/
+int SnapObjCountDifferent( const uint8 * a, const uint8 * b, int size ) {
+	int i = 0;
+	int same = 0;
+#ifdef SNAP_OBJ_SSE2
+	const __m128i one = _mm_set1_epi8( 1 );
+	const __m128i zero = _mm_setzero_si128();
+	__m128i sums = zero;
+	for ( ; i + 32 <= size; i += 32 ) {
+		const __m128i eq0 = _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i *)( a + i ) ), _mm_loadu_si128( (const __m128i *)( b + i ) ) );
+		const __m128i eq1 = _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i *)( a + i + 16 ) ), _mm_loadu_si128( (const __m128i *)( b + i + 16 ) ) );
+		// each byte lane ends up 0, 1 or 2, and sad adds the lanes into two 64 bit halves
+		const __m128i counts = _mm_add_epi8( _mm_and_si128( eq0, one ), _mm_and_si128( eq1, one ) );
+		sums = _mm_add_epi64( sums, _mm_sad_epu8( counts, zero ) );
+	}
+	same += _mm_cvtsi128_si32( sums ) + _mm_cvtsi128_si32( _mm_srli_si128( sums, 8 ) );
+#endif
+	for ( ; i < size; i++ ) {
+		same += ( a[i] == b[i] ) ? 1 : 0;
+	}
+	return size - same;
+}
+
+/*
+========================
+SnapObjSubtract
+========================
+*/
+void SnapObjSubtract( uint8 * dest, const uint8 * a, const uint8 * b, int size ) {
+	int i = 0;
+#ifdef SNAP_OBJ_SSE2
+	for ( ; i + 16 <= size; i += 16 ) {
+		const __m128i delta = _mm_sub_epi8( _mm_loadu_si128( (const __m128i *)( a + i ) ), _mm_loadu_si128( (const __m128i *)( b + i ) ) );
+		_mm_storeu_si128( (__m128i *)( dest + i ), delta );
+	}
+#endif
+	for ( ; i < size; i++ ) {
+		dest[i] = (uint8)( a[i] - b[i] );
+	}
+}
+
+/*
+========================
+WriteObjectDelta
+Writes the per byte difference of two states, unchanged stretches become zero runs without
+visiting every byte
+========================
+*/
+static void WriteObjectDelta( idZeroRunLengthCompressor & rleCompressor, const uint8 * newData, const uint8 * oldData, int size ) {
+	int b = 0;
+	while ( b < size ) {
+		const int changedStart = SnapObjFindDifferent( newData, oldData, b, size );
+		rleCompressor.WriteZeros( changedStart - b );
+		const int changedEnd = SnapObjFindSame( newData, oldData, changedStart, size );
+		for ( int c = changedStart; c < changedEnd; c++ ) {
+			rleCompressor.WriteByte( (uint8)( newData[c] - oldData[c] ) );
+		}
+		b = changedEnd;
+	}
+}
+
 /*
 ========================
 ObjectsSame
@@ -62,6 +189,167 @@ ID_INLINE bool ObjectsSame( objJobState_t & newState, objJobState_t & oldState )
 	return false;			// Not the same
 }
 
+/*
+========================
+idSnapDeltaCache::idSnapDeltaCache
+========================
+*/
+idSnapDeltaCache::idSnapDeltaCache() :
+	memory( NULL ),
+	memoryUsed( 0 ),
+	maxMemory( 0 ),
+	numHits( 0 ),
+	numMisses( 0 ) {
+}
+
+/*
+========================
+idSnapDeltaCache::~idSnapDeltaCache
+========================
+*/
+idSnapDeltaCache::~idSnapDeltaCache() {
+	Shutdown();
+}
+
+/*
+========================
+idSnapDeltaCache::Init
+========================
+*/
+void idSnapDeltaCache::Init( int maxMemory_ ) {
+	Shutdown();
+	maxMemory	= ( maxMemory_ + 15 ) & ~15;
+	memory		= (uint8 *)Mem_Alloc16( maxMemory, TAG_NETWORKING );
+	hash.Clear( 1024, 1024 );
+	entries.SetGranularity( 1024 );
+	Clear();
+}
+
+/*
+========================
+idSnapDeltaCache::Shutdown
+========================
+*/
+void idSnapDeltaCache::Shutdown() {
+	if ( memory != NULL ) {
+		Mem_Free16( memory );
+		memory = NULL;
+	}
+	maxMemory = 0;
+	memoryUsed = 0;
+	entries.Clear();
+	hash.Free();
+}
+
+/*
+========================
+idSnapDeltaCache::Clear
+========================
+*/
+void idSnapDeltaCache::Clear() {
+	entries.SetNum( 0 );
+	hash.Clear();
+	memoryUsed = 0;
+}
+
+/*
+========================
+idSnapDeltaCache::GetKey
+========================
+*/
+int idSnapDeltaCache::GetKey( const objJobState_t & newState, const objJobState_t & oldState ) const {
+	const int ptrBits = (int)( (uintptr_t)newState.data >> 4 );
+	return hash.GenerateKey( newState.objectNum ^ ( ( oldState.valid ? oldState.size : 0xFFFF ) << 16 ), ptrBits );
+}
+
+/*
+========================
+idSnapDeltaCache::AllocData
+========================
+*/
+uint8 * idSnapDeltaCache::AllocData( int size ) {
+	const int alignedSize = OBJ_DEST_SIZE_ALIGN16( size );
+	if ( memoryUsed + alignedSize > maxMemory ) {
+		return NULL;
+	}
+	uint8 * data = memory + memoryUsed;
+	memoryUsed += alignedSize;
+	return data;
+}
+
+/*
+========================
+idSnapDeltaCache::Find
+========================
+*/
+const snapDeltaCacheEntry_t * idSnapDeltaCache::Find( const objJobState_t & newState, const objJobState_t & oldState ) {
+	assert( newState.valid );
+
+	const int key = GetKey( newState, oldState );
+	for ( int i = hash.First( key ); i != idHashIndex::NULL_INDEX; i = hash.Next( i ) ) {
+		const snapDeltaCacheEntry_t & entry = entries[i];
+		if ( entry.newData != newState.data || entry.objectNum != newState.objectNum || entry.newSize != newState.size ) {
+			continue;
+		}
+		if ( entry.oldValid != ( oldState.valid != 0 ) ) {
+			continue;
+		}
+		if ( entry.oldValid ) {
+			if ( entry.oldSize != oldState.size || memcmp( entry.oldData, oldState.data, oldState.size ) != 0 ) {
+				continue;
+			}
+		}
+		numHits++;
+		return &entry;
+	}
+	numMisses++;
+	return NULL;
+}
+
+/*
+========================
+idSnapDeltaCache::Add
+========================
+*/
+const snapDeltaCacheEntry_t * idSnapDeltaCache::Add( const objJobState_t & newState, const objJobState_t & oldState, bool same, int32 csize, const uint8 * data, int dataSize ) {
+	assert( newState.valid );
+
+	if ( memory == NULL ) {
+		return NULL;
+	}
+
+	const int oldSize = oldState.valid ? oldState.size : 0;
+
+	// the entry is only usable if both the old state copy and the delta fit
+	if ( memoryUsed + OBJ_DEST_SIZE_ALIGN16( oldSize ) + OBJ_DEST_SIZE_ALIGN16( dataSize ) > maxMemory ) {
+		return NULL;
+	}
+
+	snapDeltaCacheEntry_t & entry = entries.Alloc();
+	entry.objectNum	= newState.objectNum;
+	entry.newSize	= newState.size;
+	entry.oldSize	= oldSize;
+	entry.oldValid	= ( oldState.valid != 0 );
+	entry.same		= same;
+	entry.newData	= newState.data;
+	entry.oldData	= NULL;
+	entry.csize		= csize;
+	entry.data		= NULL;
+
+	if ( oldSize > 0 ) {
+		entry.oldData = AllocData( oldSize );
+		memcpy( entry.oldData, oldState.data, oldSize );
+	}
+	if ( dataSize > 0 ) {
+		entry.data = AllocData( dataSize );
+		memcpy( entry.data, data, dataSize );
+	}
+
+	hash.Add( GetKey( newState, oldState ), entries.Num() - 1 );
+
+	return &entry;
+}
+
 /*
 ========================
 SnapshotObjectJob
@@ -98,6 +386,9 @@ void SnapshotObjectJob( objParms_t * parms ) {
 	bool visChange		= false; // visibility changes will be signified with a 0xffff state size
 	bool visSendState	= false; // the state is sent when an entity is no longer stale
 
+	// Encoded delta shared with other peers, if another peer already needed this one
+	const snapDeltaCacheEntry_t * cached = NULL;
+
 	// Compute visibility changes 
 	// (we need to do this before writing out object id, because we may not need to write out the id if we early out)
 	// (when we don't write out the id, we assume this is an "ack" when we deserialize the objects)
@@ -126,13 +417,27 @@ void SnapshotObjectJob( objParms_t * parms ) {
 				visSendState = true;
 			}				
 		}
+
+		if ( parms->deltaCache != NULL && ( !visChange || visSendState ) ) {
+			cached = parms->deltaCache->Find( newState, oldState );
+		}
 		
 		// Same object, write a delta (never early out during vis changes)
-		if ( !visChange && ObjectsSame( newState, oldState ) ) {
-			// same state, write nothing
-			header->flags |= OBJ_SAME;
-			return;
+		if ( !visChange ) {
+			bool same = ( cached != NULL ) ? cached->same : ObjectsSame( newState, oldState );
+			if ( same ) {
+				if ( cached == NULL && parms->deltaCache != NULL ) {
+					parms->deltaCache->Add( newState, oldState, true, 0, NULL, 0 );
+				}
+				// same state, write nothing
+				header->flags |= OBJ_SAME;
+				return;
+			}
+		} else if ( cached != NULL && cached->same ) {
+			cached = NULL;		// a state that is no longer stale is always written out
 		}
+	} else if ( parms->deltaCache != NULL && newState.valid ) {
+		cached = parms->deltaCache->Find( newState, oldState );
 	}
 
 	// Get the id of the object we are writing out
@@ -148,14 +453,22 @@ void SnapshotObjectJob( objParms_t * parms ) {
 	} else if ( !oldState.valid ) {
 		// New object, write out full state
 		assert( newState.valid );
-		// delta against an empty snap
-		rleCompressor.Start( dataStart, NULL, OBJ_DEST_SIZE_ALIGN16( newState.size ) );
-		rleCompressor.WriteBytes( newState.data, newState.size );
-		header->csize = rleCompressor.End();
 		header->flags |= OBJ_NEW;
-		if ( header->csize == -1 ) {
-			// Not enough space, don't compress, have lzw job do zrle compression instead
-			memcpy( dataStart, newState.data, newState.size );
+		if ( cached != NULL ) {
+			header->csize	= cached->csize;
+			header->data	= cached->data;
+		} else {
+			// delta against an empty snap
+			rleCompressor.Start( dataStart, NULL, OBJ_DEST_SIZE_ALIGN16( newState.size ) );
+			rleCompressor.WriteBytes( newState.data, newState.size );
+			header->csize = rleCompressor.End();
+			if ( header->csize == -1 ) {
+				// Not enough space, don't compress, have lzw job do zrle compression instead
+				memcpy( dataStart, newState.data, newState.size );
+			}
+			if ( parms->deltaCache != NULL ) {
+				parms->deltaCache->Add( newState, oldState, false, header->csize, dataStart, header->csize == -1 ? newState.size : header->csize );
+			}
 		}
 	} else {
 		// Compare to same obj id in different snapshot
@@ -167,13 +480,13 @@ void SnapshotObjectJob( objParms_t * parms ) {
 			header->flags |= visSendState ? OBJ_VIS_NOT_STALE : OBJ_VIS_STALE;
 		}
 	
-		if ( !visChange || visSendState ) {			
+		if ( cached != NULL ) {
+			header->csize	= cached->csize;
+			header->data	= cached->data;
+		} else if ( !visChange || visSendState ) {			
 			int compareSize = Min( newState.size, oldState.size );
 			rleCompressor.Start( dataStart, NULL, OBJ_DEST_SIZE_ALIGN16( newState.size ) );
-			for ( int b = 0; b < compareSize; b++ ) {
-				byte delta = newState.data[b] - oldState.data[b];
-				rleCompressor.WriteByte( ( 0xFF + 1 + delta ) & 0xFF );
-			}
+			WriteObjectDelta( rleCompressor, newState.data, oldState.data, compareSize );
 			// Get leftover
 			int leftOver = newState.size - compareSize;
 			
@@ -185,16 +498,18 @@ void SnapshotObjectJob( objParms_t * parms ) {
 
 			if ( header->csize == -1 ) {
 				// Not enough space, don't compress, have lzw job do zrle compression instead
-				for ( int b = 0; b < compareSize; b++ ) {
-					*dataStart++ = ( ( 0xFF + 1 + ( newState.data[b] - oldState.data[b] ) ) & 0xFF );
-				}
+				SnapObjSubtract( dataStart, newState.data, oldState.data, compareSize );
 				// Get leftover
 				int leftOver = newState.size - compareSize;
 			
 				if ( leftOver > 0 ) {
-					memcpy( dataStart, newState.data + compareSize, leftOver );
+					memcpy( dataStart + compareSize, newState.data + compareSize, leftOver );
 				}
 			}
+
+			if ( parms->deltaCache != NULL ) {
+				parms->deltaCache->Add( newState, oldState, false, header->csize, dataStart, header->csize == -1 ? newState.size : header->csize );
+			}
 		}
 	}
 
@@ -213,7 +528,7 @@ void SnapshotObjectJob( objParms_t * parms ) {
 FinishLZWStream
 ========================
 */
-static void FinishLZWStream( lzwParm_t * parm, idLZWCompressor * lzwCompressor ) {
+static void FinishLZWStream( lzwParm_t * parm, idSnapshotCompressor * lzwCompressor ) {
 	if ( lzwCompressor->IsOverflowed() ) {
 		lzwCompressor->Restore();
 	}
@@ -245,10 +560,11 @@ static void FinishLZWStream( lzwParm_t * parm, idLZWCompressor * lzwCompressor )
 NewLZWStream
 ========================
 */
-static void NewLZWStream( lzwParm_t * parm, idLZWCompressor * lzwCompressor ) {
+static void NewLZWStream( lzwParm_t * parm, idSnapshotCompressor * lzwCompressor ) {
 	
 	// Reset compressor
 	int maxSize = parm->ioData->maxlzwMem - parm->ioData->lzwBytes;
+	parm->ioData->lzwData->codec = parm->ioData->codec;
 	lzwCompressor->Start( &parm->ioData->lzwMem[parm->ioData->lzwBytes], maxSize );
 	
 	parm->ioData->lastObjId = 0;
@@ -265,7 +581,7 @@ static void NewLZWStream( lzwParm_t * parm, idLZWCompressor * lzwCompressor ) {
 ContinueLZWStream
 ========================
 */
-static void ContinueLZWStream( lzwParm_t * parm, idLZWCompressor * lzwCompressor ) {
+static void ContinueLZWStream( lzwParm_t * parm, idSnapshotCompressor * lzwCompressor ) {
 	// Continue compressor where we left off
 	int maxSize = parm->ioData->maxlzwMem - parm->ioData->lzwBytes;
 	lzwCompressor->Start( &parm->ioData->lzwMem[parm->ioData->lzwBytes], maxSize, true );
@@ -295,10 +611,10 @@ void LZWJobInternal( lzwParm_t * parm, unsigned int dmaTag ) {
 
 	dmaTag = dmaTag;
 #if defined( ID_PC_WIN )
-	ALIGN16( idLZWCompressor lzwCompressor( parm->ioData->lzwData ) );
+	ALIGN16( idSnapshotCompressor lzwCompressor( parm->ioData->lzwData ) );
 #else
 #warning implement LZWCompressor Align 16
-	idLZWCompressor lzwCompressor( parm->ioData->lzwData );
+	idSnapshotCompressor lzwCompressor( parm->ioData->lzwData );
 #endif // ID_PC_WIN
 	if ( parm->fragmented ) {
 		// This packet was partially written out, we need to continue writing, using previous lzw dictionary values
@@ -425,3 +741,163 @@ LZWJob
 void LZWJob( lzwParm_t * parm ) {
 	LZWJobInternal( parm, 0 );
 }
+
+/*
+========================
+snapObjDiffBenchmark
+
+Times the object state compare and delta encoding against the byte at a time loops they
+replaced, over pairs of states shaped like entity updates: most unchanged, the rest with a
+few short changed spans and the odd change in size.
+========================
+*/
+CONSOLE_COMMAND( snapObjDiffBenchmark, "usage: snapObjDiffBenchmark [numObjects] [iterations]", 0 ) {
+	static const int MAX_OBJ_SIZE = 512;
+
+	const int numObjects	= args.Argc() > 1 ? Max( 1, atoi( args.Argv( 1 ) ) ) : 2048;
+	const int iterations	= args.Argc() > 2 ? Max( 1, atoi( args.Argv( 2 ) ) ) : 100;
+
+	idRandom random( 1234 );
+	idList< uint8 > oldData;
+	idList< uint8 > newData;
+	idList< int > oldSizes;
+	idList< int > newSizes;
+	oldData.SetNum( numObjects * MAX_OBJ_SIZE );
+	newData.SetNum( numObjects * MAX_OBJ_SIZE );
+	oldSizes.SetNum( numObjects );
+	newSizes.SetNum( numObjects );
+
+	for ( int i = 0; i < numObjects; i++ ) {
+		uint8 * oldState = &oldData[i * MAX_OBJ_SIZE];
+		uint8 * newState = &newData[i * MAX_OBJ_SIZE];
+		oldSizes[i] = 16 + random.RandomInt( MAX_OBJ_SIZE - 32 );
+		newSizes[i] = oldSizes[i] + ( random.RandomInt( 10 ) == 0 ? random.RandomInt( 16 ) : 0 );
+		for ( int b = 0; b < MAX_OBJ_SIZE; b++ ) {
+			oldState[b] = random.RandomInt( 3 ) == 0 ? (uint8)random.RandomInt( 256 ) : 0;
+		}
+		memcpy( newState, oldState, MAX_OBJ_SIZE );
+		if ( random.RandomInt( 10 ) < 3 ) {
+			continue;
+		}
+		const int numSpans = 1 + random.RandomInt( 4 );
+		for ( int s = 0; s < numSpans; s++ ) {
+			const int spanStart = random.RandomInt( newSizes[i] );
+			const int spanEnd = Min( newSizes[i], spanStart + 1 + random.RandomInt( 8 ) );
+			for ( int b = spanStart; b < spanEnd; b++ ) {
+				newState[b] = (uint8)( newState[b] + 1 + random.RandomInt( 255 ) );
+			}
+		}
+	}
+
+	int totalBytes = 0;
+	for ( int i = 0; i < numObjects; i++ ) {
+		totalBytes += Min( newSizes[i], oldSizes[i] );
+	}
+
+	// Both encoders must produce the same stream
+	int mismatches = 0;
+	for ( int i = 0; i < numObjects; i++ ) {
+		uint8 byteDest[ OBJ_DEST_SIZE_ALIGN16( MAX_OBJ_SIZE ) ];
+		uint8 blockDest[ OBJ_DEST_SIZE_ALIGN16( MAX_OBJ_SIZE ) ];
+		const uint8 * newState = &newData[i * MAX_OBJ_SIZE];
+		const uint8 * oldState = &oldData[i * MAX_OBJ_SIZE];
+		const int compareSize = Min( newSizes[i], oldSizes[i] );
+
+		idZeroRunLengthCompressor byteCompressor;
+		byteCompressor.Start( byteDest, NULL, sizeof( byteDest ) );
+		for ( int b = 0; b < compareSize; b++ ) {
+			byteCompressor.WriteByte( (uint8)( newState[b] - oldState[b] ) );
+		}
+		const int byteSize = byteCompressor.End();
+
+		idZeroRunLengthCompressor blockCompressor;
+		blockCompressor.Start( blockDest, NULL, sizeof( blockDest ) );
+		WriteObjectDelta( blockCompressor, newState, oldState, compareSize );
+		const int blockSize = blockCompressor.End();
+
+		int byteCount = 0;
+		for ( int b = 0; b < compareSize; b++ ) {
+			byteCount += ( newState[b] != oldState[b] ) ? 1 : 0;
+		}
+
+		if ( byteSize != blockSize || ( byteSize > 0 && memcmp( byteDest, blockDest, byteSize ) != 0 ) || byteCount != SnapObjCountDifferent( newState, oldState, compareSize ) ) {
+			mismatches++;
+		}
+	}
+
+	uint8 * dest = (uint8 *)Mem_Alloc16( OBJ_DEST_SIZE_ALIGN16( MAX_OBJ_SIZE ), TAG_NETWORKING );
+	volatile int sink = 0;
+
+	// CompareObject
+	uint64 start = Sys_Microseconds();
+	for ( int it = 0; it < iterations; it++ ) {
+		int count = 0;
+		for ( int i = 0; i < numObjects; i++ ) {
+			const uint8 * newState = &newData[i * MAX_OBJ_SIZE];
+			const uint8 * oldState = &oldData[i * MAX_OBJ_SIZE];
+			const int compareSize = Min( newSizes[i], oldSizes[i] );
+			for ( int b = 0; b < compareSize; b++ ) {
+				count += ( newState[b] != oldState[b] ) ? 1 : 0;
+			}
+		}
+		sink = sink + count;
+	}
+	const uint64 byteCompareMicroseconds = Sys_Microseconds() - start;
+
+	start = Sys_Microseconds();
+	for ( int it = 0; it < iterations; it++ ) {
+		int count = 0;
+		for ( int i = 0; i < numObjects; i++ ) {
+			count += SnapObjCountDifferent( &newData[i * MAX_OBJ_SIZE], &oldData[i * MAX_OBJ_SIZE], Min( newSizes[i], oldSizes[i] ) );
+		}
+		sink = sink + count;
+	}
+	const uint64 blockCompareMicroseconds = Sys_Microseconds() - start;
+
+	// SnapshotObjectJob delta encoding
+	start = Sys_Microseconds();
+	for ( int it = 0; it < iterations; it++ ) {
+		for ( int i = 0; i < numObjects; i++ ) {
+			const uint8 * newState = &newData[i * MAX_OBJ_SIZE];
+			const uint8 * oldState = &oldData[i * MAX_OBJ_SIZE];
+			const int compareSize = Min( newSizes[i], oldSizes[i] );
+			idZeroRunLengthCompressor rleCompressor;
+			rleCompressor.Start( dest, NULL, OBJ_DEST_SIZE_ALIGN16( newSizes[i] ) );
+			for ( int b = 0; b < compareSize; b++ ) {
+				byte delta = newState[b] - oldState[b];
+				rleCompressor.WriteByte( ( 0xFF + 1 + delta ) & 0xFF );
+			}
+			sink = sink + rleCompressor.End();
+		}
+	}
+	const uint64 byteEncodeMicroseconds = Sys_Microseconds() - start;
+
+	start = Sys_Microseconds();
+	for ( int it = 0; it < iterations; it++ ) {
+		for ( int i = 0; i < numObjects; i++ ) {
+			idZeroRunLengthCompressor rleCompressor;
+			rleCompressor.Start( dest, NULL, OBJ_DEST_SIZE_ALIGN16( newSizes[i] ) );
+			WriteObjectDelta( rleCompressor, &newData[i * MAX_OBJ_SIZE], &oldData[i * MAX_OBJ_SIZE], Min( newSizes[i], oldSizes[i] ) );
+			sink = sink + rleCompressor.End();
+		}
+	}
+	const uint64 blockEncodeMicroseconds = Sys_Microseconds() - start;
+
+	Mem_Free16( dest );
+
+	const float megabytes = (float)totalBytes * iterations / ( 1024.0f * 1024.0f );
+#ifdef SNAP_OBJ_SSE2
+	const char * kernel = "sse2";
+#else
+	const char * kernel = "scalar";
+#endif
+	idLib::Printf( "%d object states, %.1f bytes average, %d iterations, %s kernels\n", numObjects, (float)totalBytes / numObjects, iterations, kernel );
+	idLib::Printf( "            bytewise MB/s   block MB/s   speedup\n" );
+	idLib::Printf( "compare     %13.1f   %10.1f   %6.2fx\n", megabytes * 1000000.0f / Max( byteCompareMicroseconds, (uint64)1 ), megabytes * 1000000.0f / Max( blockCompareMicroseconds, (uint64)1 ),
+		(float)byteCompareMicroseconds / Max( blockCompareMicroseconds, (uint64)1 ) );
+	idLib::Printf( "delta zrle  %13.1f   %10.1f   %6.2fx\n", megabytes * 1000000.0f / Max( byteEncodeMicroseconds, (uint64)1 ), megabytes * 1000000.0f / Max( blockEncodeMicroseconds, (uint64)1 ),
+		(float)byteEncodeMicroseconds / Max( blockEncodeMicroseconds, (uint64)1 ) );
+	if ( mismatches > 0 ) {
+		idLib::Warning( "snapObjDiffBenchmark: %d results differ from the bytewise loops", mismatches );
+	}
+}
@@ -69,6 +69,8 @@ struct objJobState_t {
 	uint32				visMask;
 };
 
+class idSnapDeltaCache;
+
 // Input to initial jobs that produce delta'd zrle compressed versions of all the snap obj's
 struct ALIGNTYPE16 objParms_t { 
 	// Input
@@ -77,6 +79,8 @@ struct ALIGNTYPE16 objParms_t {
 	objJobState_t		newState;
 	objJobState_t		oldState;
 
+	idSnapDeltaCache *	deltaCache;				// Optional, shares encoded deltas between peers
+
 	// Output
 	objHeader_t	*		destHeader;
 	uint8 *				dest;
@@ -103,6 +107,7 @@ struct ALIGNTYPE16 lzwInOutData_t {
 	int						optimalLength;			// Optimal length of lzw streams
 	int						snapSequence;
 	uint16					lastObjId;				// Last obj id written out
+	int						codec;					// snapshotCodec_t new streams are written with
 	lzwCompressionData_t *	lzwData;
 };
 
@@ -121,6 +126,72 @@ struct ALIGNTYPE16 lzwParm_t {
 	lzwInOutData_t *		ioData;					// In/Out
 };
 
+/*
+================================================
+idSnapDeltaCache
+
+Encoded object deltas shared by every peer written during the same snapshot pass. Peers whose
+base states hold the same contents for an object need the same delta bytes, so the delta + zrle
+work is only done once per distinct (object, new state, old state) and the lzw job reads the
+cached fragment directly.
+
+Entries are keyed on the new state's buffer pointer and hold a copy of the old state, which is
+compared on lookup. Clear() must be called whenever new state buffers may have been freed and
+reallocated; idLobby clears it at the start of every UpdateSnaps.
+================================================
+*/
+struct snapDeltaCacheEntry_t {
+	uint16			objectNum;
+	uint16			newSize;
+	uint16			oldSize;
+	bool			oldValid;
+	bool			same;					// New and old states are identical, nothing is sent
+	const uint8 *	newData;
+	uint8 *			oldData;				// Copy of the old state
+	int32			csize;					// Size after zrle compression, -1 if data holds the uncompressed delta
+	uint8 *			data;					// Delta'd (and usually zrle compressed) object
+};
+
+class idSnapDeltaCache {
+public:
+					idSnapDeltaCache();
+					~idSnapDeltaCache();
+
+	void			Init( int maxMemory );
+	void			Shutdown();
+	bool			IsInitialized() const { return memory != NULL; }
+
+	// Drops all entries, keeps the memory
+	void			Clear();
+
+	const snapDeltaCacheEntry_t *	Find( const objJobState_t & newState, const objJobState_t & oldState );
+	// Returns NULL if the cache is out of memory
+	const snapDeltaCacheEntry_t *	Add( const objJobState_t & newState, const objJobState_t & oldState, bool same, int32 csize, const uint8 * data, int dataSize );
+
+	int				GetNumHits() const { return numHits; }
+	int				GetNumMisses() const { return numMisses; }
+	int				GetMemoryUsed() const { return memoryUsed; }
+	void			ResetStats() { numHits = 0; numMisses = 0; }
+
+private:
+	idList< snapDeltaCacheEntry_t, TAG_NETWORKING >	entries;
+	idHashIndex		hash;
+	uint8 *			memory;
+	int				memoryUsed;
+	int				maxMemory;
+	int				numHits;
+	int				numMisses;
+
+	int				GetKey( const objJobState_t & newState, const objJobState_t & oldState ) const;
+	uint8 *			AllocData( int size );
+};
+
+// Block compare kernels for object states, 32 bytes at a time with SSE2 and 8 at a time otherwise
+extern int SnapObjFindDifferent( const uint8 * a, const uint8 * b, int start, int end );	// first byte in [start, end) that differs, or end
+extern int SnapObjFindSame( const uint8 * a, const uint8 * b, int start, int end );			// first byte in [start, end) that matches, or end
+extern int SnapObjCountDifferent( const uint8 * a, const uint8 * b, int size );
+extern void SnapObjSubtract( uint8 * dest, const uint8 * a, const uint8 * b, int size );	// dest = a - b per byte
+
 extern void SnapshotObjectJob( objParms_t * parms );
 extern void LZWJob( lzwParm_t * parm );
 
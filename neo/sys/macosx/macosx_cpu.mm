@@ -153,6 +153,24 @@ static void CPUID( int func, unsigned regs[4] ) {
 #endif // __i386__ _WIN32
 }
 
+/*
+================
+XGetBV0
+
+Returns the low bits of XCR0, which tell which register states the OS saves.
+Only valid when CPUID reports OSXSAVE.
+================
+*/
+static unsigned XGetBV0() {
+#if defined( __i386__ ) || defined( __x86_64__ )
+	unsigned regEAX, regEDX;
+	__asm__ __volatile__ ( "xgetbv" : "=a" ( regEAX ), "=d" ( regEDX ) : "c" ( 0 ) );
+	return regEAX;
+#else
+	return 0;
+#endif
+}
+
 
 /*
 ================
@@ -298,6 +316,95 @@ static bool HasSSE3() {
 	return false;
 }
 
+/*
+================
+HasSSE41
+================
+*/
+static bool HasSSE41() {
+	unsigned regs[4];
+
+	// get CPU feature bits
+	CPUID( 1, regs );
+
+	// bit 19 of ECX denotes SSE4.1 existence
+	if ( regs[_REG_ECX] & ( 1 << 19 ) ) {
+		return true;
+	}
+	return false;
+}
+
+/*
+================
+HasAVX
+================
+*/
+static bool HasAVX() {
+	unsigned regs[4];
+
+	// get CPU feature bits
+	CPUID( 1, regs );
+
+	// bit 28 of ECX denotes AVX existence, bit 27 that the OS uses XSAVE
+	if ( ( regs[_REG_ECX] & ( 1 << 28 ) ) == 0 || ( regs[_REG_ECX] & ( 1 << 27 ) ) == 0 ) {
+		return false;
+	}
+
+	// the OS has to save the XMM and YMM registers on a context switch
+	if ( ( XGetBV0() & 6 ) != 6 ) {
+		return false;
+	}
+	return true;
+}
+
+/*
+================
+HasAVX2
+================
+*/
+static bool HasAVX2() {
+	unsigned regs[4];
+
+	if ( !HasAVX() ) {
+		return false;
+	}
+
+	// check the highest standard function
+	CPUID( 0, regs );
+	if ( regs[_REG_EAX] < 7 ) {
+		return false;
+	}
+
+	// bit 5 of EBX denotes AVX2 existence
+	CPUID( 7, regs );
+	if ( regs[_REG_EBX] & ( 1 << 5 ) ) {
+		return true;
+	}
+	return false;
+}
+
+/*
+================
+HasFMA3
+================
+*/
+static bool HasFMA3() {
+	unsigned regs[4];
+
+	if ( !HasAVX() ) {
+		return false;
+	}
+
+	// get CPU feature bits
+	CPUID( 1, regs );
+
+	// bit 12 of ECX denotes FMA3 existence
+	if ( regs[_REG_ECX] & ( 1 << 12 ) ) {
+		return true;
+	}
+	return false;
+}
+
 /*
 ================
 LogicalProcPerPhysicalProc
@@ -502,6 +609,26 @@ cpuid_t Sys_GetCPUId() {
 		flags |= CPUID_SSE3;
 	}
 
+	// check for Streaming SIMD Extensions 4.1
+	if ( HasSSE41() ) {
+		flags |= CPUID_SSE41;
+	}
+
+	// check for Advanced Vector Extensions
+	if ( HasAVX() ) {
+		flags |= CPUID_AVX;
+	}
+
+	// check for Advanced Vector Extensions 2
+	if ( HasAVX2() ) {
+		flags |= CPUID_AVX2;
+	}
+
+	// check for three operand Fused Multiply-Add
+	if ( HasFMA3() ) {
+		flags |= CPUID_FMA3;
+	}
+
 	// check for Hyper-Threading Technology
 	if ( HasHTT() ) {
 		flags |= CPUID_HTT;
@@ -384,6 +384,49 @@ void Net_SendUDPPacket( int netSocket, int length, const void *data, const netad
 	}
 }
 
+/*
+========================
+Net_SendUDPPackets
+
+Returns the number of system calls it took
+========================
+*/
+int Net_SendUDPPackets( int netSocket, const netadr_t *to, const byte *data, int stride, const int *sizes, int numPackets ) {
+	if ( !netSocket ) {
+		return 0;
+	}
+
+	for ( int i = 0; i < numPackets; i++ ) {
+		Net_SendUDPPacket( netSocket, sizes[i], data + i * stride, to[i] );
+	}
+	return numPackets;
+}
+
+/*
+========================
+Net_GetUDPPackets
+
+Reads up to maxPackets, returns how many were read and the number of system calls it took in calls
+========================
+*/
+int Net_GetUDPPackets( int netSocket, netadr_t *from, byte *data, int stride, int *sizes, int maxPackets, int &calls ) {
+	calls = 0;
+
+	if ( !netSocket ) {
+		return 0;
+	}
+
+	int numPackets = 0;
+	while ( numPackets < maxPackets ) {
+		calls++;
+		if ( !Net_GetUDPPacket( netSocket, from[numPackets], (char *)( data + numPackets * stride ), sizes[numPackets], stride ) ) {
+			break;
+		}
+		numPackets++;
+	}
+	return numPackets;
+}
+
 /*
 ========================
 Sys_InitNetworking
@@ -704,6 +747,8 @@ idUDP::idUDP() {
 	bytesRead = 0;
 	packetsWritten = 0;
 	bytesWritten = 0;
+	recvCalls = 0;
+	sendCalls = 0;
 }
 
 /*
@@ -754,6 +799,7 @@ bool idUDP::GetPacket( netadr_t &from, void *data, int &size, int maxSize ) {
 
 	while ( 1 ) {
 
+		recvCalls++;
 		ret = Net_GetUDPPacket( netSocket, from, (char *)data, size, maxSize );
 		if ( !ret ) {
 			break;
@@ -804,5 +850,49 @@ void idUDP::SendPacket( const netadr_t to, const void *data, int size ) {
 		return;
 	}
 
+	sendCalls++;
 	Net_SendUDPPacket( netSocket, size, data, to );
 }
+
+/*
+========================
+idUDP::SendPackets
+========================
+*/
+void idUDP::SendPackets( const netadr_t *to, const byte *data, int stride, const int *sizes, int numPackets ) {
+	int start = 0;
+	for ( int i = 0; i <= numPackets; i++ ) {
+		if ( i < numPackets && to[i].type != NA_BAD ) {
+			packetsWritten++;
+			bytesWritten += sizes[i];
+			continue;
+		}
+
+		// send the run of good packets before this one
+		if ( i > start && !silent ) {
+			sendCalls += Net_SendUDPPackets( netSocket, to + start, data + start * stride, stride, sizes + start, i - start );
+		}
+		if ( i < numPackets ) {
+			idLib::Warning( "idUDP::SendPackets: bad address type NA_BAD - ignored" );
+		}
+		start = i + 1;
+	}
+}
+
+/*
+========================
+idUDP::GetPackets
+========================
+*/
+int idUDP::GetPackets( netadr_t *from, byte *data, int stride, int *sizes, int maxPackets ) {
+	int calls = 0;
+	int numPackets = Net_GetUDPPackets( netSocket, from, data, stride, sizes, maxPackets, calls );
+
+	recvCalls += calls;
+	packetsRead += numPackets;
+	for ( int i = 0; i < numPackets; i++ ) {
+		bytesRead += sizes[i];
+	}
+
+	return numPackets;
+}
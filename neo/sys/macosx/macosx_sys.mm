@@ -44,6 +44,7 @@ If you have questions concerning this license or the applicable additional terms
 #import <sys/sysctl.h>
 #import <sys/stat.h>
 #import <sys/statvfs.h>
+#import <sys/mman.h>
 #import <dirent.h>
 
 #import <dlfcn.h>
@@ -393,6 +394,57 @@ ID_TIME_T Sys_FileTimeStamp( idFileHandle fp ) {
 	return st.st_mtime;
 }
 
+/*
+========================
+Sys_MapFile
+========================
+*/
+const void * Sys_MapFile( idFileHandle fp, int length ) {
+	if ( fp == NULL || length <= 0 ) {
+		return NULL;
+	}
+	void * data = mmap( NULL, length, PROT_READ, MAP_PRIVATE, fileno( fp ), 0 );
+	if ( data == MAP_FAILED ) {
+		return NULL;
+	}
+	return data;
+}
+
+/*
+========================
+Sys_UnmapFile
+========================
+*/
+void Sys_UnmapFile( const void * data, int length ) {
+	if ( data != NULL ) {
+		munmap( const_cast< void * >( data ), length );
+	}
+}
+
+/*
+========================
+Sys_AdviseMappedFile
+========================
+*/
+void Sys_AdviseMappedFile( const void * data, int length, fileMapAdvice_t advice ) {
+	if ( data == NULL || length <= 0 ) {
+		return;
+	}
+
+	// madvise wants a page aligned start
+	const uintptr_t pageSize = (uintptr_t)getpagesize();
+	const uintptr_t start = (uintptr_t)data & ~( pageSize - 1 );
+	const size_t size = length + ( (uintptr_t)data - start );
+
+	int flags = MADV_NORMAL;
+	if ( advice == FILEMAP_ADVICE_SEQUENTIAL ) {
+		flags = MADV_SEQUENTIAL;
+	} else if ( advice == FILEMAP_ADVICE_WILLNEED ) {
+		flags = MADV_WILLNEED;
+	}
+	madvise( (void *)start, size, flags );
+}
+
 /*
 ========================
 Sys_Rmdir
@@ -898,6 +950,18 @@ void Sys_Init() {
 		if ( osx.cpuid & CPUID_SSE3 ) {
 			string += "SSE3 & ";
 		}
+		if ( osx.cpuid & CPUID_SSE41 ) {
+			string += "SSE4.1 & ";
+		}
+		if ( osx.cpuid & CPUID_AVX ) {
+			string += "AVX & ";
+		}
+		if ( osx.cpuid & CPUID_AVX2 ) {
+			string += "AVX2 & ";
+		}
+		if ( osx.cpuid & CPUID_FMA3 ) {
+			string += "FMA & ";
+		}
 		if ( osx.cpuid & CPUID_HTT ) {
 			string += "HTT & ";
 		}
@@ -927,6 +991,14 @@ void Sys_Init() {
 				id |= CPUID_SSE2;
 			} else if ( token.Icmp( "sse3" ) == 0 ) {
 				id |= CPUID_SSE3;
+			} else if ( token.Icmp( "sse4.1" ) == 0 ) {
+				id |= CPUID_SSE41;
+			} else if ( token.Icmp( "avx" ) == 0 ) {
+				id |= CPUID_AVX;
+			} else if ( token.Icmp( "avx2" ) == 0 ) {
+				id |= CPUID_AVX2;
+			} else if ( token.Icmp( "fma" ) == 0 ) {
+				id |= CPUID_FMA3;
 			} else if ( token.Icmp( "htt" ) == 0 ) {
 				id |= CPUID_HTT;
 			}
@@ -839,6 +839,7 @@ public:		// Turning this on for now, for the sake of getting this up and running
 
 	lzwCompressionData_t *				lzwData;				// Shared across all snapshot jobs
 	uint8 *								objMemory;				// Shared across all snapshot jobs
+	idSnapDeltaCache					snapDeltaCache;			// Encoded object deltas shared across all peers in a frame
 	bool								haveSubmittedSnaps;		// True if we previously submitted snaps to jobs
 	idSnapShot *						localReadSS;
 
@@ -74,14 +74,45 @@ public:
 	bool ReadRawPacket( lobbyAddress_t & from, void * data, int & size, int maxSize  );
 	void SendRawPacket( const lobbyAddress_t & to, const void * data, int size );
 
+	// Sends the packets net_socketBatch held back this frame
+	void FlushSendBatch();
+	// Call once a frame after the lobbies have pumped their packets
+	void EndFrame();
+
 	bool IsOpen();
 	void Close();
 	
 private:
+	static const int MAX_BATCH_PACKETS	= 64;
+	static const int BATCH_STRIDE		= idPacketProcessor::MAX_FINAL_PACKET_SIZE;
+
+	bool	UseBatching() const;
+
 	float	forcePacketDropCurr;	// Used with net_forceDrop and net_forceDropCorrelation
 	float	forcePacketDropPrev;
 
 	idUDP	UDP;
+
+	// Packets waiting to go out in one batched send
+	int			numSendBatch;
+	netadr_t	sendBatchTo[MAX_BATCH_PACKETS];
+	int			sendBatchSizes[MAX_BATCH_PACKETS];
+	byte		sendBatchData[MAX_BATCH_PACKETS * BATCH_STRIDE];
+
+	// Packets read by the last batched receive that haven't been handed out yet
+	int			numRecvBatch;
+	int			recvBatchRead;
+	netadr_t	recvBatchFrom[MAX_BATCH_PACKETS];
+	int			recvBatchSizes[MAX_BATCH_PACKETS];
+	byte		recvBatchData[MAX_BATCH_PACKETS * BATCH_STRIDE];
+
+	// net_showSocketBatch
+	int			statsStartTime;
+	int			statsFrames;
+	int			statsSendCalls;
+	int			statsRecvCalls;
+	int			statsPacketsWritten;
+	int			statsPacketsRead;
 };
 
 struct lobbyUser_t {
@@ -53,6 +53,9 @@ idCVar net_pingIncPercentBeforeRecover( "net_pingIncPercentBeforeRecover", "1.3"
 idCVar net_maxFailedPingRecoveries( "net_maxFailedPingRecoveries", "10", CVAR_INTEGER, "Max failed ping recoveries before we stop trying" );
 idCVar net_pingRecoveryThrottleTimeInSeconds( "net_pingRecoveryThrottleTimeInSeconds", "3", CVAR_INTEGER, "Throttle snaps for this amount of time in seconds to recover from ping spike" );
 
+idCVar net_snapDeltaCache( "net_snapDeltaCache", "1", CVAR_BOOL, "Share encoded snapshot object deltas between peers that have the same base state for an object" );
+idCVar net_snapDeltaCacheMemory( "net_snapDeltaCacheMemory", "1024", CVAR_INTEGER | CVAR_INIT, "Size in KB of the shared snapshot delta cache" );
+
 idCVar net_peer_timeout_loading( "net_peer_timeout_loading", "90000", CVAR_INTEGER, "time in MS to disconnect clients during loading - production only" );
 
 
@@ -79,6 +82,15 @@ void idLobby::UpdateSnaps() {
 		return;
 	}
 
+	// The cached deltas point at the snapshot buffers of the last pass, which may be gone by now
+	if ( net_snapDeltaCache.GetBool() ) {
+		if ( !snapDeltaCache.IsInitialized() ) {
+			snapDeltaCache.Init( net_snapDeltaCacheMemory.GetInteger() * 1024 );
+		}
+		snapDeltaCache.Clear();
+		snapDeltaCache.ResetStats();
+	}
+
 	for ( int p = 0; p < peers.Num(); p++ ) {
 		peer_t & peer = peers[p];
 	
@@ -95,6 +107,10 @@ void idLobby::UpdateSnaps() {
 		}
 	}
 
+	if ( net_snapDeltaCache.GetBool() && snapDeltaCache.GetNumHits() + snapDeltaCache.GetNumMisses() > 0 ) {
+		NET_VERBOSESNAPSHOT_PRINT_LEVEL( 3, va( "  Snap delta cache: %d hits, %d misses, %d bytes\n", snapDeltaCache.GetNumHits(), snapDeltaCache.GetNumMisses(), snapDeltaCache.GetMemoryUsed() ) );
+	}
+
 #if 0
 	uint64 endTimeMicroSec = Sys_Microseconds();
 
@@ -198,7 +214,8 @@ bool idLobby::SubmitPendingSnap( int p ) {
 	assert( !peer.snapProc->PendingSnapReadyToSend() );
 	
 	// Submit snapshot delta to jobs
-	peer.snapProc->SubmitPendingSnap( p + 1, objMemory, SNAP_OBJ_JOB_MEMORY, lzwData );
+	idSnapDeltaCache * deltaCache = ( net_snapDeltaCache.GetBool() && snapDeltaCache.IsInitialized() ) ? &snapDeltaCache : NULL;
+	peer.snapProc->SubmitPendingSnap( p + 1, objMemory, SNAP_OBJ_JOB_MEMORY, lzwData, deltaCache );
 
 	NET_VERBOSESNAPSHOT_PRINT_LEVEL( 2, va("  Submitted snapshot to jobList for peer %d. Since last jobsub: %d\n", p, timeFromLastSub ) );
 	
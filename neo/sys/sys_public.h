@@ -51,12 +51,16 @@ enum cpuid_t {
 	CPUID_SSE2							= 0x00080,	// Streaming SIMD Extensions 2
 	CPUID_SSE3							= 0x00100,	// Streaming SIMD Extentions 3 aka Prescott's New Instructions
 	CPUID_ALTIVEC						= 0x00200,	// AltiVec
+	CPUID_SSE41							= 0x00400,	// Streaming SIMD Extensions 4.1
 	CPUID_HTT							= 0x01000,	// Hyper-Threading Technology
 	CPUID_CMOV							= 0x02000,	// Conditional Move (CMOV) and fast floating point comparison (FCOMI) instructions
 	CPUID_FTZ							= 0x04000,	// Flush-To-Zero mode (denormal results are flushed to zero)
 	CPUID_DAZ							= 0x08000,	// Denormals-Are-Zero mode (denormal source operands are set to zero)
 	CPUID_XENON							= 0x10000,	// Xbox 360
-	CPUID_CELL							= 0x20000	// PS3
+	CPUID_CELL							= 0x20000,	// PS3
+	CPUID_AVX							= 0x40000,	// Advanced Vector Extensions, including OS support for the YMM registers
+	CPUID_AVX2							= 0x80000,	// Advanced Vector Extensions 2
+	CPUID_FMA3							= 0x100000	// three operand Fused Multiply-Add
 };
 
 enum fpuExceptions_t {
@@ -538,6 +542,16 @@ typedef FILE*	idFileHandle;
 #endif // ID_PC_WIN
 
 ID_TIME_T		Sys_FileTimeStamp( idFileHandle fp );
+
+// read only memory mapping of an open file, returns NULL if the file can't be mapped
+enum fileMapAdvice_t {
+	FILEMAP_ADVICE_NORMAL,
+	FILEMAP_ADVICE_SEQUENTIAL,		// pages will be read in order once
+	FILEMAP_ADVICE_WILLNEED			// start reading the pages in ahead of their use
+};
+const void *	Sys_MapFile( idFileHandle fp, int length );
+void			Sys_UnmapFile( const void * data, int length );
+void			Sys_AdviseMappedFile( const void * data, int length, fileMapAdvice_t advice );
 // NOTE: do we need to guarantee the same output on all platforms?
 const char *	Sys_TimeStampToStr( ID_TIME_T timeStamp );
 const char *	Sys_SecToStr( int sec );
@@ -619,6 +633,11 @@ public:
 
 	void		SendPacket( const netadr_t to, const void *data, int size );
 
+	// Batched versions of SendPacket and GetPacket, packet i lives at data + i * stride.
+	// The current implementations still make one system call per packet, so this saves nothing yet.
+	void		SendPackets( const netadr_t *to, const byte *data, int stride, const int *sizes, int numPackets );
+	int			GetPackets( netadr_t *from, byte *data, int stride, int *sizes, int maxPackets );
+
 	void		SetSilent( bool silent ) { this->silent = silent; }
 	bool		GetSilent() const { return silent; }
 
@@ -628,6 +647,9 @@ public:
 	int			packetsWritten;
 	int			bytesWritten;
 
+	int			recvCalls;		// socket system calls made to read and write packets
+	int			sendCalls;
+
 	bool		IsOpen() const { return netSocket > 0; }
 
 private:
@@ -60,6 +60,8 @@ idCVar net_offlineTransitionThreshold( "net_offlineTransitionThreshold", "1000",
 
 idCVar net_port( "net_port", "27015", CVAR_INTEGER, "host port number" ); // Port to host when using dedicated servers, port to broadcast on when looking for a dedicated server to connect to
 idCVar net_headlessServer( "net_headlessServer", "0", CVAR_BOOL, "toggle to automatically host a game and allow peer[0] to control menus" );
+idCVar net_socketBatch( "net_socketBatch", "0", CVAR_INTEGER, "Route socket reads and writes through the batched packet interface, sends are held until the end of the frame. The platform code still makes one system call per packet, so this only adds send latency for now. 0 = off, 1 = on net_headlessServer hosts, 2 = always", 0, 2 );
+idCVar net_showSocketBatch( "net_showSocketBatch", "0", CVAR_BOOL, "Print socket system calls per frame and packets per system call once a second" );
 
 const char * idSessionLocal::stateToString[ NUM_STATES ] = {
 	ASSERT_ENUM_STRING( STATE_PRESS_START, 0 ),
@@ -1784,6 +1786,9 @@ void idSessionLocal::Pump() {
 	GetGameLobby().PumpPackets();
 	GetGameStateLobby().PumpPackets();
 
+	// Everything this frame's lobbies wanted to send is queued now, send it as one batch
+	GetPort().EndFrame();
+
 	int currentTime = Sys_Milliseconds();
 
 	const int SHOW_MIGRATING_INFO_IN_SECONDS = 3;	// Show for at least this long once we start showing it
@@ -3801,10 +3806,28 @@ idNetSessionPort::idNetSessionPort
 */
 idNetSessionPort::idNetSessionPort() :
 	forcePacketDropPrev( 0.0f ),
-	forcePacketDropCurr( 0.0f )
+	forcePacketDropCurr( 0.0f ),
+	numSendBatch( 0 ),
+	numRecvBatch( 0 ),
+	recvBatchRead( 0 ),
+	statsStartTime( 0 ),
+	statsFrames( 0 ),
+	statsSendCalls( 0 ),
+	statsRecvCalls( 0 ),
+	statsPacketsWritten( 0 ),
+	statsPacketsRead( 0 )
 {
 }
 
+/*
+========================
+idNetSessionPort::UseBatching
+========================
+*/
+bool idNetSessionPort::UseBatching() const {
+	return net_socketBatch.GetInteger() == 2 || ( net_socketBatch.GetInteger() == 1 && net_headlessServer.GetBool() );
+}
+
 /*
 ========================
 idNetSessionPort::InitPort
@@ -3820,7 +3843,26 @@ idNetSessionPort::ReadRawPacket
 ========================
 */
 bool idNetSessionPort::ReadRawPacket( lobbyAddress_t & from, void * data, int & size, int maxSize  ) {
-	bool result = UDP.GetPacket( from.netAddr, data, size, maxSize );
+	bool result = false;
+
+	if ( recvBatchRead == numRecvBatch && UseBatching() ) {
+		// Read whatever is waiting on the socket, and hand the packets out from the batch
+		numRecvBatch = UDP.GetPackets( recvBatchFrom, recvBatchData, BATCH_STRIDE, recvBatchSizes, MAX_BATCH_PACKETS );
+		recvBatchRead = 0;
+	}
+
+	if ( recvBatchRead < numRecvBatch ) {
+		const int i = recvBatchRead++;
+		if ( !verify( recvBatchSizes[i] <= maxSize ) ) {
+			return false;
+		}
+		from.netAddr = recvBatchFrom[i];
+		size = recvBatchSizes[i];
+		memcpy( data, &recvBatchData[i * BATCH_STRIDE], size );
+		result = true;
+	} else if ( !UseBatching() ) {
+		result = UDP.GetPacket( from.netAddr, data, size, maxSize );
+	}
 	
 	static idRandom2 random( Sys_Milliseconds() );
 	if ( net_forceDrop.GetInteger() != 0 ) {
@@ -3845,7 +3887,74 @@ void idNetSessionPort::SendRawPacket( const lobbyAddress_t & to, const void * da
 	}
 	assert( size <= idPacketProcessor::MAX_FINAL_PACKET_SIZE );
 	
-	UDP.SendPacket( to.netAddr, data, size );
+	if ( !UseBatching() ) {
+		FlushSendBatch();		// in case batching was just turned off
+		UDP.SendPacket( to.netAddr, data, size );
+		return;
+	}
+
+	if ( numSendBatch == MAX_BATCH_PACKETS ) {
+		FlushSendBatch();
+	}
+	sendBatchTo[numSendBatch]		= to.netAddr;
+	sendBatchSizes[numSendBatch]	= size;
+	memcpy( &sendBatchData[numSendBatch * BATCH_STRIDE], data, size );
+	numSendBatch++;
+}
+
+/*
+========================
+idNetSessionPort::FlushSendBatch
+========================
+*/
+void idNetSessionPort::FlushSendBatch() {
+	if ( numSendBatch == 0 ) {
+		return;
+	}
+	UDP.SendPackets( sendBatchTo, sendBatchData, BATCH_STRIDE, sendBatchSizes, numSendBatch );
+	numSendBatch = 0;
+}
+
+/*
+========================
+idNetSessionPort::EndFrame
+========================
+*/
+void idNetSessionPort::EndFrame() {
+	FlushSendBatch();
+
+	if ( !net_showSocketBatch.GetBool() ) {
+		statsStartTime = 0;
+		return;
+	}
+
+	const int time = Sys_Milliseconds();
+	if ( statsStartTime == 0 ) {
+		statsStartTime		= time;
+		statsFrames			= 0;
+		statsSendCalls		= UDP.sendCalls;
+		statsRecvCalls		= UDP.recvCalls;
+		statsPacketsWritten	= UDP.packetsWritten;
+		statsPacketsRead	= UDP.packetsRead;
+		return;
+	}
+
+	statsFrames++;
+
+	if ( time - statsStartTime < 1000 ) {
+		return;
+	}
+
+	const int sendCalls		= UDP.sendCalls - statsSendCalls;
+	const int recvCalls		= UDP.recvCalls - statsRecvCalls;
+	const int packetsOut	= UDP.packetsWritten - statsPacketsWritten;
+	const int packetsIn		= UDP.packetsRead - statsPacketsRead;
+
+	idLib::Printf( "socket %s: %.1f syscalls/frame (%.1f send, %.1f recv), %.1f packets/send call, %.1f packets/recv call\n", UseBatching() ? "batched" : "unbatched",
+		(float)( sendCalls + recvCalls ) / statsFrames, (float)sendCalls / statsFrames, (float)recvCalls / statsFrames,
+		sendCalls > 0 ? (float)packetsOut / sendCalls : 0.0f, recvCalls > 0 ? (float)packetsIn / recvCalls : 0.0f );
+
+	statsStartTime = 0;
 }
 
 /*
@@ -3863,6 +3972,12 @@ idNetSessionPort::Close
 ========================
 */
 void idNetSessionPort::Close() {
+	// don't drop what is still waiting to go out
+	FlushSendBatch();
+
+	numSendBatch	= 0;
+	numRecvBatch	= 0;
+	recvBatchRead	= 0;
 	UDP.Close();
 }
 
@@ -450,6 +450,46 @@ ID_TIME_T Sys_FileTimeStamp( idFileHandle fp ) {
 	return itime.QuadPart;
 }
 
+/*
+========================
+Sys_MapFile
+========================
+*/
+const void * Sys_MapFile( idFileHandle fp, int length ) {
+	if ( fp == NULL || fp == INVALID_HANDLE_VALUE || length <= 0 ) {
+		return NULL;
+	}
+	HANDLE mapping = CreateFileMapping( fp, NULL, PAGE_READONLY, 0, 0, NULL );
+	if ( mapping == NULL ) {
+		return NULL;
+	}
+	const void * data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, length );
+	// the view keeps the mapping object alive
+	CloseHandle( mapping );
+	return data;
+}
+
+/*
+========================
+Sys_UnmapFile
+========================
+*/
+void Sys_UnmapFile( const void * data, int length ) {
+	if ( data != NULL ) {
+		UnmapViewOfFile( data );
+	}
+}
+
+/*
+========================
+Sys_AdviseMappedFile
+
+There is no madvise equivalent before Windows 8, the system read ahead on page faults is used.
+========================
+*/
+void Sys_AdviseMappedFile( const void * data, int length, fileMapAdvice_t advice ) {
+}
+
 /*
 ========================
 Sys_Rmdir
@@ -1170,6 +1210,18 @@ void Sys_Init() {
 		if ( win32.cpuid & CPUID_SSE3 ) {
 			string += "SSE3 & ";
 		}
+		if ( win32.cpuid & CPUID_SSE41 ) {
+			string += "SSE4.1 & ";
+		}
+		if ( win32.cpuid & CPUID_AVX ) {
+			string += "AVX & ";
+		}
+		if ( win32.cpuid & CPUID_AVX2 ) {
+			string += "AVX2 & ";
+		}
+		if ( win32.cpuid & CPUID_FMA3 ) {
+			string += "FMA & ";
+		}
 		if ( win32.cpuid & CPUID_HTT ) {
 			string += "HTT & ";
 		}
@@ -1199,6 +1251,14 @@ void Sys_Init() {
 				id |= CPUID_SSE2;
 			} else if ( token.Icmp( "sse3" ) == 0 ) {
 				id |= CPUID_SSE3;
+			} else if ( token.Icmp( "sse4.1" ) == 0 ) {
+				id |= CPUID_SSE41;
+			} else if ( token.Icmp( "avx" ) == 0 ) {
+				id |= CPUID_AVX;
+			} else if ( token.Icmp( "avx2" ) == 0 ) {
+				id |= CPUID_AVX2;
+			} else if ( token.Icmp( "fma" ) == 0 ) {
+				id |= CPUID_FMA3;
 			} else if ( token.Icmp( "htt" ) == 0 ) {
 				id |= CPUID_HTT;
 			}
@@ -883,6 +883,8 @@ idUDP::idUDP() {
 	bytesRead = 0;
 	packetsWritten = 0;
 	bytesWritten = 0;
+	recvCalls = 0;
+	sendCalls = 0;
 }
 
 /*
@@ -933,6 +935,7 @@ bool idUDP::GetPacket( netadr_t &from, void *data, int &size, int maxSize ) {
 
 	while ( 1 ) {
 
+		recvCalls++;
 		ret = Net_GetUDPPacket( netSocket, from, (char *)data, size, maxSize );
 		if ( !ret ) {
 			break;
@@ -983,5 +986,32 @@ void idUDP::SendPacket( const netadr_t to, const void *data, int size ) {
 		return;
 	}
 
+	sendCalls++;
 	Net_SendUDPPacket( netSocket, size, data, to );
+}
+
+/*
+========================
+idUDP::SendPackets
+
+Winsock has no batched send, so this is one sendto per packet
+========================
+*/
+void idUDP::SendPackets( const netadr_t *to, const byte *data, int stride, const int *sizes, int numPackets ) {
+	for ( int i = 0; i < numPackets; i++ ) {
+		SendPacket( to[i], data + i * stride, sizes[i] );
+	}
+}
+
+/*
+========================
+idUDP::GetPackets
+========================
+*/
+int idUDP::GetPackets( netadr_t *from, byte *data, int stride, int *sizes, int maxPackets ) {
+	int numPackets = 0;
+	while ( numPackets < maxPackets && GetPacket( from[numPackets], data + numPackets * stride, sizes[numPackets], stride ) ) {
+		numPackets++;
+	}
+	return numPackets;
 }
\ No newline at end of file